@@ -0,0 +1,667 @@
+//==============================================================================
+//
+// File: CAnalyzer.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CAnalyzer class walks the syntax tree the parser built. It declares the
+// variables, checks the types and scopes, and evaluates the script at compile
+// time (folding the calls of the pure natives). Every error it finds is added
+// to the error list of the parser. The calls of the effectful natives are not
+// made while compiling. Every statement is lowered into IR while it's checked,
+// the IR of the statements is put together in the order of the script and
+// handed to the CCompiler, which emits the effectful calls into the program.
+//
+// The analysis takes two passes. The first pass declares the variables and
+// binds every name to its variable, this only depends on the order of the
+// script. It also finds out which top-level statements use the same variables.
+// The second pass checks and evaluates the top-level statements, statements
+// that don't share any variables can be evaluated on different threads.
+//
+//==============================================================================
+
+#include <utility>
+#include "CAnalyzer.h"
+#include "CLogger.h"
+#include "CFunctionWrapper.h"
+#include "CNativeCache.h"
+#include "CThreadPool.h"
+#include "CDiagnostics.h"
+#include "CCompiler.h"
+
+// The constructor of the CAnalyzer class, the errors are added to lErrorList
+CAnalyzer::CAnalyzer(ErrorList & lErrorList): m_oIndentation(0, 0)
+{
+	m_pErrorList = &lErrorList;
+	m_pProgram = NULL;
+	m_pTaskGraph = NULL;
+	m_iCurrentStatement = 0;
+}
+
+// Pushes back an error onto the error list, the message is only formatted when the error is printed
+void CAnalyzer::PushBackError(StatementErrorList & lErrors, int iErrorLine, eDiagnosticCode eCode, CDiagnosticArgument oFirst, CDiagnosticArgument oSecond)
+{
+	lErrors.push_back(CError(eCode, iErrorLine, oFirst, oSecond));
+}
+
+// Analyzes the entire script, the top-level statements are evaluated on iThreadCount threads
+void CAnalyzer::Run(const CAstBlock * pProgram, int iThreadCount, const int * piLineShifts)
+{
+	m_pProgram = pProgram;
+	size_t iStatementCount = pProgram->m_iStatementCount;
+
+	// The parser gave up after too many errors, the syntax tree is only part of the script
+	if(CDiagnostics::IsLimitReached(m_pErrorList->size()))
+		return;
+
+	// Only find out which statements depend on each other if there are threads to spread them over
+	if(iThreadCount > 1 && iStatementCount > 1)
+		m_pTaskGraph = new CTaskGraph(iStatementCount);
+
+	// The first pass, in the order of the script
+	for(m_iCurrentStatement = 0; m_iCurrentStatement < iStatementCount; m_iCurrentStatement++)
+		BindStatement(pProgram->m_ppStatements[m_iCurrentStatement]);
+
+	// The dependencies are in the task graph now
+	m_lLastWriters.clear();
+	m_lReaders.clear();
+
+	// The second pass, either on the threads or in the order of the script
+	m_lStatementResults.assign(iStatementCount, NULL);
+
+	if(m_pTaskGraph != NULL)
+	{
+		CThreadPool oThreadPool(iThreadCount);
+		m_pTaskGraph->Run(oThreadPool, AnalyzeTopLevelStatementTask, this);
+
+		delete m_pTaskGraph;
+		m_pTaskGraph = NULL;
+	}
+	else
+	{
+		for(size_t i = 0; i < iStatementCount; i++)
+			AnalyzeTopLevelStatement(i);
+	}
+
+	// Merge the errors and the IR in the order of the statements, this is the order they'd be found in without threads
+	// The loads of the variables become the values of the assignments before them, which puts the IR in SSA form
+	CIrFunction oProgram;
+	std::vector<IrValue> lVariableValues(m_lVariableList.size(), IR_NO_VALUE);
+
+	for(size_t i = 0; i < iStatementCount; i++)
+	{
+		CStatementResult * pResult = m_lStatementResults[i];
+
+		if(pResult == NULL)
+			continue;
+
+		// The statement moved since it was parsed, its nodes still have the old lines
+		if(piLineShifts != NULL && piLineShifts[i] != 0)
+		{
+			for(size_t j = 0; j < pResult->m_lErrors.size(); j++)
+				pResult->m_lErrors[j].m_iLine += piLineShifts[i];
+		}
+
+		m_pErrorList->insert(m_pErrorList->end(), pResult->m_lErrors.begin(), pResult->m_lErrors.end());
+
+		oProgram.Append(pResult->m_oCode, lVariableValues, piLineShifts != NULL ? piLineShifts[i] : 0);
+
+		delete pResult;
+	}
+
+	m_lStatementResults.clear();
+
+	// The program makes the effectful calls, the names of the variables are only used when the IR is dumped
+	std::vector<SymbolID> lVariableNames(m_lVariableList.size());
+
+	for(size_t i = 0; i < m_lVariableList.size(); i++)
+		lVariableNames[i] = m_lVariableList[i].m_iName;
+
+	oProgram.SetVariableNames(lVariableNames);
+	CCompiler::SetProgram(oProgram);
+
+	// Find the variables that are used before they're assigned and the values that are never read
+	// Nothing needs the dataflow but the warnings, so it's skipped if they're off
+	if(!CDiagnostics::AreWarningsEnabled())
+		return;
+
+	m_oDataflow.Run(pProgram, m_lVariableList.size());
+
+	const std::vector<CDataflowFinding> & lFindings = m_oDataflow.GetFindings();
+
+	for(size_t i = 0; i < lFindings.size() && !CDiagnostics::IsLimitReached(m_pErrorList->size()); i++)
+	{
+		const CDataflowEvent & oEvent = m_oDataflow.GetEvent(lFindings[i].m_iEvent);
+		int iLine = oEvent.m_pNode->m_iLine + (piLineShifts != NULL ? piLineShifts[oEvent.m_iStatement] : 0);
+
+		m_pErrorList->push_back(CError(lFindings[i].m_eCode, iLine, CDiagnosticArgument::Symbol(m_lVariableList[oEvent.m_iVariable].m_iName)));
+	}
+}
+
+// Declares the variables and binds the names in a block, a { } block opens a new scope
+void CAnalyzer::BindBlock(const CAstBlock * pBlock)
+{
+	// We found a {, open a new scope and increase the indentation level and the unique indentation id
+	if(pBlock->m_bBraced)
+	{
+		m_oSymbolTable.EnterScope();
+		m_oIndentation.m_iLevel++;
+		m_oIndentation.m_iLevelID++;
+	}
+
+	for(size_t i = 0; i < pBlock->m_iStatementCount; i++)
+		BindStatement(pBlock->m_ppStatements[i]);
+
+	// We found a }, close the scope, decrease the indentation level, keep increasing the unique id
+	if(pBlock->m_bBraced)
+	{
+		m_oSymbolTable.ExitScope();
+		m_oIndentation.m_iLevel--;
+		m_oIndentation.m_iLevelID++;
+	}
+}
+
+// Declares the variables and binds the names in a statement
+void CAnalyzer::BindStatement(const CAstNode * pStatement)
+{
+	switch(pStatement->m_eType)
+	{
+		case AST_NODE_BLOCK:
+			BindBlock((const CAstBlock *) pStatement);
+			break;
+
+		case AST_NODE_DECLARATION:
+		{
+			const CAstDeclaration * pDeclaration = (const CAstDeclaration *) pStatement;
+
+			// Bind the name in the current scope, this shadows the same name in the scopes around it
+			if(!m_oSymbolTable.Declare(pDeclaration->m_iName, m_lVariableList.size()))
+			{
+				// The second pass reports the error, and won't evaluate the initialiser
+				pDeclaration->m_iVariable = UNRESOLVED_VARIABLE;
+				break;
+			}
+
+			pDeclaration->m_iVariable = (unsigned int) m_lVariableList.size();
+
+			// Setup a CVariable object
+			CVariable oVariable;
+			oVariable.m_iName = pDeclaration->m_iName;
+			oVariable.m_eType = pDeclaration->m_eVariableType;
+			oVariable.m_oValue = CValue(pDeclaration->m_eVariableType);
+
+			// Save the indentation level for this variable
+			oVariable.m_oIndentation = m_oIndentation;
+
+			// Push it onto the variable list, the variable exists from here on (even in its own initialiser)
+			m_lVariableList.push_back(oVariable);
+
+			// The declaring statement is the first one to assign the variable
+			if(m_pTaskGraph != NULL)
+			{
+				m_lLastWriters.push_back(m_iCurrentStatement);
+				m_lReaders.push_back(std::vector<size_t>());
+			}
+
+			if(pDeclaration->m_pInitialiser != NULL)
+				BindExpression(pDeclaration->m_pInitialiser);
+			break;
+		}
+
+		case AST_NODE_ASSIGNMENT:
+		{
+			const CAstAssignment * pAssignment = (const CAstAssignment *) pStatement;
+			BindExpression(pAssignment->m_pTarget);
+			BindExpression(pAssignment->m_pValue);
+
+			// The target is assigned, not just used
+			if(pAssignment->m_pTarget->m_eType == AST_NODE_VARIABLE)
+			{
+				const CAstVariable * pTarget = (const CAstVariable *) pAssignment->m_pTarget;
+
+				if(pTarget->m_bInScope)
+					AddVariableUse(pTarget->m_iVariable, true);
+			}
+			break;
+		}
+
+		case AST_NODE_EXPRESSION_STATEMENT:
+			BindExpression(((const CAstExpressionStatement *) pStatement)->m_pExpression);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Binds the names in an expression to their variables
+void CAnalyzer::BindExpression(const CAstNode * pNode)
+{
+	switch(pNode->m_eType)
+	{
+		case AST_NODE_VARIABLE:
+		{
+			const CAstVariable * pVariable = (const CAstVariable *) pNode;
+			const CBinding * pBinding = m_oSymbolTable.Find(pVariable->m_iName);
+
+			// The second pass reports names that don't exist or aren't in scope
+			if(pBinding == NULL)
+			{
+				pVariable->m_iVariable = UNRESOLVED_VARIABLE;
+				pVariable->m_bInScope = false;
+				break;
+			}
+
+			pVariable->m_iVariable = (unsigned int) pBinding->m_iVariable;
+			pVariable->m_bInScope = pBinding->m_bInScope;
+
+			if(pBinding->m_bInScope)
+				AddVariableUse(pBinding->m_iVariable, false);
+			break;
+		}
+
+		case AST_NODE_NEGATION:
+			BindExpression(((const CAstNegation *) pNode)->m_pOperand);
+			break;
+
+		case AST_NODE_BINARY:
+			BindExpression(((const CAstBinary *) pNode)->m_pLeft);
+			BindExpression(((const CAstBinary *) pNode)->m_pRight);
+			break;
+
+		case AST_NODE_CALL:
+		{
+			const CAstCall * pCall = (const CAstCall *) pNode;
+
+			for(size_t i = 0; i < pCall->m_iArgumentCount; i++)
+				BindExpression(pCall->m_ppArguments[i]);
+
+			// The types of the arguments might have changed since the tree was analyzed before, resolve the call again
+			pCall->m_iFunctionHandle = INVALID_FUNCTION_HANDLE;
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Adds the dependencies of the current top-level statement on the statements before it that use the variable
+void CAnalyzer::AddVariableUse(size_t iVariable, bool bAssigned)
+{
+	if(m_pTaskGraph == NULL)
+		return;
+
+	// The value has to be the one the last assignment left behind
+	size_t iLastWriter = m_lLastWriters[iVariable];
+
+	if(iLastWriter != m_iCurrentStatement)
+		m_pTaskGraph->AddDependency(m_iCurrentStatement, iLastWriter);
+
+	std::vector<size_t> & lReaders = m_lReaders[iVariable];
+
+	if(!bAssigned)
+	{
+		// Remember we used it, a later assignment has to wait for us
+		if(iLastWriter != m_iCurrentStatement && (lReaders.empty() || lReaders.back() != m_iCurrentStatement))
+			lReaders.push_back(m_iCurrentStatement);
+
+		return;
+	}
+
+	// Assigning the variable has to wait until every statement that uses the current value is done
+	for(size_t i = 0; i < lReaders.size(); i++)
+	{
+		if(lReaders[i] != m_iCurrentStatement)
+			m_pTaskGraph->AddDependency(m_iCurrentStatement, lReaders[i]);
+	}
+
+	lReaders.clear();
+	m_lLastWriters[iVariable] = m_iCurrentStatement;
+}
+
+// Checks and evaluates one top-level statement, this runs on the threads of the task graph
+void CAnalyzer::AnalyzeTopLevelStatement(size_t iStatement)
+{
+	CStatementResult oResult;
+	AnalyzeStatement(oResult, m_pProgram->m_ppStatements[iStatement]);
+
+	if(oResult.m_lErrors.empty() && oResult.m_oCode.IsEmpty())
+		return;
+
+	m_lStatementResults[iStatement] = new CStatementResult();
+	m_lStatementResults[iStatement]->m_lErrors.swap(oResult.m_lErrors);
+	m_lStatementResults[iStatement]->m_oCode.Swap(oResult.m_oCode);
+}
+
+// The task the threads of the task graph run
+void CAnalyzer::AnalyzeTopLevelStatementTask(void * pAnalyzer, size_t iStatement)
+{
+	((CAnalyzer *) pAnalyzer)->AnalyzeTopLevelStatement(iStatement);
+}
+
+// Analyzes every statement of a block
+void CAnalyzer::AnalyzeBlock(CStatementResult & oResult, const CAstBlock * pBlock)
+{
+	for(size_t i = 0; i < pBlock->m_iStatementCount; i++)
+		AnalyzeStatement(oResult, pBlock->m_ppStatements[i]);
+}
+
+// Analyzes one statement
+void CAnalyzer::AnalyzeStatement(CStatementResult & oResult, const CAstNode * pStatement)
+{
+	switch(pStatement->m_eType)
+	{
+		case AST_NODE_BLOCK:
+			AnalyzeBlock(oResult, (const CAstBlock *) pStatement);
+			break;
+
+		case AST_NODE_DECLARATION:
+			AnalyzeDeclaration(oResult, (const CAstDeclaration *) pStatement);
+			break;
+
+		case AST_NODE_ASSIGNMENT:
+			AnalyzeAssignment(oResult, (const CAstAssignment *) pStatement);
+			break;
+
+		// The value of the expression isn't used, but a call still has to be made
+		case AST_NODE_EXPRESSION_STATEMENT:
+		{
+			CValue oValue;
+			IrValue iValue;
+			Evaluate(oResult, ((const CAstExpressionStatement *) pStatement)->m_pExpression, oValue, iValue);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Assigns the initialiser of a declaration to the variable
+void CAnalyzer::AnalyzeDeclaration(CStatementResult & oResult, const CAstDeclaration * pDeclaration)
+{
+	// The first pass couldn't declare the variable
+	if(pDeclaration->m_iVariable == UNRESOLVED_VARIABLE)
+	{
+		PushBackError(oResult.m_lErrors, pDeclaration->m_iLine, DIAGNOSTIC_VARIABLE_REDECLARED, CDiagnosticArgument::Symbol(pDeclaration->m_iName));
+		return;
+	}
+
+	if(pDeclaration->m_pInitialiser != NULL)
+		AssignValue(oResult, pDeclaration->m_iVariable, pDeclaration->m_pInitialiser, pDeclaration->m_iLine);
+}
+
+// Checks the target of an assignment, and assigns the value to it
+void CAnalyzer::AnalyzeAssignment(CStatementResult & oResult, const CAstAssignment * pAssignment)
+{
+	const CAstNode * pTarget = pAssignment->m_pTarget;
+
+	// We can only assign to variables
+	if(pTarget->m_eType != AST_NODE_VARIABLE)
+	{
+		// The user is trying to assign something to a constant value (for example: 5 = 3;)
+		if(pTarget->m_eType == AST_NODE_INTEGER_LITERAL || pTarget->m_eType == AST_NODE_FLOAT_LITERAL)
+			PushBackError(oResult.m_lErrors, pAssignment->m_iLine, DIAGNOSTIC_ASSIGNMENT_TO_CONSTANT, CDiagnosticArgument::Expression(pTarget));
+
+		// It's a string literal
+		else if(pTarget->m_eType == AST_NODE_STRING_LITERAL)
+			PushBackError(oResult.m_lErrors, pAssignment->m_iLine, DIAGNOSTIC_ASSIGNMENT_TO_STRING_LITERAL);
+
+		// It's a call or a calculation
+		else
+			PushBackError(oResult.m_lErrors, pAssignment->m_iLine, DIAGNOSTIC_ASSIGNMENT_TO_EXPRESSION, CDiagnosticArgument::Expression(pTarget));
+
+		return;
+	}
+
+	const CAstVariable * pVariable = (const CAstVariable *) pTarget;
+	SymbolID iName = pVariable->m_iName;
+
+	// Variable simply doesn't exist
+	if(pVariable->m_iVariable == UNRESOLVED_VARIABLE)
+	{
+		PushBackError(oResult.m_lErrors, pAssignment->m_iLine, DIAGNOSTIC_ASSIGNMENT_TO_UNDECLARED, CDiagnosticArgument::Symbol(iName));
+		return;
+	}
+
+	// The variable was declared in a block that has been closed
+	if(!pVariable->m_bInScope)
+	{
+		PushBackError(oResult.m_lErrors, pAssignment->m_iLine, DIAGNOSTIC_VARIABLE_OUT_OF_SCOPE, CDiagnosticArgument::Symbol(iName));
+		return;
+	}
+
+	AssignValue(oResult, pVariable->m_iVariable, pAssignment->m_pValue, pAssignment->m_iLine);
+}
+
+// Evaluates an expression and assigns it to a variable, if the types match
+void CAnalyzer::AssignValue(CStatementResult & oResult, size_t iVariable, const CAstNode * pValue, int iLine)
+{
+	CValue oValue;
+	IrValue iValue;
+
+	if(!Evaluate(oResult, pValue, oValue, iValue))
+		return;
+
+	CVariable & oVariable = m_lVariableList[iVariable];
+
+	// Type checking: make sure the value has the type of the variable
+	if(oValue.GetType() != oVariable.m_eType)
+	{
+		if(pValue->m_eType == AST_NODE_CALL)
+			PushBackError(oResult.m_lErrors, iLine, DIAGNOSTIC_RETURN_TYPE_MISMATCH, CDiagnosticArgument::Symbol(((const CAstCall *) pValue)->m_iFunction), CDiagnosticArgument::Symbol(oVariable.m_iName));
+		else if(pValue->m_eType == AST_NODE_STRING_LITERAL)
+			PushBackError(oResult.m_lErrors, iLine, DIAGNOSTIC_STRING_TYPE_MISMATCH, CDiagnosticArgument::Expression(pValue), CDiagnosticArgument::Symbol(oVariable.m_iName));
+		else
+			PushBackError(oResult.m_lErrors, iLine, DIAGNOSTIC_TYPE_MISMATCH, CDiagnosticArgument::Expression(pValue), CDiagnosticArgument::Symbol(oVariable.m_iName));
+
+		return;
+	}
+
+	// Set the hasBeenAssignedAnything flag to true
+	// This flags the variable as been defined
+	oVariable.m_bHasBeenAssignedAnything = true;
+
+	// Set the value, the evaluated value isn't needed anymore so a long string is moved instead of copied
+	oVariable.m_oValue = std::move(oValue);
+
+	// In the IR the assignment is a copy, which is the new value of the variable
+	oResult.m_oCode.AddCopy(iValue, (unsigned int) iVariable, iLine);
+}
+
+// Evaluates an expression at compile time, returns false if an error was found (and reported)
+bool CAnalyzer::Evaluate(CStatementResult & oResult, const CAstNode * pNode, CValue & oValue, IrValue & iValue)
+{
+	switch(pNode->m_eType)
+	{
+		case AST_NODE_INTEGER_LITERAL:
+			oValue.SetInteger(((const CAstIntegerLiteral *) pNode)->m_iValue);
+			iValue = oResult.m_oCode.AddConstant(oValue, pNode->m_iLine);
+			return true;
+
+		case AST_NODE_FLOAT_LITERAL:
+			oValue.SetFloat(((const CAstFloatLiteral *) pNode)->m_fValue);
+			iValue = oResult.m_oCode.AddConstant(oValue, pNode->m_iLine);
+			return true;
+
+		case AST_NODE_STRING_LITERAL:
+		{
+			SymbolID iString = ((const CAstStringLiteral *) pNode)->m_iValue;
+			oValue.SetString(CSymbolPool::GetString(iString), CSymbolPool::GetLength(iString));
+			iValue = oResult.m_oCode.AddConstant(oValue, pNode->m_iLine);
+			return true;
+		}
+
+		case AST_NODE_VARIABLE:
+			return EvaluateVariable(oResult, (const CAstVariable *) pNode, oValue, iValue);
+
+		case AST_NODE_NEGATION:
+			return EvaluateNegation(oResult, (const CAstNegation *) pNode, oValue, iValue);
+
+		case AST_NODE_BINARY:
+			return EvaluateBinary(oResult, (const CAstBinary *) pNode, oValue, iValue);
+
+		case AST_NODE_CALL:
+			return EvaluateCall(oResult, (const CAstCall *) pNode, oValue, iValue);
+
+		default:
+			return false;
+	}
+}
+
+// Evaluates a variable, it has to be declared in the current scope or in a scope around it
+bool CAnalyzer::EvaluateVariable(CStatementResult & oResult, const CAstVariable * pVariable, CValue & oValue, IrValue & iValue)
+{
+	if(pVariable->m_iVariable == UNRESOLVED_VARIABLE)
+	{
+		PushBackError(oResult.m_lErrors, pVariable->m_iLine, DIAGNOSTIC_UNDECLARED_VARIABLE, CDiagnosticArgument::Symbol(pVariable->m_iName));
+		return false;
+	}
+
+	// The variable was declared in a block that has been closed
+	if(!pVariable->m_bInScope)
+	{
+		PushBackError(oResult.m_lErrors, pVariable->m_iLine, DIAGNOSTIC_VARIABLE_OUT_OF_SCOPE, CDiagnosticArgument::Symbol(pVariable->m_iName));
+		return false;
+	}
+
+	oValue = m_lVariableList[pVariable->m_iVariable].m_oValue;
+	iValue = oResult.m_oCode.AddLoad(pVariable->m_iVariable, oValue.GetType(), pVariable->m_iLine);
+	return true;
+}
+
+// Evaluates -expression
+bool CAnalyzer::EvaluateNegation(CStatementResult & oResult, const CAstNegation * pNegation, CValue & oValue, IrValue & iValue)
+{
+	IrValue iOperand;
+
+	if(!Evaluate(oResult, pNegation->m_pOperand, oValue, iOperand))
+		return false;
+
+	// String doesn't support operator-
+	if(oValue.GetType() == VARIABLE_TYPE_STRING)
+	{
+		PushBackError(oResult.m_lErrors, pNegation->m_iLine, DIAGNOSTIC_STRING_MINUS);
+		return false;
+	}
+
+	// Negating the smallest integer wraps around instead of overflowing
+	NegateValue(oValue);
+	iValue = oResult.m_oCode.AddNegation(iOperand, pNegation->m_iLine);
+	return true;
+}
+
+// Evaluates left + right and left - right, both sides need the same type
+bool CAnalyzer::EvaluateBinary(CStatementResult & oResult, const CAstBinary * pBinary, CValue & oValue, IrValue & iValue)
+{
+	CValue oRightValue;
+	IrValue iLeft, iRight;
+
+	if(!Evaluate(oResult, pBinary->m_pLeft, oValue, iLeft) || !Evaluate(oResult, pBinary->m_pRight, oRightValue, iRight))
+		return false;
+
+	// Wait, are both sides of the same type?
+	if(oValue.GetType() != oRightValue.GetType())
+	{
+		PushBackError(oResult.m_lErrors, pBinary->m_iLine, DIAGNOSTIC_CONCATENATION_TYPE_MISMATCH, CDiagnosticArgument::Expression(pBinary->m_pLeft), CDiagnosticArgument::Expression(pBinary->m_pRight));
+		return false;
+	}
+
+	// String doesn't support operator-
+	if(pBinary->m_eOperator != PLUS_OPERATOR_TOKEN && oValue.GetType() == VARIABLE_TYPE_STRING)
+	{
+		PushBackError(oResult.m_lErrors, pBinary->m_iLine, DIAGNOSTIC_STRING_MINUS);
+		return false;
+	}
+
+	// int + int and int - int wrap around, string + string concats the strings (a long right side is linked into the rope, not copied)
+	eIrOpcode eOpcode = GetBinaryOpcode(pBinary->m_eOperator == PLUS_OPERATOR_TOKEN, oValue.GetType());
+	CombineValues(eOpcode, oValue, oRightValue);
+	iValue = oResult.m_oCode.AddBinary(eOpcode, iLeft, iRight, pBinary->m_iLine);
+	return true;
+}
+
+// Evaluates the arguments of a call and calls the function
+bool CAnalyzer::EvaluateCall(CStatementResult & oResult, const CAstCall * pCall, CValue & oValue, IrValue & iValue)
+{
+	// The parameter list for the function, and the IR values of the arguments
+	ParameterList lParameterList;
+	lParameterList.reserve(pCall->m_iArgumentCount);
+	std::vector<IrValue> lArguments(pCall->m_iArgumentCount);
+
+	for(size_t i = 0; i < pCall->m_iArgumentCount; i++)
+	{
+		CValue oArgument;
+
+		if(!Evaluate(oResult, pCall->m_ppArguments[i], oArgument, lArguments[i]))
+			return false;
+
+		// Move the argument onto the parameter list, it keeps the type of its value
+		lParameterList.push_back(std::move(oArgument));
+	}
+
+	// Resolve the call to an overload the first time, this also checks the parameters
+	// The types of the arguments of a call never change, so the handle can be reused
+	if(pCall->m_iFunctionHandle == INVALID_FUNCTION_HANDLE)
+	{
+		CError oError(DIAGNOSTIC_UNKNOWN_FUNCTION, pCall->m_iLine);
+		pCall->m_iFunctionHandle = CFunctionWrapper::ResolveFunction(pCall->m_iFunction, lParameterList, oError);
+
+		if(pCall->m_iFunctionHandle == INVALID_FUNCTION_HANDLE)
+		{
+			oResult.m_lErrors.push_back(oError);
+			return false;
+		}
+	}
+
+	const IrValue * piArguments = lArguments.empty() ? NULL : &lArguments[0];
+
+	// An effectful function isn't called while compiling, the call is emitted into the program
+	// Effectful functions return nothing, so the call evaluates to the integer 0
+	if(CFunctionWrapper::IsEffectful(pCall->m_iFunctionHandle))
+	{
+		oValue = CValue();
+		iValue = oResult.m_oCode.AddCall(pCall->m_iFunctionHandle, piArguments, lArguments.size(), VARIABLE_TYPE_INTEGER, pCall->m_iLine);
+		return true;
+	}
+
+	// A pure function only computes its result, fold the call into its value
+	// Scripts make the same calls over and over, the cache remembers the results of the calls folded before
+	if(!CNativeCache::Find(pCall->m_iFunctionHandle, lParameterList, oValue))
+	{
+		oValue = CFunctionWrapper::CallFunction(pCall->m_iFunctionHandle, lParameterList.empty() ? NULL : &lParameterList[0]);
+		CNativeCache::Add(pCall->m_iFunctionHandle, lParameterList, oValue);
+	}
+
+	// The IR keeps the call, the type of the result is only known now
+	iValue = oResult.m_oCode.AddCall(pCall->m_iFunctionHandle, piArguments, lArguments.size(), oValue.GetType(), pCall->m_iLine);
+	return true;
+}
+
+// Logs every variable and its value, this method is only available when compiling in debug mode
+#if _DEBUG
+void CAnalyzer::LogVariables()
+{
+	CLogger::Write("\n* Variables found:");
+	for(VariableList::iterator iterator = m_lVariableList.begin(); iterator != m_lVariableList.end(); iterator++)
+	{
+		// Check if the variable has been assigned anything
+		if((*iterator).m_bHasBeenAssignedAnything)
+		{
+			// Output the variable name and type
+			if((*iterator).m_eType == VARIABLE_TYPE_INTEGER)
+				CLogger::Write("Variable %s (integer) has value %d (tab level: %d, tab id: %d)", CSymbolPool::GetString((*iterator).m_iName), (*iterator).m_oValue.GetInteger(), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+
+			if((*iterator).m_eType == VARIABLE_TYPE_FLOAT)
+				CLogger::Write("Variable %s (float) has value %.2f (tab level: %d, tab id: %d)", CSymbolPool::GetString((*iterator).m_iName), (*iterator).m_oValue.GetFloat(), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+
+			if((*iterator).m_eType == VARIABLE_TYPE_STRING)
+				CLogger::Write("Variable %s (string) has value %s (tab level: %d, tab id: %d)", CSymbolPool::GetString((*iterator).m_iName), (*iterator).m_oValue.GetString(), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+		}
+
+		else CLogger::Write("Variable %s has been declared but not yet defined. (tab level: %d, tab id: %d)", CSymbolPool::GetString((*iterator).m_iName), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+//==============================================================================
+//
+// File: CAnalyzer.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CAnalyzer class walks the syntax tree the parser built. It declares the
+// variables, checks the types and scopes, and evaluates the script at compile
+// time (folding the calls of the pure natives). Every error it finds is added
+// to the error list of the parser. The calls of the effectful natives are not
+// made while compiling. Every statement is lowered into IR while it's checked,
+// the IR of the statements is put together in the order of the script and
+// handed to the CCompiler, which emits the effectful calls into the program.
+//
+// The analysis takes two passes. The first pass declares the variables and
+// binds every name to its variable, this only depends on the order of the
+// script. It also finds out which top-level statements use the same variables.
+// The second pass checks and evaluates the top-level statements, statements
+// that don't share any variables can be evaluated on different threads.
+//
+//==============================================================================
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <vector>
+#include "CAst.h"
+#include "CError.h"
+#include "CVariable.h"
+#include "CSymbolTable.h"
+#include "CTaskGraph.h"
+#include "CDataflow.h"
+#include "CIr.h"
+
+// The errors found in one top-level statement
+typedef std::vector<CError> StatementErrorList;
+
+// What checking and evaluating one top-level statement gives
+struct CStatementResult
+{
+	// The errors found in the statement
+	StatementErrorList m_lErrors;
+	// The IR of the statement, its variables are loads until it's put together with the other statements
+	CIrFunction m_oCode;
+};
+
+class CAnalyzer
+{
+	// Every variable declared in the script, in the order of the declarations
+	VariableList m_lVariableList;
+	// Binds the variable names to the variables on m_lVariableList, scope by scope (first pass only)
+	CSymbolTable m_oSymbolTable;
+	// The list the errors are added to
+	ErrorList * m_pErrorList;
+	// The indentation level and ID of the block that's being bound, numbered the same way the tokenizer does
+	// Only used to log where the variables were declared
+	CIndentation m_oIndentation;
+
+	// The script that's being analyzed
+	const CAstBlock * m_pProgram;
+	// The errors and IR of every top-level statement, NULL if the statement has neither
+	// Every statement has its own lists, so they can be merged in the order of the script
+	std::vector<CStatementResult *> m_lStatementResults;
+
+	// The top-level statements and the variables they share, NULL if the statements are evaluated in order
+	CTaskGraph * m_pTaskGraph;
+	// The top-level statement that's being bound
+	size_t m_iCurrentStatement;
+	// For every variable, the last top-level statement that assigned it
+	std::vector<size_t> m_lLastWriters;
+	// For every variable, the top-level statements that used it since it was last assigned
+	std::vector<std::vector<size_t> > m_lReaders;
+	// The uses and assignments of the variables, and what flows between them
+	CDataflow m_oDataflow;
+
+	// This method pushes back an error on the list, the message is only formatted when the error is printed
+	static void PushBackError(StatementErrorList & lErrors, int iErrorLine, eDiagnosticCode eCode, CDiagnosticArgument oFirst = CDiagnosticArgument(), CDiagnosticArgument oSecond = CDiagnosticArgument());
+
+	// The first pass: declares the variables and binds the names in a block, a { } block opens a new scope
+	void BindBlock(const CAstBlock * pBlock);
+	void BindStatement(const CAstNode * pStatement);
+	void BindExpression(const CAstNode * pNode);
+	// Adds the dependencies of the current top-level statement on the statements before it that use the variable
+	void AddVariableUse(size_t iVariable, bool bAssigned);
+
+	// The second pass: checks and evaluates one top-level statement, this runs on the threads of the task graph
+	void AnalyzeTopLevelStatement(size_t iStatement);
+	static void AnalyzeTopLevelStatementTask(void * pAnalyzer, size_t iStatement);
+	// Analyzes every statement of a block
+	void AnalyzeBlock(CStatementResult & oResult, const CAstBlock * pBlock);
+	// Analyzes one statement
+	void AnalyzeStatement(CStatementResult & oResult, const CAstNode * pStatement);
+	// Assigns the initialiser of a declaration to the variable
+	void AnalyzeDeclaration(CStatementResult & oResult, const CAstDeclaration * pDeclaration);
+	// Checks the target of an assignment, and assigns the value to it
+	void AnalyzeAssignment(CStatementResult & oResult, const CAstAssignment * pAssignment);
+	// Evaluates an expression and assigns it to a variable, if the types match
+	void AssignValue(CStatementResult & oResult, size_t iVariable, const CAstNode * pValue, int iLine);
+
+	// Evaluates an expression at compile time, returns false if an error was found (and reported)
+	// The expression is lowered into the IR of the statement as well, iValue is the IR value of the result
+	bool Evaluate(CStatementResult & oResult, const CAstNode * pNode, CValue & oValue, IrValue & iValue);
+	bool EvaluateVariable(CStatementResult & oResult, const CAstVariable * pVariable, CValue & oValue, IrValue & iValue);
+	bool EvaluateNegation(CStatementResult & oResult, const CAstNegation * pNegation, CValue & oValue, IrValue & iValue);
+	bool EvaluateBinary(CStatementResult & oResult, const CAstBinary * pBinary, CValue & oValue, IrValue & iValue);
+	bool EvaluateCall(CStatementResult & oResult, const CAstCall * pCall, CValue & oValue, IrValue & iValue);
+
+	// The analyzer can't be copied
+	CAnalyzer(const CAnalyzer &);
+	CAnalyzer & operator=(const CAnalyzer &);
+
+public:
+	// The constructor of the CAnalyzer class, the errors are added to lErrorList
+	CAnalyzer(ErrorList & lErrorList);
+	// Analyzes the entire script, the top-level statements are evaluated on iThreadCount threads
+	// piLineShifts tells, for every top-level statement, how many lines it moved since it was parsed (NULL if none did)
+	// The shift is added to the lines of the errors, CEditSession keeps the syntax tree of lines that only moved
+	// Nothing is analyzed if the parser already reached the error limit, the syntax tree is incomplete then
+	void Run(const CAstBlock * pProgram, int iThreadCount, const int * piLineShifts = NULL);
+	// Returns the dataflow of the script, which assignments are dead and which variables are used before they're assigned
+	// The dataflow is only analyzed when the warnings are enabled (see CDiagnostics)
+	const CDataflow & GetDataflow() const { return m_oDataflow; }
+	// Logs every variable and its value, this method is only available when compiling in debug mode
+	#if _DEBUG
+	void LogVariables();
+	#endif
+};
\ No newline at end of file
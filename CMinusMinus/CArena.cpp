@@ -0,0 +1,80 @@
+//==============================================================================
+//
+// File: CArena.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CArena class is a bump-pointer allocator. Allocating moves a pointer
+// forward through a big block of memory, a new block is only needed when the
+// current one is full. Nothing is freed on its own, every block is freed at
+// once when the arena is destroyed. The syntax tree is allocated in an arena.
+//
+//==============================================================================
+
+#include "CArena.h"
+#include "CLogger.h"
+
+#include <cstdlib>
+
+// Creates an empty arena, the first block is allocated on the first allocation
+CArena::CArena(size_t iBlockSize)
+{
+	m_pCurrentBlock = NULL;
+	m_pCurrent = NULL;
+	m_pEnd = NULL;
+	m_iBlockSize = iBlockSize;
+	m_iBytesUsed = 0;
+	m_iBytesAllocated = 0;
+}
+
+// Frees every block
+CArena::~CArena()
+{
+	Reset();
+}
+
+// Frees every block, the memory handed out can't be used anymore
+void CArena::Reset()
+{
+	while(m_pCurrentBlock != NULL)
+	{
+		CArenaBlock * pPrevious = m_pCurrentBlock->m_pPrevious;
+		free(m_pCurrentBlock);
+		m_pCurrentBlock = pPrevious;
+	}
+
+	m_pCurrent = NULL;
+	m_pEnd = NULL;
+	m_iBytesUsed = 0;
+	m_iBytesAllocated = 0;
+}
+
+// Allocates a new block which fits at least iSize bytes aligned to iAlignment, then allocates from it
+void * CArena::AllocateFromNewBlock(size_t iSize, size_t iAlignment)
+{
+	// Big allocations get a block of their own
+	size_t iBlockSize = m_iBlockSize;
+
+	if(iSize + iAlignment > iBlockSize)
+		iBlockSize = iSize + iAlignment;
+
+	CArenaBlock * pBlock = (CArenaBlock *) malloc(sizeof(CArenaBlock) + iBlockSize);
+
+	if(pBlock == NULL)
+	{
+		CLogger::Write("* Out of memory while allocating the syntax tree");
+		exit(1);
+	}
+
+	pBlock->m_iSize = iBlockSize;
+	pBlock->m_pPrevious = m_pCurrentBlock;
+	m_pCurrentBlock = pBlock;
+	m_iBytesAllocated += iBlockSize;
+
+	m_pCurrent = (char *) (pBlock + 1);
+	m_pEnd = m_pCurrent + iBlockSize;
+
+	// The new block is big enough, this can't fail
+	return Allocate(iSize, iAlignment);
+}
\ No newline at end of file
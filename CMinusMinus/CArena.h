@@ -0,0 +1,90 @@
+//==============================================================================
+//
+// File: CArena.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CArena class is a bump-pointer allocator. Allocating moves a pointer
+// forward through a big block of memory, a new block is only needed when the
+// current one is full. Nothing is freed on its own, every block is freed at
+// once when the arena is destroyed. The syntax tree is allocated in an arena.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// The size of the blocks the arena allocates, bigger allocations get a block of their own
+#define ARENA_DEFAULT_BLOCK_SIZE 65536
+
+class CArena
+{
+	// The header of every block, the memory handed out follows it
+	struct CArenaBlock
+	{
+		// The block that was allocated before this one
+		CArenaBlock * m_pPrevious;
+		// The size of the block (without the header)
+		size_t m_iSize;
+	};
+
+	// The block we're allocating from
+	CArenaBlock * m_pCurrentBlock;
+	// The next free byte in the current block, and the end of the current block
+	char * m_pCurrent;
+	char * m_pEnd;
+	// The size of a new block
+	size_t m_iBlockSize;
+	// The amount of bytes handed out, and the amount of bytes in the blocks
+	size_t m_iBytesUsed;
+	size_t m_iBytesAllocated;
+
+	// Allocates a new block which fits at least iSize bytes aligned to iAlignment, then allocates from it
+	void * AllocateFromNewBlock(size_t iSize, size_t iAlignment);
+
+	// The arena can't be copied
+	CArena(const CArena &);
+	CArena & operator=(const CArena &);
+
+public:
+	// Creates an empty arena, the first block is allocated on the first allocation
+	CArena(size_t iBlockSize = ARENA_DEFAULT_BLOCK_SIZE);
+	// Frees every block
+	~CArena();
+
+	// Allocates iSize bytes aligned to iAlignment (a power of two)
+	void * Allocate(size_t iSize, size_t iAlignment)
+	{
+		// Round the pointer up to the alignment
+		char * pAligned = (char *) (((size_t) m_pCurrent + iAlignment - 1) & ~(iAlignment - 1));
+
+		if(m_pCurrent == NULL || pAligned + iSize > m_pEnd)
+			return AllocateFromNewBlock(iSize, iAlignment);
+
+		m_pCurrent = pAligned + iSize;
+		m_iBytesUsed += iSize;
+		return pAligned;
+	}
+
+	// Allocates and default constructs an object, its destructor is never called
+	template <typename T> T * New()
+	{
+		return new (Allocate(sizeof(T), __alignof(T))) T();
+	}
+
+	// Allocates an array of iCount objects without constructing them, for pointers and other plain types
+	template <typename T> T * NewArray(size_t iCount)
+	{
+		return (T *) Allocate(sizeof(T) * (iCount > 0 ? iCount : 1), __alignof(T));
+	}
+
+	// Frees every block, the memory handed out can't be used anymore
+	void Reset();
+
+	// The amount of bytes handed out, and the amount of bytes allocated for the blocks
+	size_t GetBytesUsed() const { return m_iBytesUsed; }
+	size_t GetBytesAllocated() const { return m_iBytesAllocated; }
+};
\ No newline at end of file
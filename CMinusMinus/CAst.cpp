@@ -0,0 +1,189 @@
+//==============================================================================
+//
+// File: CAst.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The syntax tree the parser builds. Every node starts with a CAstNode header
+// which tells what kind of node it is, the node can then be cast to the struct
+// of that kind. The nodes are allocated in a CArena and only hold symbol IDs
+// and parsed values, not tokens, so the tokens can be released while parsing.
+//
+//==============================================================================
+
+#include "CAst.h"
+#include "CLogger.h"
+
+// Descriptions of expressions in error messages are cut off after this many characters
+#define AST_MAX_DESCRIPTION_LENGTH 64
+
+// The names of the node types, generated from AST_NODE_TYPE_LIST
+static const char * g_aAstNodeTypeNames[AST_NODE_TYPE_COUNT] =
+{
+	#define AST_NODE_TYPE_NAME_ENTRY(eType, Struct) #eType,
+	AST_NODE_TYPE_LIST(AST_NODE_TYPE_NAME_ENTRY)
+	#undef AST_NODE_TYPE_NAME_ENTRY
+};
+
+// Returns the name of a node type
+const char * GetAstNodeTypeName(eAstNodeType eType)
+{
+	if(eType < 0 || eType >= AST_NODE_TYPE_COUNT)
+		return "INVALID_AST_NODE_TYPE";
+
+	return g_aAstNodeTypeNames[eType];
+}
+
+// Appends the description of an expression, long expressions are cut off
+static void AppendDescription(const CAstNode * pNode, std::string & sDescription)
+{
+	if(sDescription.size() >= AST_MAX_DESCRIPTION_LENGTH)
+		return;
+
+	switch(pNode->m_eType)
+	{
+		case AST_NODE_INTEGER_LITERAL:
+			sDescription += CSymbolPool::GetString(((const CAstIntegerLiteral *) pNode)->m_iSpelling);
+			break;
+
+		case AST_NODE_FLOAT_LITERAL:
+			sDescription += CSymbolPool::GetString(((const CAstFloatLiteral *) pNode)->m_iSpelling);
+			break;
+
+		case AST_NODE_STRING_LITERAL:
+			sDescription += CSymbolPool::GetString(((const CAstStringLiteral *) pNode)->m_iValue);
+			break;
+
+		case AST_NODE_VARIABLE:
+			sDescription += CSymbolPool::GetString(((const CAstVariable *) pNode)->m_iName);
+			break;
+
+		case AST_NODE_CALL:
+			sDescription += CSymbolPool::GetString(((const CAstCall *) pNode)->m_iFunction);
+			sDescription += "()";
+			break;
+
+		case AST_NODE_NEGATION:
+			sDescription += "-";
+			AppendDescription(((const CAstNegation *) pNode)->m_pOperand, sDescription);
+			break;
+
+		case AST_NODE_BINARY:
+		{
+			const CAstBinary * pBinary = (const CAstBinary *) pNode;
+			AppendDescription(pBinary->m_pLeft, sDescription);
+			sDescription += " ";
+			sDescription += GetTokenTypeSpelling(pBinary->m_eOperator);
+			sDescription += " ";
+			AppendDescription(pBinary->m_pRight, sDescription);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Describes an expression for an error message, for example 'a + 5'
+std::string DescribeExpression(const CAstNode * pNode)
+{
+	std::string sDescription;
+	AppendDescription(pNode, sDescription);
+
+	if(sDescription.size() >= AST_MAX_DESCRIPTION_LENGTH)
+		sDescription += "...";
+
+	return sDescription;
+}
+
+// Logs a node and every node below it, this is only available when compiling in debug mode
+#if _DEBUG
+void LogSyntaxTree(const CAstNode * pNode, int iDepth)
+{
+	// Indent the node two spaces for every level
+	int iIndent = iDepth * 2;
+
+	switch(pNode->m_eType)
+	{
+		case AST_NODE_BLOCK:
+		{
+			const CAstBlock * pBlock = (const CAstBlock *) pNode;
+			CLogger::Write("%*s%s (line %d, %d statements)", iIndent, "", GetAstNodeTypeName(pNode->m_eType), pNode->m_iLine, (int) pBlock->m_iStatementCount);
+
+			for(size_t i = 0; i < pBlock->m_iStatementCount; i++)
+				LogSyntaxTree(pBlock->m_ppStatements[i], iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_DECLARATION:
+		{
+			const CAstDeclaration * pDeclaration = (const CAstDeclaration *) pNode;
+			const char * szType = pDeclaration->m_eVariableType == VARIABLE_TYPE_INTEGER ? "int" : (pDeclaration->m_eVariableType == VARIABLE_TYPE_FLOAT ? "float" : "string");
+			CLogger::Write("%*s%s %s %s (line %d)", iIndent, "", GetAstNodeTypeName(pNode->m_eType), szType, CSymbolPool::GetString(pDeclaration->m_iName), pNode->m_iLine);
+
+			if(pDeclaration->m_pInitialiser != NULL)
+				LogSyntaxTree(pDeclaration->m_pInitialiser, iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_ASSIGNMENT:
+		{
+			const CAstAssignment * pAssignment = (const CAstAssignment *) pNode;
+			CLogger::Write("%*s%s (line %d)", iIndent, "", GetAstNodeTypeName(pNode->m_eType), pNode->m_iLine);
+			LogSyntaxTree(pAssignment->m_pTarget, iDepth + 1);
+			LogSyntaxTree(pAssignment->m_pValue, iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_EXPRESSION_STATEMENT:
+		{
+			CLogger::Write("%*s%s (line %d)", iIndent, "", GetAstNodeTypeName(pNode->m_eType), pNode->m_iLine);
+			LogSyntaxTree(((const CAstExpressionStatement *) pNode)->m_pExpression, iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_INTEGER_LITERAL:
+			CLogger::Write("%*s%s %d", iIndent, "", GetAstNodeTypeName(pNode->m_eType), ((const CAstIntegerLiteral *) pNode)->m_iValue);
+			break;
+
+		case AST_NODE_FLOAT_LITERAL:
+			CLogger::Write("%*s%s %g", iIndent, "", GetAstNodeTypeName(pNode->m_eType), ((const CAstFloatLiteral *) pNode)->m_fValue);
+			break;
+
+		case AST_NODE_STRING_LITERAL:
+			CLogger::Write("%*s%s \"%s\"", iIndent, "", GetAstNodeTypeName(pNode->m_eType), CSymbolPool::GetString(((const CAstStringLiteral *) pNode)->m_iValue));
+			break;
+
+		case AST_NODE_VARIABLE:
+			CLogger::Write("%*s%s %s", iIndent, "", GetAstNodeTypeName(pNode->m_eType), CSymbolPool::GetString(((const CAstVariable *) pNode)->m_iName));
+			break;
+
+		case AST_NODE_NEGATION:
+		{
+			CLogger::Write("%*s%s", iIndent, "", GetAstNodeTypeName(pNode->m_eType));
+			LogSyntaxTree(((const CAstNegation *) pNode)->m_pOperand, iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_BINARY:
+		{
+			const CAstBinary * pBinary = (const CAstBinary *) pNode;
+			CLogger::Write("%*s%s %s", iIndent, "", GetAstNodeTypeName(pNode->m_eType), GetTokenTypeSpelling(pBinary->m_eOperator));
+			LogSyntaxTree(pBinary->m_pLeft, iDepth + 1);
+			LogSyntaxTree(pBinary->m_pRight, iDepth + 1);
+			break;
+		}
+
+		case AST_NODE_CALL:
+		{
+			const CAstCall * pCall = (const CAstCall *) pNode;
+			CLogger::Write("%*s%s %s (%d arguments)", iIndent, "", GetAstNodeTypeName(pNode->m_eType), CSymbolPool::GetString(pCall->m_iFunction), (int) pCall->m_iArgumentCount);
+
+			for(size_t i = 0; i < pCall->m_iArgumentCount; i++)
+				LogSyntaxTree(pCall->m_ppArguments[i], iDepth + 1);
+			break;
+		}
+	}
+}
+#endif
\ No newline at end of file
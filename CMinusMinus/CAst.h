@@ -0,0 +1,158 @@
+//==============================================================================
+//
+// File: CAst.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The syntax tree the parser builds. Every node starts with a CAstNode header
+// which tells what kind of node it is, the node can then be cast to the struct
+// of that kind. The nodes are allocated in a CArena and only hold symbol IDs
+// and parsed values, not tokens, so the tokens can be released while parsing.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include "TokenTypes.h"
+#include "CSymbolPool.h"
+#include "CVariable.h"
+#include "CFunction.h"
+
+// The variable of a name that doesn't refer to a variable
+#define UNRESOLVED_VARIABLE 0xFFFFFFFF
+
+// Every kind of node, and the struct that belongs to it
+#define AST_NODE_TYPE_LIST(NODE) \
+	NODE(AST_NODE_BLOCK, CAstBlock) \
+	NODE(AST_NODE_DECLARATION, CAstDeclaration) \
+	NODE(AST_NODE_ASSIGNMENT, CAstAssignment) \
+	NODE(AST_NODE_EXPRESSION_STATEMENT, CAstExpressionStatement) \
+	NODE(AST_NODE_INTEGER_LITERAL, CAstIntegerLiteral) \
+	NODE(AST_NODE_FLOAT_LITERAL, CAstFloatLiteral) \
+	NODE(AST_NODE_STRING_LITERAL, CAstStringLiteral) \
+	NODE(AST_NODE_VARIABLE, CAstVariable) \
+	NODE(AST_NODE_NEGATION, CAstNegation) \
+	NODE(AST_NODE_BINARY, CAstBinary) \
+	NODE(AST_NODE_CALL, CAstCall)
+
+enum eAstNodeType
+{
+	#define AST_NODE_TYPE_ENUM_ENTRY(eType, Struct) eType,
+	AST_NODE_TYPE_LIST(AST_NODE_TYPE_ENUM_ENTRY)
+	#undef AST_NODE_TYPE_ENUM_ENTRY
+
+	// The amount of node types
+	AST_NODE_TYPE_COUNT
+};
+
+// The header every node starts with
+struct CAstNode
+{
+	// What kind of node is this?
+	eAstNodeType m_eType;
+	// The line the node starts on
+	int m_iLine;
+};
+
+// A list of statements, either between { and } or the entire script
+struct CAstBlock : public CAstNode
+{
+	CAstNode ** m_ppStatements;
+	size_t m_iStatementCount;
+	// Is this a { } block? The entire script is a block as well, but it doesn't open a new level
+	bool m_bBraced;
+};
+
+// int name; or int name = expression;
+struct CAstDeclaration : public CAstNode
+{
+	eVariableTypes m_eVariableType;
+	SymbolID m_iName;
+	// NULL if the variable isn't initialised
+	CAstNode * m_pInitialiser;
+	// The variable that's declared, UNRESOLVED_VARIABLE if the name already exists in the scope (set by the analyzer)
+	mutable unsigned int m_iVariable;
+};
+
+// target = expression;
+// The target is any expression, the analyzer reports targets that aren't variables
+struct CAstAssignment : public CAstNode
+{
+	CAstNode * m_pTarget;
+	CAstNode * m_pValue;
+};
+
+// expression; (for example a function call)
+struct CAstExpressionStatement : public CAstNode
+{
+	CAstNode * m_pExpression;
+};
+
+// 42
+struct CAstIntegerLiteral : public CAstNode
+{
+	int m_iValue;
+	// How the literal was written, for error messages
+	SymbolID m_iSpelling;
+};
+
+// 3.14
+struct CAstFloatLiteral : public CAstNode
+{
+	double m_fValue;
+	// How the literal was written, for error messages
+	SymbolID m_iSpelling;
+};
+
+// "Hello"
+struct CAstStringLiteral : public CAstNode
+{
+	SymbolID m_iValue;
+};
+
+// name
+struct CAstVariable : public CAstNode
+{
+	SymbolID m_iName;
+	// The variable the name refers to, UNRESOLVED_VARIABLE if it was never declared (set by the analyzer)
+	mutable unsigned int m_iVariable;
+	// False if the variable was declared in a block that's closed here
+	mutable bool m_bInScope;
+};
+
+// -expression
+struct CAstNegation : public CAstNode
+{
+	CAstNode * m_pOperand;
+};
+
+// left + right, left - right
+struct CAstBinary : public CAstNode
+{
+	eTokenType m_eOperator;
+	CAstNode * m_pLeft;
+	CAstNode * m_pRight;
+};
+
+// name(argument, argument)
+struct CAstCall : public CAstNode
+{
+	SymbolID m_iFunction;
+	CAstNode ** m_ppArguments;
+	size_t m_iArgumentCount;
+	// The overload the call resolved to, the analyzer resolves a call once and reuses the handle after that
+	mutable FunctionHandle m_iFunctionHandle;
+};
+
+// Returns the name of a node type
+const char * GetAstNodeTypeName(eAstNodeType eType);
+
+// Describes an expression for an error message, for example 'a + 5'
+std::string DescribeExpression(const CAstNode * pNode);
+
+// Logs a node and every node below it, this is only available when compiling in debug mode
+#if _DEBUG
+void LogSyntaxTree(const CAstNode * pNode, int iDepth);
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+//==============================================================================
+//
+// File: CBitVector.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CBitVector class is a dense set of bits, one bit for every variable of
+// the script. The dataflow analysis keeps its facts in bit vectors: combining
+// the facts of two blocks is one AND or OR for every 32 variables.
+//
+//==============================================================================
+
+#include "CBitVector.h"
+
+// The constructor of the CBitVector class, every bit is set to bValue
+CBitVector::CBitVector(size_t iBitCount, bool bValue)
+{
+	m_iBitCount = iBitCount;
+	m_lWords.assign((iBitCount + BIT_VECTOR_WORD_BITS - 1) / BIT_VECTOR_WORD_BITS, bValue ? ~0u : 0u);
+	ClearUnusedBits();
+}
+
+// Clears the unused bits of the last word, so comparing and counting can look at whole words
+void CBitVector::ClearUnusedBits()
+{
+	size_t iUsedBits = m_iBitCount % BIT_VECTOR_WORD_BITS;
+
+	if(iUsedBits != 0)
+		m_lWords.back() &= (1u << iUsedBits) - 1;
+}
+
+// Sets every bit
+void CBitVector::SetAll()
+{
+	m_lWords.assign(m_lWords.size(), ~0u);
+	ClearUnusedBits();
+}
+
+// Clears every bit
+void CBitVector::ClearAll()
+{
+	m_lWords.assign(m_lWords.size(), 0u);
+}
+
+// Returns the amount of bits that are set
+size_t CBitVector::Count() const
+{
+	size_t iCount = 0;
+
+	for(size_t i = 0; i < m_lWords.size(); i++)
+	{
+		// Clear the lowest bit until none are left, this takes one step for every bit that's set
+		for(unsigned int iWord = m_lWords[i]; iWord != 0; iWord &= iWord - 1)
+			iCount++;
+	}
+
+	return iCount;
+}
+
+// Adds the bits of another vector of the same size, returns true if a bit changed
+bool CBitVector::UnionWith(const CBitVector & oOther)
+{
+	unsigned int iChanged = 0;
+
+	for(size_t i = 0; i < m_lWords.size(); i++)
+	{
+		unsigned int iWord = m_lWords[i] | oOther.m_lWords[i];
+		iChanged |= iWord ^ m_lWords[i];
+		m_lWords[i] = iWord;
+	}
+
+	return iChanged != 0;
+}
+
+// Keeps the bits that are also set in another vector of the same size, returns true if a bit changed
+bool CBitVector::IntersectWith(const CBitVector & oOther)
+{
+	unsigned int iChanged = 0;
+
+	for(size_t i = 0; i < m_lWords.size(); i++)
+	{
+		unsigned int iWord = m_lWords[i] & oOther.m_lWords[i];
+		iChanged |= iWord ^ m_lWords[i];
+		m_lWords[i] = iWord;
+	}
+
+	return iChanged != 0;
+}
+
+// Clears the bits that are set in another vector of the same size
+void CBitVector::Subtract(const CBitVector & oOther)
+{
+	for(size_t i = 0; i < m_lWords.size(); i++)
+		m_lWords[i] &= ~oOther.m_lWords[i];
+}
+
+// The transfer function of a block: this = oGen | (oInput & ~oKill), returns true if a bit changed
+bool CBitVector::AssignTransfer(const CBitVector & oGen, const CBitVector & oInput, const CBitVector & oKill)
+{
+	unsigned int iChanged = 0;
+
+	for(size_t i = 0; i < m_lWords.size(); i++)
+	{
+		unsigned int iWord = oGen.m_lWords[i] | (oInput.m_lWords[i] & ~oKill.m_lWords[i]);
+		iChanged |= iWord ^ m_lWords[i];
+		m_lWords[i] = iWord;
+	}
+
+	return iChanged != 0;
+}
\ No newline at end of file
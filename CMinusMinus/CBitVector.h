@@ -0,0 +1,58 @@
+//==============================================================================
+//
+// File: CBitVector.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CBitVector class is a dense set of bits, one bit for every variable of
+// the script. The dataflow analysis keeps its facts in bit vectors: combining
+// the facts of two blocks is one AND or OR for every 32 variables.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// The amount of bits in a word of the bit vector
+#define BIT_VECTOR_WORD_BITS 32
+
+class CBitVector
+{
+	// The bits, 32 in a word, the unused bits of the last word are always 0
+	std::vector<unsigned int> m_lWords;
+	// The amount of bits
+	size_t m_iBitCount;
+
+	// Clears the unused bits of the last word
+	void ClearUnusedBits();
+
+public:
+	// The constructor of the CBitVector class, every bit is set to bValue
+	CBitVector(size_t iBitCount = 0, bool bValue = false);
+
+	// Returns the amount of bits
+	size_t GetBitCount() const { return m_iBitCount; }
+	// Returns, sets and clears a bit
+	bool Test(size_t iBit) const { return (m_lWords[iBit / BIT_VECTOR_WORD_BITS] >> (iBit % BIT_VECTOR_WORD_BITS) & 1) != 0; }
+	void Set(size_t iBit) { m_lWords[iBit / BIT_VECTOR_WORD_BITS] |= 1u << (iBit % BIT_VECTOR_WORD_BITS); }
+	void Clear(size_t iBit) { m_lWords[iBit / BIT_VECTOR_WORD_BITS] &= ~(1u << (iBit % BIT_VECTOR_WORD_BITS)); }
+	// Sets or clears every bit
+	void SetAll();
+	void ClearAll();
+	// Returns the amount of bits that are set
+	size_t Count() const;
+
+	// Adds or keeps the bits of another vector of the same size, returns true if a bit changed
+	bool UnionWith(const CBitVector & oOther);
+	bool IntersectWith(const CBitVector & oOther);
+	// Clears the bits that are set in another vector of the same size
+	void Subtract(const CBitVector & oOther);
+	// The transfer function of a block: this = oGen | (oInput & ~oKill), returns true if a bit changed
+	bool AssignTransfer(const CBitVector & oGen, const CBitVector & oInput, const CBitVector & oKill);
+
+	bool operator==(const CBitVector & oOther) const { return m_iBitCount == oOther.m_iBitCount && m_lWords == oOther.m_lWords; }
+	bool operator!=(const CBitVector & oOther) const { return !(*this == oOther); }
+};
\ No newline at end of file
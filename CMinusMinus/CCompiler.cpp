@@ -7,20 +7,43 @@
 // 
 // The CCompiler class outputs the output code off the token list, after the token
 // list being parsed and checked by the CParser.
+// The analyzer lowers the script into IR (see CIr.h), the passes of the
+// CPassManager fold what's known while compiling. What's left for the program
+// are the calls of the effectful functions, every call lowers itself into
+// code in the order the script makes the calls.
 // 
 //==============================================================================
 
 #include "CCompiler.h"
+#include "CFunctionWrapper.h"
+#include "CNativeCache.h"
+#include "CPassManager.h"
 #include "CLogger.h"
 #include <fstream>
 
-// Holds a list of all functions and their parameters that need to be called
-std::vector<std::pair<int, ParameterList>> CCompiler::m_lAssemblyFunctionList;
+// The IR of the script
+CIrFunction CCompiler::m_oProgram;
+// The code the calls were lowered into
+std::string CCompiler::m_sCode;
 
-// Pushes back a function on the m_lAssemblyFunctionList
-void CCompiler::AddFunction(int iFunction, ParameterList lParameterList)
+// Sets the IR of the script, the function is taken (it's empty after this)
+void CCompiler::SetProgram(CIrFunction & oProgram)
 {
-	m_lAssemblyFunctionList.push_back(make_pair(iFunction, lParameterList));
+	m_oProgram.Clear();
+	m_oProgram.Swap(oProgram);
+}
+
+// Appends code to the program
+void CCompiler::Emit(const std::string & sCode)
+{
+	m_sCode += sCode;
+}
+
+// Forgets the IR
+void CCompiler::Reset()
+{
+	m_oProgram.Clear();
+	m_sCode.clear();
 }
 
 // Runs the compiler
@@ -42,15 +65,70 @@ void CCompiler::Run()
 	assemblyOutput << ".code\n";
 	assemblyOutput << "start:\n";
 
-	// Loop through all the functions we're supposed to call and write them to the file
-	for(size_t i = 0; i < m_lAssemblyFunctionList.size(); i++)
+	// Optimise the IR, the passes usually leave only the effectful calls and the constants they're made with
+	CPassManager::Run(m_oProgram);
+
+	// Lower the IR, the effectful functions emit their code
+	// Whatever the passes didn't fold is calculated here, in the order of the instructions
+	m_sCode.clear();
+
+	std::vector<CValue> lValues(m_oProgram.GetInstructionCount());
+	ParameterList lParameterList;
+
+	for(IrValue i = 0; i < lValues.size(); i++)
 	{
-		if(m_lAssemblyFunctionList[i].first == MESSAGEBOX_FUNCTION)
+		const CIrInstruction & oInstruction = m_oProgram.GetInstruction(i);
+
+		switch(oInstruction.m_eOpcode)
 		{
-			assemblyOutput << "\tinvoke	MessageBox,HWND_DESKTOP,\"" << m_lAssemblyFunctionList[i].second[0].m_sValue.c_str() << "\",\"" << m_lAssemblyFunctionList[i].second[1].m_sValue.c_str() << "\",MB_OK\n";
+			case IR_OPCODE_CONSTANT:
+				lValues[i] = m_oProgram.GetConstant(oInstruction);
+				break;
+
+			case IR_OPCODE_COPY:
+				lValues[i] = lValues[m_oProgram.GetOperand(oInstruction, 0)];
+				break;
+
+			case IR_OPCODE_NEGATE:
+				lValues[i] = lValues[m_oProgram.GetOperand(oInstruction, 0)];
+				NegateValue(lValues[i]);
+				break;
+
+			case IR_OPCODE_ADD:
+			case IR_OPCODE_SUBTRACT:
+			case IR_OPCODE_CONCATENATE:
+				lValues[i] = lValues[m_oProgram.GetOperand(oInstruction, 0)];
+				CombineValues(oInstruction.m_eOpcode, lValues[i], lValues[m_oProgram.GetOperand(oInstruction, 1)]);
+				break;
+
+			case IR_OPCODE_CALL:
+			{
+				lParameterList.clear();
+
+				for(unsigned int j = 0; j < oInstruction.m_iOperandCount; j++)
+					lParameterList.push_back(lValues[m_oProgram.GetOperand(oInstruction, j)]);
+
+				// Effectful functions return nothing, so the call is the integer 0
+				if(m_oProgram.IsEffectful(oInstruction))
+				{
+					CFunctionWrapper::CallFunction(oInstruction.m_iFunction, lParameterList.empty() ? NULL : &lParameterList[0]);
+					break;
+				}
+
+				// The analyzer already counted the call, so the cache is only peeked at
+				if(!CNativeCache::Peek(oInstruction.m_iFunction, lParameterList, lValues[i]))
+					lValues[i] = CFunctionWrapper::CallFunction(oInstruction.m_iFunction, lParameterList.empty() ? NULL : &lParameterList[0]);
+				break;
+			}
+
+			default:
+				break;
 		}
 	}
 
+	// Write the code of the calls to the file
+	assemblyOutput << m_sCode;
+
 	// Don't forget to exit the process
 	assemblyOutput << "\tinvoke  ExitProcess,0\n";
 	assemblyOutput << ".end start\n";
@@ -7,31 +7,33 @@
 // 
 // The CCompiler class outputs the output code off the token list, after the token
 // list being parsed and checked by the CParser.
+// The analyzer lowers the script into IR (see CIr.h), the passes of the
+// CPassManager fold what's known while compiling. What's left for the program
+// are the calls of the effectful functions, every call lowers itself into
+// code in the order the script makes the calls.
 // 
 //==============================================================================
 
 #pragma once
 
+#include <string>
 #include <vector>
-#include "CParameter.h"
-
-// This enum holds all possible assembly functions that can be called (these are actually Win32 functions)
-enum eAssemblyFunctions
-{
-	MESSAGEBOX_FUNCTION // MessageBox(), in win32ax.inc
-};
-
-// Typedef to make the function list more readable
-typedef std::vector<std::pair<int, ParameterList>> AssemblyFunctionList;
+#include "CIr.h"
 
 class CCompiler
 {
-	// Holds a list of all functions and their parameters that need to be called
-	static AssemblyFunctionList m_lAssemblyFunctionList;
+	// The IR of the script
+	static CIrFunction m_oProgram;
+	// The code the calls were lowered into
+	static std::string m_sCode;
 
 public:
-	// Pushes back a function on the m_lAssemblyFunctionList
-	static void AddFunction(int iFunction, ParameterList lParameterList);
+	// Sets the IR of the script, the function is taken (it's empty after this)
+	static void SetProgram(CIrFunction & oProgram);
+	// Appends code to the program, the effectful functions call this when they're lowered
+	static void Emit(const std::string & sCode);
+	// Forgets the IR, CEditSession evaluates the script again after every edit
+	static void Reset();
 	// Runs the compiler
 	static void Run();
 };
\ No newline at end of file
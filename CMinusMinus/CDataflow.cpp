@@ -0,0 +1,362 @@
+//==============================================================================
+//
+// File: CDataflow.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CDataflow class finds out how values flow through the variables of the
+// script. The uses and assignments of the variables are grouped in basic
+// blocks, the facts of a block are bit vectors with one bit per variable. A
+// dataflow problem is solved with a worklist until the facts stop changing.
+// Definite assignment finds the variables that are used before they're given
+// a value, liveness finds the assignments whose value is never read.
+//
+//==============================================================================
+
+#include "CDataflow.h"
+
+// The constructor of the CDataflow class
+CDataflow::CDataflow()
+{
+	m_iVariableCount = 0;
+	m_iCurrentStatement = 0;
+}
+
+// Adds an event to the current block
+void CDataflow::AddEvent(eDataflowEventType eType, unsigned int iVariable, const CAstNode * pNode)
+{
+	CDataflowEvent oEvent;
+	oEvent.m_eType = eType;
+	oEvent.m_iVariable = iVariable;
+	oEvent.m_iStatement = m_iCurrentStatement;
+	oEvent.m_pNode = pNode;
+
+	m_lEvents.push_back(oEvent);
+	m_lBlocks.back().m_iEventCount++;
+}
+
+// Ends the current block and starts a new one that control falls through to
+void CDataflow::StartBlock()
+{
+	CBasicBlock oBlock;
+	oBlock.m_iFirstEvent = m_lEvents.size();
+	oBlock.m_iEventCount = 0;
+
+	if(!m_lBlocks.empty())
+	{
+		oBlock.m_lPredecessors.push_back(m_lBlocks.size() - 1);
+		m_lBlocks.back().m_lSuccessors.push_back(m_lBlocks.size());
+	}
+
+	m_lBlocks.push_back(oBlock);
+}
+
+// Adds the events of a statement, in the order the analyzer evaluates them
+void CDataflow::AddStatementEvents(const CAstNode * pStatement)
+{
+	switch(pStatement->m_eType)
+	{
+		// A { } block only opens a scope, control still runs straight through it
+		case AST_NODE_BLOCK:
+		{
+			const CAstBlock * pBlock = (const CAstBlock *) pStatement;
+
+			for(size_t i = 0; i < pBlock->m_iStatementCount; i++)
+				AddStatementEvents(pBlock->m_ppStatements[i]);
+			break;
+		}
+
+		// The initialiser is evaluated first, then it's stored
+		case AST_NODE_DECLARATION:
+		{
+			const CAstDeclaration * pDeclaration = (const CAstDeclaration *) pStatement;
+
+			if(pDeclaration->m_pInitialiser == NULL)
+				break;
+
+			AddExpressionEvents(pDeclaration->m_pInitialiser);
+
+			if(pDeclaration->m_iVariable != UNRESOLVED_VARIABLE)
+				AddEvent(DATAFLOW_EVENT_DEFINITION, pDeclaration->m_iVariable, pStatement);
+			break;
+		}
+
+		case AST_NODE_ASSIGNMENT:
+		{
+			const CAstAssignment * pAssignment = (const CAstAssignment *) pStatement;
+			AddExpressionEvents(pAssignment->m_pValue);
+
+			// Targets that aren't variables in scope are errors, the analyzer reports them
+			if(pAssignment->m_pTarget->m_eType == AST_NODE_VARIABLE)
+			{
+				const CAstVariable * pTarget = (const CAstVariable *) pAssignment->m_pTarget;
+
+				if(pTarget->m_iVariable != UNRESOLVED_VARIABLE && pTarget->m_bInScope)
+					AddEvent(DATAFLOW_EVENT_DEFINITION, pTarget->m_iVariable, pStatement);
+			}
+			break;
+		}
+
+		case AST_NODE_EXPRESSION_STATEMENT:
+			AddExpressionEvents(((const CAstExpressionStatement *) pStatement)->m_pExpression);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Adds the events of an expression, the operands are evaluated from left to right
+void CDataflow::AddExpressionEvents(const CAstNode * pNode)
+{
+	switch(pNode->m_eType)
+	{
+		case AST_NODE_VARIABLE:
+		{
+			const CAstVariable * pVariable = (const CAstVariable *) pNode;
+
+			// Names that don't exist or aren't in scope are errors, the analyzer reports them
+			if(pVariable->m_iVariable != UNRESOLVED_VARIABLE && pVariable->m_bInScope)
+				AddEvent(DATAFLOW_EVENT_USE, pVariable->m_iVariable, pNode);
+			break;
+		}
+
+		case AST_NODE_NEGATION:
+			AddExpressionEvents(((const CAstNegation *) pNode)->m_pOperand);
+			break;
+
+		case AST_NODE_BINARY:
+			AddExpressionEvents(((const CAstBinary *) pNode)->m_pLeft);
+			AddExpressionEvents(((const CAstBinary *) pNode)->m_pRight);
+			break;
+
+		case AST_NODE_CALL:
+		{
+			const CAstCall * pCall = (const CAstCall *) pNode;
+
+			for(size_t i = 0; i < pCall->m_iArgumentCount; i++)
+				AddExpressionEvents(pCall->m_ppArguments[i]);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Solves a dataflow problem over the blocks with a worklist, until no fact changes anymore
+void CDataflow::Solve(const std::vector<CBasicBlock> & lBlocks, CDataflowProblem & oProblem)
+{
+	size_t iBlockCount = lBlocks.size();
+	size_t iBitCount = oProblem.m_oBoundary.GetBitCount();
+	bool bForward = oProblem.m_eDirection == DATAFLOW_FORWARD;
+
+	// The facts start at the top of the lattice: nothing holds for a union, everything holds for an intersection
+	CBitVector oTop(iBitCount, oProblem.m_eMeet == DATAFLOW_MEET_INTERSECTION);
+	oProblem.m_lIn.assign(iBlockCount, oTop);
+	oProblem.m_lOut.assign(iBlockCount, oTop);
+	oProblem.m_iVisits = 0;
+
+	// The worklist is a stack, the blocks are pushed so the first block of the direction is visited first
+	// That's the order the facts flow in, so straight-line code is solved in one visit per block
+	std::vector<size_t> lWorklist;
+	std::vector<bool> lQueued(iBlockCount, true);
+	lWorklist.reserve(iBlockCount);
+
+	for(size_t i = 0; i < iBlockCount; i++)
+		lWorklist.push_back(bForward ? iBlockCount - 1 - i : i);
+
+	while(!lWorklist.empty())
+	{
+		size_t iBlock = lWorklist.back();
+		lWorklist.pop_back();
+		lQueued[iBlock] = false;
+		oProblem.m_iVisits++;
+
+		const CBasicBlock & oBlock = lBlocks[iBlock];
+		const std::vector<size_t> & lSources = bForward ? oBlock.m_lPredecessors : oBlock.m_lSuccessors;
+		const std::vector<size_t> & lTargets = bForward ? oBlock.m_lSuccessors : oBlock.m_lPredecessors;
+		CBitVector & oInput = bForward ? oProblem.m_lIn[iBlock] : oProblem.m_lOut[iBlock];
+		CBitVector & oOutput = bForward ? oProblem.m_lOut[iBlock] : oProblem.m_lIn[iBlock];
+
+		// Combine the facts of the blocks the facts come from, the first (or last) block gets the boundary
+		if(lSources.empty())
+			oInput = oProblem.m_oBoundary;
+		else
+		{
+			oInput = oTop;
+
+			for(size_t i = 0; i < lSources.size(); i++)
+			{
+				const CBitVector & oSource = bForward ? oProblem.m_lOut[lSources[i]] : oProblem.m_lIn[lSources[i]];
+
+				if(oProblem.m_eMeet == DATAFLOW_MEET_UNION)
+					oInput.UnionWith(oSource);
+				else
+					oInput.IntersectWith(oSource);
+			}
+		}
+
+		// Only the blocks the facts flow to have to be visited again, and only if the facts changed
+		if(!oOutput.AssignTransfer(oProblem.m_lGen[iBlock], oInput, oProblem.m_lKill[iBlock]))
+			continue;
+
+		for(size_t i = 0; i < lTargets.size(); i++)
+		{
+			if(!lQueued[lTargets[i]])
+			{
+				lQueued[lTargets[i]] = true;
+				lWorklist.push_back(lTargets[i]);
+			}
+		}
+	}
+}
+
+// Definite assignment: a variable is assigned at a point if every path to it assigns the variable
+// A block assigns every variable it stores in, nothing ever makes a variable unassigned again
+void CDataflow::ComputeDefiniteAssignmentSets()
+{
+	m_oDefiniteAssignment.m_eDirection = DATAFLOW_FORWARD;
+	m_oDefiniteAssignment.m_eMeet = DATAFLOW_MEET_INTERSECTION;
+	m_oDefiniteAssignment.m_oBoundary = CBitVector(m_iVariableCount);
+	m_oDefiniteAssignment.m_lGen.assign(m_lBlocks.size(), CBitVector(m_iVariableCount));
+	m_oDefiniteAssignment.m_lKill.assign(m_lBlocks.size(), CBitVector(m_iVariableCount));
+
+	for(size_t i = 0; i < m_lBlocks.size(); i++)
+	{
+		const CBasicBlock & oBlock = m_lBlocks[i];
+
+		for(size_t j = oBlock.m_iFirstEvent; j < oBlock.m_iFirstEvent + oBlock.m_iEventCount; j++)
+		{
+			if(m_lEvents[j].m_eType == DATAFLOW_EVENT_DEFINITION)
+				m_oDefiniteAssignment.m_lGen[i].Set(m_lEvents[j].m_iVariable);
+		}
+	}
+}
+
+// Liveness: a variable is live at a point if some path from it reads the variable before it's assigned again
+// A block makes the variables it reads before assigning them live, and the variables it assigns dead
+void CDataflow::ComputeLivenessSets()
+{
+	m_oLiveness.m_eDirection = DATAFLOW_BACKWARD;
+	m_oLiveness.m_eMeet = DATAFLOW_MEET_UNION;
+	// Nothing is read after the script ends
+	m_oLiveness.m_oBoundary = CBitVector(m_iVariableCount);
+	m_oLiveness.m_lGen.assign(m_lBlocks.size(), CBitVector(m_iVariableCount));
+	m_oLiveness.m_lKill.assign(m_lBlocks.size(), CBitVector(m_iVariableCount));
+
+	for(size_t i = 0; i < m_lBlocks.size(); i++)
+	{
+		const CBasicBlock & oBlock = m_lBlocks[i];
+
+		for(size_t j = oBlock.m_iFirstEvent; j < oBlock.m_iFirstEvent + oBlock.m_iEventCount; j++)
+		{
+			const CDataflowEvent & oEvent = m_lEvents[j];
+
+			if(oEvent.m_eType == DATAFLOW_EVENT_DEFINITION)
+				m_oLiveness.m_lKill[i].Set(oEvent.m_iVariable);
+			else if(!m_oLiveness.m_lKill[i].Test(oEvent.m_iVariable))
+				m_oLiveness.m_lGen[i].Set(oEvent.m_iVariable);
+		}
+	}
+}
+
+// Finds the uses of variables that aren't assigned on every path to the use
+// Only the first of those uses is reported for every variable, the other ones don't tell anything new
+void CDataflow::FindUnassignedUses()
+{
+	CBitVector oReported(m_iVariableCount);
+
+	for(size_t i = 0; i < m_lBlocks.size(); i++)
+	{
+		const CBasicBlock & oBlock = m_lBlocks[i];
+		CBitVector oAssigned = m_oDefiniteAssignment.m_lIn[i];
+
+		for(size_t j = oBlock.m_iFirstEvent; j < oBlock.m_iFirstEvent + oBlock.m_iEventCount; j++)
+		{
+			const CDataflowEvent & oEvent = m_lEvents[j];
+
+			if(oEvent.m_eType == DATAFLOW_EVENT_DEFINITION)
+				oAssigned.Set(oEvent.m_iVariable);
+			else if(!oAssigned.Test(oEvent.m_iVariable) && !oReported.Test(oEvent.m_iVariable))
+			{
+				oReported.Set(oEvent.m_iVariable);
+
+				CDataflowFinding oFinding;
+				oFinding.m_eCode = DIAGNOSTIC_USED_BEFORE_ASSIGNMENT;
+				oFinding.m_iEvent = j;
+				m_lFindings.push_back(oFinding);
+			}
+		}
+	}
+}
+
+// Finds the assignments whose value is dead: no path from the assignment reads it before it's assigned again
+void CDataflow::FindDeadStores()
+{
+	m_oDeadStores = CBitVector(m_lEvents.size());
+
+	for(size_t i = 0; i < m_lBlocks.size(); i++)
+	{
+		const CBasicBlock & oBlock = m_lBlocks[i];
+		CBitVector oLive = m_oLiveness.m_lOut[i];
+
+		// Walk the block backwards, starting with what's live at its end
+		for(size_t j = oBlock.m_iFirstEvent + oBlock.m_iEventCount; j-- > oBlock.m_iFirstEvent; )
+		{
+			const CDataflowEvent & oEvent = m_lEvents[j];
+
+			if(oEvent.m_eType == DATAFLOW_EVENT_USE)
+			{
+				oLive.Set(oEvent.m_iVariable);
+				continue;
+			}
+
+			if(!oLive.Test(oEvent.m_iVariable))
+				m_oDeadStores.Set(j);
+
+			oLive.Clear(oEvent.m_iVariable);
+		}
+	}
+
+	// Report them in the order of the script
+	for(size_t i = 0; i < m_lEvents.size(); i++)
+	{
+		if(!m_oDeadStores.Test(i))
+			continue;
+
+		CDataflowFinding oFinding;
+		oFinding.m_eCode = DIAGNOSTIC_DEAD_STORE;
+		oFinding.m_iEvent = i;
+		m_lFindings.push_back(oFinding);
+	}
+}
+
+// Analyzes the script, the variables have to be bound already (see CAnalyzer)
+void CDataflow::Run(const CAstBlock * pProgram, size_t iVariableCount)
+{
+	m_iVariableCount = iVariableCount;
+	m_lEvents.clear();
+	m_lBlocks.clear();
+	m_lFindings.clear();
+
+	// The language has no jumps, so the entire script is one basic block
+	// Statements that branch or loop would end the current block with StartBlock() and add their edges
+	StartBlock();
+
+	for(size_t i = 0; i < pProgram->m_iStatementCount; i++)
+	{
+		m_iCurrentStatement = (unsigned int) i;
+		AddStatementEvents(pProgram->m_ppStatements[i]);
+	}
+
+	ComputeDefiniteAssignmentSets();
+	Solve(m_lBlocks, m_oDefiniteAssignment);
+
+	ComputeLivenessSets();
+	Solve(m_lBlocks, m_oLiveness);
+
+	FindUnassignedUses();
+	FindDeadStores();
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+//==============================================================================
+//
+// File: CDataflow.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CDataflow class finds out how values flow through the variables of the
+// script. The uses and assignments of the variables are grouped in basic
+// blocks, the facts of a block are bit vectors with one bit per variable. A
+// dataflow problem is solved with a worklist until the facts stop changing.
+// Definite assignment finds the variables that are used before they're given
+// a value, liveness finds the assignments whose value is never read.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include "CAst.h"
+#include "CError.h"
+#include "CBitVector.h"
+
+// What an event does with its variable
+enum eDataflowEventType
+{
+	// The value of the variable is read
+	DATAFLOW_EVENT_USE,
+	// A value is stored in the variable
+	DATAFLOW_EVENT_DEFINITION
+};
+
+// A use or an assignment of a variable, the events are in the order the analyzer evaluates them
+struct CDataflowEvent
+{
+	eDataflowEventType m_eType;
+	// The variable (an index on the variable list of the analyzer)
+	unsigned int m_iVariable;
+	// The top-level statement the event is in
+	unsigned int m_iStatement;
+	// The variable node of a use, the declaration or assignment of a definition
+	const CAstNode * m_pNode;
+};
+
+// A run of events that's always executed from start to end
+struct CBasicBlock
+{
+	// The events of the block are [m_iFirstEvent, m_iFirstEvent + m_iEventCount) on the event list
+	size_t m_iFirstEvent;
+	size_t m_iEventCount;
+	// The blocks control can come from and go to
+	std::vector<size_t> m_lPredecessors;
+	std::vector<size_t> m_lSuccessors;
+};
+
+// Which way the facts flow
+enum eDataflowDirection
+{
+	// From the start of the script to the end, the facts at the start of a block come from its predecessors
+	DATAFLOW_FORWARD,
+	// From the end of the script to the start, the facts at the end of a block come from its successors
+	DATAFLOW_BACKWARD
+};
+
+// How the facts of the blocks a block can be reached from are combined
+enum eDataflowMeet
+{
+	// A fact holds if it holds on any path (may analysis)
+	DATAFLOW_MEET_UNION,
+	// A fact holds if it holds on every path (must analysis)
+	DATAFLOW_MEET_INTERSECTION
+};
+
+// A dataflow problem, the facts leaving a block are m_lGen[block] | (facts entering the block & ~m_lKill[block])
+struct CDataflowProblem
+{
+	eDataflowDirection m_eDirection;
+	eDataflowMeet m_eMeet;
+	// The facts every block creates and removes
+	std::vector<CBitVector> m_lGen;
+	std::vector<CBitVector> m_lKill;
+	// The facts entering the script (forward) or leaving it (backward)
+	CBitVector m_oBoundary;
+
+	// The solution: the facts at the start and the end of every block
+	std::vector<CBitVector> m_lIn;
+	std::vector<CBitVector> m_lOut;
+	// How many times a block was visited before the facts stopped changing
+	size_t m_iVisits;
+};
+
+// Something the analyses found: the diagnostic and the event it's about
+struct CDataflowFinding
+{
+	eDiagnosticCode m_eCode;
+	size_t m_iEvent;
+};
+
+class CDataflow
+{
+	// The amount of variables, every fact has one bit for each
+	size_t m_iVariableCount;
+	// Every use and assignment of a variable, in the order of evaluation
+	std::vector<CDataflowEvent> m_lEvents;
+	// The basic blocks, in the order of the script
+	std::vector<CBasicBlock> m_lBlocks;
+	// The top-level statement the events that are added belong to
+	unsigned int m_iCurrentStatement;
+
+	// The solved problems
+	CDataflowProblem m_oDefiniteAssignment;
+	CDataflowProblem m_oLiveness;
+	// One bit for every event, set if the event is an assignment whose value is never read
+	CBitVector m_oDeadStores;
+	// The uses of unassigned variables and the dead stores, in the order of the events
+	std::vector<CDataflowFinding> m_lFindings;
+
+	// Adds the events of a statement and an expression, in the order the analyzer evaluates them
+	void AddStatementEvents(const CAstNode * pStatement);
+	void AddExpressionEvents(const CAstNode * pNode);
+	void AddEvent(eDataflowEventType eType, unsigned int iVariable, const CAstNode * pNode);
+	// Ends the current block and starts a new one that control falls through to
+	void StartBlock();
+
+	// Computes the gen and kill sets of both problems
+	void ComputeDefiniteAssignmentSets();
+	void ComputeLivenessSets();
+	// Walks the events of every block with the solved facts, and records what's found
+	void FindUnassignedUses();
+	void FindDeadStores();
+
+	// The analysis can't be copied
+	CDataflow(const CDataflow &);
+	CDataflow & operator=(const CDataflow &);
+
+public:
+	// The constructor of the CDataflow class
+	CDataflow();
+	// Analyzes the script, the variables have to be bound already (see CAnalyzer)
+	void Run(const CAstBlock * pProgram, size_t iVariableCount);
+	// Solves a dataflow problem over the blocks with a worklist, until no fact changes anymore
+	static void Solve(const std::vector<CBasicBlock> & lBlocks, CDataflowProblem & oProblem);
+
+	// Returns an event
+	const CDataflowEvent & GetEvent(size_t iEvent) const { return m_lEvents[iEvent]; }
+	// Returns the uses of unassigned variables and the dead stores, in the order of the events
+	const std::vector<CDataflowFinding> & GetFindings() const { return m_lFindings; }
+	// Returns true if the value an event stores is never read
+	bool IsDeadStore(size_t iEvent) const { return m_oDeadStores.Test(iEvent); }
+	// Returns the amount of events, blocks and block visits, for the debug log
+	size_t GetEventCount() const { return m_lEvents.size(); }
+	size_t GetBlockCount() const { return m_lBlocks.size(); }
+	size_t GetVisitCount() const { return m_oDefiniteAssignment.m_iVisits + m_oLiveness.m_iVisits; }
+};
\ No newline at end of file
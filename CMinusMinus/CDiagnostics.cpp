@@ -0,0 +1,262 @@
+//==============================================================================
+//
+// File: CDiagnostics.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CDiagnostics class turns the CError records into messages. The records
+// only hold a code and arguments, the message of a record is formatted when
+// it's printed. This class also holds the error limit: once a script has that
+// many errors the parser and the analyzer give up, and only that many errors
+// are printed. The errors are printed as text, or as one JSON document.
+//
+//==============================================================================
+
+#include "CDiagnostics.h"
+#include "CLogger.h"
+#include "CAst.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstdio>
+
+// The amount of errors after which the compiler gives up, 0 means there's no limit
+size_t CDiagnostics::m_iErrorLimit = DIAGNOSTIC_DEFAULT_ERROR_LIMIT;
+// How the errors are printed
+eDiagnosticOutputFormat CDiagnostics::m_eOutputFormat = DIAGNOSTIC_OUTPUT_TEXT;
+// Are the warnings reported?
+bool CDiagnostics::m_bWarningsEnabled = false;
+
+// The number, name, severity and message of every diagnostic, generated from DIAGNOSTIC_LIST
+// The names skip the "DIAGNOSTIC_" every code starts with
+struct CDiagnosticInfo
+{
+	int m_iNumber;
+	const char * m_szName;
+	eDiagnosticSeverity m_eSeverity;
+	const char * m_szMessage;
+};
+
+static const CDiagnosticInfo g_aDiagnostics[DIAGNOSTIC_COUNT] =
+{
+	#define DIAGNOSTIC_INFO_ENTRY(eCode, iNumber, eSeverity, szMessage) { iNumber, #eCode + sizeof("DIAGNOSTIC_") - 1, DIAGNOSTIC_SEVERITY_##eSeverity, szMessage },
+	DIAGNOSTIC_LIST(DIAGNOSTIC_INFO_ENTRY)
+	#undef DIAGNOSTIC_INFO_ENTRY
+};
+
+// The amount of types a packed DIAGNOSTIC_ARGUMENT_PARAMETER_TYPES argument holds is stored in the lowest four bits
+// A count of DIAGNOSTIC_MAX_PARAMETER_TYPES + 1 means the list held more types than were kept
+#define PARAMETER_TYPES_COUNT_BITS 4
+#define PARAMETER_TYPES_COUNT_MASK 0xF
+#define PARAMETER_TYPES_TYPE_BITS 2
+#define PARAMETER_TYPES_TYPE_MASK 0x3
+
+// Packs the types of the parameters, only the first DIAGNOSTIC_MAX_PARAMETER_TYPES are kept
+CDiagnosticArgument CDiagnosticArgument::ParameterTypes(const ParameterList & lParameterList)
+{
+	CDiagnosticArgument oArgument;
+	oArgument.m_eType = DIAGNOSTIC_ARGUMENT_PARAMETER_TYPES;
+
+	size_t iCount = lParameterList.size() > DIAGNOSTIC_MAX_PARAMETER_TYPES ? DIAGNOSTIC_MAX_PARAMETER_TYPES + 1 : lParameterList.size();
+	oArgument.m_iParameterTypes = (unsigned int) iCount;
+
+	for(size_t i = 0; i < iCount && i < DIAGNOSTIC_MAX_PARAMETER_TYPES; i++)
+		oArgument.m_iParameterTypes |= (unsigned int) lParameterList[i].GetType() << (PARAMETER_TYPES_COUNT_BITS + i * PARAMETER_TYPES_TYPE_BITS);
+
+	return oArgument;
+}
+
+// Returns the number a diagnostic is reported with, for example 1002
+int CDiagnostics::GetNumber(eDiagnosticCode eCode)
+{
+	if(eCode < 0 || eCode >= DIAGNOSTIC_COUNT)
+		return 0;
+
+	return g_aDiagnostics[eCode].m_iNumber;
+}
+
+// Returns the name of a diagnostic, for example "UNEXPECTED_TOKEN"
+const char * CDiagnostics::GetName(eDiagnosticCode eCode)
+{
+	if(eCode < 0 || eCode >= DIAGNOSTIC_COUNT)
+		return "INVALID_DIAGNOSTIC";
+
+	return g_aDiagnostics[eCode].m_szName;
+}
+
+// Returns whether a diagnostic is an error or a warning
+eDiagnosticSeverity CDiagnostics::GetSeverity(eDiagnosticCode eCode)
+{
+	if(eCode < 0 || eCode >= DIAGNOSTIC_COUNT)
+		return DIAGNOSTIC_SEVERITY_ERROR;
+
+	return g_aDiagnostics[eCode].m_eSeverity;
+}
+
+// Appends the text of an argument to a message
+static void AppendArgument(const CDiagnosticArgument & oArgument, std::string & sMessage)
+{
+	switch(oArgument.m_eType)
+	{
+		case DIAGNOSTIC_ARGUMENT_INTEGER:
+		{
+			char szBuffer[16];
+			sprintf_s(szBuffer, sizeof(szBuffer), "%d", oArgument.m_iInteger);
+			sMessage += szBuffer;
+			break;
+		}
+
+		case DIAGNOSTIC_ARGUMENT_SYMBOL:
+			sMessage += CSymbolPool::GetString(oArgument.m_iSymbol);
+			break;
+
+		case DIAGNOSTIC_ARGUMENT_TEXT:
+			sMessage += oArgument.m_szText;
+			break;
+
+		case DIAGNOSTIC_ARGUMENT_PARAMETER_TYPE:
+			sMessage += GetTypeAsString(oArgument.m_eParameterType);
+			break;
+
+		case DIAGNOSTIC_ARGUMENT_PARAMETER_TYPES:
+		{
+			unsigned int iCount = oArgument.m_iParameterTypes & PARAMETER_TYPES_COUNT_MASK;
+
+			for(unsigned int i = 0; i < iCount && i < DIAGNOSTIC_MAX_PARAMETER_TYPES; i++)
+			{
+				if(i > 0)
+					sMessage += ", ";
+
+				sMessage += GetTypeAsString((eVariableTypes) ((oArgument.m_iParameterTypes >> (PARAMETER_TYPES_COUNT_BITS + i * PARAMETER_TYPES_TYPE_BITS)) & PARAMETER_TYPES_TYPE_MASK));
+			}
+
+			// Not every type was kept
+			if(iCount > DIAGNOSTIC_MAX_PARAMETER_TYPES)
+				sMessage += ", ...";
+			break;
+		}
+
+		case DIAGNOSTIC_ARGUMENT_EXPRESSION:
+			sMessage += DescribeExpression(oArgument.m_pExpression);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Formats the message of an error, the arguments are filled in
+std::string CDiagnostics::FormatError(const CError & oError)
+{
+	std::string sMessage;
+
+	if(oError.m_eCode < 0 || oError.m_eCode >= DIAGNOSTIC_COUNT)
+		return sMessage;
+
+	// Copy the message, replacing every %1 up to %4 by its argument
+	for(const char * szMessage = g_aDiagnostics[oError.m_eCode].m_szMessage; *szMessage != '\0'; szMessage++)
+	{
+		if(szMessage[0] == '%' && szMessage[1] >= '1' && szMessage[1] < '1' + DIAGNOSTIC_MAX_ARGUMENTS)
+		{
+			AppendArgument(oError.m_aArguments[szMessage[1] - '1'], sMessage);
+			szMessage++;
+		}
+		else
+			sMessage += *szMessage;
+	}
+
+	return sMessage;
+}
+
+// Sorts the errors on their line, errors on the same line keep their order
+static bool IsErrorOnEarlierLine(const CError & oFirstError, const CError & oSecondError)
+{
+	return oFirstError.m_iLine < oSecondError.m_iLine;
+}
+
+// Sorts the errors on their line, errors on the same line stay in the order they were found in
+void CDiagnostics::SortByLine(ErrorList & lErrorList)
+{
+	std::stable_sort(lErrorList.begin(), lErrorList.end(), IsErrorOnEarlierLine);
+}
+
+// Appends a string to a JSON document, between quotes and with the characters JSON doesn't allow escaped
+static void AppendJsonString(const std::string & sText, std::string & sJson)
+{
+	sJson += '"';
+
+	for(size_t i = 0; i < sText.size(); i++)
+	{
+		unsigned char cCharacter = (unsigned char) sText[i];
+
+		if(cCharacter == '"' || cCharacter == '\\')
+		{
+			sJson += '\\';
+			sJson += (char) cCharacter;
+		}
+		else if(cCharacter == '\n')
+			sJson += "\\n";
+		else if(cCharacter == '\r')
+			sJson += "\\r";
+		else if(cCharacter == '\t')
+			sJson += "\\t";
+		else if(cCharacter < 0x20)
+		{
+			char szBuffer[8];
+			sprintf_s(szBuffer, sizeof(szBuffer), "\\u%04x", (int) cCharacter);
+			sJson += szBuffer;
+		}
+		else
+			sJson += (char) cCharacter;
+	}
+
+	sJson += '"';
+}
+
+// Prints the errors, up to the error limit
+void CDiagnostics::Print(const ErrorList & lErrorList)
+{
+	// Once the limit is reached the compiler gave up, the script may have more errors than the list holds
+	// Only the errors up to the limit are printed, the analyzer may have found a few more before it stopped
+	bool bTruncated = IsLimitReached(lErrorList.size());
+	size_t iPrintedCount = bTruncated ? m_iErrorLimit : lErrorList.size();
+
+	if(m_eOutputFormat == DIAGNOSTIC_OUTPUT_JSON)
+	{
+		// One error per line, the document is still valid JSON
+		CLogger::WriteLine("{\"diagnostics\":[");
+
+		for(size_t i = 0; i < iPrintedCount; i++)
+		{
+			const CError & oError = lErrorList[i];
+			char szBuffer[128];
+			sprintf_s(szBuffer, sizeof(szBuffer), "{\"code\":%d,\"name\":\"%s\",\"severity\":\"%s\",\"line\":%d,\"message\":", GetNumber(oError.m_eCode), GetName(oError.m_eCode), GetSeverity(oError.m_eCode) == DIAGNOSTIC_SEVERITY_WARNING ? "warning" : "error", oError.m_iLine);
+
+			std::string sJson = szBuffer;
+			AppendJsonString(FormatError(oError), sJson);
+			sJson += i + 1 < iPrintedCount ? "}," : "}";
+			CLogger::WriteLine(sJson);
+		}
+
+		CLogger::Write("],\"truncated\":%s}", bTruncated ? "true" : "false");
+		return;
+	}
+
+	// Now loop through the error list
+	#if _DEBUG
+	if(iPrintedCount > 0) CLogger::Write("\n* Errors found:");
+	#endif
+
+	// Log every error
+	for(size_t i = 0; i < iPrintedCount; i++)
+	{
+		if(GetSeverity(lErrorList[i].m_eCode) == DIAGNOSTIC_SEVERITY_WARNING)
+			CLogger::Write("Line %d: Warning: %s", lErrorList[i].m_iLine, FormatError(lErrorList[i]).c_str());
+		else
+			CLogger::Write("Line %d: %s", lErrorList[i].m_iLine, FormatError(lErrorList[i]).c_str());
+	}
+
+	// Tell that there may be more errors than the ones we printed
+	if(bTruncated)
+		CLogger::Write("Too many errors, stopped after %d.", (int) m_iErrorLimit);
+}
\ No newline at end of file
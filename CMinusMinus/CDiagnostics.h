@@ -0,0 +1,67 @@
+//==============================================================================
+//
+// File: CDiagnostics.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CDiagnostics class turns the CError records into messages. The records
+// only hold a code and arguments, the message of a record is formatted when
+// it's printed. This class also holds the error limit: once a script has that
+// many errors the parser and the analyzer give up, and only that many errors
+// are printed. The errors are printed as text, or as one JSON document.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include "CError.h"
+
+// The amount of errors after which the compiler gives up, unless another limit is set
+#define DIAGNOSTIC_DEFAULT_ERROR_LIMIT 100
+
+// How the errors are printed
+enum eDiagnosticOutputFormat
+{
+	// One line per error: "Line 3: Unexpected ';' found."
+	DIAGNOSTIC_OUTPUT_TEXT,
+	// One JSON document that holds every error, for editors and other tools
+	DIAGNOSTIC_OUTPUT_JSON
+};
+
+class CDiagnostics
+{
+	// The amount of errors after which the compiler gives up, 0 means there's no limit
+	static size_t m_iErrorLimit;
+	// How the errors are printed
+	static eDiagnosticOutputFormat m_eOutputFormat;
+	// Are the warnings reported? They're off unless they're asked for
+	static bool m_bWarningsEnabled;
+
+public:
+	// Sets the amount of errors after which the compiler gives up, 0 means there's no limit
+	static void SetErrorLimit(size_t iErrorLimit) { m_iErrorLimit = iErrorLimit; }
+	static size_t GetErrorLimit() { return m_iErrorLimit; }
+	// Returns true if this many errors reach the limit
+	static bool IsLimitReached(size_t iErrorCount) { return m_iErrorLimit != 0 && iErrorCount >= m_iErrorLimit; }
+	// Sets how the errors are printed
+	static void SetOutputFormat(eDiagnosticOutputFormat eOutputFormat) { m_eOutputFormat = eOutputFormat; }
+	// Turns the warnings on or off
+	static void SetWarningsEnabled(bool bWarningsEnabled) { m_bWarningsEnabled = bWarningsEnabled; }
+	static bool AreWarningsEnabled() { return m_bWarningsEnabled; }
+
+	// Returns the number a diagnostic is reported with, for example 1002
+	static int GetNumber(eDiagnosticCode eCode);
+	// Returns the name of a diagnostic, for example "UNEXPECTED_TOKEN"
+	static const char * GetName(eDiagnosticCode eCode);
+	// Returns whether a diagnostic is an error or a warning
+	static eDiagnosticSeverity GetSeverity(eDiagnosticCode eCode);
+	// Formats the message of an error, the arguments are filled in
+	static std::string FormatError(const CError & oError);
+
+	// Sorts the errors on their line, errors on the same line stay in the order they were found in
+	static void SortByLine(ErrorList & lErrorList);
+	// Prints the errors, up to the error limit
+	static void Print(const ErrorList & lErrorList);
+};
\ No newline at end of file
@@ -0,0 +1,410 @@
+//==============================================================================
+//
+// File: CEditSession.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CEditSession class keeps a script in memory while it's being edited, so
+// an edit doesn't have to go through the entire pipeline again. The lexer
+// state at the start of every line is saved, after an edit the lines are lexed
+// again from the edit onwards until a line starts in the same state as before.
+// The script is split in sections of complete top-level statements which are
+// lexed and parsed on their own, only the sections the edit touched are parsed
+// again. The analyzer then checks the syntax trees of the sections as one.
+//
+//==============================================================================
+
+#include "CEditSession.h"
+#include "CAnalyzer.h"
+#include "CCompiler.h"
+#include "CLogger.h"
+#include "CDiagnostics.h"
+#include "CSourceFile.h"
+
+#include <windows.h>
+#include <cstdlib>
+
+// A section is at least this many lines long (unless the script ends first), it ends at the next statement boundary
+#define EDIT_SESSION_SECTION_LINES 64
+
+// The constructor of the CEditSession class
+CEditSession::CEditSession(std::string sFileName, int iThreadCount)
+{
+	m_sFileName = sFileName;
+	m_iThreadCount = iThreadCount;
+	m_iRelexedLines = 0;
+	m_iReparsedSections = 0;
+}
+
+// Frees every section
+CEditSession::~CEditSession()
+{
+	for(size_t i = 0; i < m_lSections.size(); i++)
+		FreeSection(m_lSections[i]);
+}
+
+// Returns the line an offset in the source is on, that's the last line that starts at or before it
+size_t CEditSession::FindLine(size_t iOffset) const
+{
+	size_t iFirst = 0;
+	size_t iCount = m_lLines.size();
+
+	while(iCount > 1)
+	{
+		size_t iHalf = iCount / 2;
+
+		if(m_lLines[iFirst + iHalf].m_iStart <= iOffset)
+			iFirst += iHalf;
+
+		iCount -= iHalf;
+	}
+
+	return iFirst;
+}
+
+// Returns the section a line is in, that's the last section that starts at or before it
+size_t CEditSession::FindSection(size_t iLine) const
+{
+	size_t iFirst = 0;
+	size_t iCount = m_lSections.size();
+
+	while(iCount > 1)
+	{
+		size_t iHalf = iCount / 2;
+
+		if(m_lSections[iFirst + iHalf].m_iFirstLine <= iLine)
+			iFirst += iHalf;
+
+		iCount -= iHalf;
+	}
+
+	return iFirst;
+}
+
+// Returns where a line ends, right after its newline
+size_t CEditSession::GetLineEnd(size_t iLine) const
+{
+	return iLine + 1 < m_lLines.size() ? m_lLines[iLine + 1].m_iStart : m_sSource.size();
+}
+
+// Lexes a line, starting in the state of its checkpoint, and returns the state at the start of the next line
+CLineCheckpoint CEditSession::LexLine(size_t iLine)
+{
+	const CLineCheckpoint & oLine = m_lLines[iLine];
+	const char * pSource = m_sSource.c_str();
+	size_t iLineEnd = GetLineEnd(iLine);
+
+	m_oLexer.Start(pSource, oLine.m_iStart, iLineEnd, (int) iLine + 1);
+	m_oLexer.SetState(oLine.m_eState, oLine.m_iStart - oLine.m_iLiteralDistance);
+
+	// Only the last token of the line matters, a statement ends with a ; or a }
+	int iBlockDepth = oLine.m_iBlockDepth;
+	bool bAfterStatement = oLine.m_bAfterStatement;
+	CLexedToken oToken;
+
+	while(m_oLexer.Next(oToken))
+	{
+		char cFirstCharacter = pSource[oToken.m_iOffset];
+		bool bPunctuator = !oToken.m_bStringLiteral && oToken.m_iLength == 1;
+
+		if(bPunctuator && cFirstCharacter == '{')
+			iBlockDepth++;
+		else if(bPunctuator && cFirstCharacter == '}' && iBlockDepth > 0)
+			iBlockDepth--;
+
+		bAfterStatement = bPunctuator && (cFirstCharacter == ';' || cFirstCharacter == '}');
+	}
+
+	// The lexer starts every range on level 0, its level is relative to the start of the line
+	CLineCheckpoint oNextLine;
+	oNextLine.m_iStart = iLineEnd;
+	oNextLine.m_eState = m_oLexer.GetState();
+	oNextLine.m_iLiteralDistance = (oNextLine.m_eState == LEXER_STATE_STRING_LITERAL) ? iLineEnd - m_oLexer.GetLiteralStart() : 0;
+	oNextLine.m_oIndentation = CIndentation(oLine.m_oIndentation.m_iLevel + m_oLexer.GetIndentationLevel(), oLine.m_oIndentation.m_iLevelID + m_oLexer.GetIndentationLevelID());
+	oNextLine.m_iBlockDepth = iBlockDepth;
+	oNextLine.m_bAfterStatement = bAfterStatement;
+
+	return oNextLine;
+}
+
+// Lexes and parses a section, the old tokens and syntax tree of the section are freed
+void CEditSession::ParseSection(CSourceSection & oSection)
+{
+	FreeSection(oSection);
+
+	size_t iBegin = m_lLines[oSection.m_iFirstLine].m_iStart;
+	size_t iEnd = GetLineEnd(oSection.m_iFirstLine + oSection.m_iLineCount - 1);
+
+	oSection.m_pTokenizer = new CTokenizer(m_sFileName);
+	oSection.m_pTokenizer->RunRange(m_sSource.c_str(), iBegin, iEnd, (int) oSection.m_iFirstLine + 1);
+
+	oSection.m_pParser = new CParser(*oSection.m_pTokenizer);
+	oSection.m_pProgram = oSection.m_pParser->Parse();
+	oSection.m_iParsedFirstLine = oSection.m_iFirstLine;
+
+	m_iReparsedSections++;
+}
+
+// Frees the tokens and the syntax tree of a section
+void CEditSession::FreeSection(CSourceSection & oSection)
+{
+	delete oSection.m_pParser;
+	delete oSection.m_pTokenizer;
+
+	oSection.m_pParser = NULL;
+	oSection.m_pTokenizer = NULL;
+	oSection.m_pProgram = NULL;
+}
+
+// Replaces the sections [iFirstSection, iEndSection) by new sections that hold the lines [iFirstLine, iEndLine)
+void CEditSession::SplitSections(size_t iFirstSection, size_t iEndSection, size_t iFirstLine, size_t iEndLine)
+{
+	for(size_t i = iFirstSection; i < iEndSection; i++)
+		FreeSection(m_lSections[i]);
+
+	std::vector<CSourceSection> lSections;
+	size_t iSectionStart = iFirstLine;
+
+	for(size_t iLine = iFirstLine + 1; iLine <= iEndLine; iLine++)
+	{
+		// A section ends at the first statement boundary after it's long enough, or at the end of the range
+		if(iLine < iEndLine && (iLine - iSectionStart < EDIT_SESSION_SECTION_LINES || !m_lLines[iLine].IsStatementBoundary()))
+			continue;
+
+		CSourceSection oSection;
+		oSection.m_iFirstLine = iSectionStart;
+		oSection.m_iLineCount = iLine - iSectionStart;
+		oSection.m_pTokenizer = NULL;
+		oSection.m_pParser = NULL;
+		oSection.m_pProgram = NULL;
+
+		ParseSection(oSection);
+		lSections.push_back(oSection);
+
+		iSectionStart = iLine;
+	}
+
+	m_lSections.erase(m_lSections.begin() + iFirstSection, m_lSections.begin() + iEndSection);
+	m_lSections.insert(m_lSections.begin() + iFirstSection, lSections.begin(), lSections.end());
+}
+
+// Checks and evaluates the syntax trees of every section, as if they were parsed as one script
+void CEditSession::Check()
+{
+	m_lErrorList.clear();
+
+	std::vector<CAstNode *> lStatements;
+	std::vector<int> lLineShifts;
+
+	for(size_t i = 0; i < m_lSections.size(); i++)
+	{
+		const CSourceSection & oSection = m_lSections[i];
+		int iLineShift = (int) oSection.m_iFirstLine - (int) oSection.m_iParsedFirstLine;
+
+		// The syntax errors come first, just like when the script is parsed as a whole
+		const ErrorList & lSyntaxErrors = oSection.m_pParser->GetErrorList();
+
+		for(size_t j = 0; j < lSyntaxErrors.size() && !CDiagnostics::IsLimitReached(m_lErrorList.size()); j++)
+		{
+			m_lErrorList.push_back(lSyntaxErrors[j]);
+			m_lErrorList.back().m_iLine += iLineShift;
+		}
+
+		for(size_t j = 0; j < oSection.m_pProgram->m_iStatementCount; j++)
+		{
+			lStatements.push_back(oSection.m_pProgram->m_ppStatements[j]);
+			lLineShifts.push_back(iLineShift);
+		}
+
+		// The parser gave up on the rest of the script, the sections after it don't count
+		// The parser of the entire script would also have given up once the errors reached the limit
+		if(oSection.m_pParser->IsAborted() || CDiagnostics::IsLimitReached(m_lErrorList.size()))
+			break;
+	}
+
+	// The top-level statements of the sections form one script
+	CAstBlock oProgram;
+	oProgram.m_eType = AST_NODE_BLOCK;
+	oProgram.m_iLine = 1;
+	oProgram.m_ppStatements = lStatements.empty() ? NULL : &lStatements[0];
+	oProgram.m_iStatementCount = lStatements.size();
+	oProgram.m_bBraced = false;
+
+	// The calls of the last check are evaluated again
+	CCompiler::Reset();
+
+	CAnalyzer oAnalyzer(m_lErrorList);
+	oAnalyzer.Run(&oProgram, m_iThreadCount, lLineShifts.empty() ? NULL : &lLineShifts[0]);
+
+	CDiagnostics::SortByLine(m_lErrorList);
+}
+
+// Reads the script and runs the entire pipeline once
+void CEditSession::Open()
+{
+	CSourceFile oSourceFile;
+
+	if(!oSourceFile.Open(m_sFileName))
+	{
+		CLogger::Write("* Could not open source file %s", m_sFileName.c_str());
+		exit(1);
+	}
+
+	// The token buffer saves offsets in 32 bits
+	if((unsigned long long) oSourceFile.GetSize() > 0xFFFFFFFFULL)
+	{
+		CLogger::Write("* Source file %s is too big (4 GB at most)", m_sFileName.c_str());
+		exit(1);
+	}
+
+	// The session edits its own copy of the source
+	m_sSource.assign(oSourceFile.GetData(), oSourceFile.GetSize());
+	oSourceFile.Close();
+
+	// The first line starts in between tokens, on level 0, every newline starts a new line
+	// The state at the start of the other lines is found by lexing the line before them
+	CLineCheckpoint oLine;
+	m_lLines.assign(1, oLine);
+
+	for(size_t i = 0; i < m_sSource.size(); i++)
+	{
+		if(m_sSource[i] != '\n')
+			continue;
+
+		oLine.m_iStart = i + 1;
+		m_lLines.push_back(oLine);
+	}
+
+	for(size_t i = 0; i + 1 < m_lLines.size(); i++)
+		m_lLines[i + 1] = LexLine(i);
+
+	m_iRelexedLines = m_lLines.size();
+	m_iReparsedSections = 0;
+
+	SplitSections(0, m_lSections.size(), 0, m_lLines.size());
+	Check();
+
+	#if _DEBUG
+	CLogger::Write("* Opened %s: %d lines in %d sections", m_sFileName.c_str(), (int) m_lLines.size(), (int) m_lSections.size());
+	#endif
+}
+
+// Replaces iRemovedLength bytes at iOffset by sInsertedText, then checks the script again
+void CEditSession::ApplyEdit(size_t iOffset, size_t iRemovedLength, const std::string & sInsertedText)
+{
+	#if _DEBUG
+	LARGE_INTEGER iStartTime;
+	QueryPerformanceCounter(&iStartTime);
+	#endif
+
+	m_iRelexedLines = 0;
+	m_iReparsedSections = 0;
+
+	// Keep the edit inside the source
+	if(iOffset > m_sSource.size())
+		iOffset = m_sSource.size();
+
+	if(iRemovedLength > m_sSource.size() - iOffset)
+		iRemovedLength = m_sSource.size() - iOffset;
+
+	// The lines after the line the edit starts on, up to the line it ends on, are replaced
+	// So are the sections they start
+	size_t iFirstLine = FindLine(iOffset);
+	size_t iLastLine = FindLine(iOffset + iRemovedLength);
+	size_t iFirstSection = FindSection(iFirstLine);
+	size_t iLastSection = FindSection(iLastLine);
+
+	m_sSource.replace(iOffset, iRemovedLength, sInsertedText);
+
+	// Every newline in the new text starts a line, the state at its start is found when it's lexed
+	std::vector<CLineCheckpoint> lNewLines;
+
+	for(size_t i = 0; i < sInsertedText.size(); i++)
+	{
+		if(sInsertedText[i] != '\n')
+			continue;
+
+		CLineCheckpoint oLine = m_lLines[iFirstLine];
+		oLine.m_iStart = iOffset + i + 1;
+		lNewLines.push_back(oLine);
+	}
+
+	m_lLines.erase(m_lLines.begin() + iFirstLine + 1, m_lLines.begin() + iLastLine + 1);
+	m_lLines.insert(m_lLines.begin() + iFirstLine + 1, lNewLines.begin(), lNewLines.end());
+
+	// The lines and sections after the edit moved
+	size_t iEditEndLine = iFirstLine + 1 + lNewLines.size();
+	int iLineShift = (int) lNewLines.size() - (int) (iLastLine - iFirstLine);
+
+	for(size_t i = iEditEndLine; i < m_lLines.size(); i++)
+		m_lLines[i].m_iStart = m_lLines[i].m_iStart - iRemovedLength + sInsertedText.size();
+
+	for(size_t i = iLastSection + 1; i < m_lSections.size(); i++)
+		m_lSections[i].m_iFirstLine = (size_t) ((int) m_lSections[i].m_iFirstLine + iLineShift);
+
+	// Lex the lines again from the edit onwards, until a line after the edit starts in the same state as before
+	// The lines after it are lexed the same way as before, only their indentation level IDs can change
+	size_t iLine = iFirstLine;
+	size_t iConvergedLine = m_lLines.size();
+
+	while(iLine + 1 < m_lLines.size())
+	{
+		CLineCheckpoint oNextLine = LexLine(iLine);
+		iLine++;
+
+		const CLineCheckpoint & oOldLine = m_lLines[iLine];
+
+		if(iLine >= iEditEndLine && oNextLine.m_eState == oOldLine.m_eState && oNextLine.m_iLiteralDistance == oOldLine.m_iLiteralDistance
+			&& oNextLine.m_oIndentation.m_iLevel == oOldLine.m_oIndentation.m_iLevel && oNextLine.m_iBlockDepth == oOldLine.m_iBlockDepth && oNextLine.m_bAfterStatement == oOldLine.m_bAfterStatement)
+		{
+			int iLevelIDShift = oNextLine.m_oIndentation.m_iLevelID - oOldLine.m_oIndentation.m_iLevelID;
+
+			if(iLevelIDShift != 0)
+			{
+				for(size_t i = iLine; i < m_lLines.size(); i++)
+					m_lLines[i].m_oIndentation.m_iLevelID += iLevelIDShift;
+			}
+
+			iConvergedLine = iLine;
+			break;
+		}
+
+		m_lLines[iLine] = oNextLine;
+	}
+
+	m_iRelexedLines = iConvergedLine - iFirstLine;
+
+	// Parse the sections the edit touched again, up to the first section that starts at or after the converged line
+	// That section still starts on a statement boundary, the lines from there on didn't change
+	size_t iEndSection = iLastSection + 1;
+
+	while(iEndSection < m_lSections.size() && m_lSections[iEndSection].m_iFirstLine < iConvergedLine)
+		iEndSection++;
+
+	size_t iEndLine = (iEndSection < m_lSections.size()) ? m_lSections[iEndSection].m_iFirstLine : m_lLines.size();
+	SplitSections(iFirstSection, iEndSection, m_lSections[iFirstSection].m_iFirstLine, iEndLine);
+
+	// Syntax errors mention lines in their message, the sections with syntax errors that moved are parsed again as well
+	for(size_t i = iFirstSection; i < m_lSections.size(); i++)
+	{
+		if(m_lSections[i].m_iFirstLine != m_lSections[i].m_iParsedFirstLine && !m_lSections[i].m_pParser->GetErrorList().empty())
+			ParseSection(m_lSections[i]);
+	}
+
+	Check();
+
+	#if _DEBUG
+	LARGE_INTEGER iEndTime, iFrequency;
+	QueryPerformanceCounter(&iEndTime);
+	QueryPerformanceFrequency(&iFrequency);
+
+	CLogger::Write("* Edit at offset %d: lexed %d lines and parsed %d sections again in %.3f ms", (int) iOffset, (int) m_iRelexedLines, (int) m_iReparsedSections, (double) (iEndTime.QuadPart - iStartTime.QuadPart) * 1000.0 / (double) iFrequency.QuadPart);
+	#endif
+}
+
+// Logs every error, up to the error limit
+void CEditSession::LogErrors()
+{
+	CDiagnostics::Print(m_lErrorList);
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+//==============================================================================
+//
+// File: CEditSession.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CEditSession class keeps a script in memory while it's being edited, so
+// an edit doesn't have to go through the entire pipeline again. The lexer
+// state at the start of every line is saved, after an edit the lines are lexed
+// again from the edit onwards until a line starts in the same state as before.
+// The script is split in sections of complete top-level statements which are
+// lexed and parsed on their own, only the sections the edit touched are parsed
+// again. The analyzer then checks the syntax trees of the sections as one.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CLexer.h"
+#include "CTokenizer.h"
+#include "CParser.h"
+#include "CError.h"
+
+// The state of the lexer at the start of a line
+struct CLineCheckpoint
+{
+	// Where the line starts in the source
+	size_t m_iStart;
+	// Is the line inside a string literal or a comment?
+	eLexerState m_eState;
+	// If the line is inside a string literal, how many bytes before the start of the line the literal started
+	size_t m_iLiteralDistance;
+	// The indentation level and ID at the start of the line
+	CIndentation m_oIndentation;
+	// How deep the blocks are nested at the start of the line, as the parser sees it
+	// Unlike the indentation level this never goes below 0, the parser skips a } that doesn't close a block
+	int m_iBlockDepth;
+	// Does the last token before the line end a statement (a ; or a })? Also true if there is no token before it
+	bool m_bAfterStatement;
+
+	// By default this is the state at the start of the script: in between tokens, on level 0
+	CLineCheckpoint::CLineCheckpoint(): m_iStart(0), m_eState(LEXER_STATE_NORMAL), m_iLiteralDistance(0), m_oIndentation(0, 0), m_iBlockDepth(0), m_bAfterStatement(true) { }
+
+	// Can a section start on this line? That's only the case in between two top-level statements
+	bool IsStatementBoundary() const { return m_eState == LEXER_STATE_NORMAL && m_iBlockDepth == 0 && m_bAfterStatement; }
+};
+
+// A run of lines that holds complete top-level statements, every section is lexed and parsed on its own
+struct CSourceSection
+{
+	// The first line of the section (counting from 0) and the amount of lines in it
+	size_t m_iFirstLine;
+	size_t m_iLineCount;
+	// The first line of the section when it was parsed, the lines in its syntax tree count from there
+	size_t m_iParsedFirstLine;
+	// The tokens and the syntax tree of the section
+	CTokenizer * m_pTokenizer;
+	CParser * m_pParser;
+	const CAstBlock * m_pProgram;
+};
+
+class CEditSession
+{
+	// The name of the script, the source is read from this file when the session is opened
+	std::string m_sFileName;
+	// The source as it is after the last edit
+	std::string m_sSource;
+	// The lexer state at the start of every line
+	std::vector<CLineCheckpoint> m_lLines;
+	// The sections of the script, in the order of the source
+	std::vector<CSourceSection> m_lSections;
+	// Finds the lexer state at the start of the lines, one line at a time
+	CLexer m_oLexer;
+	// The amount of threads the analyzer evaluates the script on
+	int m_iThreadCount;
+
+	// The errors the last check found, in the order of the source
+	ErrorList m_lErrorList;
+	// How much work the last edit took
+	size_t m_iRelexedLines;
+	size_t m_iReparsedSections;
+
+	// The session can't be copied, it owns the sections
+	CEditSession(const CEditSession &);
+	CEditSession & operator=(const CEditSession &);
+
+	// Returns the line an offset in the source is on
+	size_t FindLine(size_t iOffset) const;
+	// Returns the section a line is in
+	size_t FindSection(size_t iLine) const;
+	// Returns where a line ends, right after its newline
+	size_t GetLineEnd(size_t iLine) const;
+	// Lexes a line, starting in the state of its checkpoint, and returns the state at the start of the next line
+	CLineCheckpoint LexLine(size_t iLine);
+
+	// Lexes and parses a section, the old tokens and syntax tree of the section are freed
+	void ParseSection(CSourceSection & oSection);
+	static void FreeSection(CSourceSection & oSection);
+	// Replaces the sections [iFirstSection, iEndSection) by new sections that hold the lines [iFirstLine, iEndLine)
+	// The first line of the range has to be a statement boundary, and so does iEndLine
+	void SplitSections(size_t iFirstSection, size_t iEndSection, size_t iFirstLine, size_t iEndLine);
+	// Checks and evaluates the syntax trees of every section
+	void Check();
+
+public:
+	// The constructor of the CEditSession class, the script is evaluated on iThreadCount threads
+	CEditSession(std::string sFileName, int iThreadCount);
+	// Frees every section
+	~CEditSession();
+	// Reads the script and runs the entire pipeline once
+	void Open();
+	// Replaces iRemovedLength bytes at iOffset by sInsertedText, then checks the script again
+	// Only the lines and sections the edit touched are lexed and parsed again
+	void ApplyEdit(size_t iOffset, size_t iRemovedLength, const std::string & sInsertedText);
+
+	// Returns the source as it is after the last edit
+	const std::string & GetSource() const { return m_sSource; }
+	// Returns the errors the last check found, in the order of the source
+	// The errors point into the syntax trees of the sections, format them before the next edit
+	const ErrorList & GetErrorList() const { return m_lErrorList; }
+	// Returns how many lines and sections the last edit lexed and parsed again
+	size_t GetRelexedLines() const { return m_iRelexedLines; }
+	size_t GetReparsedSections() const { return m_iReparsedSections; }
+	// Logs every error, up to the error limit
+	void LogErrors();
+};
\ No newline at end of file
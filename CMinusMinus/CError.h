@@ -4,19 +4,147 @@
 // Project: CMinusMinus
 // Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
 // License: See LICENSE in root directory
-// 
-// The CError structure allows for easy error outputting in the CParser.
-// 
+//
+// The CError structure is one diagnostic: a code, the line it was found on and
+// the arguments of its message. The message itself is only formatted when the
+// error is printed (see CDiagnostics), most errors are never printed at all.
+//
 //==============================================================================
 
 #pragma once
 
+#include <vector>
+#include "CSymbolPool.h"
+#include "CParameter.h"
+
+struct CAstNode;
+
+// The most arguments a message takes
+#define DIAGNOSTIC_MAX_ARGUMENTS 4
+
+// The most parameter types a DIAGNOSTIC_ARGUMENT_PARAMETER_TYPES argument holds
+#define DIAGNOSTIC_MAX_PARAMETER_TYPES 14
+
+// Every diagnostic, the number it's reported with, whether it's an error or a warning and its message
+// The message refers to the arguments with %1 up to %4, they're filled in when the message is formatted
+// The numbers are part of the JSON output, never change the number of an existing diagnostic
+#define DIAGNOSTIC_LIST(DIAGNOSTIC) \
+	/* Syntax errors, found by the CParser */ \
+	DIAGNOSTIC(DIAGNOSTIC_UNEXPECTED_END, 1001, ERROR, "Unexpected end of the script.") \
+	DIAGNOSTIC(DIAGNOSTIC_UNEXPECTED_TOKEN, 1002, ERROR, "Unexpected '%1' found.") \
+	DIAGNOSTIC(DIAGNOSTIC_UNFINISHED_STATEMENT, 1003, ERROR, "Finish the statement at line %1 first.") \
+	DIAGNOSTIC(DIAGNOSTIC_NESTED_TOO_DEEP, 1004, ERROR, "Blocks and brackets are nested too deep (%1 levels at most).") \
+	DIAGNOSTIC(DIAGNOSTIC_MISSING_VALUE, 1005, ERROR, "Expected a value or variable after the equal sign on line %1") \
+	DIAGNOSTIC(DIAGNOSTIC_UNCLOSED_BLOCK, 1006, ERROR, "Expected a '}' to close the block opened on line %1.") \
+	DIAGNOSTIC(DIAGNOSTIC_MISSING_VARIABLE_NAME, 1007, ERROR, "Expected a variable name after '%1'.") \
+	DIAGNOSTIC(DIAGNOSTIC_UNCLOSED_BRACKET, 1008, ERROR, "Expected a ')' to close the '(' on line %1.") \
+	DIAGNOSTIC(DIAGNOSTIC_MISSING_ARGUMENT_SEPARATOR, 1009, ERROR, "Expected a ',' or ')' in the call to %1.") \
+	/* Errors in the meaning of the script, found by the CAnalyzer */ \
+	DIAGNOSTIC(DIAGNOSTIC_VARIABLE_REDECLARED, 2001, ERROR, "'%1' already exists. Cannot re-declare a variable.") \
+	DIAGNOSTIC(DIAGNOSTIC_ASSIGNMENT_TO_CONSTANT, 2002, ERROR, "Cannot assign to a value constant (%1).") \
+	DIAGNOSTIC(DIAGNOSTIC_ASSIGNMENT_TO_STRING_LITERAL, 2003, ERROR, "Cannot assign anything to a string literal.") \
+	DIAGNOSTIC(DIAGNOSTIC_ASSIGNMENT_TO_EXPRESSION, 2004, ERROR, "Cannot assign anything to '%1', it's not a variable.") \
+	DIAGNOSTIC(DIAGNOSTIC_ASSIGNMENT_TO_UNDECLARED, 2005, ERROR, "Cannot assign anything to %1, variable does not exist.") \
+	DIAGNOSTIC(DIAGNOSTIC_VARIABLE_OUT_OF_SCOPE, 2006, ERROR, "Cannot access %1, that variable is declared on another level.") \
+	DIAGNOSTIC(DIAGNOSTIC_RETURN_TYPE_MISMATCH, 2007, ERROR, "Could not assign the return value of %1 to %2, the types differ.") \
+	DIAGNOSTIC(DIAGNOSTIC_STRING_TYPE_MISMATCH, 2008, ERROR, "Cannot assign \"%1\" to '%2', the types differ.") \
+	DIAGNOSTIC(DIAGNOSTIC_TYPE_MISMATCH, 2009, ERROR, "Cannot assign '%1' to '%2', the types differ.") \
+	DIAGNOSTIC(DIAGNOSTIC_UNDECLARED_VARIABLE, 2010, ERROR, "Cannot use %1, variable does not exist.") \
+	DIAGNOSTIC(DIAGNOSTIC_STRING_MINUS, 2011, ERROR, "The string type does not define the minus operator.") \
+	DIAGNOSTIC(DIAGNOSTIC_CONCATENATION_TYPE_MISMATCH, 2012, ERROR, "Cannot concatenate '%1' and '%2', the types differ.") \
+	/* Calls that don't fit a function, found by the CFunctionWrapper */ \
+	DIAGNOSTIC(DIAGNOSTIC_UNKNOWN_FUNCTION, 3001, ERROR, "Could not call %1, function does not exist.") \
+	DIAGNOSTIC(DIAGNOSTIC_PARAMETER_COUNT, 3002, ERROR, "%1 expects %2 parameter(s), got %3.") \
+	DIAGNOSTIC(DIAGNOSTIC_PARAMETER_TYPE, 3003, ERROR, "Parameter %1 has a bad type (expected %2, got %3, in function call %4)") \
+	DIAGNOSTIC(DIAGNOSTIC_NO_MATCHING_OVERLOAD, 3004, ERROR, "No overload of %1 takes (%2).") \
+	/* Values that are read before they're assigned or never read at all, found by the CDataflow */ \
+	DIAGNOSTIC(DIAGNOSTIC_USED_BEFORE_ASSIGNMENT, 4001, WARNING, "%1 is used before it's assigned a value.") \
+	DIAGNOSTIC(DIAGNOSTIC_DEAD_STORE, 4002, WARNING, "The value assigned to %1 is never used.")
+
+enum eDiagnosticCode
+{
+	#define DIAGNOSTIC_ENUM_ENTRY(eCode, iNumber, eSeverity, szMessage) eCode,
+	DIAGNOSTIC_LIST(DIAGNOSTIC_ENUM_ENTRY)
+	#undef DIAGNOSTIC_ENUM_ENTRY
+
+	// The amount of diagnostics
+	DIAGNOSTIC_COUNT
+};
+
+// How bad a diagnostic is
+enum eDiagnosticSeverity
+{
+	// The script can't be compiled
+	DIAGNOSTIC_SEVERITY_ERROR,
+	// The script compiles, but it probably doesn't do what was meant
+	DIAGNOSTIC_SEVERITY_WARNING
+};
+
+// What an argument of a message holds
+enum eDiagnosticArgumentType
+{
+	// The message doesn't have this argument
+	DIAGNOSTIC_ARGUMENT_NONE,
+	// A number, for example a line
+	DIAGNOSTIC_ARGUMENT_INTEGER,
+	// An interned value, for example a variable name
+	DIAGNOSTIC_ARGUMENT_SYMBOL,
+	// A string that lives as long as the program, for example the spelling of a keyword
+	DIAGNOSTIC_ARGUMENT_TEXT,
+	// The type of a parameter
+	DIAGNOSTIC_ARGUMENT_PARAMETER_TYPE,
+	// The types of a list of parameters, packed two bits per type after a four bit count
+	DIAGNOSTIC_ARGUMENT_PARAMETER_TYPES,
+	// An expression of the syntax tree, it's described when the message is formatted
+	// The error can only be formatted as long as the syntax tree is alive
+	DIAGNOSTIC_ARGUMENT_EXPRESSION
+};
+
+// One argument of a message
+struct CDiagnosticArgument
+{
+	eDiagnosticArgumentType m_eType;
+
+	union
+	{
+		int m_iInteger;
+		SymbolID m_iSymbol;
+		const char * m_szText;
+		eVariableTypes m_eParameterType;
+		unsigned int m_iParameterTypes;
+		const CAstNode * m_pExpression;
+	};
+
+	// The default constructor for the CDiagnosticArgument struct, creates a DIAGNOSTIC_ARGUMENT_NONE argument
+	CDiagnosticArgument::CDiagnosticArgument(): m_eType(DIAGNOSTIC_ARGUMENT_NONE), m_pExpression(NULL) { }
+
+	// Creates an argument of each type
+	static CDiagnosticArgument Integer(int iInteger) { CDiagnosticArgument oArgument; oArgument.m_eType = DIAGNOSTIC_ARGUMENT_INTEGER; oArgument.m_iInteger = iInteger; return oArgument; }
+	static CDiagnosticArgument Symbol(SymbolID iSymbol) { CDiagnosticArgument oArgument; oArgument.m_eType = DIAGNOSTIC_ARGUMENT_SYMBOL; oArgument.m_iSymbol = iSymbol; return oArgument; }
+	static CDiagnosticArgument Text(const char * szText) { CDiagnosticArgument oArgument; oArgument.m_eType = DIAGNOSTIC_ARGUMENT_TEXT; oArgument.m_szText = szText; return oArgument; }
+	static CDiagnosticArgument ParameterType(eVariableTypes eType) { CDiagnosticArgument oArgument; oArgument.m_eType = DIAGNOSTIC_ARGUMENT_PARAMETER_TYPE; oArgument.m_eParameterType = eType; return oArgument; }
+	static CDiagnosticArgument Expression(const CAstNode * pExpression) { CDiagnosticArgument oArgument; oArgument.m_eType = DIAGNOSTIC_ARGUMENT_EXPRESSION; oArgument.m_pExpression = pExpression; return oArgument; }
+	// Packs the types of the parameters, only the first DIAGNOSTIC_MAX_PARAMETER_TYPES are kept
+	static CDiagnosticArgument ParameterTypes(const ParameterList & lParameterList);
+};
+
 struct CError
 {
-	// The error message
-	std::string m_sMessage;
+	// Which diagnostic is this?
+	eDiagnosticCode m_eCode;
 	// The line the error occured on
 	int m_iLine;
+	// The arguments of the message
+	CDiagnosticArgument m_aArguments[DIAGNOSTIC_MAX_ARGUMENTS];
+
+	// The constructor of the CError struct, the arguments that aren't passed are DIAGNOSTIC_ARGUMENT_NONE
+	CError::CError(eDiagnosticCode eCode, int iLine, CDiagnosticArgument oFirst = CDiagnosticArgument(), CDiagnosticArgument oSecond = CDiagnosticArgument(), CDiagnosticArgument oThird = CDiagnosticArgument(), CDiagnosticArgument oFourth = CDiagnosticArgument()): m_eCode(eCode), m_iLine(iLine)
+	{
+		m_aArguments[0] = oFirst;
+		m_aArguments[1] = oSecond;
+		m_aArguments[2] = oThird;
+		m_aArguments[3] = oFourth;
+	}
 };
 
-typedef std::list<CError> ErrorList;
\ No newline at end of file
+typedef std::vector<CError> ErrorList;
\ No newline at end of file
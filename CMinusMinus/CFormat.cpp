@@ -0,0 +1,262 @@
+//==============================================================================
+//
+// File: CFormat.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CFormat class implements the format() native. A format string is parsed
+// once into a list of operations: copy a piece of text or write an argument.
+// The compiled formats are kept, so a format string that's used again (which
+// is what reports do) goes straight to writing the arguments.
+//
+//==============================================================================
+
+#include "CFormat.h"
+#include "CSymbolPool.h"
+#include "Util.h"
+#include "CLogger.h"
+#include "CThreadPool.h"
+
+#include <cstring>
+
+// The amount of buckets, twice the most formats that are kept so the chains stay short (always a power of two)
+#define FORMAT_CACHE_BUCKETS (FORMAT_CACHE_MAX_FORMATS * 2)
+
+// The compiled formats by the hash of their string
+std::vector<CCompiledFormat *> CFormat::m_lBuckets;
+size_t CFormat::m_iFormatCount = 0;
+// How often a format string was found, and how often it had to be parsed
+size_t CFormat::m_iHits = 0;
+size_t CFormat::m_iCompilations = 0;
+// The lock of the formats
+volatile long CFormat::m_iLock = 0;
+
+// Returns true if the character is a digit
+static inline bool IsFormatDigit(char cCharacter)
+{
+	return (unsigned char) (cCharacter - '0') < 10;
+}
+
+// Adds a piece of the format string to the operations, it's merged with the text right before it
+static void AddText(CCompiledFormat & oFormat, size_t iStart, size_t iLength)
+{
+	oFormat.m_iTextLength += iLength;
+
+	// Is the last operation text that ends right here?
+	if(!oFormat.m_lOperations.empty())
+	{
+		CFormatOperation & oLast = oFormat.m_lOperations.back();
+
+		if(oLast.m_eType == FORMAT_OPERATION_TEXT && oLast.m_iStart + oLast.m_iLength == iStart)
+		{
+			oLast.m_iLength += iLength;
+			return;
+		}
+	}
+
+	CFormatOperation oOperation;
+	oOperation.m_eType = FORMAT_OPERATION_TEXT;
+	oOperation.m_iStart = iStart;
+	oOperation.m_iLength = iLength;
+	oOperation.m_iArgument = 0;
+	oOperation.m_iPrecision = -1;
+	oFormat.m_lOperations.push_back(oOperation);
+}
+
+// Parses a format string into its operations
+void CFormat::Compile(const char * szFormat, size_t iLength, CCompiledFormat & oFormat)
+{
+	oFormat.m_sFormat.assign(szFormat, iLength);
+	oFormat.m_iHash = CSymbolPool::Hash(szFormat, iLength);
+	oFormat.m_lOperations.clear();
+	oFormat.m_iTextLength = 0;
+	oFormat.m_pNextInBucket = NULL;
+
+	// The argument {} refers to, it's the one after the argument of the placeholder before it
+	int iNextArgument = 0;
+	size_t i = 0;
+
+	while(i < iLength)
+	{
+		char cCharacter = szFormat[i];
+
+		// {{ and }} write a single brace, that's the first character of the pair
+		if((cCharacter == '{' || cCharacter == '}') && i + 1 < iLength && szFormat[i + 1] == cCharacter)
+		{
+			AddText(oFormat, i, 1);
+			i += 2;
+			continue;
+		}
+
+		if(cCharacter != '{')
+		{
+			AddText(oFormat, i, 1);
+			i++;
+			continue;
+		}
+
+		// Parse the placeholder: an optional argument index, then an optional :.precision and the }
+		size_t iEnd = i + 1;
+		int iArgument = -1;
+		int iPrecision = -1;
+
+		if(iEnd < iLength && IsFormatDigit(szFormat[iEnd]))
+		{
+			for(iArgument = 0; iEnd < iLength && IsFormatDigit(szFormat[iEnd]) && iArgument < 1000; iEnd++)
+				iArgument = iArgument * 10 + (szFormat[iEnd] - '0');
+		}
+
+		if(iEnd + 2 < iLength && szFormat[iEnd] == ':' && szFormat[iEnd + 1] == '.' && IsFormatDigit(szFormat[iEnd + 2]))
+		{
+			for(iEnd += 2, iPrecision = 0; iEnd < iLength && IsFormatDigit(szFormat[iEnd]) && iPrecision < 1000; iEnd++)
+				iPrecision = iPrecision * 10 + (szFormat[iEnd] - '0');
+		}
+
+		// Not a placeholder after all, the { is just text
+		if(iEnd >= iLength || szFormat[iEnd] != '}')
+		{
+			AddText(oFormat, i, 1);
+			i++;
+			continue;
+		}
+
+		if(iArgument == -1)
+			iArgument = iNextArgument;
+
+		iNextArgument = iArgument + 1;
+
+		CFormatOperation oOperation;
+		oOperation.m_eType = FORMAT_OPERATION_ARGUMENT;
+		oOperation.m_iStart = i;
+		oOperation.m_iLength = iEnd + 1 - i;
+		oOperation.m_iArgument = iArgument;
+		oOperation.m_iPrecision = iPrecision;
+		oFormat.m_lOperations.push_back(oOperation);
+
+		i = iEnd + 1;
+	}
+}
+
+// Writes the arguments as the compiled format says
+void CFormat::Apply(const CCompiledFormat & oFormat, const CValue * const * ppArguments, size_t iArgumentCount, std::string & sResult)
+{
+	const char * szFormat = oFormat.m_sFormat.c_str();
+	// Big floats with a precision are written with all of their digits, so the buffer is sized for those
+	char szNumber[MAX_FIXED_FLOAT_STRING_LENGTH];
+
+	// Most arguments are short numbers, so this is usually the only allocation
+	sResult.reserve(oFormat.m_iTextLength + iArgumentCount * 16);
+
+	for(size_t i = 0; i < oFormat.m_lOperations.size(); i++)
+	{
+		const CFormatOperation & oOperation = oFormat.m_lOperations[i];
+
+		// Copy text, and placeholders of arguments that weren't passed
+		if(oOperation.m_eType == FORMAT_OPERATION_TEXT || (size_t) oOperation.m_iArgument >= iArgumentCount)
+		{
+			sResult.append(szFormat + oOperation.m_iStart, oOperation.m_iLength);
+			continue;
+		}
+
+		const CValue & oArgument = *ppArguments[oOperation.m_iArgument];
+
+		switch(oArgument.GetType())
+		{
+			case VARIABLE_TYPE_INTEGER:
+				sResult.append(szNumber, FormatInteger(oArgument.GetInteger(), szNumber));
+				break;
+
+			case VARIABLE_TYPE_FLOAT:
+			{
+				if(oOperation.m_iPrecision == -1)
+					sResult.append(szNumber, FormatFloat(oArgument.GetFloat(), szNumber));
+				else
+					sResult.append(szNumber, FormatFixedFloat(oArgument.GetFloat(), oOperation.m_iPrecision, szNumber));
+				break;
+			}
+
+			case VARIABLE_TYPE_STRING:
+			{
+				// The precision cuts a string off
+				size_t iLength = oArgument.GetLength();
+
+				if(oOperation.m_iPrecision != -1 && (size_t) oOperation.m_iPrecision < iLength)
+					iLength = oOperation.m_iPrecision;
+
+				sResult.append(oArgument.GetString(), iLength);
+				break;
+			}
+		}
+	}
+}
+
+// Formats the arguments, the format string is parsed unless it was used before
+std::string CFormat::Format(const CValue & oFormat, const CValue * const * ppArguments, size_t iArgumentCount)
+{
+	const char * szFormat = oFormat.GetString();
+	size_t iLength = oFormat.GetLength();
+	unsigned int iHash = CSymbolPool::Hash(szFormat, iLength);
+	const CCompiledFormat * pFormat = NULL;
+
+	LockSpinLock(&m_iLock);
+
+	if(!m_lBuckets.empty())
+	{
+		for(pFormat = m_lBuckets[iHash & (m_lBuckets.size() - 1)]; pFormat != NULL; pFormat = pFormat->m_pNextInBucket)
+		{
+			if(pFormat->m_iHash == iHash && pFormat->m_sFormat.size() == iLength && memcmp(pFormat->m_sFormat.data(), szFormat, iLength) == 0)
+				break;
+		}
+	}
+
+	if(pFormat != NULL)
+		m_iHits++;
+
+	UnlockSpinLock(&m_iLock);
+
+	std::string sResult;
+
+	// The format was used before, write the arguments right away
+	if(pFormat != NULL)
+	{
+		Apply(*pFormat, ppArguments, iArgumentCount, sResult);
+		return sResult;
+	}
+
+	// Compile the format outside the lock, then keep it if there's still room
+	CCompiledFormat * pCompiledFormat = new CCompiledFormat;
+	Compile(szFormat, iLength, *pCompiledFormat);
+	Apply(*pCompiledFormat, ppArguments, iArgumentCount, sResult);
+
+	LockSpinLock(&m_iLock);
+
+	m_iCompilations++;
+
+	if(m_iFormatCount < FORMAT_CACHE_MAX_FORMATS)
+	{
+		if(m_lBuckets.empty())
+			m_lBuckets.assign(FORMAT_CACHE_BUCKETS, NULL);
+
+		// Another thread may have compiled the same format in the meantime, keeping both copies is harmless
+		size_t iBucket = iHash & (m_lBuckets.size() - 1);
+		pCompiledFormat->m_pNextInBucket = m_lBuckets[iBucket];
+		m_lBuckets[iBucket] = pCompiledFormat;
+		m_iFormatCount++;
+		pCompiledFormat = NULL;
+	}
+
+	UnlockSpinLock(&m_iLock);
+
+	// There was no room for the format
+	delete pCompiledFormat;
+
+	return sResult;
+}
+
+
+// Logs how often the format strings were parsed
+void CFormat::LogStatistics()
+{
+	CLogger::Write("* Formats: %d parsed, %d reused, %d of %d kept", (int) m_iCompilations, (int) m_iHits, (int) m_iFormatCount, FORMAT_CACHE_MAX_FORMATS);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+//==============================================================================
+//
+// File: CFormat.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CFormat class implements the format() native. A format string is parsed
+// once into a list of operations: copy a piece of text or write an argument.
+// The compiled formats are kept, so a format string that's used again (which
+// is what reports do) goes straight to writing the arguments.
+//
+// The placeholders are {} for the next argument and {N} for argument N (the
+// first one is 0), {:.P} and {N:.P} write floats with P decimals and cut off
+// strings after P characters. {{ and }} write a brace. A placeholder that
+// can't be parsed or refers to an argument that wasn't passed is copied.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CValue.h"
+
+// The most formats that are kept, formats after that are parsed every time they're used
+#define FORMAT_CACHE_MAX_FORMATS 256
+
+// What an operation of a compiled format does
+enum eFormatOperationType
+{
+	// Copies a piece of the format string
+	FORMAT_OPERATION_TEXT,
+	// Writes an argument
+	FORMAT_OPERATION_ARGUMENT
+};
+
+// One operation of a compiled format
+struct CFormatOperation
+{
+	eFormatOperationType m_eType;
+	// The piece of the format string the operation covers, for an argument this is the placeholder
+	size_t m_iStart;
+	size_t m_iLength;
+	// The argument to write and its precision (-1 if the placeholder doesn't have one)
+	int m_iArgument;
+	int m_iPrecision;
+};
+
+typedef std::vector<CFormatOperation> FormatOperationList;
+
+// A parsed format string
+struct CCompiledFormat
+{
+	// The format string, the operations point into it
+	std::string m_sFormat;
+	// The hash of the format string (see CSymbolPool::Hash())
+	unsigned int m_iHash;
+	FormatOperationList m_lOperations;
+	// The amount of characters the text operations copy, the result is at least this long
+	size_t m_iTextLength;
+	// The next format in the same bucket
+	CCompiledFormat * m_pNextInBucket;
+};
+
+class CFormat
+{
+	// The compiled formats by the hash of their string
+	// The formats are never freed, the operations of a format are used outside the lock
+	static std::vector<CCompiledFormat *> m_lBuckets;
+	static size_t m_iFormatCount;
+	// How often a format string was found, and how often it had to be parsed
+	static size_t m_iHits;
+	static size_t m_iCompilations;
+	// The lock of the formats, the analyzer folds format() calls on several threads
+	static volatile long m_iLock;
+
+	// Parses a format string into its operations
+	static void Compile(const char * szFormat, size_t iLength, CCompiledFormat & oFormat);
+	// Writes the arguments as the compiled format says
+	static void Apply(const CCompiledFormat & oFormat, const CValue * const * ppArguments, size_t iArgumentCount, std::string & sResult);
+
+public:
+	// Formats the arguments, the format string is parsed unless it was used before
+	static std::string Format(const CValue & oFormat, const CValue * const * ppArguments, size_t iArgumentCount);
+	// Logs how often the format strings were parsed
+	static void LogStatistics();
+};
\ No newline at end of file
@@ -8,26 +8,47 @@
 // Each function (native or not) for the language is represented by a CFunction
 // structure. It holds the function name, the parameter types the function expects
 // and a pointer to the function it should call (only for native functions).
+// Natives are bound with BindNative() (see CNativeBinder.h), which also gives
+// the thunk that calls them.
+// Functions can be overloaded, every overload is a CFunction of its own.
 // 
 //==============================================================================
 
 #include "CParameter.h"
-#include "CReturnValue.h"
+#include "CSymbolPool.h"
 
 #pragma once
 
+// A handle to a registered function, it stays the same for as long as the program runs
+typedef unsigned int FunctionHandle;
+
+// The handle of a function that couldn't be resolved
+#define INVALID_FUNCTION_HANDLE 0xFFFFFFFF
+
+// Any native, the thunk casts it back to its real type before calling it
+typedef void (*NativeFunction) ();
+// Reads the parameters out of the values, calls the native and turns its result into a value
+typedef CValue (*NativeThunk) (NativeFunction, const CValue *);
+
 struct CFunction
 {
-	// The function name
-	std::string m_sName;
-	// A list of parameter types the function expects
-	std::vector<eParameterTypes> m_lParameterTypes;
+	// The function name (interned, see CSymbolPool)
+	SymbolID m_iName;
+	// The parameter types the function expects, this is constant data of the binder
+	const eVariableTypes * m_pParameterTypes;
+	unsigned int m_iParameterCount;
 	// Do we have to check for types for this function?
 	bool m_bTypeSensitive;
+	// Does calling the function do more than return a value? Those calls are emitted into the program, not called while compiling
+	bool m_bEffectful;
 
-	// A pointer to the function that is supposed to be called
+	// A pointer to the function that is supposed to be called and the thunk that calls it
 	// Only for native functions
-	CReturnValue (*m_pFunctionToCall) (ParameterList);
+	NativeFunction m_pFunctionToCall;
+	NativeThunk m_pThunk;
+
+	// The next overload with the same name, INVALID_FUNCTION_HANDLE if this is the last one
+	FunctionHandle m_iNextOverload;
 };
 
 typedef std::vector<CFunction> FunctionList;
\ No newline at end of file
@@ -13,122 +13,223 @@
 
 #include "CFunctionWrapper.h"
 #include "NativeFunctions.h"
-#include "Util.h"
 
-#include <sstream>
+// The amount of slots the hash table starts with (always a power of two)
+#define FUNCTION_TABLE_INITIAL_SLOTS 64
 
-// The list of all functions for the script
+// The list of all functions for the script, a function handle is an index on this list
 FunctionList CFunctionWrapper::m_lFunctionList;
+// The open addressing hash table, each slot holds the handle of the first overload of a name plus one (0 means the slot is empty)
+std::vector<unsigned int> CFunctionWrapper::m_lSlots;
 
-// This method registers a function with the script
-void CFunctionWrapper::RegisterFunction(std::string sName, CReturnValue (*pFunctionToCall) (ParameterList), std::vector<eParameterTypes> lParameterTypes, bool bTypeSensitive)
+// Returns the slot of a name, this is either the slot holding the name or the empty slot it would go in
+size_t CFunctionWrapper::FindSlot(SymbolID iFunctionName)
 {
+	size_t iMask = m_lSlots.size() - 1;
+	size_t iSlot = HashSymbolID(iFunctionName) & iMask;
+
+	// Walk the probe sequence until we find the name or an empty slot
+	while(m_lSlots[iSlot] != 0 && m_lFunctionList[m_lSlots[iSlot] - 1].m_iName != iFunctionName)
+		iSlot = (iSlot + 1) & iMask;
+
+	return iSlot;
+}
+
+// Doubles the size of the hash table
+void CFunctionWrapper::GrowTable()
+{
+	std::vector<unsigned int> lOldSlots;
+	lOldSlots.swap(m_lSlots);
+
+	size_t iSlotCount = lOldSlots.empty() ? FUNCTION_TABLE_INITIAL_SLOTS : lOldSlots.size() * 2;
+	size_t iMask = iSlotCount - 1;
+	m_lSlots.assign(iSlotCount, 0);
+
+	// Put every name back into the bigger table, the names are distinct so we only need an empty slot
+	for(size_t i = 0; i < lOldSlots.size(); i++)
+	{
+		if(lOldSlots[i] == 0)
+			continue;
+
+		size_t iSlot = HashSymbolID(m_lFunctionList[lOldSlots[i] - 1].m_iName) & iMask;
+
+		while(m_lSlots[iSlot] != 0)
+			iSlot = (iSlot + 1) & iMask;
+
+		m_lSlots[iSlot] = lOldSlots[i];
+	}
+}
+
+// This method registers a native with the script, registering a name again adds an overload
+void CFunctionWrapper::RegisterFunction(const CNativeBinding & oBinding)
+{
+	// Keep the table at most half full, so the probe sequences stay short
+	if((m_lFunctionList.size() + 1) * 2 > m_lSlots.size())
+		GrowTable();
+
 	// Set up a CFunction object and push it back onto the function list
 	CFunction oFunction;
-	oFunction.m_sName = sName;
-	oFunction.m_lParameterTypes = lParameterTypes;
-	oFunction.m_bTypeSensitive = bTypeSensitive;
-	oFunction.m_pFunctionToCall = pFunctionToCall;
+	oFunction.m_iName = CSymbolPool::Intern(oBinding.m_szName);
+	oFunction.m_pParameterTypes = oBinding.m_pParameterTypes;
+	oFunction.m_iParameterCount = oBinding.m_iParameterCount;
+	oFunction.m_bTypeSensitive = oBinding.m_bTypeSensitive;
+	oFunction.m_bEffectful = oBinding.m_bEffectful;
+	oFunction.m_pFunctionToCall = oBinding.m_pFunction;
+	oFunction.m_pThunk = oBinding.m_pThunk;
+	oFunction.m_iNextOverload = INVALID_FUNCTION_HANDLE;
 
 	m_lFunctionList.push_back(oFunction);
+	FunctionHandle iFunction = (FunctionHandle) m_lFunctionList.size() - 1;
+
+	size_t iSlot = FindSlot(oFunction.m_iName);
+
+	// The first function with this name
+	if(m_lSlots[iSlot] == 0)
+	{
+		m_lSlots[iSlot] = iFunction + 1;
+		return;
+	}
+
+	// Add the overload to the end of the chain, so the overloads are tried in the order they were registered
+	FunctionHandle iLast = m_lSlots[iSlot] - 1;
+
+	while(m_lFunctionList[iLast].m_iNextOverload != INVALID_FUNCTION_HANDLE)
+		iLast = m_lFunctionList[iLast].m_iNextOverload;
+
+	m_lFunctionList[iLast].m_iNextOverload = iFunction;
 }
 
 // This method registers all natives for the language
 void CFunctionWrapper::RegisterNatives()
 {
-	// squareroot(float fValue);
-	std::vector<eParameterTypes> lRequiredParameterTypes;
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_FLOAT);
-	RegisterFunction("squareroot", squareroot, lRequiredParameterTypes);
-
-	// power(float fBase, float fExp);
-	lRequiredParameterTypes.clear();
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_FLOAT);
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_FLOAT);
-	RegisterFunction("power", power, lRequiredParameterTypes);
-
-	lRequiredParameterTypes.clear();
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_STRING);
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_STRING);
-	RegisterFunction("messageBox", messageBox, lRequiredParameterTypes);
-
-	lRequiredParameterTypes.clear();
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_STRING);
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_INTEGER);
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_INTEGER);
-	RegisterFunction("getSubstring", getSubstring, lRequiredParameterTypes);
-
-	lRequiredParameterTypes.clear();
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_STRING);
-	RegisterFunction("getSize", getSize, lRequiredParameterTypes);
-
-	lRequiredParameterTypes.clear();
-	lRequiredParameterTypes.push_back(PARAMETER_TYPE_STRING);
-	RegisterFunction("toString", toString, lRequiredParameterTypes);
+	// Every native of the language, the parameter types are deduced from the signatures in NativeFunctions.h
+	// The pure natives are folded while compiling, the effectful ones are emitted into the program
+	static const CNativeBinding aNatives[] =
+	{
+		// squareroot(float fValue);
+		BindNative("squareroot", squareroot),
+		// power(float fBase, float fExp);
+		BindNative("power", power),
+		// messageBox(string sText, string sCaption);
+		BindEffectfulNative("messageBox", messageBox),
+		// getSubstring(string sString, int iStart, int iLength);
+		BindNative("getSubstring", getSubstring),
+		// getSize(string sString);
+		BindNative("getSize", getSize),
+		// toString(any value);
+		BindNative("toString", toString),
+		// find(string sString, string sPart);
+		BindNative("find", find),
+		// count(string sString, string sPart);
+		BindNative("count", count),
+		// replace(string sString, string sPart, string sReplacement);
+		BindNative("replace", replace),
+		// split(string sString, string sSeparator, int iIndex);
+		BindNative("split", split),
+		// compare(string sFirst, string sSecond);
+		BindNative("compare", compare),
+		// toUpper(string sString);
+		BindNative("toUpper", toUpper),
+		// toLower(string sString);
+		BindNative("toLower", toLower),
+		// trim(string sString);
+		BindNative("trim", trim),
+		// format(string sFormat, any values...); one overload per amount of values, the casts pick the C++ overload
+		BindNative("format", (std::string (*)(CStringValue)) format),
+		BindNative("format", (std::string (*)(CStringValue, const CValue &)) format),
+		BindNative("format", (std::string (*)(CStringValue, const CValue &, const CValue &)) format),
+		BindNative("format", (std::string (*)(CStringValue, const CValue &, const CValue &, const CValue &)) format)
+	};
+
+	size_t iNativeCount = sizeof(aNatives) / sizeof(aNatives[0]);
+
+	// Make room for every native at once, so registering them doesn't grow the list or the table again
+	m_lFunctionList.reserve(m_lFunctionList.size() + iNativeCount);
+
+	while((m_lFunctionList.size() + iNativeCount) * 2 > m_lSlots.size())
+		GrowTable();
+
+	for(size_t i = 0; i < iNativeCount; i++)
+		RegisterFunction(aNatives[i]);
 }
 
 // This method returns true if a function exists, false otherwise
-bool CFunctionWrapper::FunctionExists(std::string sFunctionName)
+bool CFunctionWrapper::FunctionExists(SymbolID iFunctionName)
+{
+	return !m_lSlots.empty() && m_lSlots[FindSlot(iFunctionName)] != 0;
+}
+
+// Returns true if a function takes the parameters, bExactTypes checks the types even if the function isn't type sensitive
+bool CFunctionWrapper::AcceptsParameters(const CFunction & oFunction, const ParameterList & lParameterList, bool bExactTypes)
 {
-	// Loop through all the functions
-	for(size_t i = 0; i < m_lFunctionList.size(); i++)
+	// Are the parameter lists equally big?
+	if(oFunction.m_iParameterCount != lParameterList.size())
+		return false;
+
+	// Only check the types if we have to
+	if(!bExactTypes && !oFunction.m_bTypeSensitive)
+		return true;
+
+	for(size_t i = 0; i < lParameterList.size(); i++)
 	{
-		// Do we have a matching name?
-		if(m_lFunctionList[i].m_sName == sFunctionName)
-			return true;
+		if(oFunction.m_pParameterTypes[i] != VARIABLE_TYPE_ANY && lParameterList[i].GetType() != oFunction.m_pParameterTypes[i])
+			return false;
 	}
 
-	// Nothing found, return false
-	return false;
+	return true;
 }
 
-// This method calls an existing function with a parameter list
-CFunctionCallAttempt CFunctionWrapper::CallFunction(std::string sFunctionName, ParameterList lParameterList)
+// Picks the overload of a function that takes the parameters, and checks the parameters
+FunctionHandle CFunctionWrapper::ResolveFunction(SymbolID iFunctionName, const ParameterList & lParameterList, CError & oError)
 {
-	// The object we'll return to the script
-	CReturnValue oReturnValue;
+	// Wait, does the function exist?
+	FunctionHandle iFirst = m_lSlots.empty() ? 0 : m_lSlots[FindSlot(iFunctionName)];
 
-	// Loop through all the functions
-	for(FunctionList::iterator iterator = m_lFunctionList.begin(); iterator != m_lFunctionList.end(); iterator++)
+	if(iFirst == 0)
 	{
-		// Do we have a function name match?
-		if((*iterator).m_sName == sFunctionName)
-		{
-			// Do we have enough parameters? (are the parameter lists equally big?)
-			if((*iterator).m_lParameterTypes.size() != lParameterList.size())
-			{
-				// Setup the error message
-				std::stringstream ssErrorMessage;
-				ssErrorMessage << sFunctionName << " expects " << (*iterator).m_lParameterTypes.size() << " parameter(s), got " << lParameterList.size() << ".";
+		oError = CError(DIAGNOSTIC_UNKNOWN_FUNCTION, oError.m_iLine, CDiagnosticArgument::Symbol(iFunctionName));
+		return INVALID_FUNCTION_HANDLE;
+	}
 
-				return CFunctionCallAttempt(ssErrorMessage.str());
-			}
-			
-			// Current parameter number
-			int iCurrentParameterNumber = 1;
+	iFirst--;
 
-			// Check if every parameter has the correct type, only if the function is type sensitive
-			if((*iterator).m_bTypeSensitive)
+	// An overload whose parameter types match exactly wins, otherwise the first overload that accepts the parameters
+	for(FunctionHandle i = iFirst; i != INVALID_FUNCTION_HANDLE; i = m_lFunctionList[i].m_iNextOverload)
+	{
+		if(AcceptsParameters(m_lFunctionList[i], lParameterList, true))
+			return i;
+	}
+
+	for(FunctionHandle i = iFirst; i != INVALID_FUNCTION_HANDLE; i = m_lFunctionList[i].m_iNextOverload)
+	{
+		if(AcceptsParameters(m_lFunctionList[i], lParameterList, false))
+			return i;
+	}
+
+	const CFunction & oFunction = m_lFunctionList[iFirst];
+
+	// The function isn't overloaded, tell exactly what's wrong with the parameters
+	if(oFunction.m_iNextOverload == INVALID_FUNCTION_HANDLE)
+	{
+		// Do we have enough parameters? (are the parameter lists equally big?)
+		if(oFunction.m_iParameterCount != lParameterList.size())
+		{
+			oError = CError(DIAGNOSTIC_PARAMETER_COUNT, oError.m_iLine, CDiagnosticArgument::Symbol(iFunctionName), CDiagnosticArgument::Integer((int) oFunction.m_iParameterCount), CDiagnosticArgument::Integer((int) lParameterList.size()));
+			return INVALID_FUNCTION_HANDLE;
+		}
+
+		// Find the first parameter that has a bad type
+		for(size_t i = 0; i < lParameterList.size(); i++)
+		{
+			if(oFunction.m_pParameterTypes[i] != VARIABLE_TYPE_ANY && lParameterList[i].GetType() != oFunction.m_pParameterTypes[i])
 			{
-				for(unsigned int i = 0; i < lParameterList.size(); i++, iCurrentParameterNumber++)
-				{
-					if(lParameterList[i].m_eType != (*iterator).m_lParameterTypes[i])
-					{
-						// The types of this parameter differ
-						std::stringstream ssErrorMessage;
-						ssErrorMessage << "Parameter " << iCurrentParameterNumber << " has a bad type (expected " << GetTypeAsString((*iterator).m_lParameterTypes[i]) << ", got " << GetTypeAsString(lParameterList[i].m_eType) << ", in function call " << sFunctionName << ")";
-
-						return CFunctionCallAttempt(ssErrorMessage.str());
-					}
-				}
+				oError = CError(DIAGNOSTIC_PARAMETER_TYPE, oError.m_iLine, CDiagnosticArgument::Integer((int) i + 1), CDiagnosticArgument::ParameterType(oFunction.m_pParameterTypes[i]), CDiagnosticArgument::ParameterType(lParameterList[i].GetType()), CDiagnosticArgument::Symbol(iFunctionName));
+				return INVALID_FUNCTION_HANDLE;
 			}
-
-			// Call the actual function
-			oReturnValue = (*iterator).m_pFunctionToCall(lParameterList);
-			break;
 		}
 	}
 
-	// Return a valid CFunctionCallAttempt object
-	return CFunctionCallAttempt(oReturnValue);
+	// None of the overloads takes the parameters, the message lists their types
+	oError = CError(DIAGNOSTIC_NO_MATCHING_OVERLOAD, oError.m_iLine, CDiagnosticArgument::Symbol(iFunctionName), CDiagnosticArgument::ParameterTypes(lParameterList));
+	return INVALID_FUNCTION_HANDLE;
 }
\ No newline at end of file
@@ -13,21 +13,38 @@
 
 #pragma once
 
-#include "CFunction.h"
-#include "CFunctionCallAttempt.h"
+#include "CNativeBinder.h"
+#include "CError.h"
 
 class CFunctionWrapper
 {
-	// The list of all functions for the script
+	// The list of all functions for the script, a function handle is an index on this list
 	static FunctionList m_lFunctionList;
+	// The open addressing hash table, each slot holds the handle of the first overload of a name plus one (0 means the slot is empty)
+	static std::vector<unsigned int> m_lSlots;
+
+	// Returns the slot of a name, this is either the slot holding the name or the empty slot it would go in
+	static size_t FindSlot(SymbolID iFunctionName);
+	// Doubles the size of the hash table
+	static void GrowTable();
+	// Returns true if a function takes the parameters, bExactTypes checks the types even if the function isn't type sensitive
+	static bool AcceptsParameters(const CFunction & oFunction, const ParameterList & lParameterList, bool bExactTypes);
 
 public:
-	// This method calls an existing function with a parameter list
-	static CFunctionCallAttempt CallFunction(std::string sFunctionName, ParameterList lParameterList);
 	// This method registers all natives for the language
 	static void RegisterNatives();
+	// This method registers a native with the script, registering a name again adds an overload
+	static void RegisterFunction(const CNativeBinding & oBinding);
 	// This method returns true if a function exists, false otherwise
-	static bool FunctionExists(std::string sFunctionName);
-	// This method registers a function with the script
-	static void RegisterFunction(std::string sName, CReturnValue (*pFunctionToCall) (ParameterList), std::vector<eParameterTypes> eParameterTypes, bool bTypeSensitive = false);
+	static bool FunctionExists(SymbolID iFunctionName);
+	// Picks the overload of a function that takes the parameters, and checks the parameters
+	// Returns INVALID_FUNCTION_HANDLE and fills in the code and arguments of oError if no overload takes them
+	static FunctionHandle ResolveFunction(SymbolID iFunctionName, const ParameterList & lParameterList, CError & oError);
+	// Returns true if calling a resolved function does more than return a value, see CNativeBinder.h
+	static bool IsEffectful(FunctionHandle iFunction) { return m_lFunctionList[iFunction].m_bEffectful; }
+	// Returns the name of a resolved function
+	static SymbolID GetFunctionName(FunctionHandle iFunction) { return m_lFunctionList[iFunction].m_iName; }
+	// This method calls a resolved function, the parameters were already checked by ResolveFunction()
+	// The parameters are passed as a pointer to the first one, there are as many as the function takes
+	static CValue CallFunction(FunctionHandle iFunction, const CValue * pParameters) { const CFunction & oFunction = m_lFunctionList[iFunction]; return oFunction.m_pThunk(oFunction.m_pFunctionToCall, pParameters); }
 };
\ No newline at end of file
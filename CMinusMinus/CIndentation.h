@@ -11,10 +11,9 @@
 // 
 // { int test = 42; } { int bla = test; }
 //
-// In the above example bla shouldn't be able to access test, even though they're on
-// on the same indentation level (1 in our example). We hand each of the enclosing brackets
-// a unique ID to prevent this from being allowed. 
-// See CParser::HasCorrectIndentationLevel(CIndentation oToBeAccessed, CIndentation oToAccess);
+// Both variables are on the same indentation level (1 in our example), but the enclosing
+// brackets each get a unique ID. Which variables can be accessed from where is decided
+// by CSymbolTable, the indentation is kept on the tokens and variables for the logs.
 // 
 //==============================================================================
 
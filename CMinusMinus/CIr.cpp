@@ -0,0 +1,364 @@
+//==============================================================================
+//
+// File: CIr.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The intermediate representation between the analyzer and the compiler. The
+// analyzer lowers every statement it checks into instructions, the statements
+// are then put together into one CIrFunction in SSA form: every instruction
+// defines one value, and a value is never assigned again. Assigning a variable
+// is a copy that defines a new value, using a variable uses the value of the
+// last assignment before it. The CPassManager optimises the function, then the
+// CCompiler lowers what's left into code.
+// Scripts don't have control flow, a function is one block and the order of
+// the instructions is the order the program runs them in.
+//
+//==============================================================================
+
+#include "CIr.h"
+#include "CFunctionWrapper.h"
+#include "CLogger.h"
+#include "Util.h"
+
+// Strings up to this many characters are written in dumps, only the length of a longer string is written
+// Writing a long string would flatten its rope
+#define IR_DUMP_MAX_STRING_LENGTH 32
+
+// The names of the opcodes, generated from IR_OPCODE_LIST
+static const char * g_aIrOpcodeNames[IR_OPCODE_COUNT] =
+{
+	#define IR_OPCODE_NAME_ENTRY(eOpcode, szName) szName,
+	IR_OPCODE_LIST(IR_OPCODE_NAME_ENTRY)
+	#undef IR_OPCODE_NAME_ENTRY
+};
+
+// Returns the name of an opcode
+const char * GetIrOpcodeName(eIrOpcode eOpcode)
+{
+	if(eOpcode < 0 || eOpcode >= IR_OPCODE_COUNT)
+		return "invalid";
+
+	return g_aIrOpcodeNames[eOpcode];
+}
+
+// Negates a value, an integer wraps around instead of overflowing
+void NegateValue(CValue & oValue)
+{
+	if(oValue.GetType() == VARIABLE_TYPE_INTEGER)
+		oValue.SetInteger((int) (0u - (unsigned int) oValue.GetInteger()));
+	else
+		oValue.SetFloat(-oValue.GetFloat());
+}
+
+// Adds, subtracts or concatenates the right value to the left value, both have the same type
+void CombineValues(eIrOpcode eOpcode, CValue & oLeft, const CValue & oRight)
+{
+	switch(eOpcode)
+	{
+		// int + int, calculated through unsigned so an overflow wraps around
+		case IR_OPCODE_ADD:
+			if(oLeft.GetType() == VARIABLE_TYPE_INTEGER)
+				oLeft.SetInteger((int) ((unsigned int) oLeft.GetInteger() + (unsigned int) oRight.GetInteger()));
+			else
+				oLeft.SetFloat(oLeft.GetFloat() + oRight.GetFloat());
+			break;
+
+		case IR_OPCODE_SUBTRACT:
+			if(oLeft.GetType() == VARIABLE_TYPE_INTEGER)
+				oLeft.SetInteger((int) ((unsigned int) oLeft.GetInteger() - (unsigned int) oRight.GetInteger()));
+			else
+				oLeft.SetFloat(oLeft.GetFloat() - oRight.GetFloat());
+			break;
+
+		// A long right side is linked into the rope, not copied
+		case IR_OPCODE_CONCATENATE:
+			oLeft.Append(oRight);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Returns the opcode of left + right or left - right on values of a type
+eIrOpcode GetBinaryOpcode(bool bPlus, eVariableTypes eType)
+{
+	if(!bPlus)
+		return IR_OPCODE_SUBTRACT;
+
+	return eType == VARIABLE_TYPE_STRING ? IR_OPCODE_CONCATENATE : IR_OPCODE_ADD;
+}
+
+// Does running the instruction do more than define its value?
+bool CIrFunction::IsEffectful(const CIrInstruction & oInstruction) const
+{
+	return oInstruction.m_eOpcode == IR_OPCODE_CALL && CFunctionWrapper::IsEffectful(oInstruction.m_iFunction);
+}
+
+// Adds an instruction without operands, returns the value it defines
+IrValue CIrFunction::AddInstruction(eIrOpcode eOpcode, eVariableTypes eType, int iLine)
+{
+	CIrInstruction oInstruction;
+	oInstruction.m_eOpcode = eOpcode;
+	oInstruction.m_eType = eType;
+	oInstruction.m_iFirstOperand = (unsigned int) m_lOperands.size();
+	oInstruction.m_iOperandCount = 0;
+	oInstruction.m_iConstant = 0;
+	oInstruction.m_iLine = iLine;
+
+	m_lInstructions.push_back(oInstruction);
+	return (IrValue) m_lInstructions.size() - 1;
+}
+
+// Adds a constant
+IrValue CIrFunction::AddConstant(const CValue & oValue, int iLine)
+{
+	IrValue iValue = AddInstruction(IR_OPCODE_CONSTANT, oValue.GetType(), iLine);
+	m_lInstructions[iValue].m_iConstant = (unsigned int) m_lConstants.size();
+	m_lConstants.push_back(oValue);
+	return iValue;
+}
+
+// Adds a read of a variable, Append() replaces it by the value the variable has
+IrValue CIrFunction::AddLoad(unsigned int iVariable, eVariableTypes eType, int iLine)
+{
+	IrValue iValue = AddInstruction(IR_OPCODE_LOAD, eType, iLine);
+	m_lInstructions[iValue].m_iVariable = iVariable;
+	return iValue;
+}
+
+// Adds a copy of a value, if it's assigned to a variable the copy is the new value of the variable
+IrValue CIrFunction::AddCopy(IrValue iSource, unsigned int iVariable, int iLine)
+{
+	IrValue iValue = AddInstruction(IR_OPCODE_COPY, m_lInstructions[iSource].m_eType, iLine);
+	m_lInstructions[iValue].m_iVariable = iVariable;
+	m_lInstructions[iValue].m_iOperandCount = 1;
+	m_lOperands.push_back(iSource);
+	return iValue;
+}
+
+// Adds -operand
+IrValue CIrFunction::AddNegation(IrValue iOperand, int iLine)
+{
+	IrValue iValue = AddInstruction(IR_OPCODE_NEGATE, m_lInstructions[iOperand].m_eType, iLine);
+	m_lInstructions[iValue].m_iOperandCount = 1;
+	m_lOperands.push_back(iOperand);
+	return iValue;
+}
+
+// Adds left + right, left - right or the concatenation of two strings
+IrValue CIrFunction::AddBinary(eIrOpcode eOpcode, IrValue iLeft, IrValue iRight, int iLine)
+{
+	IrValue iValue = AddInstruction(eOpcode, m_lInstructions[iLeft].m_eType, iLine);
+	m_lInstructions[iValue].m_iOperandCount = 2;
+	m_lOperands.push_back(iLeft);
+	m_lOperands.push_back(iRight);
+	return iValue;
+}
+
+// Adds a call of a resolved function, eType is the type of what the call returns
+IrValue CIrFunction::AddCall(FunctionHandle iFunction, const IrValue * piOperands, size_t iOperandCount, eVariableTypes eType, int iLine)
+{
+	IrValue iValue = AddInstruction(IR_OPCODE_CALL, eType, iLine);
+	m_lInstructions[iValue].m_iFunction = iFunction;
+	m_lInstructions[iValue].m_iOperandCount = (unsigned int) iOperandCount;
+	m_lOperands.insert(m_lOperands.end(), piOperands, piOperands + iOperandCount);
+	return iValue;
+}
+
+// Puts a statement that was lowered on its own at the end of the function, its loads are replaced by SSA values
+void CIrFunction::Append(const CIrFunction & oStatement, std::vector<IrValue> & lVariableValues, int iLineShift)
+{
+	// The values of the statement are numbered from 0, this is what they're numbered in the function
+	std::vector<IrValue> lValues(oStatement.m_lInstructions.size());
+
+	for(size_t i = 0; i < oStatement.m_lInstructions.size(); i++)
+	{
+		const CIrInstruction & oInstruction = oStatement.m_lInstructions[i];
+		int iLine = oInstruction.m_iLine + iLineShift;
+
+		// A read of a variable is the value of the last assignment
+		// A variable that wasn't assigned yet holds the empty value of its type, the declaration set it
+		if(oInstruction.m_eOpcode == IR_OPCODE_LOAD)
+		{
+			IrValue & iVariableValue = lVariableValues[oInstruction.m_iVariable];
+
+			if(iVariableValue == IR_NO_VALUE)
+				iVariableValue = AddConstant(CValue(oInstruction.m_eType), iLine);
+
+			lValues[i] = iVariableValue;
+			continue;
+		}
+
+		if(oInstruction.m_eOpcode == IR_OPCODE_CONSTANT)
+		{
+			lValues[i] = AddConstant(oStatement.m_lConstants[oInstruction.m_iConstant], iLine);
+			continue;
+		}
+
+		// Copy the instruction, its operands are values of the statement that were numbered again already
+		CIrInstruction oCopy = oInstruction;
+		oCopy.m_iFirstOperand = (unsigned int) m_lOperands.size();
+		oCopy.m_iLine = iLine;
+
+		for(unsigned int j = 0; j < oInstruction.m_iOperandCount; j++)
+			m_lOperands.push_back(lValues[oStatement.m_lOperands[oInstruction.m_iFirstOperand + j]]);
+
+		lValues[i] = (IrValue) m_lInstructions.size();
+		m_lInstructions.push_back(oCopy);
+
+		// An assignment gives the variable a new value
+		if(oInstruction.m_eOpcode == IR_OPCODE_COPY && oInstruction.m_iVariable != IR_NO_VARIABLE)
+			lVariableValues[oInstruction.m_iVariable] = lValues[i];
+	}
+}
+
+// Turns an instruction into a constant, the uses of its value stay the same
+void CIrFunction::ReplaceByConstant(IrValue iValue, const CValue & oValue)
+{
+	CIrInstruction & oInstruction = m_lInstructions[iValue];
+	oInstruction.m_eOpcode = IR_OPCODE_CONSTANT;
+	oInstruction.m_iOperandCount = 0;
+	oInstruction.m_iConstant = (unsigned int) m_lConstants.size();
+	m_lConstants.push_back(oValue);
+}
+
+// Removes every instruction that isn't kept, the values are numbered again
+// A kept instruction can only use kept values
+void CIrFunction::RemoveInstructions(const std::vector<bool> & lKept)
+{
+	IrInstructionList lInstructions;
+	std::vector<IrValue> lOperands;
+	std::vector<CValue> lConstants;
+
+	// What the kept values are numbered now
+	std::vector<IrValue> lValues(m_lInstructions.size(), IR_NO_VALUE);
+
+	for(size_t i = 0; i < m_lInstructions.size(); i++)
+	{
+		if(!lKept[i])
+			continue;
+
+		CIrInstruction oInstruction = m_lInstructions[i];
+		unsigned int iFirstOperand = oInstruction.m_iFirstOperand;
+		oInstruction.m_iFirstOperand = (unsigned int) lOperands.size();
+
+		for(unsigned int j = 0; j < oInstruction.m_iOperandCount; j++)
+			lOperands.push_back(lValues[m_lOperands[iFirstOperand + j]]);
+
+		// The constants of removed instructions are dropped as well
+		if(oInstruction.m_eOpcode == IR_OPCODE_CONSTANT)
+		{
+			lConstants.push_back(std::move(m_lConstants[oInstruction.m_iConstant]));
+			oInstruction.m_iConstant = (unsigned int) lConstants.size() - 1;
+		}
+
+		lValues[i] = (IrValue) lInstructions.size();
+		lInstructions.push_back(oInstruction);
+	}
+
+	m_lInstructions.swap(lInstructions);
+	m_lOperands.swap(lOperands);
+	m_lConstants.swap(lConstants);
+}
+
+// Forgets every instruction
+void CIrFunction::Clear()
+{
+	m_lInstructions.clear();
+	m_lOperands.clear();
+	m_lConstants.clear();
+	m_lVariableNames.clear();
+}
+
+// Swaps the instructions of two functions
+void CIrFunction::Swap(CIrFunction & oOther)
+{
+	m_lInstructions.swap(oOther.m_lInstructions);
+	m_lOperands.swap(oOther.m_lOperands);
+	m_lConstants.swap(oOther.m_lConstants);
+	m_lVariableNames.swap(oOther.m_lVariableNames);
+}
+
+// Logs every instruction, for example: %3 = add integer %1, %2
+void CIrFunction::Dump(const char * szTitle) const
+{
+	CLogger::Write("\n* IR %s (%d instructions):", szTitle, (int) m_lInstructions.size());
+
+	char szBuffer[MAX_NUMBER_STRING_LENGTH];
+	std::string sLine;
+
+	for(size_t i = 0; i < m_lInstructions.size(); i++)
+	{
+		const CIrInstruction & oInstruction = m_lInstructions[i];
+
+		FormatInteger((int) i, szBuffer);
+		sLine = "  %";
+		sLine += szBuffer;
+		sLine += " = ";
+		sLine += GetIrOpcodeName(oInstruction.m_eOpcode);
+		sLine += " ";
+		sLine += GetTypeAsString(oInstruction.m_eType);
+
+		// A call names its function before the operands
+		if(oInstruction.m_eOpcode == IR_OPCODE_CALL)
+		{
+			sLine += " ";
+			sLine += CSymbolPool::GetString(CFunctionWrapper::GetFunctionName(oInstruction.m_iFunction));
+		}
+
+		for(unsigned int j = 0; j < oInstruction.m_iOperandCount; j++)
+		{
+			FormatInteger((int) m_lOperands[oInstruction.m_iFirstOperand + j], szBuffer);
+			sLine += j == 0 ? " %" : ", %";
+			sLine += szBuffer;
+		}
+
+		// The value of a constant
+		if(oInstruction.m_eOpcode == IR_OPCODE_CONSTANT)
+		{
+			const CValue & oValue = m_lConstants[oInstruction.m_iConstant];
+			sLine += " ";
+
+			if(oValue.GetType() == VARIABLE_TYPE_INTEGER)
+			{
+				FormatInteger(oValue.GetInteger(), szBuffer);
+				sLine += szBuffer;
+			}
+			else if(oValue.GetType() == VARIABLE_TYPE_FLOAT)
+			{
+				FormatFloat(oValue.GetFloat(), szBuffer);
+				sLine += szBuffer;
+			}
+			else if(oValue.GetLength() <= IR_DUMP_MAX_STRING_LENGTH)
+			{
+				sLine += "\"";
+				sLine.append(oValue.GetString(), oValue.GetLength());
+				sLine += "\"";
+			}
+			else
+			{
+				FormatInteger((int) oValue.GetLength(), szBuffer);
+				sLine += "(";
+				sLine += szBuffer;
+				sLine += " characters)";
+			}
+		}
+
+		// The variable a load reads or a copy assigns
+		bool bHasVariable = oInstruction.m_eOpcode == IR_OPCODE_LOAD || oInstruction.m_eOpcode == IR_OPCODE_COPY;
+
+		if(bHasVariable && oInstruction.m_iVariable != IR_NO_VARIABLE && oInstruction.m_iVariable < m_lVariableNames.size())
+		{
+			sLine += " ; ";
+			sLine += CSymbolPool::GetString(m_lVariableNames[oInstruction.m_iVariable]);
+		}
+
+		if(IsEffectful(oInstruction))
+			sLine += " ; effectful";
+
+		CLogger::WriteLine(sLine);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+//==============================================================================
+//
+// File: CIr.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The intermediate representation between the analyzer and the compiler. The
+// analyzer lowers every statement it checks into instructions, the statements
+// are then put together into one CIrFunction in SSA form: every instruction
+// defines one value, and a value is never assigned again. Assigning a variable
+// is a copy that defines a new value, using a variable uses the value of the
+// last assignment before it. The CPassManager optimises the function, then the
+// CCompiler lowers what's left into code.
+// Scripts don't have control flow, a function is one block and the order of
+// the instructions is the order the program runs them in.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CValue.h"
+#include "CFunction.h"
+#include "CSymbolPool.h"
+
+// A value of a function, it's the index of the instruction that defines it
+typedef unsigned int IrValue;
+
+// No value, and the copy of a value that isn't assigned to a variable
+#define IR_NO_VALUE 0xFFFFFFFF
+#define IR_NO_VARIABLE 0xFFFFFFFF
+
+// Every instruction, and how it's written in a dump
+#define IR_OPCODE_LIST(OPCODE) \
+	OPCODE(IR_OPCODE_CONSTANT, "const") \
+	OPCODE(IR_OPCODE_LOAD, "load") \
+	OPCODE(IR_OPCODE_COPY, "copy") \
+	OPCODE(IR_OPCODE_NEGATE, "neg") \
+	OPCODE(IR_OPCODE_ADD, "add") \
+	OPCODE(IR_OPCODE_SUBTRACT, "sub") \
+	OPCODE(IR_OPCODE_CONCATENATE, "concat") \
+	OPCODE(IR_OPCODE_CALL, "call")
+
+enum eIrOpcode
+{
+	#define IR_OPCODE_ENUM_ENTRY(eOpcode, szName) eOpcode,
+	IR_OPCODE_LIST(IR_OPCODE_ENUM_ENTRY)
+	#undef IR_OPCODE_ENUM_ENTRY
+
+	// The amount of opcodes
+	IR_OPCODE_COUNT
+};
+
+struct CIrInstruction
+{
+	eIrOpcode m_eOpcode;
+	// The type of the value the instruction defines
+	eVariableTypes m_eType;
+	// The operands are on the operand list of the function
+	unsigned int m_iFirstOperand;
+	unsigned int m_iOperandCount;
+
+	union
+	{
+		// CONSTANT: the constant on the constant list of the function
+		unsigned int m_iConstant;
+		// LOAD: the variable that's read, COPY: the variable that's assigned (IR_NO_VARIABLE if none)
+		unsigned int m_iVariable;
+		// CALL: the function that's called
+		FunctionHandle m_iFunction;
+	};
+
+	// The line of the statement the instruction was lowered from
+	int m_iLine;
+};
+
+typedef std::vector<CIrInstruction> IrInstructionList;
+
+class CIrFunction
+{
+	// The instructions in the order the program runs them, an instruction defines the value of its index
+	IrInstructionList m_lInstructions;
+	// The operands of every instruction, one after the other
+	std::vector<IrValue> m_lOperands;
+	// The values of the constants
+	std::vector<CValue> m_lConstants;
+	// The names of the variables, only used in dumps
+	std::vector<SymbolID> m_lVariableNames;
+
+	// Adds an instruction without operands, returns the value it defines
+	IrValue AddInstruction(eIrOpcode eOpcode, eVariableTypes eType, int iLine);
+
+public:
+	// The amount of instructions
+	size_t GetInstructionCount() const { return m_lInstructions.size(); }
+	bool IsEmpty() const { return m_lInstructions.empty(); }
+	// Returns the instruction that defines a value
+	const CIrInstruction & GetInstruction(IrValue iValue) const { return m_lInstructions[iValue]; }
+	// Returns and replaces an operand of an instruction
+	IrValue GetOperand(const CIrInstruction & oInstruction, size_t iOperand) const { return m_lOperands[oInstruction.m_iFirstOperand + iOperand]; }
+	void SetOperand(const CIrInstruction & oInstruction, size_t iOperand, IrValue iValue) { m_lOperands[oInstruction.m_iFirstOperand + iOperand] = iValue; }
+	// Returns the value of a CONSTANT instruction
+	const CValue & GetConstant(const CIrInstruction & oInstruction) const { return m_lConstants[oInstruction.m_iConstant]; }
+	// Does running the instruction do more than define its value? Those instructions are never removed
+	bool IsEffectful(const CIrInstruction & oInstruction) const;
+
+	// Adds an instruction, returns the value it defines
+	IrValue AddConstant(const CValue & oValue, int iLine);
+	IrValue AddLoad(unsigned int iVariable, eVariableTypes eType, int iLine);
+	IrValue AddCopy(IrValue iSource, unsigned int iVariable, int iLine);
+	IrValue AddNegation(IrValue iOperand, int iLine);
+	IrValue AddBinary(eIrOpcode eOpcode, IrValue iLeft, IrValue iRight, int iLine);
+	IrValue AddCall(FunctionHandle iFunction, const IrValue * piOperands, size_t iOperandCount, eVariableTypes eType, int iLine);
+
+	// Puts a statement that was lowered on its own at the end of the function, its loads are replaced by SSA values
+	// lVariableValues holds the current value of every variable, IR_NO_VALUE if the variable wasn't assigned yet
+	// The statement moved iLineShift lines since it was parsed (see CAnalyzer::Run)
+	void Append(const CIrFunction & oStatement, std::vector<IrValue> & lVariableValues, int iLineShift);
+	// Turns an instruction into a constant, the uses of its value stay the same
+	void ReplaceByConstant(IrValue iValue, const CValue & oValue);
+	// Removes every instruction that isn't kept, the values are numbered again
+	void RemoveInstructions(const std::vector<bool> & lKept);
+
+	// Sets the names of the variables, for dumps
+	void SetVariableNames(std::vector<SymbolID> & lVariableNames) { m_lVariableNames.swap(lVariableNames); }
+	// Forgets every instruction
+	void Clear();
+	// Swaps the instructions of two functions
+	void Swap(CIrFunction & oOther);
+	// Logs every instruction
+	void Dump(const char * szTitle) const;
+};
+
+// Returns the name of an opcode
+const char * GetIrOpcodeName(eIrOpcode eOpcode);
+
+// Negates a value, an integer wraps around instead of overflowing
+void NegateValue(CValue & oValue);
+// Adds, subtracts or concatenates the right value to the left value, both have the same type
+// Integers are calculated through unsigned, so an overflow wraps around
+void CombineValues(eIrOpcode eOpcode, CValue & oLeft, const CValue & oRight);
+// Returns the opcode of left + right or left - right on values of a type
+eIrOpcode GetBinaryOpcode(bool bPlus, eVariableTypes eType);
\ No newline at end of file
@@ -0,0 +1,355 @@
+//==============================================================================
+//
+// File: CIrPasses.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The passes that optimise a CIrFunction, the CPassManager runs them in the
+// order of its pipeline. A pass keeps the effectful calls and their order, it
+// only replaces the uses of values by equal values and removes instructions
+// nothing needs.
+// A function is one block, so the passes walk it once from the top: the value
+// that replaces an operand is always defined before the instruction using it.
+//
+//==============================================================================
+
+#include "CIrPasses.h"
+#include "CFunctionWrapper.h"
+#include "CNativeCache.h"
+
+// Finds an earlier instruction that computes the same value, an open addressing table of values
+class CExpressionTable
+{
+	const CIrFunction & m_oFunction;
+	// Each slot holds a value plus one, 0 means the slot is empty
+	// There are at least twice as many slots as instructions, so the table never fills up
+	std::vector<IrValue> m_lSlots;
+
+	// Returns the hash of what an instruction computes
+	size_t Hash(const CIrInstruction & oInstruction) const;
+	// Do two instructions compute the same value?
+	bool IsSame(const CIrInstruction & oFirst, const CIrInstruction & oSecond) const;
+
+public:
+	// The constructor of the CExpressionTable class, the table is sized for every instruction of the function
+	CExpressionTable(const CIrFunction & oFunction);
+	// Returns the first instruction that computes the same as the value, the value itself if there is none
+	IrValue FindOrAdd(IrValue iValue);
+};
+
+// The constructor of the CExpressionTable class
+CExpressionTable::CExpressionTable(const CIrFunction & oFunction): m_oFunction(oFunction)
+{
+	size_t iSlotCount = 16;
+
+	while(iSlotCount < oFunction.GetInstructionCount() * 2)
+		iSlotCount *= 2;
+
+	m_lSlots.assign(iSlotCount, 0);
+}
+
+// Returns the hash of what an instruction computes
+size_t CExpressionTable::Hash(const CIrInstruction & oInstruction) const
+{
+	size_t iHash = ((size_t) oInstruction.m_eOpcode * 31 + (size_t) oInstruction.m_eType) * 2654435769u;
+
+	if(oInstruction.m_eOpcode == IR_OPCODE_CONSTANT)
+		return iHash ^ m_oFunction.GetConstant(oInstruction).GetHash();
+
+	if(oInstruction.m_eOpcode == IR_OPCODE_CALL)
+		iHash = (iHash ^ oInstruction.m_iFunction) * 16777619u;
+
+	for(unsigned int i = 0; i < oInstruction.m_iOperandCount; i++)
+		iHash = (iHash ^ m_oFunction.GetOperand(oInstruction, i)) * 16777619u;
+
+	return iHash;
+}
+
+// Do two instructions compute the same value?
+bool CExpressionTable::IsSame(const CIrInstruction & oFirst, const CIrInstruction & oSecond) const
+{
+	if(oFirst.m_eOpcode != oSecond.m_eOpcode || oFirst.m_eType != oSecond.m_eType || oFirst.m_iOperandCount != oSecond.m_iOperandCount)
+		return false;
+
+	// Constants are the same if their values are, floats are compared bit by bit
+	if(oFirst.m_eOpcode == IR_OPCODE_CONSTANT)
+		return m_oFunction.GetConstant(oFirst).IsIdentical(m_oFunction.GetConstant(oSecond));
+
+	if(oFirst.m_eOpcode == IR_OPCODE_CALL && oFirst.m_iFunction != oSecond.m_iFunction)
+		return false;
+
+	for(unsigned int i = 0; i < oFirst.m_iOperandCount; i++)
+	{
+		if(m_oFunction.GetOperand(oFirst, i) != m_oFunction.GetOperand(oSecond, i))
+			return false;
+	}
+
+	return true;
+}
+
+// Returns the first instruction that computes the same as the value, the value itself if there is none
+IrValue CExpressionTable::FindOrAdd(IrValue iValue)
+{
+	const CIrInstruction & oInstruction = m_oFunction.GetInstruction(iValue);
+	size_t iMask = m_lSlots.size() - 1;
+
+	// Hashing a long string would flatten its rope, a long string constant is only equal to itself
+	if(oInstruction.m_eOpcode == IR_OPCODE_CONSTANT && m_oFunction.GetConstant(oInstruction).GetLength() >= VALUE_SMALL_STRING_SIZE)
+		return iValue;
+
+	for(size_t iSlot = Hash(oInstruction) & iMask; ; iSlot = (iSlot + 1) & iMask)
+	{
+		if(m_lSlots[iSlot] == 0)
+		{
+			m_lSlots[iSlot] = iValue + 1;
+			return iValue;
+		}
+
+		if(IsSame(m_oFunction.GetInstruction(m_lSlots[iSlot] - 1), oInstruction))
+			return m_lSlots[iSlot] - 1;
+	}
+}
+
+// Replaces the operands of an instruction by what lReplacements says they're equal to
+static void ReplaceOperands(CIrFunction & oFunction, const CIrInstruction & oInstruction, const std::vector<IrValue> & lReplacements)
+{
+	for(unsigned int i = 0; i < oInstruction.m_iOperandCount; i++)
+		oFunction.SetOperand(oInstruction, i, lReplacements[oFunction.GetOperand(oInstruction, i)]);
+}
+
+// Is the value defined by a constant?
+static bool IsConstant(const CIrFunction & oFunction, IrValue iValue)
+{
+	return oFunction.GetInstruction(iValue).m_eOpcode == IR_OPCODE_CONSTANT;
+}
+
+// Is the value the integer 0, or the empty string?
+static bool IsEmptyConstant(const CIrFunction & oFunction, IrValue iValue)
+{
+	const CIrInstruction & oInstruction = oFunction.GetInstruction(iValue);
+
+	if(oInstruction.m_eOpcode != IR_OPCODE_CONSTANT)
+		return false;
+
+	const CValue & oValue = oFunction.GetConstant(oInstruction);
+	return oValue.GetType() == VARIABLE_TYPE_STRING ? oValue.GetLength() == 0 : (oValue.GetType() == VARIABLE_TYPE_INTEGER && oValue.GetInteger() == 0);
+}
+
+// Calculates an instruction whose operands are all constants, returns false if it can't be calculated while compiling
+static bool FoldInstruction(CIrFunction & oFunction, IrValue iValue)
+{
+	const CIrInstruction & oInstruction = oFunction.GetInstruction(iValue);
+
+	for(unsigned int i = 0; i < oInstruction.m_iOperandCount; i++)
+	{
+		if(!IsConstant(oFunction, oFunction.GetOperand(oInstruction, i)))
+			return false;
+	}
+
+	CValue oValue;
+
+	switch(oInstruction.m_eOpcode)
+	{
+		case IR_OPCODE_NEGATE:
+			oValue = oFunction.GetConstant(oFunction.GetInstruction(oFunction.GetOperand(oInstruction, 0)));
+			NegateValue(oValue);
+			break;
+
+		case IR_OPCODE_ADD:
+		case IR_OPCODE_SUBTRACT:
+		case IR_OPCODE_CONCATENATE:
+			oValue = oFunction.GetConstant(oFunction.GetInstruction(oFunction.GetOperand(oInstruction, 0)));
+			CombineValues(oInstruction.m_eOpcode, oValue, oFunction.GetConstant(oFunction.GetInstruction(oFunction.GetOperand(oInstruction, 1))));
+			break;
+
+		// A pure function is called now, the cache probably has the result from when the analyzer folded the call
+		// The analyzer already counted the call, so the cache is only peeked at and a result that was pushed out isn't added again
+		case IR_OPCODE_CALL:
+		{
+			if(oFunction.IsEffectful(oInstruction))
+				return false;
+
+			ParameterList lParameterList;
+			lParameterList.reserve(oInstruction.m_iOperandCount);
+
+			for(unsigned int i = 0; i < oInstruction.m_iOperandCount; i++)
+				lParameterList.push_back(oFunction.GetConstant(oFunction.GetInstruction(oFunction.GetOperand(oInstruction, i))));
+
+			if(!CNativeCache::Peek(oInstruction.m_iFunction, lParameterList, oValue))
+				oValue = CFunctionWrapper::CallFunction(oInstruction.m_iFunction, lParameterList.empty() ? NULL : &lParameterList[0]);
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	oFunction.ReplaceByConstant(iValue, oValue);
+	return true;
+}
+
+// Returns the value an instruction always equals because of an identity, IR_NO_VALUE if there is none
+// x - x becomes the constant 0 instead
+static IrValue SimplifyInstruction(CIrFunction & oFunction, IrValue iValue)
+{
+	const CIrInstruction & oInstruction = oFunction.GetInstruction(iValue);
+
+	switch(oInstruction.m_eOpcode)
+	{
+		// - -x is x, for floats as well
+		case IR_OPCODE_NEGATE:
+		{
+			const CIrInstruction & oOperand = oFunction.GetInstruction(oFunction.GetOperand(oInstruction, 0));
+
+			if(oOperand.m_eOpcode == IR_OPCODE_NEGATE)
+				return oFunction.GetOperand(oOperand, 0);
+
+			return IR_NO_VALUE;
+		}
+
+		// x + 0 and 0 + x are x, "" + x and x + "" are x
+		// Not for floats, -0.0 + 0.0 is 0.0
+		case IR_OPCODE_ADD:
+		case IR_OPCODE_CONCATENATE:
+		{
+			if(oInstruction.m_eType == VARIABLE_TYPE_FLOAT)
+				return IR_NO_VALUE;
+
+			if(IsEmptyConstant(oFunction, oFunction.GetOperand(oInstruction, 1)))
+				return oFunction.GetOperand(oInstruction, 0);
+
+			if(IsEmptyConstant(oFunction, oFunction.GetOperand(oInstruction, 0)))
+				return oFunction.GetOperand(oInstruction, 1);
+
+			return IR_NO_VALUE;
+		}
+
+		// x - 0 is x, x - x is 0 (integers only, inf - inf isn't 0)
+		case IR_OPCODE_SUBTRACT:
+		{
+			if(oInstruction.m_eType != VARIABLE_TYPE_INTEGER)
+				return IR_NO_VALUE;
+
+			if(IsEmptyConstant(oFunction, oFunction.GetOperand(oInstruction, 1)))
+				return oFunction.GetOperand(oInstruction, 0);
+
+			if(oFunction.GetOperand(oInstruction, 0) == oFunction.GetOperand(oInstruction, 1))
+				oFunction.ReplaceByConstant(iValue, CValue(0));
+
+			return IR_NO_VALUE;
+		}
+
+		default:
+			return IR_NO_VALUE;
+	}
+}
+
+// Replaces the uses of a copy by the value that was copied
+void RunCopyPropagation(CIrFunction & oFunction)
+{
+	std::vector<IrValue> lReplacements(oFunction.GetInstructionCount());
+
+	for(IrValue i = 0; i < lReplacements.size(); i++)
+	{
+		const CIrInstruction & oInstruction = oFunction.GetInstruction(i);
+		ReplaceOperands(oFunction, oInstruction, lReplacements);
+
+		// The operand was replaced already, so a copy of a copy goes to the first value right away
+		lReplacements[i] = oInstruction.m_eOpcode == IR_OPCODE_COPY ? oFunction.GetOperand(oInstruction, 0) : i;
+	}
+}
+
+// Replaces the uses of an instruction by an earlier instruction that has the same opcode and operands
+void RunCommonSubexpressionElimination(CIrFunction & oFunction)
+{
+	std::vector<IrValue> lReplacements(oFunction.GetInstructionCount());
+	CExpressionTable oTable(oFunction);
+
+	for(IrValue i = 0; i < lReplacements.size(); i++)
+	{
+		const CIrInstruction & oInstruction = oFunction.GetInstruction(i);
+		ReplaceOperands(oFunction, oInstruction, lReplacements);
+
+		// Every effectful call has to be made, even if it's made with the same parameters before
+		lReplacements[i] = oFunction.IsEffectful(oInstruction) ? i : oTable.FindOrAdd(i);
+	}
+}
+
+// Gives every value a number, values that are always equal get the same number
+// The number of a value is the first value that's equal to it, the uses are replaced by that value
+void RunGlobalValueNumbering(CIrFunction & oFunction)
+{
+	std::vector<IrValue> lNumbers(oFunction.GetInstructionCount());
+	CExpressionTable oTable(oFunction);
+
+	for(IrValue i = 0; i < lNumbers.size(); i++)
+	{
+		const CIrInstruction & oInstruction = oFunction.GetInstruction(i);
+		ReplaceOperands(oFunction, oInstruction, lNumbers);
+
+		// A copy is the value it copies
+		if(oInstruction.m_eOpcode == IR_OPCODE_COPY)
+		{
+			lNumbers[i] = oFunction.GetOperand(oInstruction, 0);
+			continue;
+		}
+
+		if(oFunction.IsEffectful(oInstruction))
+		{
+			lNumbers[i] = i;
+			continue;
+		}
+
+		// Calculate the instruction if its operands are constants, otherwise look for an identity
+		if(!FoldInstruction(oFunction, i))
+		{
+			IrValue iSame = SimplifyInstruction(oFunction, i);
+
+			if(iSame != IR_NO_VALUE)
+			{
+				lNumbers[i] = iSame;
+				continue;
+			}
+		}
+
+		// Integer addition doesn't care about the order of its operands, sort them so a + b and b + a are found as one
+		// Floats keep their order, the payload of a NaN depends on it
+		if(oInstruction.m_eOpcode == IR_OPCODE_ADD && oInstruction.m_eType == VARIABLE_TYPE_INTEGER)
+		{
+			IrValue iLeft = oFunction.GetOperand(oInstruction, 0);
+			IrValue iRight = oFunction.GetOperand(oInstruction, 1);
+
+			if(iLeft > iRight)
+			{
+				oFunction.SetOperand(oInstruction, 0, iRight);
+				oFunction.SetOperand(oInstruction, 1, iLeft);
+			}
+		}
+
+		lNumbers[i] = oTable.FindOrAdd(i);
+	}
+}
+
+// Removes every instruction the effectful calls don't need
+void RunDeadCodeElimination(CIrFunction & oFunction)
+{
+	std::vector<bool> lLive(oFunction.GetInstructionCount(), false);
+
+	// Walk up from the last instruction, the uses of a value are all below it
+	for(size_t i = lLive.size(); i-- > 0; )
+	{
+		const CIrInstruction & oInstruction = oFunction.GetInstruction((IrValue) i);
+
+		if(oFunction.IsEffectful(oInstruction))
+			lLive[i] = true;
+
+		if(!lLive[i])
+			continue;
+
+		for(unsigned int j = 0; j < oInstruction.m_iOperandCount; j++)
+			lLive[oFunction.GetOperand(oInstruction, j)] = true;
+	}
+
+	oFunction.RemoveInstructions(lLive);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+//==============================================================================
+//
+// File: CIrPasses.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The passes that optimise a CIrFunction, the CPassManager runs them in the
+// order of its pipeline. A pass keeps the effectful calls and their order, it
+// only replaces the uses of values by equal values and removes instructions
+// nothing needs.
+//
+//==============================================================================
+
+#pragma once
+
+#include "CIr.h"
+
+// Copy propagation: replaces the uses of a copy by the value that was copied
+void RunCopyPropagation(CIrFunction & oFunction);
+// Common subexpression elimination: replaces the uses of an instruction by an earlier instruction that has the same opcode and operands
+void RunCommonSubexpressionElimination(CIrFunction & oFunction);
+// Global value numbering: gives every value a number, values that are always equal get the same number
+// Copies, operations on constants, calls of pure functions on constants and a few identities (x + 0, x - x, - -x) are numbered as well
+void RunGlobalValueNumbering(CIrFunction & oFunction);
+// Dead code elimination: removes every instruction the effectful calls don't need
+void RunDeadCodeElimination(CIrFunction & oFunction);
\ No newline at end of file
@@ -0,0 +1,202 @@
+//==============================================================================
+//
+// File: CLexer.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CLexer class finds the tokens in a range of the source, one token at a time.
+// It only finds where the tokens are, the CTokenizer decides what they are. The
+// range can start inside a string literal or a multi line comment, this is used
+// by the parallel tokenizer which lexes the source in chunks.
+//
+//==============================================================================
+
+#include "CLexer.h"
+#include "Scanning.h"
+
+// The constructor of the CLexer class, the lexer has nothing to lex until Start() is called
+CLexer::CLexer()
+{
+	m_pSource = NULL;
+	m_pCurrent = NULL;
+	m_pEnd = NULL;
+	m_iLineNumber = 1;
+	m_iIndentationLevel = 0;
+	m_iIndentationLevelID = 0;
+	m_eState = LEXER_STATE_NORMAL;
+	m_iLiteralStart = 0;
+}
+
+// Starts lexing the range [iBegin, iEnd) of the source, in the normal state, on level 0
+void CLexer::Start(const char * pSource, size_t iBegin, size_t iEnd, int iFirstLine)
+{
+	m_pSource = pSource;
+	m_pCurrent = pSource + iBegin;
+	m_pEnd = pSource + iEnd;
+	m_iLineNumber = iFirstLine;
+	m_iIndentationLevel = 0;
+	m_iIndentationLevelID = 0;
+	m_eState = LEXER_STATE_NORMAL;
+	m_iLiteralStart = 0;
+}
+
+// Lets the range start inside a string literal (which started at iLiteralStart) or a comment
+void CLexer::SetState(eLexerState eState, size_t iLiteralStart)
+{
+	m_eState = eState;
+	m_iLiteralStart = iLiteralStart;
+}
+
+// Finds the next token, returns false if the end of the range was reached
+bool CLexer::Next(CLexedToken & oToken)
+{
+	const char * pCurrent = m_pCurrent;
+	const char * pEnd = m_pEnd;
+
+	while(true)
+	{
+		// We're inside a string literal, it runs until the next double quote
+		if(m_eState == LEXER_STATE_STRING_LITERAL)
+		{
+			int iNewLines = 0;
+			const char * pLiteralEnd = FindCharacter(pCurrent, pEnd, '"', iNewLines);
+			m_iLineNumber += iNewLines;
+
+			// A string literal that isn't closed before the end of the range isn't returned
+			if(pLiteralEnd == pEnd)
+			{
+				m_pCurrent = pEnd;
+				return false;
+			}
+
+			oToken.m_bStringLiteral = true;
+			oToken.m_iOffset = m_iLiteralStart;
+			oToken.m_iLength = (pLiteralEnd - m_pSource) - m_iLiteralStart;
+			oToken.m_iLine = m_iLineNumber;
+			oToken.m_oIndentation = CIndentation(m_iIndentationLevel, m_iIndentationLevelID);
+
+			// Skip the closing double quote
+			m_eState = LEXER_STATE_NORMAL;
+			m_pCurrent = pLiteralEnd + 1;
+			return true;
+		}
+
+		// We're inside a multi line comment, skip the rest of it
+		if(m_eState == LEXER_STATE_COMMENT)
+		{
+			int iNewLines = 0;
+			const char * pCommentStart = pCurrent;
+			pCurrent = SkipMultiLineComment(pCurrent, pEnd, iNewLines);
+			m_iLineNumber += iNewLines;
+
+			// The comment is closed if it ends with */
+			if(pCurrent - pCommentStart >= 2 && pCurrent[-2] == '*' && pCurrent[-1] == '/')
+				m_eState = LEXER_STATE_NORMAL;
+		}
+
+		if(pCurrent >= pEnd)
+		{
+			m_pCurrent = pEnd;
+			return false;
+		}
+
+		// Every character is classified through the character class table (see Scanning.h)
+		switch(GetCharacterClass(*pCurrent))
+		{
+			// The character is part of a variable name, function name or value
+			case CHARACTER_CLASS_VALUE:
+			{
+				// Find where the value ends
+				const char * pValueEnd = SkipValue(pCurrent, pEnd);
+
+				oToken.m_bStringLiteral = false;
+				oToken.m_iOffset = pCurrent - m_pSource;
+				oToken.m_iLength = pValueEnd - pCurrent;
+				oToken.m_iLine = m_iLineNumber;
+				oToken.m_oIndentation = CIndentation(m_iIndentationLevel, m_iIndentationLevelID);
+
+				m_pCurrent = pValueEnd;
+				return true;
+			}
+
+			// Spaces, tabs and newlines only separate tokens, skip all of them at once
+			case CHARACTER_CLASS_WHITESPACE:
+			{
+				int iNewLines = 0;
+				pCurrent = SkipWhitespace(pCurrent, pEnd, iNewLines);
+				m_iLineNumber += iNewLines;
+				break;
+			}
+
+			// If we found a double quote, we're entering a string literal
+			case CHARACTER_CLASS_DOUBLE_QUOTE:
+			{
+				// The literal starts right after the double quote
+				pCurrent++;
+				m_eState = LEXER_STATE_STRING_LITERAL;
+				m_iLiteralStart = pCurrent - m_pSource;
+				break;
+			}
+
+			// A slash either starts a comment or is part of a value
+			case CHARACTER_CLASS_SLASH:
+			{
+				// This is a single line comment, skip the rest of the line (the newline itself is handled as whitespace)
+				if(pEnd - pCurrent >= 2 && pCurrent[1] == '/')
+				{
+					int iNewLines = 0;
+					pCurrent = FindCharacter(pCurrent + 2, pEnd, '\n', iNewLines);
+					break;
+				}
+
+				// Start of multi-line comment (/* example of multi line comment */)
+				if(pEnd - pCurrent >= 2 && pCurrent[1] == '*')
+				{
+					pCurrent += 2;
+					m_eState = LEXER_STATE_COMMENT;
+					break;
+				}
+
+				// It's part of a value, for example 'a/b'
+				const char * pValueEnd = SkipValue(pCurrent + 1, pEnd);
+
+				oToken.m_bStringLiteral = false;
+				oToken.m_iOffset = pCurrent - m_pSource;
+				oToken.m_iLength = pValueEnd - pCurrent;
+				oToken.m_iLine = m_iLineNumber;
+				oToken.m_oIndentation = CIndentation(m_iIndentationLevel, m_iIndentationLevelID);
+
+				m_pCurrent = pValueEnd;
+				return true;
+			}
+
+			// A single character token
+			case CHARACTER_CLASS_PUNCTUATOR:
+			{
+				if(*pCurrent == '{')
+				{
+					// We found a {, increase the indentation level and the unique indentation id
+					m_iIndentationLevel++;
+					m_iIndentationLevelID++;
+				}
+
+				if(*pCurrent == '}')
+				{
+					// We found a }, decrease the indentation level, keep increasing the unique id
+					m_iIndentationLevel--;
+					m_iIndentationLevelID++;
+				}
+
+				oToken.m_bStringLiteral = false;
+				oToken.m_iOffset = pCurrent - m_pSource;
+				oToken.m_iLength = 1;
+				oToken.m_iLine = m_iLineNumber;
+				oToken.m_oIndentation = CIndentation(m_iIndentationLevel, m_iIndentationLevelID);
+
+				m_pCurrent = pCurrent + 1;
+				return true;
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+//==============================================================================
+//
+// File: CLexer.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CLexer class finds the tokens in a range of the source, one token at a time.
+// It only finds where the tokens are, the CTokenizer decides what they are. The
+// range can start inside a string literal or a multi line comment, this is used
+// by the parallel tokenizer which lexes the source in chunks.
+//
+//==============================================================================
+
+#pragma once
+
+#include "CIndentation.h"
+#include <cstddef>
+
+// The state the lexer is in between two tokens
+enum eLexerState
+{
+	// In between tokens
+	LEXER_STATE_NORMAL,
+	// Inside a string literal that hasn't been closed yet
+	LEXER_STATE_STRING_LITERAL,
+	// Inside a multi line comment that hasn't been closed yet
+	LEXER_STATE_COMMENT
+};
+
+// A token the lexer found
+struct CLexedToken
+{
+	// Is this a string literal? Otherwise it's a keyword, punctuator or value
+	bool m_bStringLiteral;
+	// Where the value of the token can be found in the source, and how long it is
+	size_t m_iOffset;
+	size_t m_iLength;
+	// The line the token was found on
+	int m_iLine;
+	// The indentation level the token is on
+	CIndentation m_oIndentation;
+
+	CLexedToken::CLexedToken(): m_bStringLiteral(false), m_iOffset(0), m_iLength(0), m_iLine(0), m_oIndentation(INVALID_INDENTATION_LEVEL, INVALID_INDENTATION_ID) { }
+};
+
+class CLexer
+{
+	// The first byte of the source, token offsets are relative to this
+	const char * m_pSource;
+	// Where the lexer is in the source, and where the range it lexes ends
+	const char * m_pCurrent;
+	const char * m_pEnd;
+	// The current source line number
+	int m_iLineNumber;
+
+	// This variable holds the indentation level the current variable is on
+	// Example of a variable on level 0:
+	// int test;
+	// Example of a variable on level 1:
+	// { int test; }
+	int m_iIndentationLevel;
+
+	// Holds the indentation level ID the variable is on.
+	// Two variables can be on the same levels but not in the same enclosing brackets
+	// Example: { int test = 42; } { int bla = test; }, bla shouldn't be able to access test
+	// Therefore this variable contains a unique ID for each indentation level
+	int m_iIndentationLevelID;
+
+	// Is the lexer inside a string literal or comment?
+	eLexerState m_eState;
+	// Where the string literal the lexer is in started
+	size_t m_iLiteralStart;
+
+public:
+	// The constructor of the CLexer class, the lexer has nothing to lex until Start() is called
+	CLexer();
+	// Starts lexing the range [iBegin, iEnd) of the source, in the normal state, on level 0
+	// The first line of the range is iFirstLine
+	void Start(const char * pSource, size_t iBegin, size_t iEnd, int iFirstLine);
+	// Lets the range start inside a string literal (which started at iLiteralStart) or a comment
+	void SetState(eLexerState eState, size_t iLiteralStart);
+	// Finds the next token, returns false if the end of the range was reached
+	bool Next(CLexedToken & oToken);
+
+	// The state the lexer is in, at the end of the range this tells if a literal or comment wasn't closed
+	eLexerState GetState() const { return m_eState; }
+	// Where the unclosed string literal started
+	size_t GetLiteralStart() const { return m_iLiteralStart; }
+	// The current line number, indentation level and indentation level ID
+	int GetLineNumber() const { return m_iLineNumber; }
+	int GetIndentationLevel() const { return m_iIndentationLevel; }
+	int GetIndentationLevelID() const { return m_iIndentationLevelID; }
+};
\ No newline at end of file
@@ -24,4 +24,10 @@ void CLogger::Write(const char * szFormat, ...)
 
 	// Print the arguments to the console
 	std::cout << szBuffer << std::endl;
+}
+
+void CLogger::WriteLine(const std::string & sText)
+{
+	// Print the string to the console
+	std::cout << sText << std::endl;
 }
\ No newline at end of file
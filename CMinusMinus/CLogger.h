@@ -15,10 +15,13 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 
 class CLogger
 {
 	public:
 	// Writes a formatted string to the outputstream
 	static void Write(const char * szFormat, ...);
+	// Writes a string as it is, unlike Write() the string can be of any length
+	static void WriteLine(const std::string & sText);
 };
\ No newline at end of file
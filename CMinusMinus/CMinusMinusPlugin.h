@@ -0,0 +1,117 @@
+//==============================================================================
+//
+// File: CMinusMinusPlugin.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The C interface between the compiler and native plugins. A plugin is a DLL
+// that exports RegisterPlugin(), which returns the table of its functions: the
+// name, the parameter types and a pointer to every function. The compiler
+// loads the plugins named with -plugin and registers their functions next to
+// the built-in natives. This header is plain C and only holds fixed-size
+// types, so a plugin doesn't have to be built with the compiler's toolset.
+// Existing fields never change: a change that breaks plugins bumps
+// PLUGIN_ABI_VERSION, and the compiler refuses plugins built against another one.
+//
+// Plugin functions are called while the script is compiled, like the pure
+// built-in natives, and their results are cached. They have to return the
+// same result for the same parameters and can't have side effects.
+//
+// A plugin looks like this:
+//
+//     static void PLUGIN_CALL Twice(const CPluginValue * pParameters, CPluginValue * pResult)
+//     {
+//         pResult->m_eType = PLUGIN_TYPE_INTEGER;
+//         pResult->m_iInteger = pParameters[0].m_iInteger * 2;
+//     }
+//
+//     static const CPluginFunction g_aFunctions[] =
+//     {
+//         { "twice", Twice, 1, { PLUGIN_TYPE_INTEGER }, PLUGIN_FUNCTION_TYPE_SENSITIVE }
+//     };
+//
+//     static const CPluginRegistration g_oRegistration = { PLUGIN_ABI_VERSION, 1, g_aFunctions };
+//
+//     PLUGIN_EXPORT const CPluginRegistration * PLUGIN_CALL RegisterPlugin(unsigned int iHostAbiVersion)
+//     {
+//         return &g_oRegistration;
+//     }
+//
+//==============================================================================
+
+#pragma once
+
+// The version of this interface, the compiler only loads plugins that were built against the same version
+#define PLUGIN_ABI_VERSION 1
+
+// The most parameters a plugin function takes
+#define PLUGIN_MAX_PARAMETERS 4
+
+// The name of the function every plugin exports
+#define PLUGIN_REGISTER_FUNCTION_NAME "RegisterPlugin"
+
+// Every function of the interface uses the C calling convention
+#define PLUGIN_CALL __cdecl
+
+#ifdef __cplusplus
+#define PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT __declspec(dllexport)
+#endif
+
+// The types of parameters and results
+#define PLUGIN_TYPE_INTEGER 0
+#define PLUGIN_TYPE_FLOAT 1
+#define PLUGIN_TYPE_STRING 2
+
+// The flags of a plugin function
+// The parameters have to have exactly the types of the function, otherwise the compiler only checks their amount
+#define PLUGIN_FUNCTION_TYPE_SENSITIVE 1
+
+// A parameter or a result, only the field of its type is used
+typedef struct CPluginValue
+{
+	// One of the PLUGIN_TYPE_ values
+	int m_eType;
+	int m_iInteger;
+	double m_fFloat;
+	// A string parameter is null terminated and lives until the function returns
+	// A string result is copied as soon as the function returns, it may point to a buffer of the plugin that's
+	// reused on the next call from the same thread (the compiler calls the functions on several threads)
+	const char * m_szString;
+	// The length of the string without the null terminator, a string result should set it (it's 0 when the function is called)
+	// A string result that leaves it 0 is read up to its null terminator, so an empty result is NULL or ""
+	unsigned int m_iLength;
+} CPluginValue;
+
+// Calls the function, pParameters holds as many values as the function has parameters
+// pResult is an integer 0 when the function is called, the function sets its type and value
+typedef void (PLUGIN_CALL * PluginFunction) (const CPluginValue * pParameters, CPluginValue * pResult);
+
+// A function of a plugin
+typedef struct CPluginFunction
+{
+	// The name the script calls the function by, a name that's already taken adds an overload
+	const char * m_szName;
+	PluginFunction m_pFunction;
+	// The amount of parameters and their types (PLUGIN_TYPE_ values)
+	unsigned int m_iParameterCount;
+	int m_aParameterTypes[PLUGIN_MAX_PARAMETERS];
+	// PLUGIN_FUNCTION_ flags
+	unsigned int m_iFlags;
+} CPluginFunction;
+
+// What RegisterPlugin() returns, this has to stay valid as long as the plugin is loaded
+typedef struct CPluginRegistration
+{
+	// The PLUGIN_ABI_VERSION the plugin was built against
+	unsigned int m_iAbiVersion;
+	// The functions of the plugin
+	unsigned int m_iFunctionCount;
+	const CPluginFunction * m_pFunctions;
+} CPluginRegistration;
+
+// The function every plugin exports, iHostAbiVersion is the PLUGIN_ABI_VERSION of the compiler
+// Returning NULL tells the compiler the plugin can't be loaded
+typedef const CPluginRegistration * (PLUGIN_CALL * PluginRegisterFunction) (unsigned int iHostAbiVersion);
\ No newline at end of file
@@ -0,0 +1,237 @@
+//==============================================================================
+//
+// File: CNativeBinder.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The native binder turns a plain C++ function into a native of the script.
+// BindNative() deduces the parameter types of the script from the signature of
+// the function, and generates a thunk that reads the parameters out of the
+// values and turns the result into a value. A native is written as
+// double power(double, double) and bound with BindNative("power", power).
+// A native is either pure or effectful. Pure natives only compute their
+// result, so the analyzer calls them while compiling and folds the call into
+// its value. Effectful natives are never called while compiling, their calls
+// are emitted into the program and the native lowers itself into code then.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include "CFunction.h"
+
+// The most parameters a bound native can take, there's an overload of BindNative() for every count
+#define NATIVE_MAX_PARAMETERS 4
+
+// Everything the CFunctionWrapper needs to register a native
+struct CNativeBinding
+{
+	// The name the script calls the native by
+	const char * m_szName;
+	// The native, and the thunk that knows its real type
+	NativeFunction m_pFunction;
+	NativeThunk m_pThunk;
+	// The parameter types the native expects, deduced from its signature
+	const eVariableTypes * m_pParameterTypes;
+	unsigned int m_iParameterCount;
+	// Do we have to check for types for this native?
+	bool m_bTypeSensitive;
+	// Is the native effectful? Its calls are emitted into the program instead of folded
+	bool m_bEffectful;
+};
+
+// How a C++ type is passed to and returned from a native, only these types can be used in a signature
+template <typename T> struct CNativeType;
+
+// An integer
+template <> struct CNativeType<int>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_INTEGER;
+	static int FromValue(const CValue & oValue) { return oValue.GetInteger(); }
+	static CValue ToValue(int iValue) { return CValue(iValue); }
+};
+
+// A float
+template <> struct CNativeType<double>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_FLOAT;
+	static double FromValue(const CValue & oValue) { return oValue.GetFloat(); }
+	static CValue ToValue(double fValue) { return CValue(fValue); }
+};
+
+// A string that's only read, it points into the value so nothing is copied
+template <> struct CNativeType<const char *>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_STRING;
+	static const char * FromValue(const CValue & oValue) { return oValue.GetString(); }
+};
+
+// A string the native works on, it's copied out of the value
+template <> struct CNativeType<std::string>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_STRING;
+	static std::string FromValue(const CValue & oValue) { return std::string(oValue.GetString(), oValue.GetLength()); }
+	static CValue ToValue(const std::string & sValue) { return CValue(sValue); }
+};
+
+// A string the native only reads, it points to the value so nothing is copied and the native knows its length
+struct CStringValue
+{
+	explicit CStringValue(const CValue & oValue): m_pValue(&oValue) { }
+	const CValue & operator*() const { return *m_pValue; }
+	const CValue * operator->() const { return m_pValue; }
+	const CValue * m_pValue;
+};
+
+template <> struct CNativeType<CStringValue>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_STRING;
+	static CStringValue FromValue(const CValue & oValue) { return CStringValue(oValue); }
+};
+
+// The value itself, for natives that take a value of any type, its type isn't checked
+template <> struct CNativeType<CValue>
+{
+	static const eVariableTypes TYPE = VARIABLE_TYPE_ANY;
+	static const CValue & FromValue(const CValue & oValue) { return oValue; }
+	static CValue ToValue(const CValue & oValue) { return oValue; }
+};
+
+// A const reference is passed like the type itself
+template <typename T> struct CNativeType<const T &> : CNativeType<T> { };
+
+// The parameter types of a signature, they're constant data so registering a native allocates nothing
+template <typename A1> struct CNativeSignature1 { static const eVariableTypes m_aTypes[1]; };
+template <typename A1, typename A2> struct CNativeSignature2 { static const eVariableTypes m_aTypes[2]; };
+template <typename A1, typename A2, typename A3> struct CNativeSignature3 { static const eVariableTypes m_aTypes[3]; };
+template <typename A1, typename A2, typename A3, typename A4> struct CNativeSignature4 { static const eVariableTypes m_aTypes[4]; };
+
+template <typename A1> const eVariableTypes CNativeSignature1<A1>::m_aTypes[1] = { CNativeType<A1>::TYPE };
+template <typename A1, typename A2> const eVariableTypes CNativeSignature2<A1, A2>::m_aTypes[2] = { CNativeType<A1>::TYPE, CNativeType<A2>::TYPE };
+template <typename A1, typename A2, typename A3> const eVariableTypes CNativeSignature3<A1, A2, A3>::m_aTypes[3] = { CNativeType<A1>::TYPE, CNativeType<A2>::TYPE, CNativeType<A3>::TYPE };
+template <typename A1, typename A2, typename A3, typename A4> const eVariableTypes CNativeSignature4<A1, A2, A3, A4>::m_aTypes[4] = { CNativeType<A1>::TYPE, CNativeType<A2>::TYPE, CNativeType<A3>::TYPE, CNativeType<A4>::TYPE };
+
+// The thunks, one for every parameter count
+// The parameters were checked when the call was resolved, so there are exactly as many as the native takes
+template <typename R> struct CNativeCall0
+{
+	typedef R (*Function)();
+	static CValue Call(NativeFunction pFunction, const CValue *) { return CNativeType<R>::ToValue(((Function) pFunction)()); }
+};
+
+template <typename R, typename A1> struct CNativeCall1
+{
+	typedef R (*Function)(A1);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { return CNativeType<R>::ToValue(((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]))); }
+};
+
+template <typename R, typename A1, typename A2> struct CNativeCall2
+{
+	typedef R (*Function)(A1, A2);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { return CNativeType<R>::ToValue(((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1]))); }
+};
+
+template <typename R, typename A1, typename A2, typename A3> struct CNativeCall3
+{
+	typedef R (*Function)(A1, A2, A3);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { return CNativeType<R>::ToValue(((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1]), CNativeType<A3>::FromValue(pParameters[2]))); }
+};
+
+template <typename R, typename A1, typename A2, typename A3, typename A4> struct CNativeCall4
+{
+	typedef R (*Function)(A1, A2, A3, A4);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { return CNativeType<R>::ToValue(((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1]), CNativeType<A3>::FromValue(pParameters[2]), CNativeType<A4>::FromValue(pParameters[3]))); }
+};
+
+// A native that returns nothing returns the integer 0 to the script
+template <> struct CNativeCall0<void>
+{
+	typedef void (*Function)();
+	static CValue Call(NativeFunction pFunction, const CValue *) { ((Function) pFunction)(); return CValue(); }
+};
+
+template <typename A1> struct CNativeCall1<void, A1>
+{
+	typedef void (*Function)(A1);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { ((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0])); return CValue(); }
+};
+
+template <typename A1, typename A2> struct CNativeCall2<void, A1, A2>
+{
+	typedef void (*Function)(A1, A2);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { ((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1])); return CValue(); }
+};
+
+template <typename A1, typename A2, typename A3> struct CNativeCall3<void, A1, A2, A3>
+{
+	typedef void (*Function)(A1, A2, A3);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { ((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1]), CNativeType<A3>::FromValue(pParameters[2])); return CValue(); }
+};
+
+template <typename A1, typename A2, typename A3, typename A4> struct CNativeCall4<void, A1, A2, A3, A4>
+{
+	typedef void (*Function)(A1, A2, A3, A4);
+	static CValue Call(NativeFunction pFunction, const CValue * pParameters) { ((Function) pFunction)(CNativeType<A1>::FromValue(pParameters[0]), CNativeType<A2>::FromValue(pParameters[1]), CNativeType<A3>::FromValue(pParameters[2]), CNativeType<A4>::FromValue(pParameters[3])); return CValue(); }
+};
+
+// Fills in a binding
+inline CNativeBinding MakeNativeBinding(const char * szName, NativeFunction pFunction, NativeThunk pThunk, const eVariableTypes * pParameterTypes, unsigned int iParameterCount, bool bTypeSensitive, bool bEffectful)
+{
+	CNativeBinding oBinding = { szName, pFunction, pThunk, pParameterTypes, iParameterCount, bTypeSensitive, bEffectful };
+	return oBinding;
+}
+
+// Binds a pure native, the parameter types and the thunk are deduced from its signature
+template <typename R> CNativeBinding BindNative(const char * szName, R (*pFunction)(), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall0<R>::Call, NULL, 0, bTypeSensitive, false);
+}
+
+template <typename R, typename A1> CNativeBinding BindNative(const char * szName, R (*pFunction)(A1), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall1<R, A1>::Call, CNativeSignature1<A1>::m_aTypes, 1, bTypeSensitive, false);
+}
+
+template <typename R, typename A1, typename A2> CNativeBinding BindNative(const char * szName, R (*pFunction)(A1, A2), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall2<R, A1, A2>::Call, CNativeSignature2<A1, A2>::m_aTypes, 2, bTypeSensitive, false);
+}
+
+template <typename R, typename A1, typename A2, typename A3> CNativeBinding BindNative(const char * szName, R (*pFunction)(A1, A2, A3), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall3<R, A1, A2, A3>::Call, CNativeSignature3<A1, A2, A3>::m_aTypes, 3, bTypeSensitive, false);
+}
+
+template <typename R, typename A1, typename A2, typename A3, typename A4> CNativeBinding BindNative(const char * szName, R (*pFunction)(A1, A2, A3, A4), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall4<R, A1, A2, A3, A4>::Call, CNativeSignature4<A1, A2, A3, A4>::m_aTypes, 4, bTypeSensitive, false);
+}
+
+// Binds an effectful native, it returns nothing because its calls aren't evaluated while compiling
+// The call evaluates to the integer 0 in the script, like the call of any native that returns nothing
+inline CNativeBinding BindEffectfulNative(const char * szName, void (*pFunction)(), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall0<void>::Call, NULL, 0, bTypeSensitive, true);
+}
+
+template <typename A1> CNativeBinding BindEffectfulNative(const char * szName, void (*pFunction)(A1), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall1<void, A1>::Call, CNativeSignature1<A1>::m_aTypes, 1, bTypeSensitive, true);
+}
+
+template <typename A1, typename A2> CNativeBinding BindEffectfulNative(const char * szName, void (*pFunction)(A1, A2), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall2<void, A1, A2>::Call, CNativeSignature2<A1, A2>::m_aTypes, 2, bTypeSensitive, true);
+}
+
+template <typename A1, typename A2, typename A3> CNativeBinding BindEffectfulNative(const char * szName, void (*pFunction)(A1, A2, A3), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall3<void, A1, A2, A3>::Call, CNativeSignature3<A1, A2, A3>::m_aTypes, 3, bTypeSensitive, true);
+}
+
+template <typename A1, typename A2, typename A3, typename A4> CNativeBinding BindEffectfulNative(const char * szName, void (*pFunction)(A1, A2, A3, A4), bool bTypeSensitive = true)
+{
+	return MakeNativeBinding(szName, (NativeFunction) pFunction, &CNativeCall4<void, A1, A2, A3, A4>::Call, CNativeSignature4<A1, A2, A3, A4>::m_aTypes, 4, bTypeSensitive, true);
+}
\ No newline at end of file
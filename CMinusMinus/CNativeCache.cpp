@@ -0,0 +1,248 @@
+//==============================================================================
+//
+// File: CNativeCache.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CNativeCache class remembers the results of the calls of pure natives.
+// A pure native always gives the same result for the same parameters, so a
+// call that was folded before is a lookup. The cache holds a limited amount
+// of results, when it's full the result that was used the longest ago goes.
+// The analyzer folds calls on several threads, so the cache has a lock.
+//
+//==============================================================================
+
+#include "CNativeCache.h"
+#include "CLogger.h"
+#include "CThreadPool.h"
+
+// The index of an entry that doesn't exist, ends the lists
+#define NATIVE_CACHE_NO_ENTRY 0xFFFFFFFF
+
+// The entries, there are never more than m_iCapacity
+std::vector<CNativeCache::CCacheEntry> CNativeCache::m_lEntries;
+// The first entry of every bucket, the amount of buckets is a power of two
+std::vector<unsigned int> CNativeCache::m_lBuckets;
+// The most and the least recently used entry
+unsigned int CNativeCache::m_iNewest = NATIVE_CACHE_NO_ENTRY;
+unsigned int CNativeCache::m_iOldest = NATIVE_CACHE_NO_ENTRY;
+// The most results the cache holds, 0 turns the cache off
+size_t CNativeCache::m_iCapacity = NATIVE_CACHE_DEFAULT_CAPACITY;
+// The lock of the cache
+volatile long CNativeCache::m_iLock = 0;
+
+// How often a call was found, wasn't found, and pushed an older result out
+size_t CNativeCache::m_iHits = 0;
+size_t CNativeCache::m_iMisses = 0;
+size_t CNativeCache::m_iEvictions = 0;
+
+// Sets how many results the cache holds, the results the cache held are forgotten
+void CNativeCache::SetCapacity(size_t iCapacity)
+{
+	LockSpinLock(&m_iLock);
+
+	m_iCapacity = iCapacity;
+	m_lEntries.clear();
+	m_lBuckets.clear();
+	m_iNewest = NATIVE_CACHE_NO_ENTRY;
+	m_iOldest = NATIVE_CACHE_NO_ENTRY;
+
+	UnlockSpinLock(&m_iLock);
+}
+
+// Returns the hash of a call
+size_t CNativeCache::HashCall(FunctionHandle iFunction, const ParameterList & lParameterList)
+{
+	size_t iHash = iFunction * 2654435769u;
+
+	for(size_t i = 0; i < lParameterList.size(); i++)
+		iHash = (iHash ^ lParameterList[i].GetHash()) * 16777619u;
+
+	return iHash;
+}
+
+// Returns the entry that holds a call, or NATIVE_CACHE_NO_ENTRY
+unsigned int CNativeCache::FindEntry(FunctionHandle iFunction, const ParameterList & lParameterList, size_t iHash)
+{
+	unsigned int iEntry = m_lBuckets[iHash & (m_lBuckets.size() - 1)];
+
+	for(; iEntry != NATIVE_CACHE_NO_ENTRY; iEntry = m_lEntries[iEntry].m_iNextInBucket)
+	{
+		const CCacheEntry & oEntry = m_lEntries[iEntry];
+
+		// Only compare the parameters of entries that could be the same call
+		if(oEntry.m_iHash != iHash || oEntry.m_iFunction != iFunction || oEntry.m_lParameterList.size() != lParameterList.size())
+			continue;
+
+		size_t i = 0;
+
+		while(i < lParameterList.size() && oEntry.m_lParameterList[i].IsIdentical(lParameterList[i]))
+			i++;
+
+		if(i == lParameterList.size())
+			return iEntry;
+	}
+
+	return NATIVE_CACHE_NO_ENTRY;
+}
+
+// Takes an entry out of the recently used list
+void CNativeCache::Unlink(unsigned int iEntry)
+{
+	CCacheEntry & oEntry = m_lEntries[iEntry];
+
+	if(oEntry.m_iNewer != NATIVE_CACHE_NO_ENTRY)
+		m_lEntries[oEntry.m_iNewer].m_iOlder = oEntry.m_iOlder;
+	else
+		m_iNewest = oEntry.m_iOlder;
+
+	if(oEntry.m_iOlder != NATIVE_CACHE_NO_ENTRY)
+		m_lEntries[oEntry.m_iOlder].m_iNewer = oEntry.m_iNewer;
+	else
+		m_iOldest = oEntry.m_iNewer;
+}
+
+// Puts an entry at the front of the recently used list
+void CNativeCache::LinkNewest(unsigned int iEntry)
+{
+	CCacheEntry & oEntry = m_lEntries[iEntry];
+	oEntry.m_iNewer = NATIVE_CACHE_NO_ENTRY;
+	oEntry.m_iOlder = m_iNewest;
+
+	if(m_iNewest != NATIVE_CACHE_NO_ENTRY)
+		m_lEntries[m_iNewest].m_iNewer = iEntry;
+	else
+		m_iOldest = iEntry;
+
+	m_iNewest = iEntry;
+}
+
+// Takes an entry out of its bucket
+void CNativeCache::RemoveFromBucket(unsigned int iEntry)
+{
+	unsigned int * piLink = &m_lBuckets[m_lEntries[iEntry].m_iHash & (m_lBuckets.size() - 1)];
+
+	while(*piLink != iEntry)
+		piLink = &m_lEntries[*piLink].m_iNextInBucket;
+
+	*piLink = m_lEntries[iEntry].m_iNextInBucket;
+}
+
+// Looks a call up, returns true and fills in oResult if the cache has its result
+bool CNativeCache::Find(FunctionHandle iFunction, const ParameterList & lParameterList, CValue & oResult)
+{
+	if(m_iCapacity == 0)
+		return false;
+
+	// Hash the parameters before taking the lock, a long string takes a while
+	size_t iHash = HashCall(iFunction, lParameterList);
+
+	LockSpinLock(&m_iLock);
+
+	unsigned int iEntry = m_lBuckets.empty() ? NATIVE_CACHE_NO_ENTRY : FindEntry(iFunction, lParameterList, iHash);
+
+	if(iEntry == NATIVE_CACHE_NO_ENTRY)
+	{
+		m_iMisses++;
+		UnlockSpinLock(&m_iLock);
+		return false;
+	}
+
+	// The entry was used just now, it goes last
+	oResult = m_lEntries[iEntry].m_oResult;
+	Unlink(iEntry);
+	LinkNewest(iEntry);
+	m_iHits++;
+
+	UnlockSpinLock(&m_iLock);
+	return true;
+}
+
+// Looks a call up like Find(), but the statistics and the order of the results stay as they are
+bool CNativeCache::Peek(FunctionHandle iFunction, const ParameterList & lParameterList, CValue & oResult)
+{
+	if(m_iCapacity == 0)
+		return false;
+
+	size_t iHash = HashCall(iFunction, lParameterList);
+
+	LockSpinLock(&m_iLock);
+
+	unsigned int iEntry = m_lBuckets.empty() ? NATIVE_CACHE_NO_ENTRY : FindEntry(iFunction, lParameterList, iHash);
+
+	if(iEntry != NATIVE_CACHE_NO_ENTRY)
+		oResult = m_lEntries[iEntry].m_oResult;
+
+	UnlockSpinLock(&m_iLock);
+	return iEntry != NATIVE_CACHE_NO_ENTRY;
+}
+
+// Remembers the result of a call, the least recently used result goes if the cache is full
+void CNativeCache::Add(FunctionHandle iFunction, const ParameterList & lParameterList, const CValue & oResult)
+{
+	if(m_iCapacity == 0)
+		return;
+
+	size_t iHash = HashCall(iFunction, lParameterList);
+
+	LockSpinLock(&m_iLock);
+
+	// Make the buckets the first time, twice as many as there are entries keeps the buckets short
+	if(m_lBuckets.empty())
+	{
+		size_t iBucketCount = 1;
+
+		while(iBucketCount < m_iCapacity * 2)
+			iBucketCount *= 2;
+
+		m_lBuckets.assign(iBucketCount, NATIVE_CACHE_NO_ENTRY);
+		m_lEntries.reserve(m_iCapacity);
+	}
+
+	// Another thread folded the same call in the meantime
+	if(FindEntry(iFunction, lParameterList, iHash) != NATIVE_CACHE_NO_ENTRY)
+	{
+		UnlockSpinLock(&m_iLock);
+		return;
+	}
+
+	unsigned int iEntry;
+
+	// Use a new entry while there's room, otherwise the least recently used one
+	if(m_lEntries.size() < m_iCapacity)
+	{
+		iEntry = (unsigned int) m_lEntries.size();
+		m_lEntries.push_back(CCacheEntry());
+	}
+	else
+	{
+		iEntry = m_iOldest;
+		RemoveFromBucket(iEntry);
+		Unlink(iEntry);
+		m_iEvictions++;
+	}
+
+	CCacheEntry & oEntry = m_lEntries[iEntry];
+	oEntry.m_iFunction = iFunction;
+	oEntry.m_lParameterList = lParameterList;
+	oEntry.m_iHash = iHash;
+	oEntry.m_oResult = oResult;
+
+	// Put the entry at the front of its bucket and of the recently used list
+	unsigned int & iBucket = m_lBuckets[iHash & (m_lBuckets.size() - 1)];
+	oEntry.m_iNextInBucket = iBucket;
+	iBucket = iEntry;
+
+	LinkNewest(iEntry);
+
+	UnlockSpinLock(&m_iLock);
+}
+
+// Logs the statistics of the cache
+void CNativeCache::LogStatistics()
+{
+	size_t iLookups = m_iHits + m_iMisses;
+
+	CLogger::Write("* Native cache: %d hits, %d misses (%.1f%% hits), %d evictions, %d of %d entries used", (int) m_iHits, (int) m_iMisses, iLookups == 0 ? 0.0 : (double) m_iHits * 100.0 / (double) iLookups, (int) m_iEvictions, (int) m_lEntries.size(), (int) m_iCapacity);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+//==============================================================================
+//
+// File: CNativeCache.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CNativeCache class remembers the results of the calls of pure natives.
+// A pure native always gives the same result for the same parameters, so a
+// call that was folded before is a lookup. The cache holds a limited amount
+// of results, when it's full the result that was used the longest ago goes.
+// The analyzer folds calls on several threads, so the cache has a lock.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include "CParameter.h"
+#include "CFunction.h"
+
+// The amount of results the cache holds by default
+#define NATIVE_CACHE_DEFAULT_CAPACITY 1024
+
+class CNativeCache
+{
+	// One result, the entries are linked from the most to the least recently used
+	struct CCacheEntry
+	{
+		// The call: the function and its parameters, and the hash of both
+		FunctionHandle m_iFunction;
+		ParameterList m_lParameterList;
+		size_t m_iHash;
+		// What the call returned
+		CValue m_oResult;
+		// The entries that were used right after and right before this one
+		unsigned int m_iNewer;
+		unsigned int m_iOlder;
+		// The next entry in the same bucket
+		unsigned int m_iNextInBucket;
+	};
+
+	// The entries, there are never more than m_iCapacity
+	static std::vector<CCacheEntry> m_lEntries;
+	// The first entry of every bucket, the amount of buckets is a power of two
+	static std::vector<unsigned int> m_lBuckets;
+	// The most and the least recently used entry
+	static unsigned int m_iNewest;
+	static unsigned int m_iOldest;
+	// The most results the cache holds, 0 turns the cache off
+	static size_t m_iCapacity;
+	// The lock of the cache, it's only held for a lookup or an insert so we spin
+	static volatile long m_iLock;
+
+	// How often a call was found, wasn't found, and pushed an older result out
+	static size_t m_iHits;
+	static size_t m_iMisses;
+	static size_t m_iEvictions;
+
+	// Returns the hash of a call
+	static size_t HashCall(FunctionHandle iFunction, const ParameterList & lParameterList);
+	// Returns the entry that holds a call, or NATIVE_CACHE_NO_ENTRY
+	static unsigned int FindEntry(FunctionHandle iFunction, const ParameterList & lParameterList, size_t iHash);
+	// Takes an entry out of the recently used list, and puts it at the front
+	static void Unlink(unsigned int iEntry);
+	static void LinkNewest(unsigned int iEntry);
+	// Takes an entry out of its bucket
+	static void RemoveFromBucket(unsigned int iEntry);
+
+public:
+	// Sets how many results the cache holds, 0 turns the cache off, the results the cache held are forgotten
+	static void SetCapacity(size_t iCapacity);
+	static size_t GetCapacity() { return m_iCapacity; }
+	// Looks a call up, returns true and fills in oResult if the cache has its result
+	static bool Find(FunctionHandle iFunction, const ParameterList & lParameterList, CValue & oResult);
+	// Looks a call up like Find(), but the statistics and the order of the results stay as they are
+	// This is for calls the analyzer already looked up, when the IR is folded or evaluated
+	static bool Peek(FunctionHandle iFunction, const ParameterList & lParameterList, CValue & oResult);
+	// Remembers the result of a call, the least recently used result goes if the cache is full
+	static void Add(FunctionHandle iFunction, const ParameterList & lParameterList, const CValue & oResult);
+
+	// Returns how often a call was found, wasn't found, and pushed an older result out
+	static size_t GetHits() { return m_iHits; }
+	static size_t GetMisses() { return m_iMisses; }
+	static size_t GetEvictions() { return m_iEvictions; }
+	// Logs the statistics of the cache
+	static void LogStatistics();
+};
\ No newline at end of file
@@ -4,598 +4,596 @@
 // Project: CMinusMinus
 // Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
 // License: See LICENSE in root directory
-// 
+//
 // The CParser class checks for any compile errors in the token list.
-// 
+// It's a recursive descent parser which reads every token once and builds a
+// syntax tree (see CAst.h), expressions are parsed with precedence climbing.
+// The CAnalyzer then walks the tree to check and evaluate the script.
+//
 //==============================================================================
 
 #include "CParser.h"
+#include "CAnalyzer.h"
 #include "CLogger.h"
-#include "Util.h"
-#include "CFunctionWrapper.h"
 
-#include <sstream>
+// How tightly the operators bind, an operator with a higher binding power is applied first
+#define BINDING_POWER_ADDITIVE 10
+#define BINDING_POWER_PREFIX 20
+
+// The deepest blocks and brackets can be nested, the parser and analyzer recurse once for every level
+#define PARSER_MAX_NESTING_DEPTH 256
 
 // Constructor of the CParser class
-CParser::CParser(TokenList lTokenList)
+CParser::CParser(CTokenizer & oTokenizer)
+{
+	m_pTokenizer = &oTokenizer;
+	m_pProgram = NULL;
+	m_iNodeCount = 0;
+	m_iCurrentToken = 0;
+	m_iPreviousLine = 0;
+	m_iNestingDepth = 0;
+	m_bAborted = false;
+}
+
+// Returns a handle to a token, the token is lexed first if the tokenizer is streaming
+// Tokens past either end of the source are INVALID_TOKEN_TYPE tokens
+CToken CParser::GetToken(size_t iToken)
+{
+	m_pTokenizer->Fetch(iToken);
+	return CToken(m_pTokenizer->GetTokenBuffer(), iToken);
+}
+
+// Returns the value of a token as an argument of an error message
+// Keywords and punctuators don't have an interned value so their spelling is used
+CDiagnosticArgument CParser::GetTokenArgument(const CToken & oToken)
+{
+	if(oToken.GetSymbol() != INVALID_SYMBOL_ID)
+		return CDiagnosticArgument::Symbol(oToken.GetSymbol());
+
+	return CDiagnosticArgument::Text(GetTokenTypeSpelling(oToken.GetType()));
+}
+
+// Pushes back an error onto the error list, the message is only formatted when the error is printed
+void CParser::PushBackError(int iErrorLine, eDiagnosticCode eCode, CDiagnosticArgument oFirst, CDiagnosticArgument oSecond)
+{
+	// The errors found while giving up on the rest of the script don't tell anything
+	if(m_bAborted)
+		return;
+
+	m_lErrorList.push_back(CError(eCode, iErrorLine, oFirst, oSecond));
+
+	// Too many errors, don't bother with the rest of the script
+	if(CDiagnostics::IsLimitReached(m_lErrorList.size()))
+		Abort();
+}
+
+// Gives up on the rest of the script, the parser acts like it reached the end
+// The rest of the tokens aren't even lexed if the tokenizer is streaming
+void CParser::Abort()
+{
+	m_bAborted = true;
+
+	if(m_oCurrentToken.IsValid())
+		m_iPreviousLine = m_oCurrentToken.GetLine();
+
+	m_oCurrentToken = CToken();
+}
+
+// Returns the line to report an error on, at the end of the script that's the line of the last token
+int CParser::GetErrorLine()
+{
+	return m_oCurrentToken.IsValid() ? m_oCurrentToken.GetLine() : m_iPreviousLine;
+}
+
+// Reports that the current token wasn't expected
+void CParser::PushBackUnexpectedTokenError()
 {
-	m_lTokenList = lTokenList;
+	if(!m_oCurrentToken.IsValid())
+		PushBackError(GetErrorLine(), DIAGNOSTIC_UNEXPECTED_END);
+	else
+		PushBackError(GetErrorLine(), DIAGNOSTIC_UNEXPECTED_TOKEN, GetTokenArgument(m_oCurrentToken));
 }
 
-// Pushes back an error onto the error list
-void CParser::PushBackError(int iErrorLine, std::string sErrorMessage)
+// Moves on to the next token, the tokens before it aren't needed anymore
+void CParser::Advance()
 {
-	CError oError;
-	oError.m_iLine = iErrorLine;
-	oError.m_sMessage = sErrorMessage;
-	m_lErrorList.push_back(oError);
+	// Stay at the end of the script
+	if(!m_oCurrentToken.IsValid())
+		return;
+
+	m_iPreviousLine = m_oCurrentToken.GetLine();
+	m_iCurrentToken++;
+
+	// The parser never looks back, while streaming the older tokens can be dropped
+	m_pTokenizer->Release(m_iCurrentToken);
+	m_oCurrentToken = GetToken(m_iCurrentToken);
+}
+
+// Moves on to the next token if the current token has the type, returns false otherwise
+bool CParser::Accept(eTokenType eType)
+{
+	if(m_oCurrentToken.GetType() != eType)
+		return false;
+
+	Advance();
+	return true;
 }
 
-// Returns true if the variable exists on the variable list, false otherwise
-bool CParser::VariableExists(std::string sVariableName)
+// Skips the rest of a statement after an error, up to and including the next ;
+void CParser::SkipStatement()
 {
-	// Loop through all the variables
-	for(VariableList::iterator iterator = m_lVariableList.begin(); iterator != m_lVariableList.end(); iterator++)
+	while(m_oCurrentToken.IsValid())
 	{
-		// If we have a name match, set the bVariableFound bool to true
-		if((*iterator).m_sValueName == sVariableName)
-			return true;
+		eTokenType eType = m_oCurrentToken.GetType();
+
+		// The end of the statement
+		if(eType == SEMICOLON_TOKEN)
+		{
+			Advance();
+			return;
+		}
+
+		// Blocks and declarations start a new statement, we'll continue from there
+		if(eType == OPEN_CURLY_BRACKET_TOKEN || eType == CLOSE_CURLY_BRACKET_TOKEN || eType == INTEGER_TYPE_TOKEN || eType == FLOAT_TYPE_TOKEN || eType == STRING_TYPE_TOKEN)
+			return;
+
+		Advance();
 	}
+}
+
+// Checks that the current token is a ; after a statement, reports an error and skips the statement otherwise
+void CParser::ExpectEndOfStatement()
+{
+	if(Accept(SEMICOLON_TOKEN))
+		return;
 
-	return false;
+	PushBackError(GetErrorLine(), DIAGNOSTIC_UNFINISHED_STATEMENT, CDiagnosticArgument::Integer(m_iPreviousLine));
+	SkipStatement();
 }
 
-// This method returns a token list iterator from a variable name
-VariableList::iterator CParser::GetVariableListIteratorFromVariableName(std::string sVariableName)
+// Stops parsing when the blocks and brackets are nested too deep, returns true if they are
+bool CParser::EnterNesting()
 {
-	// Loop through all the variables, so we can find the iterator that represents the variable we're trying to assign something to
-	for(VariableList::iterator iterator = m_lVariableList.begin(); iterator != m_lVariableList.end(); iterator++)
+	if(m_iNestingDepth < PARSER_MAX_NESTING_DEPTH)
 	{
-		// Check if the iterator name is equal to the variable name we're trying to assign something to
-		if((*iterator).m_sValueName == sVariableName)
-			return iterator;
+		m_iNestingDepth++;
+		return false;
 	}
 
-	return m_lVariableList.end();
+	PushBackError(GetErrorLine(), DIAGNOSTIC_NESTED_TOO_DEEP, CDiagnosticArgument::Integer(PARSER_MAX_NESTING_DEPTH));
+
+	// There's no sensible way to continue, skip the rest of the script
+	Abort();
+
+	return true;
 }
 
-// This method returns true if both CIndentation levels are either the same or oToAccess
-// is allowed to access variables on oToBeAccessed
-bool CParser::HasCorrectIndentationLevel(CIndentation oToBeAccessed, CIndentation oToAccess)
+// Copies the nodes on the node stack from iFirstNode onwards into the arena, and pops them
+CAstNode ** CParser::PopNodeList(size_t iFirstNode, size_t & iCount)
 {
-	// If the access level is the same, and the indentation ID is the same, return true
-	if(oToBeAccessed.m_iLevel == oToAccess.m_iLevel && oToBeAccessed.m_iLevelID == oToAccess.m_iLevelID)
-		return true;
+	iCount = m_lNodeStack.size() - iFirstNode;
+	CAstNode ** ppNodes = m_oArena.NewArray<CAstNode *>(iCount);
 
-	// If oToBeAccessed's level is smaller than oToAccess, return true
-	if(oToBeAccessed.m_iLevel < oToAccess.m_iLevel && oToBeAccessed.m_iLevelID < oToAccess.m_iLevelID)
-		return true;
+	for(size_t i = 0; i < iCount; i++)
+		ppNodes[i] = m_lNodeStack[iFirstNode + i];
 
-	// We didn't return anything yet, no correct indentation level
-	return false;
+	m_lNodeStack.resize(iFirstNode);
+	return ppNodes;
 }
 
-// Returns the variable type from a string value
-// For example: "3" returns integer, "3.14" float and "Hello" string
-eVariableTypes CParser::GetVariableType(std::string sValue)
+// Returns how tightly a binary operator binds, 0 if the token isn't a binary operator
+int CParser::GetBindingPower(eTokenType eType)
 {
-	// Either an integer or float
-	if(IsFloatOrInteger(sValue))
+	switch(eType)
 	{
-		// Integer
-		if(IsInteger(sValue))
-			return VARIABLE_TYPE_INTEGER;
+		case PLUS_OPERATOR_TOKEN:
+		case MINUS_OPERATOR_TOKEN:
+			return BINDING_POWER_ADDITIVE;
 
-		// Float
-		return VARIABLE_TYPE_FLOAT;
+		default:
+			return 0;
 	}
-	// String
-	else return VARIABLE_TYPE_STRING;
 }
 
-void CParser::Run()
+// Parses the statements up to a } or the end of the script
+CAstBlock * CParser::ParseStatements(int iLine, bool bBraced)
 {
-	// Loop through the entire token list
-	for(size_t i = 0; i < m_lTokenList.size(); i++)
+	size_t iFirstNode = m_lNodeStack.size();
+
+	while(m_oCurrentToken.IsValid())
 	{
-		// Get the current token
-		CToken CurrentToken = m_lTokenList[i];
-		// Get the previous token on the list
-		CToken PreviousToken = (i > 0) ? m_lTokenList[i - 1] : CToken();
-		// Get the token before the previous token on the list (used to check in the 'something = somethingelse' kind of checks)
-		CToken SecondPreviousToken = (i > 1) ? m_lTokenList[i - 2] : CToken();
-
-		// Check if the iterator is currently at the start of the list
-		// If it is, we need to perform some seperate checks
-		if(i == 0)
+		if(m_oCurrentToken.GetType() == CLOSE_CURLY_BRACKET_TOKEN)
 		{
-			// The only things allowed at the start of the script is a { or type
-			if(CurrentToken.m_iTokenType != OPEN_CURLY_BRACKET_TOKEN && CurrentToken.m_iTokenType != FLOAT_TYPE_TOKEN && CurrentToken.m_iTokenType != INTEGER_TYPE_TOKEN && CurrentToken.m_iTokenType != STRING_TYPE_TOKEN)
-				PushBackError(CurrentToken.m_iLine, "Unexpected '" + CurrentToken.m_sValue + "' at start of the script found.");
+			// This } closes the block
+			if(bBraced)
+				break;
 
-			// We don't need to execute the rest of the checks, call continue
+			// There's no block to close
+			PushBackError(GetErrorLine(), DIAGNOSTIC_UNEXPECTED_TOKEN, CDiagnosticArgument::Text("}"));
+			Advance();
 			continue;
 		}
 
-		// If the previous token was an equal sign, and we have a token before that, we're in an assignement statement
-		if(PreviousToken.m_iTokenType == EQUALSIGN_TOKEN && SecondPreviousToken.m_iTokenType != INVALID_TOKEN_TYPE)
-		{
-			// First check if we're assigning to anything valid
-			// It cannot be a value constant, string literal or non-existing variable
-			if(!VariableExists(SecondPreviousToken.m_sValue))
-			{
-				// The user is trying to assign something to a constant value (for example: int 5 = 3;)
-				if(IsFloatOrInteger(SecondPreviousToken.m_sValue))
-					PushBackError(CurrentToken.m_iLine, "Cannot assign to a value constant (" + SecondPreviousToken.m_sValue + ").");
+		CAstNode * pStatement = ParseStatement();
 
-				// It's a string literal
-				else if(SecondPreviousToken.m_iTokenType == STRING_LITERAL_TOKEN)
-					PushBackError(CurrentToken.m_iLine, "Cannot assign anything to a string literal.");
+		if(pStatement != NULL)
+			m_lNodeStack.push_back(pStatement);
+	}
 
-				// Variable simply doesn't exist
-				else
-					PushBackError(CurrentToken.m_iLine, "Cannot assign anything to " + SecondPreviousToken.m_sValue + ", variable does not exist.");
-				continue;
-			}
+	CAstBlock * pBlock = NewNode<CAstBlock>(AST_NODE_BLOCK, iLine);
+	pBlock->m_bBraced = bBraced;
+	pBlock->m_ppStatements = PopNodeList(iFirstNode, pBlock->m_iStatementCount);
 
-			// Get the iterator in the VariableList that represents the variable we're assigning to
-			VariableList::iterator LeftHandSide = GetVariableListIteratorFromVariableName(SecondPreviousToken.m_sValue);
+	return pBlock;
+}
 
-			// Now check if we're trying to assign something valid to the variable
-			if(!VariableExists(CurrentToken.m_sValue))
-			{
-				// Check if the current token is a value constant
-				// We handle 'var = constants' type of statements here
-
-				// Check if it's a string literal
-				if(CurrentToken.m_iTokenType == STRING_LITERAL_TOKEN)
-				{
-					// Make sure we're assigning it to a string
-					if((*LeftHandSide).m_eType != VARIABLE_TYPE_STRING)
-					{
-						PushBackError(CurrentToken.m_iLine, "Cannot assign \"" + CurrentToken.m_sValue + "\" to '" + SecondPreviousToken.m_sValue + "', the types differ.");
-						continue;
-					}
-
-					// Set the hasBeenAssignedAnything flag for this variable to true
-					// This flags the variable as been defined
-					(*LeftHandSide).m_sValue = CurrentToken.m_sValue;
-
-					// Set the value for this variable
-					(*LeftHandSide).m_bHasBeenAssignedAnything = true;
-				}
-
-				// It's a float or integer
-				else if(IsFloatOrInteger(CurrentToken.m_sValue))
-				{
-					// Is it an integer constant?
-					if(IsInteger(CurrentToken.m_sValue))
-					{
-						// Type checking
-						if((*LeftHandSide).m_eType != VARIABLE_TYPE_INTEGER)
-						{
-							PushBackError(CurrentToken.m_iLine, "Cannot assign '" + CurrentToken.m_sValue + "' to '" + SecondPreviousToken.m_sValue + "', the types differ.");
-							continue;
-						}
-
-						// Set the hasBeenAssignedAnything flag for this variable to true
-						// This flags the variable as been defined
-						(*LeftHandSide).m_bHasBeenAssignedAnything = true;
-
-						// Set the value for this variable
-						(*LeftHandSide).m_iValue = atoi(CurrentToken.m_sValue.c_str());
-					}
-
-					// Or a float constant
-					else
-					{
-						// Add some typechecking
-						if((*LeftHandSide).m_eType != PARAMETER_TYPE_FLOAT)
-						{
-							PushBackError(CurrentToken.m_iLine, "Cannot assign '" + CurrentToken.m_sValue + "' to '" + SecondPreviousToken.m_sValue + "', the types differ.");
-							continue;
-						}
-
-						// Set the hasBeenAssignedAnything flag for this variable to true
-						// This flags the variable as been defined
-						(*LeftHandSide).m_bHasBeenAssignedAnything = true;
-
-						// Set the value for this variable
-						(*LeftHandSide).m_fValue = atof(CurrentToken.m_sValue.c_str());
-					}
-				}
-
-				// It's not a string literal, not a float or integer, this means the user is trying to assign a variable to another variable
-				// While the right hand side variable doesn't exist
-				else
-				{
-					// Wait, it might be a function call, make sure the next token isn't a OPEN_BRACKET_TOKEN
-					if((i + 1) != m_lTokenList.size() && m_lTokenList[i + 1].m_iTokenType != OPEN_BRACKET_TOKEN)
-					{
-						// It wasn't, the rhs doesn't exist
-						PushBackError(CurrentToken.m_iLine, "Cannot assign '" + CurrentToken.m_sValue + "' to '" + SecondPreviousToken.m_sValue + "', '" + CurrentToken.m_sValue + "' does not exist.");
-						continue;
-					}
-				}
-			}
+// Parses one statement, returns NULL if the statement had an error (or was empty)
+CAstNode * CParser::ParseStatement()
+{
+	switch(m_oCurrentToken.GetType())
+	{
+		// { statements }
+		case OPEN_CURLY_BRACKET_TOKEN:
+			return ParseBlock();
+
+		// An empty statement
+		case SEMICOLON_TOKEN:
+			Advance();
+			return NULL;
+
+		// int name = expression;
+		case INTEGER_TYPE_TOKEN:
+		case FLOAT_TYPE_TOKEN:
+		case STRING_TYPE_TOKEN:
+			return ParseDeclaration();
+
+		default:
+			break;
+	}
 
-			// The current token isn't a value constant, it's another variable
-			// We handle 'var = var' type of statements here
-			else
-			{
-				// Get the iterator for the right hand side variable
-				VariableList::iterator RightHandSide = GetVariableListIteratorFromVariableName(CurrentToken.m_sValue);
-
-				// Check if the variable is allowed the other variable
-				if(!HasCorrectIndentationLevel((*RightHandSide).m_oIndentation, SecondPreviousToken.m_oIndentation))
-				{
-					PushBackError(CurrentToken.m_iLine, "Cannot access " + (*RightHandSide).m_sValueName + ", that variable is declared on another level.");
-					continue;
-				}
-
-				// Type checking: make sure the variables have the same types
-				if((*LeftHandSide).m_eType != (*RightHandSide).m_eType)
-				{
-					PushBackError(CurrentToken.m_iLine, "Cannot assign '" + CurrentToken.m_sValue + "' to '" + SecondPreviousToken.m_sValue + "', the types differ.");
-					continue;
-				}
-
-				// Set the hasBeenAssignedAnything flag to true
-				// This flags the variable as been defined
-				(*LeftHandSide).m_bHasBeenAssignedAnything = true;
-
-				// Set the value
-				if((*LeftHandSide).m_eType == VARIABLE_TYPE_INTEGER)
-					(*LeftHandSide).m_iValue = (*RightHandSide).m_iValue;
-
-				if((*LeftHandSide).m_eType == PARAMETER_TYPE_FLOAT)
-					(*LeftHandSide).m_fValue = (*RightHandSide).m_fValue;
-
-				if((*LeftHandSide).m_eType == VARIABLE_TYPE_STRING)
-					(*LeftHandSide).m_sValue = (*RightHandSide).m_sValue;
-			}
-		}
+	// Either an assignment or an expression (a function call, for example)
+	int iLine = GetErrorLine();
+	CAstNode * pExpression = ParseExpression(0);
 
-		// The previous token was either a + or -
-		if(PreviousToken.m_iTokenType == PLUS_OPERATOR_TOKEN || PreviousToken.m_iTokenType == MINUS_OPERATOR_TOKEN)
-		{
-			// Get the token for the assignment variable (the variable we're assigning to)
-			CToken VariableWhichIsBeingAssignedTo = CToken();
+	if(pExpression == NULL)
+	{
+		SkipStatement();
+		return NULL;
+	}
 
-			// This variable holds the amounts of times we had to decrement the iterator in order
-			// to find the variable we're assigning to. We need to save the amount of times we've
-			// decremented the iterator in order to increment it the same amount of times again,
-			// otherwise this loop will run infinitely
-			int iAmountOfDecrements = i;
+	// expression;
+	if(m_oCurrentToken.GetType() != EQUALSIGN_TOKEN)
+	{
+		CAstExpressionStatement * pStatement = NewNode<CAstExpressionStatement>(AST_NODE_EXPRESSION_STATEMENT, iLine);
+		pStatement->m_pExpression = pExpression;
 
-			// Infinite loop
-			while(true)
-			{
-				// Wait, if the iterator is already at the start of the list, break out of the loop
-				// We can't decrement an iterator which is already at the start of the loop
-				if(iAmountOfDecrements == m_lTokenList.size())
-					break;
+		ExpectEndOfStatement();
+		return pStatement;
+	}
 
-				// Save the current iterator position
-				VariableWhichIsBeingAssignedTo = m_lTokenList[iAmountOfDecrements--];
+	// target = expression;
+	int iEqualSignLine = GetErrorLine();
+	Advance();
 
-				// If we the token we're processing is a VALUE_TOKEN and it's not a constant value (eg not a float or int)
-				if(VariableWhichIsBeingAssignedTo.m_iTokenType == VALUE_TOKEN && !IsFloatOrInteger(VariableWhichIsBeingAssignedTo.m_sValue))
-					break;
-			}
+	if(m_oCurrentToken.GetType() == SEMICOLON_TOKEN || !m_oCurrentToken.IsValid())
+	{
+		PushBackError(GetErrorLine(), DIAGNOSTIC_MISSING_VALUE, CDiagnosticArgument::Integer(iEqualSignLine));
+		SkipStatement();
+		return NULL;
+	}
 
-			// Now we get the VariableList iterator which is pointing at the correct variable we want to assign to
-			VariableList::iterator LeftHandSide = GetVariableListIteratorFromVariableName(VariableWhichIsBeingAssignedTo.m_sValue);
-			// Get the variable type of the current token (eg what we're trying to assign to our variable)
-			eVariableTypes eType = GetVariableType(CurrentToken.m_sValue);
+	CAstNode * pValue = ParseExpression(0);
 
-			// Make sure the iterator is correct (it's not correct if the example we're trying to assign to doesn't exist)
-			if(LeftHandSide != m_lVariableList.end())
-			{
-				// Wait, is the type of what we're trying to assign to the variable the same as the variable?
-				if(eType != (*LeftHandSide).m_eType)
-				{
-					PushBackError(CurrentToken.m_iLine, "Cannot concatenate '" + CurrentToken.m_sValue + "' and '" + (*LeftHandSide).m_sValueName + "', the types differ.");
-					continue;
-				}
-				
-				// Is this the plus operator?
-				if(PreviousToken.m_iTokenType == PLUS_OPERATOR_TOKEN)
-				{
-					// int + int
-					if(eType == VARIABLE_TYPE_INTEGER)
-						(*LeftHandSide).m_iValue += atoi(CurrentToken.m_sValue.c_str());
-					// float + float
-					if(eType == PARAMETER_TYPE_FLOAT)
-						(*LeftHandSide).m_fValue += atof(CurrentToken.m_sValue.c_str());
-					// string + string
-					if(eType == VARIABLE_TYPE_STRING)
-					{
-						// Remove the double quotes from the string
-						std::string sStringLiteral = CurrentToken.m_sValue;
-
-						// Concat the strings
-						(*LeftHandSide).m_sValue += sStringLiteral;
-					}
-				}
-
-				// Is this the minus operator?
-				if(PreviousToken.m_iTokenType == MINUS_OPERATOR_TOKEN)
-				{
-					// int - int
-					if(eType == VARIABLE_TYPE_INTEGER)
-						(*LeftHandSide).m_iValue -= atoi(CurrentToken.m_sValue.c_str());
-					// float - float
-					if(eType == PARAMETER_TYPE_FLOAT)
-						(*LeftHandSide).m_fValue -= atof(CurrentToken.m_sValue.c_str());
-					// String doesn't support operator-
-					if(eType == VARIABLE_TYPE_STRING)
-						PushBackError(CurrentToken.m_iLine, "The string type does not define the minus operator.");
-				}
-			}
-			continue;
+	if(pValue == NULL)
+	{
+		SkipStatement();
+		return NULL;
+	}
+
+	CAstAssignment * pAssignment = NewNode<CAstAssignment>(AST_NODE_ASSIGNMENT, iLine);
+	pAssignment->m_pTarget = pExpression;
+	pAssignment->m_pValue = pValue;
+
+	ExpectEndOfStatement();
+	return pAssignment;
+}
+
+// Parses a { } block, the current token is the {
+CAstNode * CParser::ParseBlock()
+{
+	int iLine = GetErrorLine();
+
+	if(EnterNesting())
+		return NULL;
+
+	Advance();
+	CAstBlock * pBlock = ParseStatements(iLine, true);
+	m_iNestingDepth--;
+
+	// After giving up, the blocks that are still open don't need an error of their own
+	if(!Accept(CLOSE_CURLY_BRACKET_TOKEN) && !m_bAborted)
+		PushBackError(GetErrorLine(), DIAGNOSTIC_UNCLOSED_BLOCK, CDiagnosticArgument::Integer(iLine));
+
+	return pBlock;
+}
+
+// Parses a declaration, the current token is the type
+CAstNode * CParser::ParseDeclaration()
+{
+	int iLine = GetErrorLine();
+	eTokenType eTypeToken = m_oCurrentToken.GetType();
+	Advance();
+
+	// The type has to be followed by a name (numbers have their own token types)
+	if(m_oCurrentToken.GetType() != VALUE_TOKEN)
+	{
+		PushBackError(GetErrorLine(), DIAGNOSTIC_MISSING_VARIABLE_NAME, CDiagnosticArgument::Text(GetTokenTypeSpelling(eTypeToken)));
+		SkipStatement();
+		return NULL;
+	}
+
+	CAstDeclaration * pDeclaration = NewNode<CAstDeclaration>(AST_NODE_DECLARATION, iLine);
+	pDeclaration->m_iName = m_oCurrentToken.GetSymbol();
+	pDeclaration->m_pInitialiser = NULL;
+	pDeclaration->m_iVariable = UNRESOLVED_VARIABLE;
+
+	// Set the type of the variable according to the type token
+	if(eTypeToken == INTEGER_TYPE_TOKEN)
+		pDeclaration->m_eVariableType = VARIABLE_TYPE_INTEGER;
+	else if(eTypeToken == FLOAT_TYPE_TOKEN)
+		pDeclaration->m_eVariableType = VARIABLE_TYPE_FLOAT;
+	else
+		pDeclaration->m_eVariableType = VARIABLE_TYPE_STRING;
+
+	Advance();
+
+	// int name = expression;
+	if(m_oCurrentToken.GetType() == EQUALSIGN_TOKEN)
+	{
+		int iEqualSignLine = GetErrorLine();
+		Advance();
+
+		if(m_oCurrentToken.GetType() == SEMICOLON_TOKEN || !m_oCurrentToken.IsValid())
+		{
+			PushBackError(GetErrorLine(), DIAGNOSTIC_MISSING_VALUE, CDiagnosticArgument::Integer(iEqualSignLine));
+			SkipStatement();
+			return pDeclaration;
 		}
 
-		// Convert the line number of the previous token to a string
-		std::stringstream sLineNumberOfPreviousToken;
-		sLineNumberOfPreviousToken << PreviousToken.m_iLine;
-		std::string sPreviousTokensLine = sLineNumberOfPreviousToken.str();
+		pDeclaration->m_pInitialiser = ParseExpression(0);
 
-		if(CurrentToken.m_iTokenType == OPEN_CURLY_BRACKET_TOKEN)
+		// The variable is still declared, so it doesn't cause more errors further on
+		if(pDeclaration->m_pInitialiser == NULL)
 		{
-			// Allowed previous tokens: {, }, ;
-			// Not allowed previous tokens: {, float, string, int, =, VALUE_TOKEN
-			if(PreviousToken.m_iTokenType != OPEN_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != CLOSE_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != SEMICOLON_TOKEN)
-				PushBackError(CurrentToken.m_iLine, "Finish the statement at line " + sPreviousTokensLine + " first.");
-			
-			continue;
+			SkipStatement();
+			return pDeclaration;
 		}
+	}
+
+	ExpectEndOfStatement();
+	return pDeclaration;
+}
+
+// Parses an expression, only operators that bind tighter than iMinimumBindingPower are part of it
+// 'a + b - c' is parsed as '(a + b) - c', the loop builds the tree from left to right
+CAstNode * CParser::ParseExpression(int iMinimumBindingPower)
+{
+	CAstNode * pLeft = ParsePrimary();
+
+	while(pLeft != NULL)
+	{
+		eTokenType eOperator = m_oCurrentToken.GetType();
+		int iBindingPower = GetBindingPower(eOperator);
+
+		// Not an operator, or one that binds less tightly than the operator before the left hand side
+		if(iBindingPower <= iMinimumBindingPower)
+			break;
+
+		int iLine = GetErrorLine();
+		Advance();
+
+		// The right hand side only takes operators that bind more tightly
+		CAstNode * pRight = ParseExpression(iBindingPower);
 
-		if(CurrentToken.m_iTokenType == CLOSE_CURLY_BRACKET_TOKEN)
+		if(pRight == NULL)
+			return NULL;
+
+		CAstBinary * pBinary = NewNode<CAstBinary>(AST_NODE_BINARY, iLine);
+		pBinary->m_eOperator = eOperator;
+		pBinary->m_pLeft = pLeft;
+		pBinary->m_pRight = pRight;
+
+		pLeft = pBinary;
+	}
+
+	return pLeft;
+}
+
+// Parses a value, a variable, a call, a bracketed expression or a negation
+CAstNode * CParser::ParsePrimary()
+{
+	int iLine = GetErrorLine();
+
+	switch(m_oCurrentToken.GetType())
+	{
+		// 42
+		case INTEGER_LITERAL_TOKEN:
 		{
-			// Allowed previous tokens: {, }, ;
-			// Not allowed previous tokens: }, float, string, int, =, VALUE_TOKEN
-			if(PreviousToken.m_iTokenType != OPEN_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != CLOSE_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != SEMICOLON_TOKEN)
-				PushBackError(CurrentToken.m_iLine, "Finish the statement at line " + sPreviousTokensLine + " first.");
+			CAstIntegerLiteral * pLiteral = NewNode<CAstIntegerLiteral>(AST_NODE_INTEGER_LITERAL, iLine);
+			pLiteral->m_iValue = m_oCurrentToken.GetIntegerValue();
+			pLiteral->m_iSpelling = m_oCurrentToken.GetSymbol();
 
-			continue;
+			Advance();
+			return pLiteral;
 		}
 
-		if(CurrentToken.m_iTokenType == SEMICOLON_TOKEN)
+		// 3.14
+		case FLOAT_LITERAL_TOKEN:
 		{
-			// Allowed previous tokens: {, ;, }, VALUE_TOKEN
-			// Not allowed previous tokens: =, float, string, int
-			if(PreviousToken.m_iTokenType != CLOSE_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != OPEN_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != VALUE_TOKEN && PreviousToken.m_iTokenType != SEMICOLON_TOKEN)
-			{
-				if(PreviousToken.m_iTokenType == STRING_TYPE_TOKEN || PreviousToken.m_iTokenType == INTEGER_TYPE_TOKEN || PreviousToken.m_iTokenType == FLOAT_TYPE_TOKEN)
-					PushBackError(CurrentToken.m_iLine, "Expected an equal sign followed by a value or variable on line " + sPreviousTokensLine);
+			CAstFloatLiteral * pLiteral = NewNode<CAstFloatLiteral>(AST_NODE_FLOAT_LITERAL, iLine);
+			pLiteral->m_fValue = m_oCurrentToken.GetFloatValue();
+			pLiteral->m_iSpelling = m_oCurrentToken.GetSymbol();
 
-				if(PreviousToken.m_iTokenType == EQUALSIGN_TOKEN)
-					PushBackError(CurrentToken.m_iLine, "Expected a value or variable after the equal sign on line " + sPreviousTokensLine);
-			}
-
-			continue;
+			Advance();
+			return pLiteral;
 		}
 
-		if(CurrentToken.m_iTokenType == EQUALSIGN_TOKEN)
+		// "Hello"
+		case STRING_LITERAL_TOKEN:
 		{
-			// Allowed previous tokens: VALUE_TOKEN
-			// Not allowed previous tokens: =, float, string, int, {, ;, }
-			if(PreviousToken.m_iTokenType != VALUE_TOKEN)
-				PushBackError(CurrentToken.m_iLine, PreviousToken.m_sValue + " cannot be followed by an equal sign.");
+			CAstStringLiteral * pLiteral = NewNode<CAstStringLiteral>(AST_NODE_STRING_LITERAL, iLine);
+			pLiteral->m_iValue = m_oCurrentToken.GetSymbol();
 
-			continue;
+			Advance();
+			return pLiteral;
 		}
 
-		if(CurrentToken.m_iTokenType == INTEGER_TYPE_TOKEN || CurrentToken.m_iTokenType == FLOAT_TYPE_TOKEN || CurrentToken.m_iTokenType == STRING_TYPE_TOKEN)
+		// A variable, or a function call if the name is followed by a (
+		case VALUE_TOKEN:
 		{
-			// Allowed previous tokens: {, }, ;
-			// Not allowed previous tokens: =, float, string, int, VALUE_TOKEN
-			if(PreviousToken.m_iTokenType != CLOSE_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != OPEN_CURLY_BRACKET_TOKEN && PreviousToken.m_iTokenType != SEMICOLON_TOKEN)
-				PushBackError(CurrentToken.m_iLine, PreviousToken.m_sValue + " cannot be followed by a type.");
+			SymbolID iName = m_oCurrentToken.GetSymbol();
+			Advance();
 
-			continue;
+			if(m_oCurrentToken.GetType() == OPEN_BRACKET_TOKEN)
+				return ParseCall(iName, iLine);
+
+			CAstVariable * pVariable = NewNode<CAstVariable>(AST_NODE_VARIABLE, iLine);
+			pVariable->m_iName = iName;
+			pVariable->m_iVariable = UNRESOLVED_VARIABLE;
+			pVariable->m_bInScope = false;
+			return pVariable;
 		}
 
-		if(CurrentToken.m_iTokenType == VALUE_TOKEN)
+		// ( expression )
+		case OPEN_BRACKET_TOKEN:
 		{
-			// If the current token is a value token and the next one is an open bracket token, the user is trying to call a function
-			if(i != m_lTokenList.size() && m_lTokenList[i + 1].m_iTokenType == OPEN_BRACKET_TOKEN)
-			{
-				// Get the function name
-				std::string FunctionName = CurrentToken.m_sValue;
-
-				// The LoopToken is the token we'll be using in the loop.
-				CToken LoopToken = m_lTokenList[i + 1];
-				// We also save the token before the current token, this is used to get a parameter list
-				CToken TokenBeforeCurrentLoopToken = m_lTokenList[i];
-
-				// This variable holds the amounts of times we've executed the loop
-				int iAmountOfIncrements = i;
-				// The parameter list for the function
-				ParameterList lParameterList;
-
-				// Infinite loop
-				while(true)
-				{
-					// If the iAmountOfIncrements variable is equal to the token size, we can't get the next token on the list
-					// Break out of the loop
-					if(iAmountOfIncrements == m_lTokenList.size())
-						break;
-
-					// We found a close bracket token, exit the loop
-					if(LoopToken.m_iTokenType == CLOSE_BRACKET_TOKEN)
-						break;
-
-					// The current token is a value token or a string literal, and the previous token was either a ( or a ,
-					// This is a parameter for the function, push it back onto the list
-					if(LoopToken.m_iTokenType == VALUE_TOKEN || LoopToken.m_iTokenType == STRING_LITERAL_TOKEN && (TokenBeforeCurrentLoopToken.m_iTokenType == OPEN_BRACKET_TOKEN || TokenBeforeCurrentLoopToken.m_iTokenType == COMMA_TOKEN))
-					{
-						// It might be a variable, does it exist?
-						if(!VariableExists(LoopToken.m_sValue))
-						{
-							// Doesn't exist
-							// It's a float or integer
-							if(IsFloatOrInteger(LoopToken.m_sValue))
-							{
-								// It's an integer
-								if(IsInteger(LoopToken.m_sValue))
-									lParameterList.push_back(CParameter(PARAMETER_TYPE_INTEGER, atoi(LoopToken.m_sValue.c_str())));
-								// It's a float
-								else
-									lParameterList.push_back(CParameter(PARAMETER_TYPE_FLOAT, (float) atof(LoopToken.m_sValue.c_str())));
-							}
-							// It's not a float or integer, must be a string
-							else lParameterList.push_back(CParameter(PARAMETER_TYPE_STRING, LoopToken.m_sValue));
-						}
-
-						// It's a variable, this parameter was a variable
-						else
-						{
-							// Get the iterator on the VariableList
-							VariableList::iterator variableIterator = GetVariableListIteratorFromVariableName(LoopToken.m_sValue);
-
-							// Get the type of the variable and push it back onto the parameter list
-							if((*variableIterator).m_eType == VARIABLE_TYPE_INTEGER)
-								lParameterList.push_back(CParameter(PARAMETER_TYPE_INTEGER, (*variableIterator).m_iValue));
-							if((*variableIterator).m_eType == VARIABLE_TYPE_FLOAT)
-								lParameterList.push_back(CParameter(PARAMETER_TYPE_FLOAT, (float) (*variableIterator).m_fValue));
-							if((*variableIterator).m_eType == VARIABLE_TYPE_STRING)
-								lParameterList.push_back(CParameter(PARAMETER_TYPE_STRING, (*variableIterator).m_sValue));
-						}
-					}
-
-					// Save the current token and the token before the previous one
-					TokenBeforeCurrentLoopToken = m_lTokenList[iAmountOfIncrements];
-					LoopToken = m_lTokenList[++iAmountOfIncrements];
-				}
-
-				// Wait, does the function exist?
-				if(!CFunctionWrapper::FunctionExists(FunctionName))
-				{
-					PushBackError(CurrentToken.m_iLine, "Could not call " + FunctionName + ", function does not exist.");
-					continue;
-				}
-
-				// Call the function
-				CFunctionCallAttempt oAttempt = CFunctionWrapper::CallFunction(FunctionName, lParameterList);
-
-				// Did an error occur while calling the function?
-				if(oAttempt.m_bErrorOccured)
-				{
-					PushBackError(CurrentToken.m_iLine, oAttempt.m_sErrorMessage);
-					continue;
-				}
-
-				// If the token before the function name token is an equal sign token, this isn't a regular call
-				// It's an assignment statement.
-				if(PreviousToken.m_iTokenType == EQUALSIGN_TOKEN)
-				{
-					// Get the variable iterator pointing to the variable we're trying to assign to
-					VariableList::iterator VariableAssignmentIterator = GetVariableListIteratorFromVariableName(SecondPreviousToken.m_sValue);
-
-					// Does the return type of the function match the variable's type?
-					if((*VariableAssignmentIterator).m_eType != oAttempt.m_oReturnValue.m_eType)
-					{
-						PushBackError(CurrentToken.m_iLine, "Could not assign the return value of " + FunctionName + " to " + (*VariableAssignmentIterator).m_sValueName + ", the types differ.");
-						continue;
-					}
-
-					// Something has been assigned to this value
-					(*VariableAssignmentIterator).m_bHasBeenAssignedAnything = true;
-
-					// Save the value
-					if(oAttempt.m_oReturnValue.m_eType == VARIABLE_TYPE_INTEGER)
-						(*VariableAssignmentIterator).m_iValue = oAttempt.m_oReturnValue.m_iValue;
-
-					if(oAttempt.m_oReturnValue.m_eType == VARIABLE_TYPE_FLOAT)
-						(*VariableAssignmentIterator).m_fValue = oAttempt.m_oReturnValue.m_fValue;
-
-					if(oAttempt.m_oReturnValue.m_eType == VARIABLE_TYPE_STRING)
-						(*VariableAssignmentIterator).m_sValue = oAttempt.m_oReturnValue.m_sValue;
-				}
-			}
-			// End of function checking
+			if(EnterNesting())
+				return NULL;
 
-			// Allowed previous tokens: {, }, ;, =, float, string, int, =
-			// Not allowed previous tokens: VALUE_TOKEN
-			if(PreviousToken.m_iTokenType == VALUE_TOKEN)
-			{
-				PushBackError(CurrentToken.m_iLine, "'" + PreviousToken.m_sValue + "' cannot be followed by '" + CurrentToken.m_sValue + "'.");
-			}
+			Advance();
+			CAstNode * pExpression = ParseExpression(0);
+			m_iNestingDepth--;
 
-			else
+			if(pExpression == NULL)
+				return NULL;
+
+			if(!Accept(CLOSE_BRACKET_TOKEN))
 			{
-				// If the current token is a value token
-				// and the previous token was either a float, string or int type, the user is trying to declare a variable
-				if(PreviousToken.m_iTokenType == FLOAT_TYPE_TOKEN || PreviousToken.m_iTokenType == INTEGER_TYPE_TOKEN || PreviousToken.m_iTokenType == STRING_TYPE_TOKEN)
-				{
-					// Check if the current token is a valid variable name
-					if(!IsFloatOrInteger(CurrentToken.m_sValue))
-					{
-						if(VariableExists(CurrentToken.m_sValue))
-						{
-							PushBackError(CurrentToken.m_iLine, "'" + CurrentToken.m_sValue + "' already exists. Cannot re-declare a variable.");
-						}
-						else
-						{
-							// Setup a CVariable object
-							CVariable oVariable;
-							oVariable.m_sValueName = CurrentToken.m_sValue;
-
-							// Set the type of the CVariable object according to the type of token the previous token object had
-							if(PreviousToken.m_iTokenType == INTEGER_TYPE_TOKEN)
-								oVariable.m_eType = VARIABLE_TYPE_INTEGER;
-
-							if(PreviousToken.m_iTokenType == FLOAT_TYPE_TOKEN)
-								oVariable.m_eType = VARIABLE_TYPE_FLOAT;
-
-							if(PreviousToken.m_iTokenType == STRING_TYPE_TOKEN)
-								oVariable.m_eType = VARIABLE_TYPE_STRING;
-
-							// Save the indentation level for this variable
-							oVariable.m_oIndentation = CurrentToken.m_oIndentation;
-
-							// Push it onto the variable list
-							m_lVariableList.push_back(oVariable);
-						}
-					}
-				}
+				PushBackError(GetErrorLine(), DIAGNOSTIC_UNCLOSED_BRACKET, CDiagnosticArgument::Integer(iLine));
+				return NULL;
 			}
 
-			continue;
+			return pExpression;
 		}
+
+		// -expression
+		case MINUS_OPERATOR_TOKEN:
+		{
+			if(EnterNesting())
+				return NULL;
+
+			Advance();
+			CAstNode * pOperand = ParseExpression(BINDING_POWER_PREFIX);
+			m_iNestingDepth--;
+
+			if(pOperand == NULL)
+				return NULL;
+
+			CAstNegation * pNegation = NewNode<CAstNegation>(AST_NODE_NEGATION, iLine);
+			pNegation->m_pOperand = pOperand;
+			return pNegation;
+		}
+
+		default:
+			PushBackUnexpectedTokenError();
+			return NULL;
 	}
+}
 
-	// Now loop through the error list
-	#if _DEBUG
-	if(m_lErrorList.size() > 0) CLogger::Write("\n* Errors found:");
-	#endif
+// Parses the arguments of a call, the current token is the (
+CAstNode * CParser::ParseCall(SymbolID iFunction, int iLine)
+{
+	if(EnterNesting())
+		return NULL;
 
-	// Log every error
-	for(ErrorList::iterator iterator = m_lErrorList.begin(); iterator != m_lErrorList.end(); iterator++)
-		CLogger::Write("Line %d: %s", (*iterator).m_iLine, (*iterator).m_sMessage.c_str());
+	Advance();
 
-	// If we're compiling in debug mode we show the variables we've found in the scripts
-	#if _DEBUG
-	CLogger::Write("\n* Variables found:");
-	for(VariableList::iterator iterator = m_lVariableList.begin(); iterator != m_lVariableList.end(); iterator++)
+	// The arguments are collected on the node stack
+	size_t iFirstNode = m_lNodeStack.size();
+
+	if(!Accept(CLOSE_BRACKET_TOKEN))
 	{
-		// Check if the variable has been assigned anything
-		if((*iterator).m_bHasBeenAssignedAnything)
+		while(true)
 		{
-			// Output the variable name and type
-			if((*iterator).m_eType == VARIABLE_TYPE_INTEGER)
-				CLogger::Write("Variable %s (integer) has value %d (tab level: %d, tab id: %d)", (*iterator).m_sValueName.c_str(), (*iterator).m_iValue, (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+			CAstNode * pArgument = ParseExpression(0);
 
-			if((*iterator).m_eType == PARAMETER_TYPE_FLOAT)
-				CLogger::Write("Variable %s (float) has value %.2f (tab level: %d, tab id: %d)", (*iterator).m_sValueName.c_str(), (*iterator).m_fValue, (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+			if(pArgument == NULL)
+			{
+				m_lNodeStack.resize(iFirstNode);
+				m_iNestingDepth--;
+				return NULL;
+			}
 
-			if((*iterator).m_eType == VARIABLE_TYPE_STRING)
-				CLogger::Write("Variable %s (string) has value %s (tab level: %d, tab id: %d)", (*iterator).m_sValueName.c_str(), (*iterator).m_sValue.c_str(), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
-		}
+			m_lNodeStack.push_back(pArgument);
+
+			// Another argument follows
+			if(Accept(COMMA_TOKEN))
+				continue;
 
-		else CLogger::Write("Variable %s has been declared but not yet defined. (tab level: %d, tab id: %d)", (*iterator).m_sValueName.c_str(), (*iterator).m_oIndentation.m_iLevel, (*iterator).m_oIndentation.m_iLevelID);
+			// The end of the call
+			if(Accept(CLOSE_BRACKET_TOKEN))
+				break;
+
+			PushBackError(GetErrorLine(), DIAGNOSTIC_MISSING_ARGUMENT_SEPARATOR, CDiagnosticArgument::Symbol(iFunction));
+			m_lNodeStack.resize(iFirstNode);
+			m_iNestingDepth--;
+			return NULL;
+		}
 	}
+
+	m_iNestingDepth--;
+
+	CAstCall * pCall = NewNode<CAstCall>(AST_NODE_CALL, iLine);
+	pCall->m_iFunction = iFunction;
+	pCall->m_ppArguments = PopNodeList(iFirstNode, pCall->m_iArgumentCount);
+	pCall->m_iFunctionHandle = INVALID_FUNCTION_HANDLE;
+
+	return pCall;
+}
+
+// Parses the script into a syntax tree, returns the root of the tree
+const CAstBlock * CParser::Parse()
+{
+	m_iCurrentToken = 0;
+	m_oCurrentToken = GetToken(0);
+
+	// The entire script is one block without brackets
+	m_pProgram = ParseStatements(1, false);
+	return m_pProgram;
+}
+
+// Runs the actual parser, then checks and evaluates the syntax tree on iThreadCount threads
+void CParser::Run(int iThreadCount)
+{
+	// Build the syntax tree
+	const CAstBlock * pProgram = Parse();
+
+	#if _DEBUG
+	CLogger::Write("\n* Syntax tree (%d nodes, %d bytes):", (int) m_iNodeCount, (int) m_oArena.GetBytesUsed());
+	LogSyntaxTree(pProgram, 0);
+	#endif
+
+	// Check and evaluate the syntax tree, the analyzer adds its errors to our error list
+	CAnalyzer oAnalyzer(m_lErrorList);
+	oAnalyzer.Run(pProgram, iThreadCount);
+
+	// The syntax errors were found before the analyzer ran, log the errors in the order of the source
+	// The messages are formatted now, while the syntax tree the errors point into is still alive
+	CDiagnostics::SortByLine(m_lErrorList);
+	CDiagnostics::Print(m_lErrorList);
+
+	// If we're compiling in debug mode we show the variables we've found in the scripts
+	#if _DEBUG
+	oAnalyzer.LogVariables();
 	#endif
 }
\ No newline at end of file
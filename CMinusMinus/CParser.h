@@ -4,41 +4,116 @@
 // Project: CMinusMinus
 // Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
 // License: See LICENSE in root directory
-// 
+//
 // The CParser class checks for any compile errors in the token list.
-// 
+// It's a recursive descent parser which reads every token once and builds a
+// syntax tree (see CAst.h), expressions are parsed with precedence climbing.
+// The CAnalyzer then walks the tree to check and evaluate the script.
+//
 //==============================================================================
 
 #pragma once
 
 #include <list>
+#include <vector>
 #include "CToken.h"
+#include "CTokenizer.h"
 #include "CError.h"
-#include "CFunction.h"
+#include "CDiagnostics.h"
+#include "CArena.h"
+#include "CAst.h"
 
 class CParser
 {
-	// The value list (this means, variable or function names) for the script
-	VariableList m_lVariableList;
 	// The list of all errors for the script
 	ErrorList m_lErrorList;
-	// The list of all tokens for the script
-	TokenList m_lTokenList;
+	// The tokenizer the tokens are pulled from
+	CTokenizer * m_pTokenizer;
+
+	// The syntax tree is allocated in this arena, it's freed in one go with the parser
+	CArena m_oArena;
+	// The root of the syntax tree, the entire script is one block
+	CAstBlock * m_pProgram;
+	// The amount of nodes in the syntax tree
+	size_t m_iNodeCount;
+
+	// The token the parser is at, and the line of the token before it
+	size_t m_iCurrentToken;
+	CToken m_oCurrentToken;
+	int m_iPreviousLine;
+	// How deep the blocks and brackets are nested
+	int m_iNestingDepth;
+	// Set when the parser gave up on the rest of the script
+	bool m_bAborted;
+
+	// The statements and arguments of the lists that are being parsed, each list is copied into the arena once it's complete
+	std::vector<CAstNode *> m_lNodeStack;
+
+	// Allocates a node in the arena
+	template <typename T> T * NewNode(eAstNodeType eType, int iLine)
+	{
+		T * pNode = m_oArena.New<T>();
+		pNode->m_eType = eType;
+		pNode->m_iLine = iLine;
+		m_iNodeCount++;
+		return pNode;
+	}
+
+	// Copies the nodes on the node stack from iFirstNode onwards into the arena, and pops them
+	CAstNode ** PopNodeList(size_t iFirstNode, size_t & iCount);
+
+	// Returns the line to report an error on, at the end of the script that's the line of the last token
+	int GetErrorLine();
+	// Reports that the current token wasn't expected
+	void PushBackUnexpectedTokenError();
+	// Stops parsing when the blocks and brackets are nested too deep, returns true if they are
+	bool EnterNesting();
+	// Gives up on the rest of the script, the parser acts like it reached the end
+	void Abort();
+	// Moves on to the next token, the tokens before it aren't needed anymore
+	void Advance();
+	// Moves on to the next token if the current token has the type, returns false otherwise
+	bool Accept(eTokenType eType);
+	// Skips the rest of a statement after an error, up to and including the next ;
+	// A { or } isn't skipped, so the blocks stay intact
+	void SkipStatement();
+	// Checks that the current token is a ; after a statement, reports an error and skips the statement otherwise
+	void ExpectEndOfStatement();
+
+	// Parses the statements up to a } or the end of the script
+	CAstBlock * ParseStatements(int iLine, bool bBraced);
+	// Parses one statement, returns NULL if the statement had an error (or was empty)
+	CAstNode * ParseStatement();
+	// Parses a { } block, the current token is the {
+	CAstNode * ParseBlock();
+	// Parses a declaration, the current token is the type
+	CAstNode * ParseDeclaration();
+	// Parses an expression, only operators that bind tighter than iMinimumBindingPower are part of it
+	CAstNode * ParseExpression(int iMinimumBindingPower);
+	// Parses a value, a variable, a call, a bracketed expression or a negation
+	CAstNode * ParsePrimary();
+	// Parses the arguments of a call, the current token is the (
+	CAstNode * ParseCall(SymbolID iFunction, int iLine);
+	// Returns how tightly a binary operator binds, 0 if the token isn't a binary operator
+	static int GetBindingPower(eTokenType eType);
 
 public:
-	// The constructor of the CParser class, this requires a TokenList (std::list<CToken>) as an argument
-	CParser(TokenList lTokenList);
-	// Returns true if the variable exists on the variable list, false otherwise
-	bool VariableExists(std::string sVariableName);
-	// This method returns a variable list iterator from a variable name
-	VariableList::iterator GetVariableListIteratorFromVariableName(std::string sVariableName);
-	// This method returns true if both CIndentation levels are either the same or oToAccess
-	// is allowed to access variables on oToBeAccessed
-	bool HasCorrectIndentationLevel(CIndentation oToBeAccessed, CIndentation oToAccess);
-	// This method pushes back an error on the list
-	void PushBackError(int iErrorLine, std::string sErrorMessage);
-	// Returns the variable type from a string value
-	eVariableTypes GetVariableType(std::string sValue);
-	// Runs the actual parser
-	void Run();
+	// The constructor of the CParser class, this requires the tokenizer as an argument
+	// The tokenizer either lexed the entire source already (Run) or streams the tokens (Stream)
+	CParser(CTokenizer & oTokenizer);
+	// Returns a handle to a token, the token is lexed first if the tokenizer is streaming
+	// Tokens past either end of the source are INVALID_TOKEN_TYPE tokens
+	CToken GetToken(size_t iToken);
+	// Returns the value of a token as an argument of an error message
+	static CDiagnosticArgument GetTokenArgument(const CToken & oToken);
+	// This method pushes back an error on the list, the parser gives up once the error limit is reached
+	void PushBackError(int iErrorLine, eDiagnosticCode eCode, CDiagnosticArgument oFirst = CDiagnosticArgument(), CDiagnosticArgument oSecond = CDiagnosticArgument());
+	// Parses the script into a syntax tree, returns the root of the tree
+	const CAstBlock * Parse();
+	// Returns the syntax errors Parse() found
+	const ErrorList & GetErrorList() const { return m_lErrorList; }
+	// Returns true if the parser gave up on the rest of the script
+	bool IsAborted() const { return m_bAborted; }
+	// Runs the actual parser, then checks and evaluates the syntax tree on iThreadCount threads
+	void Run(int iThreadCount = 1);
 };
\ No newline at end of file
@@ -0,0 +1,115 @@
+//==============================================================================
+//
+// File: CPassManager.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CPassManager class runs the passes of CIrPasses.h over the IR of the
+// script before the CCompiler lowers it. The pipeline is a list of pass names
+// separated by commas, a pass can be in it more than once. The IR can be
+// dumped before the first pass and after every pass, and the time every pass
+// took can be logged.
+//
+//==============================================================================
+
+#include "CPassManager.h"
+#include "CIrPasses.h"
+#include "CLogger.h"
+
+#include <windows.h>
+#include <cstring>
+#include <string>
+
+// Every pass, generated from IR_PASS_LIST
+static const CIrPass g_aPasses[] =
+{
+	#define IR_PASS_ENTRY(szName, Run) { szName, Run },
+	IR_PASS_LIST(IR_PASS_ENTRY)
+	#undef IR_PASS_ENTRY
+};
+
+// The amount of passes
+#define IR_PASS_COUNT (sizeof(g_aPasses) / sizeof(g_aPasses[0]))
+
+// The passes to run, in order, as indexes on the pass list
+std::vector<size_t> CPassManager::m_lPipeline;
+// Was the pipeline set? Until then it's IR_DEFAULT_PIPELINE
+bool CPassManager::m_bPipelineSet = false;
+// Is the IR logged before the first pass and after every pass?
+bool CPassManager::m_bDumpEnabled = false;
+// Is the time every pass took logged?
+bool CPassManager::m_bTimingEnabled = false;
+
+// Sets the passes to run, returns false (and keeps the pipeline it had) if a pass doesn't exist
+bool CPassManager::SetPipeline(const char * szPipeline)
+{
+	std::vector<size_t> lPipeline;
+
+	// The pipeline is empty
+	if(strcmp(szPipeline, IR_EMPTY_PIPELINE) == 0)
+	{
+		m_lPipeline.clear();
+		m_bPipelineSet = true;
+		return true;
+	}
+
+	while(*szPipeline != '\0')
+	{
+		const char * szEnd = strchr(szPipeline, ',');
+		size_t iLength = szEnd == NULL ? strlen(szPipeline) : (size_t) (szEnd - szPipeline);
+		size_t iPass = 0;
+
+		while(iPass < IR_PASS_COUNT && (strlen(g_aPasses[iPass].m_szName) != iLength || strncmp(g_aPasses[iPass].m_szName, szPipeline, iLength) != 0))
+			iPass++;
+
+		if(iPass == IR_PASS_COUNT)
+		{
+			CLogger::Write("* Unknown pass %s", std::string(szPipeline, iLength).c_str());
+			return false;
+		}
+
+		lPipeline.push_back(iPass);
+		szPipeline += szEnd == NULL ? iLength : iLength + 1;
+	}
+
+	m_lPipeline.swap(lPipeline);
+	m_bPipelineSet = true;
+	return true;
+}
+
+// Runs the pipeline over a function
+void CPassManager::Run(CIrFunction & oFunction)
+{
+	if(!m_bPipelineSet)
+		SetPipeline(IR_DEFAULT_PIPELINE);
+
+	if(m_bDumpEnabled)
+		oFunction.Dump("of the script");
+
+	LARGE_INTEGER iFrequency, iStartTime, iEndTime;
+	QueryPerformanceFrequency(&iFrequency);
+	double fTotalTime = 0.0;
+
+	for(size_t i = 0; i < m_lPipeline.size(); i++)
+	{
+		const CIrPass & oPass = g_aPasses[m_lPipeline[i]];
+		size_t iInstructionCount = oFunction.GetInstructionCount();
+
+		QueryPerformanceCounter(&iStartTime);
+		oPass.m_pRun(oFunction);
+		QueryPerformanceCounter(&iEndTime);
+
+		double fTime = (double) (iEndTime.QuadPart - iStartTime.QuadPart) * 1000.0 / (double) iFrequency.QuadPart;
+		fTotalTime += fTime;
+
+		if(m_bTimingEnabled)
+			CLogger::Write("* Pass %s took %.3f ms (%d -> %d instructions)", oPass.m_szName, fTime, (int) iInstructionCount, (int) oFunction.GetInstructionCount());
+
+		if(m_bDumpEnabled)
+			oFunction.Dump((std::string("after ") + oPass.m_szName).c_str());
+	}
+
+	if(m_bTimingEnabled)
+		CLogger::Write("* The passes took %.3f ms", fTotalTime);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+//==============================================================================
+//
+// File: CPassManager.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CPassManager class runs the passes of CIrPasses.h over the IR of the
+// script before the CCompiler lowers it. The pipeline is a list of pass names
+// separated by commas, a pass can be in it more than once. The IR can be
+// dumped before the first pass and after every pass, and the time every pass
+// took can be logged.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include "CIr.h"
+
+// Every pass, and the name it has in a pipeline
+#define IR_PASS_LIST(PASS) \
+	PASS("copyprop", RunCopyPropagation) \
+	PASS("cse", RunCommonSubexpressionElimination) \
+	PASS("gvn", RunGlobalValueNumbering) \
+	PASS("dce", RunDeadCodeElimination)
+
+// The passes that run if no pipeline is set
+#define IR_DEFAULT_PIPELINE "copyprop,cse,gvn,dce"
+// The pipeline that doesn't run any pass
+#define IR_EMPTY_PIPELINE "none"
+
+// Runs a pass over a function
+typedef void (*IrPassFunction) (CIrFunction &);
+
+struct CIrPass
+{
+	const char * m_szName;
+	IrPassFunction m_pRun;
+};
+
+class CPassManager
+{
+	// The passes to run, in order, as indexes on the pass list
+	static std::vector<size_t> m_lPipeline;
+	// Was the pipeline set? Until then it's IR_DEFAULT_PIPELINE
+	static bool m_bPipelineSet;
+	// Is the IR logged before the first pass and after every pass?
+	static bool m_bDumpEnabled;
+	// Is the time every pass took logged?
+	static bool m_bTimingEnabled;
+
+public:
+	// Sets the passes to run, returns false (and keeps the pipeline it had) if a pass doesn't exist
+	static bool SetPipeline(const char * szPipeline);
+	// Turns the dumps and the timing on or off
+	static void SetDumpEnabled(bool bEnabled) { m_bDumpEnabled = bEnabled; }
+	static void SetTimingEnabled(bool bEnabled) { m_bTimingEnabled = bEnabled; }
+	// Runs the pipeline over a function
+	static void Run(CIrFunction & oFunction);
+};
\ No newline at end of file
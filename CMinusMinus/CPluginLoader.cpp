@@ -0,0 +1,194 @@
+//==============================================================================
+//
+// File: CPluginLoader.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CPluginLoader class loads native plugins (see CMinusMinusPlugin.h) and
+// registers their functions with the CFunctionWrapper. A plugin function is
+// called through a thunk that turns the values into CPluginValues and back,
+// there's one thunk for every amount of parameters.
+//
+//==============================================================================
+
+#include "CPluginLoader.h"
+#include "CMinusMinusPlugin.h"
+#include "CFunctionWrapper.h"
+#include "CNativeBinder.h"
+#include "CLogger.h"
+
+#include <windows.h>
+#include <cstring>
+
+static_assert(PLUGIN_MAX_PARAMETERS <= NATIVE_MAX_PARAMETERS, "Plugin functions take more parameters than natives can");
+
+// The parameter types of the plugin functions, a block for every plugin
+std::vector<eVariableTypes *> CPluginLoader::m_lParameterTypeBlocks;
+
+// Turns a value into a CPluginValue, a string parameter points into the value
+static void ToPluginValue(const CValue & oValue, CPluginValue & oPluginValue)
+{
+	oPluginValue.m_iInteger = 0;
+	oPluginValue.m_fFloat = 0.0;
+	oPluginValue.m_szString = "";
+	oPluginValue.m_iLength = 0;
+
+	switch(oValue.GetType())
+	{
+		case VARIABLE_TYPE_INTEGER:
+			oPluginValue.m_eType = PLUGIN_TYPE_INTEGER;
+			oPluginValue.m_iInteger = oValue.GetInteger();
+			break;
+
+		case VARIABLE_TYPE_FLOAT:
+			oPluginValue.m_eType = PLUGIN_TYPE_FLOAT;
+			oPluginValue.m_fFloat = oValue.GetFloat();
+			break;
+
+		case VARIABLE_TYPE_STRING:
+			oPluginValue.m_eType = PLUGIN_TYPE_STRING;
+			oPluginValue.m_szString = oValue.GetString();
+			oPluginValue.m_iLength = (unsigned int) oValue.GetLength();
+			break;
+	}
+}
+
+// Turns the result of a plugin function into a value, the string is copied
+static CValue FromPluginValue(const CPluginValue & oPluginValue)
+{
+	switch(oPluginValue.m_eType)
+	{
+		case PLUGIN_TYPE_FLOAT:
+			return CValue(oPluginValue.m_fFloat);
+
+		case PLUGIN_TYPE_STRING:
+		{
+			if(oPluginValue.m_szString == NULL)
+				return CValue(VARIABLE_TYPE_STRING);
+
+			// The plugin didn't set the length, the string ends at its null terminator
+			if(oPluginValue.m_iLength == 0)
+				return CValue(oPluginValue.m_szString, strlen(oPluginValue.m_szString));
+
+			return CValue(oPluginValue.m_szString, oPluginValue.m_iLength);
+		}
+
+		default:
+			return CValue(oPluginValue.m_iInteger);
+	}
+}
+
+// The thunk of a plugin function with N parameters
+template <unsigned int N> static CValue CallPluginFunction(NativeFunction pFunction, const CValue * pParameters)
+{
+	// A function without parameters still gets a valid pointer
+	CPluginValue aParameters[N == 0 ? 1 : N];
+
+	for(unsigned int i = 0; i < N; i++)
+		ToPluginValue(pParameters[i], aParameters[i]);
+
+	CPluginValue oResult;
+	ToPluginValue(CValue(), oResult);
+
+	((PluginFunction) pFunction)(aParameters, &oResult);
+	return FromPluginValue(oResult);
+}
+
+// The thunks by the amount of parameters
+static const NativeThunk g_aPluginThunks[PLUGIN_MAX_PARAMETERS + 1] =
+{
+	&CallPluginFunction<0>,
+	&CallPluginFunction<1>,
+	&CallPluginFunction<2>,
+	&CallPluginFunction<3>,
+	&CallPluginFunction<4>
+};
+
+// Turns a PLUGIN_TYPE_ value into a variable type, returns false if it isn't one
+static bool GetVariableType(int ePluginType, eVariableTypes & eType)
+{
+	switch(ePluginType)
+	{
+		case PLUGIN_TYPE_INTEGER:
+			eType = VARIABLE_TYPE_INTEGER;
+			return true;
+
+		case PLUGIN_TYPE_FLOAT:
+			eType = VARIABLE_TYPE_FLOAT;
+			return true;
+
+		case PLUGIN_TYPE_STRING:
+			eType = VARIABLE_TYPE_STRING;
+			return true;
+	}
+
+	return false;
+}
+
+// Loads a plugin and registers its functions, the natives have to be registered first
+bool CPluginLoader::Load(const char * szFileName)
+{
+	HMODULE hModule = LoadLibraryA(szFileName);
+
+	if(hModule == NULL)
+	{
+		CLogger::Write("* Could not load the plugin %s.", szFileName);
+		return false;
+	}
+
+	PluginRegisterFunction pRegister = (PluginRegisterFunction) GetProcAddress(hModule, PLUGIN_REGISTER_FUNCTION_NAME);
+	const CPluginRegistration * pRegistration = pRegister == NULL ? NULL : pRegister(PLUGIN_ABI_VERSION);
+
+	if(pRegistration == NULL)
+	{
+		CLogger::Write("* The plugin %s does not export %s, or refused to load.", szFileName, PLUGIN_REGISTER_FUNCTION_NAME);
+		FreeLibrary(hModule);
+		return false;
+	}
+
+	if(pRegistration->m_iAbiVersion != PLUGIN_ABI_VERSION)
+	{
+		CLogger::Write("* The plugin %s was built for plugin interface version %u, the compiler uses version %u.", szFileName, pRegistration->m_iAbiVersion, PLUGIN_ABI_VERSION);
+		FreeLibrary(hModule);
+		return false;
+	}
+
+	// Check every function before registering any, so a broken plugin doesn't leave half its functions behind
+	unsigned int iFunctionCount = pRegistration->m_iFunctionCount;
+	const CPluginFunction * pFunctions = pRegistration->m_pFunctions;
+	eVariableTypes * pParameterTypes = new eVariableTypes[iFunctionCount * PLUGIN_MAX_PARAMETERS + 1];
+
+	for(unsigned int i = 0; i < iFunctionCount; i++)
+	{
+		const CPluginFunction & oFunction = pFunctions[i];
+		bool bValid = oFunction.m_szName != NULL && oFunction.m_szName[0] != '\0' && oFunction.m_pFunction != NULL && oFunction.m_iParameterCount <= PLUGIN_MAX_PARAMETERS;
+
+		for(unsigned int j = 0; bValid && j < oFunction.m_iParameterCount; j++)
+			bValid = GetVariableType(oFunction.m_aParameterTypes[j], pParameterTypes[i * PLUGIN_MAX_PARAMETERS + j]);
+
+		if(!bValid)
+		{
+			CLogger::Write("* Function %u of the plugin %s has no name, no function or bad parameters.", i + 1, szFileName);
+			delete[] pParameterTypes;
+			FreeLibrary(hModule);
+			return false;
+		}
+	}
+
+	m_lParameterTypeBlocks.push_back(pParameterTypes);
+
+	for(unsigned int i = 0; i < iFunctionCount; i++)
+	{
+		const CPluginFunction & oFunction = pFunctions[i];
+		bool bTypeSensitive = (oFunction.m_iFlags & PLUGIN_FUNCTION_TYPE_SENSITIVE) != 0;
+
+		CFunctionWrapper::RegisterFunction(MakeNativeBinding(oFunction.m_szName, (NativeFunction) oFunction.m_pFunction, g_aPluginThunks[oFunction.m_iParameterCount], pParameterTypes + i * PLUGIN_MAX_PARAMETERS, oFunction.m_iParameterCount, bTypeSensitive, false));
+	}
+
+	#if _DEBUG
+	CLogger::Write("* Loaded the plugin %s: %u functions", szFileName, iFunctionCount);
+	#endif
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+//==============================================================================
+//
+// File: CPluginLoader.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CPluginLoader class loads native plugins (see CMinusMinusPlugin.h) and
+// registers their functions with the CFunctionWrapper. A plugin function is
+// called through a thunk that turns the values into CPluginValues and back,
+// there's one thunk for every amount of parameters.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include "CValue.h"
+
+class CPluginLoader
+{
+	// The parameter types of the plugin functions, a block for every plugin
+	// The plugins and these blocks stay loaded as long as the program runs, the function table points into them
+	static std::vector<eVariableTypes *> m_lParameterTypeBlocks;
+
+public:
+	// Loads a plugin and registers its functions, the natives have to be registered first
+	// Returns false (and logs why) if the plugin can't be loaded, none of its functions are registered then
+	static bool Load(const char * szFileName);
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+//==============================================================================
+//
+// File: CSourceFile.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSourceFile class maps a source file read-only into memory so the tokenizer
+// can lex straight over the bytes of the file. Tokens only store an offset and a
+// length into these bytes, which means the source is never copied line by line
+// or token by token. Files that cannot be mapped (empty files for example) are
+// read into a buffer owned by this class instead.
+//
+//==============================================================================
+
+#include "CSourceFile.h"
+
+#include <windows.h>
+#include <fstream>
+#include <iterator>
+
+// The constructor of the CSourceFile class
+CSourceFile::CSourceFile(): m_hFile(INVALID_HANDLE_VALUE), m_hMapping(NULL), m_pData(""), m_iSize(0) { }
+
+// The destructor unmaps the file
+CSourceFile::~CSourceFile()
+{
+	Close();
+}
+
+// Maps the file into memory, returns false if the file could not be opened
+bool CSourceFile::Open(std::string sFileName)
+{
+	Close();
+
+	// Open the file for reading, we tell Windows we're going to read it sequentially
+	m_hFile = CreateFileA(sFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if(m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER iFileSize;
+
+	// A mapping of an empty file can't be created, we also can't map files that don't fit in our address space
+	if(GetFileSizeEx(m_hFile, &iFileSize) && iFileSize.QuadPart > 0 && (unsigned long long) iFileSize.QuadPart <= (size_t) -1)
+	{
+		m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if(m_hMapping != NULL)
+		{
+			const void * pView = MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+			if(pView != NULL)
+			{
+				m_pData = static_cast<const char *>(pView);
+				m_iSize = (size_t) iFileSize.QuadPart;
+				return true;
+			}
+		}
+	}
+
+	// The file couldn't be mapped, release the handles and read the file into our own buffer instead
+	Close();
+
+	std::ifstream fileStream(sFileName.c_str(), std::ios::in | std::ios::binary);
+
+	if(!fileStream.is_open())
+		return false;
+
+	m_lFallbackBuffer.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+
+	if(!m_lFallbackBuffer.empty())
+	{
+		m_pData = &m_lFallbackBuffer[0];
+		m_iSize = m_lFallbackBuffer.size();
+	}
+
+	return true;
+}
+
+// Uses a source that's already in memory instead of a file, the source isn't copied
+void CSourceFile::Attach(const char * pData, size_t iSize)
+{
+	Close();
+
+	m_pData = pData;
+	m_iSize = iSize;
+}
+
+// Unmaps the file and releases all handles
+void CSourceFile::Close()
+{
+	// Only unmap the view if it actually belongs to the mapping
+	if(m_hMapping != NULL && m_iSize > 0)
+		UnmapViewOfFile(m_pData);
+
+	if(m_hMapping != NULL)
+		CloseHandle(m_hMapping);
+
+	if(m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+	m_pData = "";
+	m_iSize = 0;
+	m_lFallbackBuffer.clear();
+}
+
+// Returns a pointer to the first byte of the source
+const char * CSourceFile::GetData() const
+{
+	return m_pData;
+}
+
+// Returns the size of the source in bytes
+size_t CSourceFile::GetSize() const
+{
+	return m_iSize;
+}
+
+// Returns a copy of the source text at the given offset
+std::string CSourceFile::GetString(size_t iOffset, size_t iLength) const
+{
+	return std::string(m_pData + iOffset, iLength);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+//==============================================================================
+//
+// File: CSourceFile.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSourceFile class maps a source file read-only into memory so the tokenizer
+// can lex straight over the bytes of the file. Tokens only store an offset and a
+// length into these bytes, which means the source is never copied line by line
+// or token by token. Files that cannot be mapped (empty files for example) are
+// read into a buffer owned by this class instead.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class CSourceFile
+{
+	// The handle to the opened file, only valid while the file is mapped
+	void * m_hFile;
+	// The handle to the file mapping, only valid while the file is mapped
+	void * m_hMapping;
+	// Points to the first byte of the source (either the mapping or the fallback buffer)
+	const char * m_pData;
+	// The size of the source in bytes
+	size_t m_iSize;
+	// Holds the source if the file could not be mapped into memory
+	std::vector<char> m_lFallbackBuffer;
+
+	// A mapped file can't be copied, the copy would unmap the file when it's destroyed
+	CSourceFile(const CSourceFile &);
+	CSourceFile & operator=(const CSourceFile &);
+
+public:
+	// The constructor of the CSourceFile class
+	CSourceFile();
+	// The destructor unmaps the file
+	~CSourceFile();
+	// Maps the file into memory, returns false if the file could not be opened
+	bool Open(std::string sFileName);
+	// Uses a source that's already in memory instead of a file, the source isn't copied
+	// The memory has to stay valid as long as the source is used
+	void Attach(const char * pData, size_t iSize);
+	// Unmaps the file and releases all handles
+	void Close();
+	// Returns a pointer to the first byte of the source
+	const char * GetData() const;
+	// Returns the size of the source in bytes
+	size_t GetSize() const;
+	// Returns a copy of the source text at the given offset
+	std::string GetString(size_t iOffset, size_t iLength) const;
+};
\ No newline at end of file
@@ -0,0 +1,179 @@
+//==============================================================================
+//
+// File: CSymbolPool.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSymbolPool class interns the names and literals found in the source. Each
+// distinct value is stored once, in an arena, and is identified by a 32-bit symbol
+// ID. Tokens, variables and functions carry these IDs, so checking whether two
+// names are equal is an integer comparison instead of a string comparison.
+//
+//==============================================================================
+
+#include "CSymbolPool.h"
+
+#include <cstring>
+
+// The size of one block of the arena, bigger values get a block of their own
+#define SYMBOL_ARENA_BLOCK_SIZE 65536
+// The amount of slots the hash table starts with (always a power of two)
+#define SYMBOL_TABLE_INITIAL_SLOTS 1024
+
+// All interned symbols, indexed by their ID
+std::vector<CSymbolPool::CSymbol> CSymbolPool::m_lSymbols;
+// The open addressing hash table, each slot holds a symbol ID plus one (0 means the slot is empty)
+std::vector<unsigned int> CSymbolPool::m_lSlots;
+// The blocks of the arena the values are stored in
+std::vector<char *> CSymbolPool::m_lArenaBlocks;
+// The next free byte in the current arena block and the amount of bytes left in it
+char * CSymbolPool::m_pArenaPosition = NULL;
+size_t CSymbolPool::m_iArenaBytesLeft = 0;
+
+// Hashes a value (FNV-1a)
+unsigned int CSymbolPool::Hash(const char * szValue, size_t iLength)
+{
+	unsigned int iHash = 2166136261u;
+
+	for(size_t i = 0; i < iLength; i++)
+	{
+		iHash ^= (unsigned char) szValue[i];
+		iHash *= 16777619u;
+	}
+
+	return iHash;
+}
+
+// Copies a value into the arena and null terminates it
+const char * CSymbolPool::StoreInArena(const char * szValue, size_t iLength)
+{
+	size_t iBytesNeeded = iLength + 1;
+
+	// Start a new block if the value doesn't fit in the current one
+	if(iBytesNeeded > m_iArenaBytesLeft)
+	{
+		size_t iBlockSize = iBytesNeeded > SYMBOL_ARENA_BLOCK_SIZE ? iBytesNeeded : SYMBOL_ARENA_BLOCK_SIZE;
+
+		m_pArenaPosition = new char[iBlockSize];
+		m_iArenaBytesLeft = iBlockSize;
+		m_lArenaBlocks.push_back(m_pArenaPosition);
+	}
+
+	char * szStoredValue = m_pArenaPosition;
+	memcpy(szStoredValue, szValue, iLength);
+	szStoredValue[iLength] = '\0';
+
+	m_pArenaPosition += iBytesNeeded;
+	m_iArenaBytesLeft -= iBytesNeeded;
+
+	return szStoredValue;
+}
+
+// Doubles the size of the hash table
+void CSymbolPool::GrowTable()
+{
+	size_t iSlotCount = m_lSlots.empty() ? SYMBOL_TABLE_INITIAL_SLOTS : m_lSlots.size() * 2;
+	size_t iMask = iSlotCount - 1;
+
+	m_lSlots.assign(iSlotCount, 0);
+
+	// Put every symbol back into the bigger table
+	for(size_t i = 0; i < m_lSymbols.size(); i++)
+	{
+		size_t iSlot = m_lSymbols[i].m_iHash & iMask;
+
+		while(m_lSlots[iSlot] != 0)
+			iSlot = (iSlot + 1) & iMask;
+
+		m_lSlots[iSlot] = (unsigned int) i + 1;
+	}
+}
+
+// Returns the ID of a value, the value is added to the pool if it's not in there yet
+SymbolID CSymbolPool::Intern(const char * szValue, size_t iLength)
+{
+	return Intern(szValue, iLength, Hash(szValue, iLength));
+}
+
+// Returns the ID of a value whose hash (see Hash()) is already known
+SymbolID CSymbolPool::Intern(const char * szValue, size_t iLength, unsigned int iHash)
+{
+	// Keep the table at most half full, so the probe sequences stay short
+	if((m_lSymbols.size() + 1) * 2 > m_lSlots.size())
+		GrowTable();
+
+	size_t iMask = m_lSlots.size() - 1;
+	size_t iSlot = iHash & iMask;
+
+	// Walk the probe sequence until we find the value or an empty slot
+	while(m_lSlots[iSlot] != 0)
+	{
+		const CSymbol & oSymbol = m_lSymbols[m_lSlots[iSlot] - 1];
+
+		if(oSymbol.m_iHash == iHash && oSymbol.m_iLength == iLength && memcmp(oSymbol.m_szValue, szValue, iLength) == 0)
+			return m_lSlots[iSlot] - 1;
+
+		iSlot = (iSlot + 1) & iMask;
+	}
+
+	// The value isn't in the pool yet, add it
+	CSymbol oSymbol;
+	oSymbol.m_szValue = StoreInArena(szValue, iLength);
+	oSymbol.m_iLength = (unsigned int) iLength;
+	oSymbol.m_iHash = iHash;
+	m_lSymbols.push_back(oSymbol);
+
+	m_lSlots[iSlot] = (unsigned int) m_lSymbols.size();
+	return (SymbolID) m_lSymbols.size() - 1;
+}
+
+// Returns the ID of a value, the value is added to the pool if it's not in there yet
+SymbolID CSymbolPool::Intern(const std::string & sValue)
+{
+	return Intern(sValue.c_str(), sValue.length());
+}
+
+// Returns the ID of a value, or INVALID_SYMBOL_ID if the value was never interned
+SymbolID CSymbolPool::Find(const char * szValue, size_t iLength)
+{
+	if(m_lSlots.empty())
+		return INVALID_SYMBOL_ID;
+
+	unsigned int iHash = Hash(szValue, iLength);
+	size_t iMask = m_lSlots.size() - 1;
+
+	for(size_t iSlot = iHash & iMask; m_lSlots[iSlot] != 0; iSlot = (iSlot + 1) & iMask)
+	{
+		const CSymbol & oSymbol = m_lSymbols[m_lSlots[iSlot] - 1];
+
+		if(oSymbol.m_iHash == iHash && oSymbol.m_iLength == iLength && memcmp(oSymbol.m_szValue, szValue, iLength) == 0)
+			return m_lSlots[iSlot] - 1;
+	}
+
+	return INVALID_SYMBOL_ID;
+}
+
+// Returns the (null terminated) value of a symbol
+const char * CSymbolPool::GetString(SymbolID iSymbol)
+{
+	if(iSymbol >= m_lSymbols.size())
+		return "";
+
+	return m_lSymbols[iSymbol].m_szValue;
+}
+
+// Returns the length of the value of a symbol
+size_t CSymbolPool::GetLength(SymbolID iSymbol)
+{
+	if(iSymbol >= m_lSymbols.size())
+		return 0;
+
+	return m_lSymbols[iSymbol].m_iLength;
+}
+
+// Returns the amount of symbols in the pool
+size_t CSymbolPool::GetSymbolCount()
+{
+	return m_lSymbols.size();
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+//==============================================================================
+//
+// File: CSymbolPool.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSymbolPool class interns the names and literals found in the source. Each
+// distinct value is stored once, in an arena, and is identified by a 32-bit symbol
+// ID. Tokens, variables and functions carry these IDs, so checking whether two
+// names are equal is an integer comparison instead of a string comparison.
+//
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// The ID of an interned value
+typedef unsigned int SymbolID;
+
+// The symbol ID of tokens that don't have an interned value (keywords and punctuators)
+#define INVALID_SYMBOL_ID 0xFFFFFFFF
+
+// Spreads symbol IDs over a hash table (multiplicative hashing), IDs are handed out in order so they're close together
+inline size_t HashSymbolID(SymbolID iSymbol)
+{
+	return (size_t) (iSymbol * 2654435769u);
+}
+
+class CSymbolPool
+{
+	// Each symbol points to its value in the arena
+	struct CSymbol
+	{
+		// The value, it's null terminated
+		const char * m_szValue;
+		// The length of the value
+		unsigned int m_iLength;
+		// The hash of the value, saved so the table can grow without hashing every value again
+		unsigned int m_iHash;
+	};
+
+	// All interned symbols, indexed by their ID
+	static std::vector<CSymbol> m_lSymbols;
+	// The open addressing hash table, each slot holds a symbol ID plus one (0 means the slot is empty)
+	static std::vector<unsigned int> m_lSlots;
+	// The blocks of the arena the values are stored in
+	static std::vector<char *> m_lArenaBlocks;
+	// The next free byte in the current arena block and the amount of bytes left in it
+	static char * m_pArenaPosition;
+	static size_t m_iArenaBytesLeft;
+
+	// Copies a value into the arena and null terminates it
+	static const char * StoreInArena(const char * szValue, size_t iLength);
+	// Doubles the size of the hash table
+	static void GrowTable();
+
+public:
+	// Returns the ID of a value, the value is added to the pool if it's not in there yet
+	// The value doesn't have to be null terminated
+	static SymbolID Intern(const char * szValue, size_t iLength);
+	// Returns the ID of a value, the value is added to the pool if it's not in there yet
+	static SymbolID Intern(const std::string & sValue);
+	// Returns the ID of a value whose hash (see Hash()) is already known
+	// The pool isn't thread safe, but the hash can be computed on any thread
+	static SymbolID Intern(const char * szValue, size_t iLength, unsigned int iHash);
+	// Hashes a value the way the pool does
+	static unsigned int Hash(const char * szValue, size_t iLength);
+	// Returns the ID of a value, or INVALID_SYMBOL_ID if the value was never interned
+	static SymbolID Find(const char * szValue, size_t iLength);
+	// Returns the (null terminated) value of a symbol
+	static const char * GetString(SymbolID iSymbol);
+	// Returns the length of the value of a symbol
+	static size_t GetLength(SymbolID iSymbol);
+	// Returns the amount of symbols in the pool
+	static size_t GetSymbolCount();
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+//==============================================================================
+//
+// File: CSymbolTable.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSymbolTable class binds variable names to variables, scope by scope. A
+// scope is entered on { and exited on }. A name declared in a scope shadows the
+// same name in the scopes around it until the scope is exited, then the outer
+// binding is visible again. Every name has one slot in an open addressing hash
+// table, which always points to the innermost binding of that name, so looking
+// up a name is a single probe no matter how deep the scopes are nested.
+//
+//==============================================================================
+
+#include "CSymbolTable.h"
+
+// The amount of slots the hash table starts with (always a power of two)
+#define SYMBOL_TABLE_SCOPE_INITIAL_SLOTS 256
+
+// Creates a table with only the scope of the script itself
+CSymbolTable::CSymbolTable()
+{
+	m_iNameCount = 0;
+	m_lSlots.assign(SYMBOL_TABLE_SCOPE_INITIAL_SLOTS, 0);
+	m_lScopeStarts.push_back(0);
+}
+
+// Returns the slot of a name, this is either the slot holding the name or the empty slot it would go in
+size_t CSymbolTable::FindSlot(SymbolID iName) const
+{
+	size_t iMask = m_lSlots.size() - 1;
+	size_t iSlot = HashSymbolID(iName) & iMask;
+
+	// Walk the probe sequence until we find the name or an empty slot
+	while(m_lSlots[iSlot] != 0 && m_lBindings[m_lSlots[iSlot] - 1].m_iName != iName)
+		iSlot = (iSlot + 1) & iMask;
+
+	return iSlot;
+}
+
+// Doubles the size of the hash table
+void CSymbolTable::GrowTable()
+{
+	std::vector<unsigned int> lOldSlots;
+	lOldSlots.swap(m_lSlots);
+
+	size_t iMask = lOldSlots.size() * 2 - 1;
+	m_lSlots.assign(lOldSlots.size() * 2, 0);
+
+	// Put every name back into the bigger table, the names are distinct so we only need an empty slot
+	for(size_t i = 0; i < lOldSlots.size(); i++)
+	{
+		if(lOldSlots[i] == 0)
+			continue;
+
+		size_t iSlot = HashSymbolID(m_lBindings[lOldSlots[i] - 1].m_iName) & iMask;
+
+		while(m_lSlots[iSlot] != 0)
+			iSlot = (iSlot + 1) & iMask;
+
+		m_lSlots[iSlot] = lOldSlots[i];
+	}
+}
+
+// Opens a new scope, on {
+void CSymbolTable::EnterScope()
+{
+	m_lScopeStarts.push_back(m_lOpenBindings.size());
+}
+
+// Closes the innermost scope, on }, the names declared in it aren't in scope anymore
+void CSymbolTable::ExitScope()
+{
+	// The scope of the script itself is never closed
+	if(m_lScopeStarts.size() <= 1)
+		return;
+
+	size_t iScopeStart = m_lScopeStarts.back();
+	m_lScopeStarts.pop_back();
+
+	// Unbind the names of this scope, the last declared first
+	while(m_lOpenBindings.size() > iScopeStart)
+	{
+		unsigned int iBinding = m_lOpenBindings.back();
+		m_lOpenBindings.pop_back();
+
+		CBinding & oBinding = m_lBindings[iBinding];
+		oBinding.m_bInScope = false;
+
+		// Make the shadowed binding visible again. If nothing was shadowed, the slot keeps
+		// pointing to this binding so a lookup can tell the name was declared in a closed scope
+		if(oBinding.m_iShadowed != INVALID_BINDING)
+			m_lSlots[FindSlot(oBinding.m_iName)] = oBinding.m_iShadowed + 1;
+	}
+}
+
+// Binds a name to a variable in the innermost scope
+bool CSymbolTable::Declare(SymbolID iName, size_t iVariable)
+{
+	// Keep the table at most half full, so the probe sequences stay short
+	if((m_iNameCount + 1) * 2 > m_lSlots.size())
+		GrowTable();
+
+	size_t iSlot = FindSlot(iName);
+	unsigned int iShadowed = INVALID_BINDING;
+
+	if(m_lSlots[iSlot] == 0)
+		m_iNameCount++;
+
+	else
+	{
+		const CBinding & oInnermost = m_lBindings[m_lSlots[iSlot] - 1];
+
+		// Only bindings that are still in scope can be shadowed
+		if(oInnermost.m_bInScope)
+		{
+			// Declared twice in the same scope
+			if(oInnermost.m_iScopeDepth == GetScopeDepth())
+				return false;
+
+			iShadowed = m_lSlots[iSlot] - 1;
+		}
+	}
+
+	CBinding oBinding;
+	oBinding.m_iName = iName;
+	oBinding.m_iVariable = iVariable;
+	oBinding.m_iShadowed = iShadowed;
+	oBinding.m_iScopeDepth = GetScopeDepth();
+	oBinding.m_bInScope = true;
+	m_lBindings.push_back(oBinding);
+
+	unsigned int iBinding = (unsigned int) m_lBindings.size() - 1;
+	m_lOpenBindings.push_back(iBinding);
+	m_lSlots[iSlot] = iBinding + 1;
+	return true;
+}
+
+// Returns the innermost binding of a name, or NULL if the name was never declared
+const CBinding * CSymbolTable::Find(SymbolID iName) const
+{
+	size_t iSlot = FindSlot(iName);
+
+	if(m_lSlots[iSlot] == 0)
+		return NULL;
+
+	return &m_lBindings[m_lSlots[iSlot] - 1];
+}
\ No newline at end of file
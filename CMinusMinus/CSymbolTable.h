@@ -0,0 +1,76 @@
+//==============================================================================
+//
+// File: CSymbolTable.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CSymbolTable class binds variable names to variables, scope by scope. A
+// scope is entered on { and exited on }. A name declared in a scope shadows the
+// same name in the scopes around it until the scope is exited, then the outer
+// binding is visible again. Every name has one slot in an open addressing hash
+// table, which always points to the innermost binding of that name, so looking
+// up a name is a single probe no matter how deep the scopes are nested.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include "CSymbolPool.h"
+
+// The binding index of a name that was never declared
+#define INVALID_BINDING 0xFFFFFFFF
+
+// A name bound to a variable in a scope
+struct CBinding
+{
+	// The name of the variable
+	SymbolID m_iName;
+	// The index of the variable (in the variable list of the analyzer)
+	size_t m_iVariable;
+	// The binding of the same name this binding shadows, INVALID_BINDING if none
+	unsigned int m_iShadowed;
+	// The depth of the scope the name is declared in, 0 is the script itself
+	int m_iScopeDepth;
+	// False once the scope the name is declared in has been exited
+	bool m_bInScope;
+};
+
+class CSymbolTable
+{
+	// Every binding ever made, in the order of the declarations
+	std::vector<CBinding> m_lBindings;
+	// The open addressing hash table, each slot holds the innermost binding of a name plus one (0 means the slot is empty)
+	std::vector<unsigned int> m_lSlots;
+	// The amount of distinct names in the hash table
+	size_t m_iNameCount;
+	// The bindings of the scopes that are still open, innermost last
+	std::vector<unsigned int> m_lOpenBindings;
+	// For every open scope, where its bindings start on m_lOpenBindings
+	std::vector<size_t> m_lScopeStarts;
+
+	// Returns the slot of a name, this is either the slot holding the name or the empty slot it would go in
+	size_t FindSlot(SymbolID iName) const;
+	// Doubles the size of the hash table
+	void GrowTable();
+
+public:
+	// Creates a table with only the scope of the script itself
+	CSymbolTable();
+
+	// Opens a new scope, on {
+	void EnterScope();
+	// Closes the innermost scope, on }, the names declared in it aren't in scope anymore
+	void ExitScope();
+	// Returns the depth of the innermost scope, 0 is the script itself
+	int GetScopeDepth() const { return (int) m_lScopeStarts.size() - 1; }
+
+	// Binds a name to a variable in the innermost scope
+	// Returns false if the name is already declared in that scope
+	bool Declare(SymbolID iName, size_t iVariable);
+	// Returns the innermost binding of a name, or NULL if the name was never declared
+	// The binding may belong to a scope that was exited, check m_bInScope
+	// The pointer is valid until the next declaration
+	const CBinding * Find(SymbolID iName) const;
+};
\ No newline at end of file
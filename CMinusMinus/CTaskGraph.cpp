@@ -0,0 +1,190 @@
+//==============================================================================
+//
+// File: CTaskGraph.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTaskGraph class runs tasks that depend on each other on a CThreadPool. A
+// task starts once every task it depends on is done. Every thread has a queue
+// of its own: it pushes the tasks it made ready onto it and takes them back from
+// the same end, when its queue is empty it steals from the other end of the
+// queues of the other threads.
+//
+//==============================================================================
+
+#include "CTaskGraph.h"
+
+#include <windows.h>
+
+// Creates a graph of iTaskCount tasks without any dependencies
+CTaskGraph::CTaskGraph(size_t iTaskCount)
+{
+	m_iTaskCount = iTaskCount;
+	m_iTasksDone = 0;
+	m_pfnTask = NULL;
+	m_pContext = NULL;
+}
+
+// Makes iTask wait for iDependency, a task can only depend on a task that comes before it
+void CTaskGraph::AddDependency(size_t iTask, size_t iDependency)
+{
+	// A task that waits for a later task (or itself) would never start
+	if(iDependency >= iTask || iTask >= m_iTaskCount)
+		return;
+
+	m_lDependencies.push_back(std::make_pair(iDependency, iTask));
+}
+
+// Pushes a task onto the back of a queue
+void CTaskGraph::PushTask(size_t iQueue, size_t iTask)
+{
+	CTaskQueue & oQueue = m_lQueues[iQueue];
+
+	LockSpinLock(&oQueue.m_iLock);
+	oQueue.m_lTasks.push_back(iTask);
+	oQueue.m_iQueuedTasks++;
+	UnlockSpinLock(&oQueue.m_iLock);
+}
+
+// Takes the task at the back of a queue, returns false if the queue is empty
+bool CTaskGraph::PopTask(size_t iQueue, size_t & iTask)
+{
+	CTaskQueue & oQueue = m_lQueues[iQueue];
+	bool bFound = false;
+
+	LockSpinLock(&oQueue.m_iLock);
+
+	if(oQueue.m_lTasks.size() > oQueue.m_iFirst)
+	{
+		iTask = oQueue.m_lTasks.back();
+		oQueue.m_lTasks.pop_back();
+		oQueue.m_iQueuedTasks--;
+		bFound = true;
+	}
+
+	// Start at the beginning again once the queue is empty, so it doesn't keep growing
+	if(oQueue.m_lTasks.size() == oQueue.m_iFirst)
+	{
+		oQueue.m_lTasks.clear();
+		oQueue.m_iFirst = 0;
+	}
+
+	UnlockSpinLock(&oQueue.m_iLock);
+	return bFound;
+}
+
+// Takes the task at the front of one of the other queues, returns false if they're all empty
+bool CTaskGraph::StealTask(size_t iQueue, size_t & iTask)
+{
+	for(size_t i = 1; i < m_lQueues.size(); i++)
+	{
+		CTaskQueue & oQueue = m_lQueues[(iQueue + i) % m_lQueues.size()];
+
+		// Don't bother taking the lock of an empty queue
+		if(oQueue.m_iQueuedTasks == 0)
+			continue;
+
+		LockSpinLock(&oQueue.m_iLock);
+
+		if(oQueue.m_lTasks.size() > oQueue.m_iFirst)
+		{
+			iTask = oQueue.m_lTasks[oQueue.m_iFirst++];
+			oQueue.m_iQueuedTasks--;
+			UnlockSpinLock(&oQueue.m_iLock);
+			return true;
+		}
+
+		UnlockSpinLock(&oQueue.m_iLock);
+	}
+
+	return false;
+}
+
+// Runs tasks until every task is done, iWorker is the queue of the thread
+void CTaskGraph::RunWorker(size_t iWorker)
+{
+	while(m_iTasksDone < (long) m_iTaskCount)
+	{
+		size_t iTask;
+
+		// Nothing to do right now, give the other threads a chance to finish the tasks we're waiting for
+		if(!PopTask(iWorker, iTask) && !StealTask(iWorker, iTask))
+		{
+			SwitchToThread();
+			continue;
+		}
+
+		m_pfnTask(m_pContext, iTask);
+
+		// The tasks that only waited for this one can start now, we'll most likely pick them up ourselves
+		for(size_t i = m_lDependentStarts[iTask]; i < m_lDependentStarts[iTask + 1]; i++)
+		{
+			if(InterlockedDecrement(&m_lWaitingFor[m_lDependents[i]]) == 0)
+				PushTask(iWorker, m_lDependents[i]);
+		}
+
+		InterlockedIncrement(&m_iTasksDone);
+	}
+}
+
+// The task every thread of the pool runs
+void CTaskGraph::WorkerTask(void * pTaskGraph, size_t iWorker)
+{
+	((CTaskGraph *) pTaskGraph)->RunWorker(iWorker);
+}
+
+// Runs every task on the threads of the pool, and waits until all of them are done
+void CTaskGraph::Run(CThreadPool & oThreadPool, ThreadPoolTask pfnTask, void * pContext)
+{
+	m_pfnTask = pfnTask;
+	m_pContext = pContext;
+	m_iTasksDone = 0;
+
+	// Count the dependencies of every task, and the tasks that depend on every task
+	m_lWaitingFor.assign(m_iTaskCount, 0);
+	m_lDependentStarts.assign(m_iTaskCount + 1, 0);
+
+	for(size_t i = 0; i < m_lDependencies.size(); i++)
+	{
+		m_lDependentStarts[m_lDependencies[i].first + 1]++;
+		m_lWaitingFor[m_lDependencies[i].second]++;
+	}
+
+	for(size_t i = 0; i < m_iTaskCount; i++)
+		m_lDependentStarts[i + 1] += m_lDependentStarts[i];
+
+	// Put the dependent tasks in the lists, in the order the dependencies were added
+	std::vector<size_t> lPositions(m_lDependentStarts.begin(), m_lDependentStarts.end() - 1);
+	m_lDependents.resize(m_lDependencies.size());
+
+	for(size_t i = 0; i < m_lDependencies.size(); i++)
+		m_lDependents[lPositions[m_lDependencies[i].first]++] = m_lDependencies[i].second;
+
+	// Hand the tasks that can start right away out over the queues in blocks, so every
+	// thread starts on a stretch of the tasks. They're pushed in reverse, the back is taken first
+	size_t iThreadCount = (size_t) oThreadPool.GetThreadCount();
+	m_lQueues.resize(iThreadCount);
+
+	for(size_t i = 0; i < iThreadCount; i++)
+	{
+		m_lQueues[i].m_iLock = 0;
+		m_lQueues[i].m_lTasks.clear();
+		m_lQueues[i].m_iFirst = 0;
+		m_lQueues[i].m_iQueuedTasks = 0;
+	}
+
+	size_t iBlockSize = (m_iTaskCount + iThreadCount - 1) / iThreadCount;
+
+	for(size_t i = m_iTaskCount; i-- > 0; )
+	{
+		if(m_lWaitingFor[i] == 0)
+		{
+			m_lQueues[i / iBlockSize].m_lTasks.push_back(i);
+			m_lQueues[i / iBlockSize].m_iQueuedTasks++;
+		}
+	}
+
+	// Every thread of the pool runs the worker loop with a queue of its own
+	oThreadPool.Run(WorkerTask, this, iThreadCount);
+}
\ No newline at end of file
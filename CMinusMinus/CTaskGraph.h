@@ -0,0 +1,80 @@
+//==============================================================================
+//
+// File: CTaskGraph.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTaskGraph class runs tasks that depend on each other on a CThreadPool. A
+// task starts once every task it depends on is done. Every thread has a queue
+// of its own: it pushes the tasks it made ready onto it and takes them back from
+// the same end, when its queue is empty it steals from the other end of the
+// queues of the other threads.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include "CThreadPool.h"
+
+class CTaskGraph
+{
+	// The queue of one thread, the thread pushes and pops at the back, other threads steal from the front
+	struct CTaskQueue
+	{
+		// 1 while a thread uses the queue
+		volatile long m_iLock;
+		// The tasks in the queue are m_lTasks[m_iFirst] up to the end
+		std::vector<size_t> m_lTasks;
+		size_t m_iFirst;
+		// The amount of tasks in the queue, other threads check it before they take the lock
+		volatile long m_iQueuedTasks;
+		// Keep the queues of two threads out of one cache line
+		char m_aPadding[64];
+	};
+
+	// The dependencies as they were added, task second depends on task first
+	std::vector<std::pair<size_t, size_t> > m_lDependencies;
+	// The tasks that depend on task i are m_lDependents[m_lDependentStarts[i]] up to m_lDependentStarts[i + 1]
+	std::vector<size_t> m_lDependentStarts;
+	std::vector<size_t> m_lDependents;
+	// For every task, the amount of tasks it still waits for
+	std::vector<long> m_lWaitingFor;
+	// One queue for every thread
+	std::vector<CTaskQueue> m_lQueues;
+	// The amount of tasks, and the amount of tasks that are done
+	size_t m_iTaskCount;
+	volatile long m_iTasksDone;
+
+	// The function that runs a task, and the context it gets
+	ThreadPoolTask m_pfnTask;
+	void * m_pContext;
+
+	// Pushes a task onto the back of a queue
+	void PushTask(size_t iQueue, size_t iTask);
+	// Takes the task at the back of a queue, returns false if the queue is empty
+	bool PopTask(size_t iQueue, size_t & iTask);
+	// Takes the task at the front of one of the other queues, returns false if they're all empty
+	bool StealTask(size_t iQueue, size_t & iTask);
+	// Runs tasks until every task is done, iWorker is the queue of the thread
+	void RunWorker(size_t iWorker);
+	// The task every thread of the pool runs
+	static void WorkerTask(void * pTaskGraph, size_t iWorker);
+
+	// The graph can't be copied
+	CTaskGraph(const CTaskGraph &);
+	CTaskGraph & operator=(const CTaskGraph &);
+
+public:
+	// Creates a graph of iTaskCount tasks without any dependencies
+	CTaskGraph(size_t iTaskCount);
+	// Makes iTask wait for iDependency, a task can only depend on a task that comes before it
+	void AddDependency(size_t iTask, size_t iDependency);
+	// Runs every task on the threads of the pool, and waits until all of them are done
+	void Run(CThreadPool & oThreadPool, ThreadPoolTask pfnTask, void * pContext);
+	// Returns the amount of dependencies
+	size_t GetDependencyCount() const { return m_lDependencies.size(); }
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+//==============================================================================
+//
+// File: CThreadPool.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CThreadPool class runs a batch of tasks on a fixed set of worker threads.
+// The threads are created once and wait for work in between batches. The thread
+// that calls Run() helps with the tasks and returns when every task is done.
+// The spin lock the threads share data with is here as well.
+//
+//==============================================================================
+
+#include "CThreadPool.h"
+
+#include <windows.h>
+#include <process.h>
+
+// Creates a pool, the calling thread counts as one of the threads so iThreadCount - 1 workers are created
+CThreadPool::CThreadPool(int iThreadCount)
+{
+	m_pfnTask = NULL;
+	m_pContext = NULL;
+	m_iTaskCount = 0;
+	m_iNextTask = 0;
+	m_iBusyWorkers = 0;
+	m_bStopping = 0;
+
+	m_hWorkSemaphore = CreateSemaphore(NULL, 0, iThreadCount > 1 ? iThreadCount : 1, NULL);
+	m_hDoneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+	for(int i = 1; i < iThreadCount; i++)
+	{
+		void * hThread = (void *) _beginthreadex(NULL, 0, WorkerThread, this, 0, NULL);
+
+		// We'll just have to do with less threads
+		if(hThread == NULL)
+			break;
+
+		m_lThreads.push_back(hThread);
+	}
+}
+
+// Stops and closes the worker threads
+CThreadPool::~CThreadPool()
+{
+	// Wake every worker up, they'll see the stop flag and exit
+	InterlockedExchange(&m_bStopping, 1);
+
+	if(!m_lThreads.empty())
+		ReleaseSemaphore(m_hWorkSemaphore, (LONG) m_lThreads.size(), NULL);
+
+	// WaitForMultipleObjects() can't wait for more than 64 threads, wait for them one by one
+	for(size_t i = 0; i < m_lThreads.size(); i++)
+	{
+		WaitForSingleObject(m_lThreads[i], INFINITE);
+		CloseHandle(m_lThreads[i]);
+	}
+
+	CloseHandle(m_hWorkSemaphore);
+	CloseHandle(m_hDoneEvent);
+}
+
+// Picks up tasks until there are none left
+void CThreadPool::RunTasks()
+{
+	while(true)
+	{
+		long iTask = InterlockedIncrement(&m_iNextTask) - 1;
+
+		if(iTask >= m_iTaskCount)
+			break;
+
+		m_pfnTask(m_pContext, (size_t) iTask);
+	}
+}
+
+// The function every worker thread runs
+unsigned __stdcall CThreadPool::WorkerThread(void * pThreadPool)
+{
+	CThreadPool * pPool = (CThreadPool *) pThreadPool;
+
+	while(true)
+	{
+		// Wait until there's a batch to run
+		WaitForSingleObject(pPool->m_hWorkSemaphore, INFINITE);
+
+		if(pPool->m_bStopping)
+			break;
+
+		pPool->RunTasks();
+
+		// The last worker to finish tells Run() the batch is done
+		if(InterlockedDecrement(&pPool->m_iBusyWorkers) == 0)
+			SetEvent(pPool->m_hDoneEvent);
+	}
+
+	return 0;
+}
+
+// Runs iTaskCount tasks and waits until all of them are done
+void CThreadPool::Run(ThreadPoolTask pfnTask, void * pContext, size_t iTaskCount)
+{
+	m_pfnTask = pfnTask;
+	m_pContext = pContext;
+	m_iTaskCount = (long) iTaskCount;
+	m_iNextTask = 0;
+	m_iBusyWorkers = (long) m_lThreads.size();
+
+	// Make sure the workers see the batch before they're woken up
+	MemoryBarrier();
+
+	if(!m_lThreads.empty())
+		ReleaseSemaphore(m_hWorkSemaphore, (LONG) m_lThreads.size(), NULL);
+
+	// Help out, then wait for the workers
+	RunTasks();
+
+	if(!m_lThreads.empty())
+		WaitForSingleObject(m_hDoneEvent, INFINITE);
+}
+
+// Returns the amount of logical processors of the machine
+int CThreadPool::GetProcessorCount()
+{
+	SYSTEM_INFO oSystemInfo;
+	GetSystemInfo(&oSystemInfo);
+
+	return oSystemInfo.dwNumberOfProcessors > 0 ? (int) oSystemInfo.dwNumberOfProcessors : 1;
+}
+
+// Takes a spin lock, the lock is only held for a couple of instructions so we spin instead of waiting
+void LockSpinLock(volatile long * pLock)
+{
+	while(InterlockedExchange(pLock, 1) != 0)
+	{
+		// Let the thread that holds the lock finish, it may be waiting for our processor
+		while(*pLock != 0)
+			SwitchToThread();
+	}
+}
+
+// Releases a spin lock
+void UnlockSpinLock(volatile long * pLock)
+{
+	InterlockedExchange(pLock, 0);
+}
\ No newline at end of file
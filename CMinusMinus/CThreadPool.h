@@ -0,0 +1,68 @@
+//==============================================================================
+//
+// File: CThreadPool.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CThreadPool class runs a batch of tasks on a fixed set of worker threads.
+// The threads are created once and wait for work in between batches. The thread
+// that calls Run() helps with the tasks and returns when every task is done.
+// The spin lock the threads share data with is here as well.
+//
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// A task gets the context that was passed to Run() and the index of the task
+typedef void (* ThreadPoolTask)(void * pContext, size_t iTask);
+
+class CThreadPool
+{
+	// The handles of the worker threads
+	std::vector<void *> m_lThreads;
+	// Released once for every worker when a batch starts
+	void * m_hWorkSemaphore;
+	// Set when every worker finished the batch
+	void * m_hDoneEvent;
+
+	// The batch that's being run
+	ThreadPoolTask m_pfnTask;
+	void * m_pContext;
+	long m_iTaskCount;
+	// The next task that hasn't been picked up yet
+	volatile long m_iNextTask;
+	// The amount of workers that haven't finished the batch yet
+	volatile long m_iBusyWorkers;
+	// Set when the pool is destroyed
+	volatile long m_bStopping;
+
+	// Picks up tasks until there are none left
+	void RunTasks();
+	// The function every worker thread runs
+	static unsigned __stdcall WorkerThread(void * pThreadPool);
+
+	// The threads can't be copied
+	CThreadPool(const CThreadPool &);
+	CThreadPool & operator=(const CThreadPool &);
+
+public:
+	// Creates a pool, the calling thread counts as one of the threads so iThreadCount - 1 workers are created
+	CThreadPool(int iThreadCount);
+	// Stops and closes the worker threads
+	~CThreadPool();
+	// Runs iTaskCount tasks and waits until all of them are done
+	void Run(ThreadPoolTask pfnTask, void * pContext, size_t iTaskCount);
+	// Returns the amount of threads that run the tasks (including the calling thread)
+	int GetThreadCount() const { return (int) m_lThreads.size() + 1; }
+	// Returns the amount of logical processors of the machine
+	static int GetProcessorCount();
+};
+
+// Takes a spin lock, for data that's only held for a couple of instructions
+void LockSpinLock(volatile long * pLock);
+// Releases a spin lock
+void UnlockSpinLock(volatile long * pLock);
\ No newline at end of file
@@ -5,70 +5,47 @@
 // Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
 // License: See LICENSE in root directory
 // 
-// This file contains the CToken struct, this structure holds the line the token was
-// found on, the value for the token (needed for var names etc), and the actual token type
+// This file contains the CToken class, a handle to one token in a CTokenBuffer.
+// It gives access to the line the token was found on, where the value for the
+// token can be found in the source (needed for var names etc), and the actual
+// token type. A handle is only a pointer and an index, so it's cheap to copy.
+// Handles past either end of the buffer (or to a token that already left the
+// window of a streaming tokenizer) behave like an INVALID_TOKEN_TYPE token.
 //
 //==============================================================================
 
 #pragma once
 
-#include "CIndentation.h"
-#include <vector>
+#include "CTokenBuffer.h"
 
-// List of all possible tokens
-enum eTokenType
+// The token handle
+class CToken
 {
-	// Invalid token types, the default for the CToken class
-	INVALID_TOKEN_TYPE = -1,
-	// "{"
-	OPEN_CURLY_BRACKET_TOKEN,
-	// "}"
-	CLOSE_CURLY_BRACKET_TOKEN,
-	// "("
-	OPEN_BRACKET_TOKEN,
-	// ")"
-	CLOSE_BRACKET_TOKEN,
-	// ","
-	COMMA_TOKEN,
-	// ";"
-	SEMICOLON_TOKEN,
-	// "="
-	EQUALSIGN_TOKEN,
-	// "int"
-	INTEGER_TYPE_TOKEN,
-	// "float"
-	FLOAT_TYPE_TOKEN,
-	// "string"
-	STRING_TYPE_TOKEN,
-	// """
-	DOUBLE_QUOTE_TOKEN,
-	// Any string literal
-	STRING_LITERAL_TOKEN,
-	// "+"
-	PLUS_OPERATOR_TOKEN,
-	// "-"
-	MINUS_OPERATOR_TOKEN,
-	// Token for the variable or function name
-	VALUE_TOKEN
-};
+	// The buffer the token is stored in, NULL for an invalid token
+	const CTokenBuffer * m_pTokenBuffer;
+	// The index of the token in the buffer
+	size_t m_iIndex;
 
-// The token struct
-struct CToken
-{
+public:
+	// The default constructor for the CToken class, creates an INVALID_TOKEN_TYPE token
+	CToken::CToken(): m_pTokenBuffer(NULL), m_iIndex(0) { }
+	// Creates a handle to a token in a buffer
+	CToken::CToken(const CTokenBuffer & oTokenBuffer, size_t iIndex): m_pTokenBuffer(&oTokenBuffer), m_iIndex(iIndex) { }
+
+	// Returns true if the handle points to a token in the buffer
+	bool IsValid() const { return m_pTokenBuffer != NULL && m_pTokenBuffer->IsAvailable(m_iIndex); }
 	// Which type of token is this?
-	eTokenType m_iTokenType;
-	// We also save the "value" of the token, for example when we have a VALUE_TOKEN
-	// (which means it's either a variable or function name) we want to save the name of this
-	// var or function
-	std::string m_sValue;
+	eTokenType GetType() const { return IsValid() ? m_pTokenBuffer->GetType(m_iIndex) : INVALID_TOKEN_TYPE; }
+	// Variable names, function names, values and string literals are interned (see CSymbolPool),
+	// this returns the symbol ID of the value. Keywords and punctuators have INVALID_SYMBOL_ID as symbol ID
+	SymbolID GetSymbol() const { return IsValid() ? m_pTokenBuffer->GetSymbol(m_iIndex) : INVALID_SYMBOL_ID; }
+	// The value of INTEGER_LITERAL_TOKEN and FLOAT_LITERAL_TOKEN tokens, the tokenizer parses it once
+	// so the parser never has to look at the digits again
+	int GetIntegerValue() const { return IsValid() ? m_pTokenBuffer->GetIntegerValue(m_iIndex) : 0; }
+	double GetFloatValue() const { return IsValid() ? m_pTokenBuffer->GetFloatValue(m_iIndex) : 0.0; }
 	// Which line of the source was the token found on? Used in the CCMinusMinus, so when we output
 	// errors we can also output the line the error occured on
-	int m_iLine;
+	int GetLine() const { return IsValid() ? m_pTokenBuffer->GetLine(m_iIndex) : 0; }
 	// The indentation level the CToken is on
-	CIndentation m_oIndentation;
-
-	// The default constructor for the CToken class, sets the token type to INVALID_TOKEN_TYPE
-	CToken::CToken(): m_iTokenType(INVALID_TOKEN_TYPE), m_oIndentation(INVALID_INDENTATION_LEVEL, INVALID_INDENTATION_ID) { }
-};
-
-typedef std::vector<CToken> TokenList;
\ No newline at end of file
+	CIndentation GetIndentation() const { return IsValid() ? m_pTokenBuffer->GetIndentation(m_iIndex) : CIndentation(INVALID_INDENTATION_LEVEL, INVALID_INDENTATION_ID); }
+};
\ No newline at end of file
@@ -0,0 +1,274 @@
+//==============================================================================
+//
+// File: CTokenBuffer.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTokenBuffer class stores the tokens the tokenizer found. Instead of a list
+// of token structures, every field has its own array (structure of arrays): one
+// byte for the type and 32 bits for the offset, length, line, scope and payload.
+// The parser walks the buffer by index through the CToken handle (see CToken.h),
+// nothing is copied. When the tokenizer streams its tokens the buffer only keeps
+// a window of the most recent tokens, the arrays are then used as ring buffers.
+//
+//==============================================================================
+
+#include "CTokenBuffer.h"
+
+// The smallest window the buffer keeps while streaming
+#define MIN_TOKEN_WINDOW_SIZE 16
+
+// The constructor of the CTokenBuffer class, by default every token is kept
+CTokenBuffer::CTokenBuffer()
+{
+	m_iTokenCount = 0;
+	m_iNumberLiteralCount = 0;
+	m_iScopeCount = 0;
+	m_iWindowSize = 0;
+	m_iTokenMask = (size_t) -1;
+	m_iScopeMask = (size_t) -1;
+	m_iReleasedTokens = 0;
+}
+
+// Reserves room for an amount of tokens
+void CTokenBuffer::Reserve(size_t iTokenCount)
+{
+	// A window never grows this way
+	if(m_iWindowSize != 0)
+		return;
+
+	m_lTypes.reserve(iTokenCount);
+	m_lOffsets.reserve(iTokenCount);
+	m_lLengths.reserve(iTokenCount);
+	m_lLines.reserve(iTokenCount);
+	m_lScopes.reserve(iTokenCount);
+	m_lPayloads.reserve(iTokenCount);
+}
+
+// Only keep a window of the most recent tokens (rounded up to a power of two)
+void CTokenBuffer::SetWindowSize(size_t iWindowSize)
+{
+	m_iWindowSize = MIN_TOKEN_WINDOW_SIZE;
+
+	while(m_iWindowSize < iWindowSize)
+		m_iWindowSize *= 2;
+
+	m_iTokenMask = m_iWindowSize - 1;
+
+	// Every bracket starts a new indentation level ID, so the tokens in the window
+	// never use more than m_iWindowSize + 1 IDs
+	m_iScopeMask = m_iWindowSize * 2 - 1;
+
+	m_lTypes.assign(m_iWindowSize, (uint8_t) INVALID_TOKEN_TYPE);
+	m_lOffsets.assign(m_iWindowSize, 0);
+	m_lLengths.assign(m_iWindowSize, 0);
+	m_lLines.assign(m_iWindowSize, 0);
+	m_lScopes.assign(m_iWindowSize, 0);
+	m_lPayloads.assign(m_iWindowSize, INVALID_SYMBOL_ID);
+	m_lScopeLevels.assign(m_iWindowSize * 2, INVALID_INDENTATION_LEVEL);
+	m_lNumberLiterals.resize(m_iWindowSize);
+}
+
+// Tells the buffer the tokens before iToken aren't needed anymore
+void CTokenBuffer::Release(size_t iToken)
+{
+	if(iToken > m_iTokenCount)
+		iToken = m_iTokenCount;
+
+	if(iToken > m_iReleasedTokens)
+		m_iReleasedTokens = iToken;
+}
+
+// Makes sure a token can be pushed without overwriting a token that's still needed
+void CTokenBuffer::MakeRoom()
+{
+	if(m_iWindowSize != 0 && m_iTokenCount - m_iReleasedTokens >= m_iWindowSize)
+		GrowWindow();
+}
+
+// Doubles the window, this happens when more tokens are needed at once than fit in the window
+// (for example a function call with more arguments than the window holds)
+void CTokenBuffer::GrowWindow()
+{
+	size_t iOldMask = m_iTokenMask;
+	size_t iOldScopeMask = m_iScopeMask;
+	size_t iNewWindowSize = m_iWindowSize * 2;
+	size_t iNewMask = iNewWindowSize - 1;
+	size_t iNewScopeMask = iNewWindowSize * 2 - 1;
+
+	std::vector<uint8_t> lTypes(iNewWindowSize, (uint8_t) INVALID_TOKEN_TYPE);
+	std::vector<uint32_t> lOffsets(iNewWindowSize, 0);
+	std::vector<uint32_t> lLengths(iNewWindowSize, 0);
+	std::vector<uint32_t> lLines(iNewWindowSize, 0);
+	std::vector<uint32_t> lScopes(iNewWindowSize, 0);
+	std::vector<uint32_t> lPayloads(iNewWindowSize, INVALID_SYMBOL_ID);
+	std::vector<int> lScopeLevels(iNewWindowSize * 2, INVALID_INDENTATION_LEVEL);
+	std::vector<CNumberLiteral> lNumberLiterals(iNewWindowSize);
+
+	// Move the tokens that are in the window to their place in the bigger window
+	for(size_t i = m_iTokenCount > m_iWindowSize ? m_iTokenCount - m_iWindowSize : 0; i < m_iTokenCount; i++)
+	{
+		lTypes[i & iNewMask] = m_lTypes[i & iOldMask];
+		lOffsets[i & iNewMask] = m_lOffsets[i & iOldMask];
+		lLengths[i & iNewMask] = m_lLengths[i & iOldMask];
+		lLines[i & iNewMask] = m_lLines[i & iOldMask];
+		lScopes[i & iNewMask] = m_lScopes[i & iOldMask];
+		lPayloads[i & iNewMask] = m_lPayloads[i & iOldMask];
+	}
+
+	// The same for the number literals and the indentation levels
+	for(size_t i = m_iNumberLiteralCount > m_iWindowSize ? m_iNumberLiteralCount - m_iWindowSize : 0; i < m_iNumberLiteralCount; i++)
+		lNumberLiterals[i & iNewMask] = m_lNumberLiterals[i & iOldMask];
+
+	for(size_t i = m_iScopeCount > m_iWindowSize * 2 ? m_iScopeCount - m_iWindowSize * 2 : 0; i < m_iScopeCount; i++)
+		lScopeLevels[i & iNewScopeMask] = m_lScopeLevels[i & iOldScopeMask];
+
+	m_lTypes.swap(lTypes);
+	m_lOffsets.swap(lOffsets);
+	m_lLengths.swap(lLengths);
+	m_lLines.swap(lLines);
+	m_lScopes.swap(lScopes);
+	m_lPayloads.swap(lPayloads);
+	m_lScopeLevels.swap(lScopeLevels);
+	m_lNumberLiterals.swap(lNumberLiterals);
+
+	m_iWindowSize = iNewWindowSize;
+	m_iTokenMask = iNewMask;
+	m_iScopeMask = iNewScopeMask;
+}
+
+// Pushes a token onto the arrays
+void CTokenBuffer::PushToken(eTokenType eType, size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, uint32_t iPayload)
+{
+	MakeRoom();
+
+	// The indentation level ID only ever goes up, the first token with a new ID tells us its level
+	size_t iLevelID = (size_t) oIndentation.m_iLevelID;
+
+	if(iLevelID >= m_iScopeCount)
+	{
+		m_iScopeCount = iLevelID + 1;
+
+		if(m_iWindowSize == 0)
+			m_lScopeLevels.resize(m_iScopeCount, INVALID_INDENTATION_LEVEL);
+	}
+
+	m_lScopeLevels[iLevelID & m_iScopeMask] = oIndentation.m_iLevel;
+
+	// Every token is kept, append the token to the arrays
+	if(m_iWindowSize == 0)
+	{
+		m_lTypes.push_back((uint8_t) eType);
+		m_lOffsets.push_back((uint32_t) iOffset);
+		m_lLengths.push_back((uint32_t) iLength);
+		m_lLines.push_back((uint32_t) iLine);
+		m_lScopes.push_back((uint32_t) iLevelID);
+		m_lPayloads.push_back(iPayload);
+	}
+
+	// Only a window is kept, overwrite the oldest token
+	else
+	{
+		size_t iSlot = m_iTokenCount & m_iTokenMask;
+
+		m_lTypes[iSlot] = (uint8_t) eType;
+		m_lOffsets[iSlot] = (uint32_t) iOffset;
+		m_lLengths[iSlot] = (uint32_t) iLength;
+		m_lLines[iSlot] = (uint32_t) iLine;
+		m_lScopes[iSlot] = (uint32_t) iLevelID;
+		m_lPayloads[iSlot] = iPayload;
+	}
+
+	m_iTokenCount++;
+}
+
+// Pushes a keyword, punctuator, variable name, function name or string literal onto the buffer
+void CTokenBuffer::AddToken(eTokenType eType, size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol)
+{
+	PushToken(eType, iOffset, iLength, iLine, oIndentation, (uint32_t) iSymbol);
+}
+
+// Pushes an integer literal onto the buffer
+void CTokenBuffer::AddIntegerLiteral(size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol, int iValue)
+{
+	CNumberLiteral oLiteral;
+	oLiteral.m_iSymbol = iSymbol;
+	oLiteral.m_iIntegerValue = iValue;
+	oLiteral.m_fFloatValue = 0.0;
+
+	// The literal is saved first, make sure it doesn't overwrite a literal that's still needed
+	MakeRoom();
+
+	if(m_iWindowSize == 0)
+		m_lNumberLiterals.push_back(oLiteral);
+	else
+		m_lNumberLiterals[m_iNumberLiteralCount & m_iTokenMask] = oLiteral;
+
+	PushToken(INTEGER_LITERAL_TOKEN, iOffset, iLength, iLine, oIndentation, (uint32_t) m_iNumberLiteralCount++);
+}
+
+// Pushes a float literal onto the buffer
+void CTokenBuffer::AddFloatLiteral(size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol, double fValue)
+{
+	CNumberLiteral oLiteral;
+	oLiteral.m_iSymbol = iSymbol;
+	oLiteral.m_iIntegerValue = 0;
+	oLiteral.m_fFloatValue = fValue;
+
+	// The literal is saved first, make sure it doesn't overwrite a literal that's still needed
+	MakeRoom();
+
+	if(m_iWindowSize == 0)
+		m_lNumberLiterals.push_back(oLiteral);
+	else
+		m_lNumberLiterals[m_iNumberLiteralCount & m_iTokenMask] = oLiteral;
+
+	PushToken(FLOAT_LITERAL_TOKEN, iOffset, iLength, iLine, oIndentation, (uint32_t) m_iNumberLiteralCount++);
+}
+
+// Returns the indentation level and ID of a token
+CIndentation CTokenBuffer::GetIndentation(size_t iToken) const
+{
+	uint32_t iLevelID = m_lScopes[iToken & m_iTokenMask];
+	return CIndentation(m_lScopeLevels[iLevelID & m_iScopeMask], (int) iLevelID);
+}
+
+// Returns the symbol ID of a token, INVALID_SYMBOL_ID for keywords and punctuators
+SymbolID CTokenBuffer::GetSymbol(size_t iToken) const
+{
+	eTokenType eType = GetType(iToken);
+
+	// The payload of a number literal is the number of the literal, which holds the symbol ID
+	if(eType == INTEGER_LITERAL_TOKEN || eType == FLOAT_LITERAL_TOKEN)
+		return m_lNumberLiterals[m_lPayloads[iToken & m_iTokenMask] & m_iTokenMask].m_iSymbol;
+
+	return m_lPayloads[iToken & m_iTokenMask];
+}
+
+// Returns the value of an integer literal
+int CTokenBuffer::GetIntegerValue(size_t iToken) const
+{
+	if(GetType(iToken) != INTEGER_LITERAL_TOKEN)
+		return 0;
+
+	return m_lNumberLiterals[m_lPayloads[iToken & m_iTokenMask] & m_iTokenMask].m_iIntegerValue;
+}
+
+// Returns the value of a float literal
+double CTokenBuffer::GetFloatValue(size_t iToken) const
+{
+	if(GetType(iToken) != FLOAT_LITERAL_TOKEN)
+		return 0.0;
+
+	return m_lNumberLiterals[m_lPayloads[iToken & m_iTokenMask] & m_iTokenMask].m_fFloatValue;
+}
+
+// Returns the amount of memory used by the buffer, in bytes
+size_t CTokenBuffer::GetMemoryUsage() const
+{
+	return m_lTypes.capacity() * sizeof(uint8_t)
+		+ (m_lOffsets.capacity() + m_lLengths.capacity() + m_lLines.capacity() + m_lScopes.capacity() + m_lPayloads.capacity()) * sizeof(uint32_t)
+		+ m_lScopeLevels.capacity() * sizeof(int)
+		+ m_lNumberLiterals.capacity() * sizeof(CNumberLiteral);
+}
\ No newline at end of file
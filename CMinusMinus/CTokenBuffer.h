@@ -0,0 +1,121 @@
+//==============================================================================
+//
+// File: CTokenBuffer.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTokenBuffer class stores the tokens the tokenizer found. Instead of a list
+// of token structures, every field has its own array (structure of arrays): one
+// byte for the type and 32 bits for the offset, length, line, scope and payload.
+// The parser walks the buffer by index through the CToken handle (see CToken.h),
+// nothing is copied. When the tokenizer streams its tokens the buffer only keeps
+// a window of the most recent tokens, the arrays are then used as ring buffers.
+//
+//==============================================================================
+
+#pragma once
+
+#include "CIndentation.h"
+#include "CSymbolPool.h"
+#include "TokenTypes.h"
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+// The token type is stored in one byte
+static_assert(TOKEN_TYPE_COUNT <= 255, "The token types don't fit in one byte anymore");
+
+class CTokenBuffer
+{
+	// The value of a number literal, and the symbol ID of its text (used in error messages)
+	struct CNumberLiteral
+	{
+		SymbolID m_iSymbol;
+		int m_iIntegerValue;
+		double m_fFloatValue;
+	};
+
+	// The type of every token, an eTokenType
+	std::vector<uint8_t> m_lTypes;
+	// Where the value of every token can be found in the source, and how long it is
+	std::vector<uint32_t> m_lOffsets;
+	std::vector<uint32_t> m_lLengths;
+	// The line every token was found on
+	std::vector<uint32_t> m_lLines;
+	// The indentation level ID every token is on, the level belonging to the ID is saved in m_lScopeLevels
+	std::vector<uint32_t> m_lScopes;
+	// The symbol ID of variable names, function names and string literals
+	// For number literals this is the number of the literal, see m_lNumberLiterals
+	std::vector<uint32_t> m_lPayloads;
+	// The indentation level of every indentation level ID
+	// The ID changes on every bracket, so each ID belongs to exactly one level
+	std::vector<int> m_lScopeLevels;
+	// The values of the number literals
+	std::vector<CNumberLiteral> m_lNumberLiterals;
+
+	// The amount of tokens, number literals and indentation level IDs that were pushed
+	size_t m_iTokenCount;
+	size_t m_iNumberLiteralCount;
+	size_t m_iScopeCount;
+	// The amount of tokens that are kept while streaming (always a power of two), 0 if every token is kept
+	size_t m_iWindowSize;
+	// Masks that turn a token (or number literal) and an indentation level ID into an index in the arrays
+	// If every token is kept all bits are set, the arrays are then indexed directly
+	size_t m_iTokenMask;
+	size_t m_iScopeMask;
+	// The tokens before this token aren't needed anymore and may be overwritten
+	size_t m_iReleasedTokens;
+
+	// Makes sure a token can be pushed without overwriting a token that's still needed
+	void MakeRoom();
+	// Doubles the window, this happens when more tokens are needed at once than fit in the window
+	void GrowWindow();
+	// Pushes a token onto the arrays
+	void PushToken(eTokenType eType, size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, uint32_t iPayload);
+
+public:
+	// The constructor of the CTokenBuffer class, by default every token is kept
+	CTokenBuffer();
+
+	// Reserves room for an amount of tokens
+	void Reserve(size_t iTokenCount);
+	// Only keep a window of the most recent tokens (rounded up to a power of two)
+	// This has to be called before any token is pushed
+	void SetWindowSize(size_t iWindowSize);
+	// Returns the amount of tokens that are kept, 0 if every token is kept
+	size_t GetWindowSize() const { return m_iWindowSize; }
+	// Tells the buffer the tokens before iToken aren't needed anymore
+	void Release(size_t iToken);
+
+	// Pushes a keyword, punctuator, variable name, function name or string literal onto the buffer
+	// Keywords and punctuators have INVALID_SYMBOL_ID as symbol ID
+	void AddToken(eTokenType eType, size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol);
+	// Pushes an integer literal onto the buffer
+	void AddIntegerLiteral(size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol, int iValue);
+	// Pushes a float literal onto the buffer
+	void AddFloatLiteral(size_t iOffset, size_t iLength, int iLine, CIndentation oIndentation, SymbolID iSymbol, double fValue);
+
+	// Returns the amount of tokens that were pushed onto the buffer
+	size_t GetSize() const { return m_iTokenCount; }
+	// Returns true if a token is still in the buffer
+	bool IsAvailable(size_t iToken) const { return iToken < m_iTokenCount && (m_iWindowSize == 0 || m_iTokenCount - iToken <= m_iWindowSize); }
+	// Returns the type of a token
+	eTokenType GetType(size_t iToken) const { return (eTokenType) m_lTypes[iToken & m_iTokenMask]; }
+	// Returns where the value of a token can be found in the source
+	size_t GetOffset(size_t iToken) const { return m_lOffsets[iToken & m_iTokenMask]; }
+	// Returns the length of the value of a token
+	size_t GetLength(size_t iToken) const { return m_lLengths[iToken & m_iTokenMask]; }
+	// Returns the line a token was found on
+	int GetLine(size_t iToken) const { return (int) m_lLines[iToken & m_iTokenMask]; }
+	// Returns the indentation level and ID of a token
+	CIndentation GetIndentation(size_t iToken) const;
+	// Returns the symbol ID of a token, INVALID_SYMBOL_ID for keywords and punctuators
+	SymbolID GetSymbol(size_t iToken) const;
+	// Returns the value of an integer literal
+	int GetIntegerValue(size_t iToken) const;
+	// Returns the value of a float literal
+	double GetFloatValue(size_t iToken) const;
+	// Returns the amount of memory used by the buffer, in bytes
+	size_t GetMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,181 @@
+//==============================================================================
+//
+// File: CTokenRing.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTokenRing class passes classified tokens from the lexer thread to the
+// parser thread. It's a single producer, single consumer ring buffer: the lexer
+// only moves the write count, the parser only moves the read count, so no locks
+// are needed. A thread only sleeps when the ring is empty or full.
+//
+//==============================================================================
+
+#include "CTokenRing.h"
+
+#include <windows.h>
+
+// How many times a thread checks the ring again before it goes to sleep
+#define TOKEN_RING_SPIN_COUNT 128
+
+// Creates a ring which holds iCapacity tokens (rounded up to a power of two)
+CTokenRing::CTokenRing(size_t iCapacity)
+{
+	size_t iSize = 16;
+
+	while(iSize < iCapacity)
+		iSize *= 2;
+
+	m_lTokens.resize(iSize);
+	m_iMask = iSize - 1;
+
+	m_iWriteCount = 0;
+	m_iReadCount = 0;
+	m_bClosed = 0;
+	m_bStopped = 0;
+	m_bConsumerWaiting = 0;
+	m_bProducerWaiting = 0;
+
+	// Auto-reset events, a wake-up that nobody waited for only causes one extra check
+	m_hNotEmptyEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	m_hNotFullEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+// Closes the events
+CTokenRing::~CTokenRing()
+{
+	CloseHandle(m_hNotEmptyEvent);
+	CloseHandle(m_hNotFullEvent);
+}
+
+// Producer: pushes iCount tokens, waits while the ring is full
+bool CTokenRing::Push(const CClassifiedToken * pTokens, size_t iCount)
+{
+	int iSpins = 0;
+
+	while(iCount > 0)
+	{
+		if(m_bStopped)
+			return false;
+
+		size_t iWriteCount = m_iWriteCount;
+		size_t iReadCount = m_iReadCount;
+		size_t iFree = m_lTokens.size() - (iWriteCount - iReadCount);
+
+		if(iFree == 0)
+		{
+			// Give the consumer a moment before going to sleep
+			if(iSpins++ < TOKEN_RING_SPIN_COUNT)
+			{
+				YieldProcessor();
+				continue;
+			}
+
+			// Tell the consumer we're waiting, then check again: either we see its pop, or it sees our flag
+			InterlockedExchange(&m_bProducerWaiting, 1);
+
+			if(m_iReadCount == iReadCount && !m_bStopped)
+				WaitForSingleObject(m_hNotFullEvent, INFINITE);
+
+			InterlockedExchange(&m_bProducerWaiting, 0);
+			iSpins = 0;
+			continue;
+		}
+
+		// Copy as many tokens as fit
+		size_t iPushCount = iCount < iFree ? iCount : iFree;
+
+		for(size_t i = 0; i < iPushCount; i++)
+			m_lTokens[(iWriteCount + i) & m_iMask] = pTokens[i];
+
+		// The tokens have to be visible before the new write count is
+		MemoryBarrier();
+		m_iWriteCount = iWriteCount + iPushCount;
+		MemoryBarrier();
+
+		if(m_bConsumerWaiting)
+			SetEvent(m_hNotEmptyEvent);
+
+		pTokens += iPushCount;
+		iCount -= iPushCount;
+	}
+
+	return true;
+}
+
+// Producer: tells the consumer no more tokens will be pushed
+void CTokenRing::Close()
+{
+	InterlockedExchange(&m_bClosed, 1);
+
+	if(m_bConsumerWaiting)
+		SetEvent(m_hNotEmptyEvent);
+}
+
+// Consumer: pops at most iMaxCount tokens, waits while the ring is empty
+size_t CTokenRing::Pop(CClassifiedToken * pTokens, size_t iMaxCount)
+{
+	int iSpins = 0;
+
+	while(true)
+	{
+		// Read the closed flag first, if it's set the write count that follows is the final one
+		long bClosed = m_bClosed;
+		MemoryBarrier();
+
+		size_t iReadCount = m_iReadCount;
+		size_t iWriteCount = m_iWriteCount;
+		size_t iAvailable = iWriteCount - iReadCount;
+
+		if(iAvailable == 0)
+		{
+			if(bClosed)
+				return 0;
+
+			// Give the producer a moment before going to sleep
+			if(iSpins++ < TOKEN_RING_SPIN_COUNT)
+			{
+				YieldProcessor();
+				continue;
+			}
+
+			// Tell the producer we're waiting, then check again: either we see its push, or it sees our flag
+			InterlockedExchange(&m_bConsumerWaiting, 1);
+
+			if(m_iWriteCount == iWriteCount && !m_bClosed)
+				WaitForSingleObject(m_hNotEmptyEvent, INFINITE);
+
+			InterlockedExchange(&m_bConsumerWaiting, 0);
+			iSpins = 0;
+			continue;
+		}
+
+		// The tokens are visible once the write count is
+		MemoryBarrier();
+
+		size_t iPopCount = iAvailable < iMaxCount ? iAvailable : iMaxCount;
+
+		for(size_t i = 0; i < iPopCount; i++)
+			pTokens[i] = m_lTokens[(iReadCount + i) & m_iMask];
+
+		// The slots have to be read before the producer may overwrite them
+		MemoryBarrier();
+		m_iReadCount = iReadCount + iPopCount;
+		MemoryBarrier();
+
+		if(m_bProducerWaiting)
+			SetEvent(m_hNotFullEvent);
+
+		return iPopCount;
+	}
+}
+
+// Consumer: tells the producer no more tokens will be popped
+void CTokenRing::Stop()
+{
+	InterlockedExchange(&m_bStopped, 1);
+
+	if(m_bProducerWaiting)
+		SetEvent(m_hNotFullEvent);
+}
\ No newline at end of file
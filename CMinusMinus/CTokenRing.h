@@ -0,0 +1,66 @@
+//==============================================================================
+//
+// File: CTokenRing.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CTokenRing class passes classified tokens from the lexer thread to the
+// parser thread. It's a single producer, single consumer ring buffer: the lexer
+// only moves the write count, the parser only moves the read count, so no locks
+// are needed. A thread only sleeps when the ring is empty or full.
+//
+//==============================================================================
+
+#pragma once
+
+#include "CTokenizer.h"
+#include <vector>
+
+class CTokenRing
+{
+	// The slots of the ring, the amount of slots is a power of two
+	std::vector<CClassifiedToken> m_lTokens;
+	size_t m_iMask;
+
+	// The amount of tokens the producer pushed, only the producer writes this
+	volatile size_t m_iWriteCount;
+	// Keep the two counts on different cache lines, so the threads don't fight over one line
+	char m_aPadding[64];
+	// The amount of tokens the consumer popped, only the consumer writes this
+	volatile size_t m_iReadCount;
+	char m_aPadding2[64];
+
+	// Set when the producer won't push any more tokens
+	volatile long m_bClosed;
+	// Set when the consumer won't pop any more tokens
+	volatile long m_bStopped;
+
+	// Set while a thread sleeps on an empty or full ring, the other thread wakes it up
+	volatile long m_bConsumerWaiting;
+	volatile long m_bProducerWaiting;
+	void * m_hNotEmptyEvent;
+	void * m_hNotFullEvent;
+
+	// The ring can't be copied
+	CTokenRing(const CTokenRing &);
+	CTokenRing & operator=(const CTokenRing &);
+
+public:
+	// Creates a ring which holds iCapacity tokens (rounded up to a power of two)
+	CTokenRing(size_t iCapacity);
+	// Closes the events
+	~CTokenRing();
+
+	// Producer: pushes iCount tokens, waits while the ring is full
+	// Returns false if the consumer stopped, the tokens that didn't fit are dropped
+	bool Push(const CClassifiedToken * pTokens, size_t iCount);
+	// Producer: tells the consumer no more tokens will be pushed
+	void Close();
+
+	// Consumer: pops at most iMaxCount tokens, waits while the ring is empty
+	// Returns the amount of tokens popped, 0 means the ring was closed and every token was popped
+	size_t Pop(CClassifiedToken * pTokens, size_t iMaxCount);
+	// Consumer: tells the producer no more tokens will be popped
+	void Stop();
+};
\ No newline at end of file
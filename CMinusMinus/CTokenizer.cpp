@@ -7,298 +7,526 @@
 //
 // The tokenizer reads the entire source input and splits it up in tokens (without
 // validating anything though). It contains a method which -after parsing- returns
-// the list of tokens.
+// the list of tokens. The source file is memory-mapped, tokens point into the
+// mapping instead of holding a copy of their value.
 //
 //==============================================================================
 
 #include "CTokenizer.h"
 #include "CLogger.h"
+#include "Scanning.h"
+#include "Util.h"
+#include "CThreadPool.h"
+#include "CTokenRing.h"
 
-#include <fstream>
+#include <windows.h>
+#include <process.h>
+
+// The amount of tokens the ring between the lexer thread and the parser holds
+#define PIPELINE_RING_SIZE 4096
+// The lexer thread pushes, and the parser pops, this many tokens at once
+#define PIPELINE_BATCH_SIZE 64
 
 // The constructor of the CTokenizer class
 CTokenizer::CTokenizer(std::string sSourceFile)
 {
 	m_sSourceFile = sSourceFile;
+	m_pTokenRing = NULL;
+	m_hLexerThread = NULL;
+	m_iPipelineBatchPosition = 0;
+	m_iPipelineBatchSize = 0;
+}
+
+// Stops the lexer thread if the tokenizer is pipelined
+CTokenizer::~CTokenizer()
+{
+	if(m_pTokenRing == NULL)
+		return;
+
+	// The parser might not have popped every token, the lexer thread could be waiting for room
+	m_pTokenRing->Stop();
+	WaitForSingleObject(m_hLexerThread, INFINITE);
+	CloseHandle(m_hLexerThread);
+
+	delete m_pTokenRing;
 }
 
 // Returns the token type from the token string
-eTokenType CTokenizer::GetTokenType(std::string sTokenValue)
+eTokenType CTokenizer::GetTokenType(const char * szTokenValue, size_t iLength)
 {
-	if(sTokenValue == ";")
-		return SEMICOLON_TOKEN;
-	if(sTokenValue == "{")
-		return OPEN_CURLY_BRACKET_TOKEN;
-	if(sTokenValue == "}")
-		return CLOSE_CURLY_BRACKET_TOKEN;
-	if(sTokenValue == "int")
-		return INTEGER_TYPE_TOKEN;
-	if(sTokenValue == "float")
-		return FLOAT_TYPE_TOKEN;
-	if(sTokenValue == "string")
-		return STRING_TYPE_TOKEN;
-	if(sTokenValue == "=")
-		return EQUALSIGN_TOKEN;
-	if(sTokenValue == "\"")
-		return DOUBLE_QUOTE_TOKEN;
-	if(sTokenValue == "+")
-		return PLUS_OPERATOR_TOKEN;
-	if(sTokenValue == "-")
-		return MINUS_OPERATOR_TOKEN;
-	if(sTokenValue == "(")
-		return OPEN_BRACKET_TOKEN;
-	if(sTokenValue == ")")
-		return CLOSE_BRACKET_TOKEN;
-	if(sTokenValue == ",")
-		return COMMA_TOKEN;
-
-	// No valid token found, this must be a function or variable name
-	return VALUE_TOKEN;
+	// Keywords and punctuators are found through the tables generated from TOKEN_TYPE_LIST
+	// If no keyword or punctuator is found, this must be a function or variable name
+	return LookupTokenType(szTokenValue, iLength);
 }
 
-// This method pushes a new token onto the token list
-void CTokenizer::AddTokenToList(std::string sTokenValue, int iLineNumber, CIndentation oIndentation)
+// Works out the type of a token the lexer found, and parses the value of number literals
+void CTokenizer::ClassifyToken(const char * pSource, const CLexedToken & oLexedToken, CClassifiedToken & oToken)
 {
-	// Create a new CToken object
-	CToken oToken;
-	oToken.m_iTokenType = this->GetTokenType(sTokenValue);
-	oToken.m_oIndentation = oIndentation;
-	oToken.m_iLine = iLineNumber;
-	oToken.m_sValue = sTokenValue;
-
-	// Push the object back on the list
-	m_lTokenList.push_back(oToken);
+	const char * szValue = pSource + oLexedToken.m_iOffset;
+
+	oToken.m_iOffset = oLexedToken.m_iOffset;
+	oToken.m_iLength = oLexedToken.m_iLength;
+	oToken.m_iLine = oLexedToken.m_iLine;
+	oToken.m_oIndentation = oLexedToken.m_oIndentation;
+
+	// String literals are interned as they are
+	if(oLexedToken.m_bStringLiteral)
+	{
+		oToken.m_eType = STRING_LITERAL_TOKEN;
+		oToken.m_iHash = CSymbolPool::Hash(szValue, oToken.m_iLength);
+		return;
+	}
+
+	// Keywords and punctuators don't have to be interned
+	oToken.m_eType = GetTokenType(szValue, oToken.m_iLength);
+
+	if(oToken.m_eType != VALUE_TOKEN)
+		return;
+
+	// Variable names, function names and values are interned
+	oToken.m_iHash = CSymbolPool::Hash(szValue, oToken.m_iLength);
+
+	// Numbers are parsed right away, the parser uses the parsed value
+	if(IsNumericLiteral(szValue, oToken.m_iLength))
+	{
+		if(IsIntegerLiteral(szValue, oToken.m_iLength))
+		{
+			oToken.m_eType = INTEGER_LITERAL_TOKEN;
+			oToken.m_iIntegerValue = ParseIntegerLiteral(szValue, oToken.m_iLength);
+		}
+		else
+		{
+			oToken.m_eType = FLOAT_LITERAL_TOKEN;
+			oToken.m_fFloatValue = ParseFloatLiteral(szValue, oToken.m_iLength);
+		}
+	}
 }
 
-void CTokenizer::AddStringLiteralToList(std::string sValue, int iLineNumber, CIndentation oIndentation)
+// Interns a classified token and pushes it onto the token buffer
+void CTokenizer::AddTokenToList(const CClassifiedToken & oToken, int iFirstLine, CIndentation oBaseIndentation)
 {
-	// Create a new CToken object
-	CToken oToken;
-	oToken.m_iTokenType = STRING_LITERAL_TOKEN;
-	oToken.m_oIndentation = oIndentation;
-	oToken.m_iLine = iLineNumber;
-	oToken.m_sValue = sValue;
-
-	// Push the object back on the list
-	m_lTokenList.push_back(oToken);
+	int iLine = iFirstLine + oToken.m_iLine;
+	CIndentation oIndentation(oBaseIndentation.m_iLevel + oToken.m_oIndentation.m_iLevel, oBaseIndentation.m_iLevelID + oToken.m_oIndentation.m_iLevelID);
+
+	// Keywords and punctuators don't have a symbol
+	if(oToken.m_eType != VALUE_TOKEN && oToken.m_eType != STRING_LITERAL_TOKEN && oToken.m_eType != INTEGER_LITERAL_TOKEN && oToken.m_eType != FLOAT_LITERAL_TOKEN)
+	{
+		m_oTokenBuffer.AddToken(oToken.m_eType, oToken.m_iOffset, oToken.m_iLength, iLine, oIndentation, INVALID_SYMBOL_ID);
+		return;
+	}
+
+	SymbolID iSymbol = CSymbolPool::Intern(m_oSourceFile.GetData() + oToken.m_iOffset, oToken.m_iLength, oToken.m_iHash);
+
+	if(oToken.m_eType == INTEGER_LITERAL_TOKEN)
+		m_oTokenBuffer.AddIntegerLiteral(oToken.m_iOffset, oToken.m_iLength, iLine, oIndentation, iSymbol, oToken.m_iIntegerValue);
+	else if(oToken.m_eType == FLOAT_LITERAL_TOKEN)
+		m_oTokenBuffer.AddFloatLiteral(oToken.m_iOffset, oToken.m_iLength, iLine, oIndentation, iSymbol, oToken.m_fFloatValue);
+	else
+		m_oTokenBuffer.AddToken(oToken.m_eType, oToken.m_iOffset, oToken.m_iLength, iLine, oIndentation, iSymbol);
 }
 
-// Run the tokenizer, this method parses the source file and pushes all
-// found tokens on to the token list
-void CTokenizer::Run()
+// Opens the source file and resets the state of the tokenizer, Run(), Stream() and Pipeline() call this
+void CTokenizer::Open()
 {
-	// This string will hold the current value for the token
-	std::string sTokenValue;
-	// This string will hold the current source line in the while() loop
-	std::string sLine;
-	// The current source line number
-	int iLineNumber = 1;
-	// This bool is set to true if we're parsing the contents of a string literal
-	bool bInStringLiteral = false;
-	// This bool is set to true if we're parsing a multi line comment
-	bool bInMultiLineComment = false;
-
-	// This variable holds the indentation level the current variable is on
-	// Example of a variable on level 0:
-	// int test;
-	// Example of a variable on level 1:
-	// { int test; }
-	int iIndentationLevel = 0;
-
-	// Holds the indentation level ID the variable is on. 
-	// Two variables can be on the same levels but not in the same enclosing brackets
-	// Example: { int test = 42; } { int bla = test; }, bla shouldn't be able to access test
-	// Therefore this variable contains a unique ID for each indentation level
-	int iIndentationLevelID = 0;
-
-	std::ifstream fileStream(m_sSourceFile);
-
-	// Was the source file correctly opened?
-	if(!fileStream.is_open())
+	// Map the source file into memory
+	if(!m_oSourceFile.Open(m_sSourceFile))
 	{
 		CLogger::Write("* Could not open source file %s", m_sSourceFile.c_str());
 		exit(1);
 	}
 
+	// We lex straight over the bytes of the mapping
+	const char * pSource = m_oSourceFile.GetData();
+	size_t iSourceSize = m_oSourceFile.GetSize();
+
+	// The token buffer saves offsets in 32 bits
+	if((unsigned long long) iSourceSize > 0xFFFFFFFFULL)
+	{
+		CLogger::Write("* Source file %s is too big (4 GB at most)", m_sSourceFile.c_str());
+		exit(1);
+	}
+
 	#if _DEBUG
 	CLogger::Write("* File contents:");
+
+	for(size_t iLineStart = 0, iLine = 1; iLineStart < iSourceSize; iLine++)
+	{
+		size_t iLineEnd = iLineStart;
+
+		while(iLineEnd < iSourceSize && pSource[iLineEnd] != '\n')
+			iLineEnd++;
+
+		// Don't print the carriage return of files with Windows line endings
+		size_t iLineLength = iLineEnd - iLineStart;
+		if(iLineLength > 0 && pSource[iLineEnd - 1] == '\r')
+			iLineLength--;
+
+		CLogger::Write("Line %d: %.*s", (int) iLine, (int) iLineLength, pSource + iLineStart);
+		iLineStart = iLineEnd + 1;
+	}
+	#endif
+
+	#if _DEBUG
+	CLogger::Write("\n* Scanning the source with the %s kernel", GetScanningKernelName());
 	#endif
 
-	// Loop through the source, one line at a time
-	while(std::getline(fileStream, sLine))
+	// Lex the entire source, starting on line 1
+	m_oLexer.Start(pSource, 0, iSourceSize, 1);
+}
+
+// Lexes the next token and pushes it onto the token buffer
+// Returns false if the end of the source was reached without finding a token
+bool CTokenizer::LexNextToken()
+{
+	CLexedToken oLexedToken;
+
+	if(!m_oLexer.Next(oLexedToken))
+		return false;
+
+	// The lexer already counts from line 1 and level 0
+	CClassifiedToken oToken;
+	ClassifyToken(m_oSourceFile.GetData(), oLexedToken, oToken);
+	AddTokenToList(oToken, 0, CIndentation(0, 0));
+
+	return true;
+}
+
+// Logs every token, this method is only available when compiling in debug mode
+#if _DEBUG
+void CTokenizer::LogTokens()
+{
+	const char * pSource = m_oSourceFile.GetData();
+	CLogger::Write("\n* Tokens found in the source:");
+
+	for(size_t i = 0; i < m_oTokenBuffer.GetSize(); i++)
+		CLogger::Write("%s: value: %.*s, on line: %d", getStringFromTokenType(m_oTokenBuffer.GetType(i)), (int) m_oTokenBuffer.GetLength(i), pSource + m_oTokenBuffer.GetOffset(i), m_oTokenBuffer.GetLine(i));
+}
+#endif
+
+// Run the tokenizer, this method parses the source file and pushes all
+// found tokens on to the token buffer
+void CTokenizer::Run()
+{
+	Open();
+
+	// Lex the entire source
+	while(LexNextToken());
+
+	#if _DEBUG
+	LogTokens();
+	#endif
+}
+
+// Every chunk of the parallel tokenizer is at least this big (in bytes), smaller sources are lexed on one thread
+#define PARALLEL_LEXING_MIN_CHUNK_SIZE 65536
+// The source is split in more chunks than there are threads, so a thread that's done early can pick up another chunk
+#define PARALLEL_LEXING_CHUNKS_PER_THREAD 4
+
+// A chunk of the source, lexed by the parallel tokenizer
+// Every chunk starts right after a newline, so tokens never cross two chunks, only string literals and comments can
+struct CLexerChunk
+{
+	// The range of the source [m_iBegin, m_iEnd) the chunk covers
+	size_t m_iBegin;
+	size_t m_iEnd;
+	// The tokens in the chunk, their lines and indentation levels are relative to the start of the chunk
+	std::vector<CClassifiedToken> m_lTokens;
+	// The amount of newlines in the chunk, and the indentation level and ID at the end of the chunk (relative as well)
+	int m_iNewLines;
+	int m_iIndentationLevel;
+	int m_iIndentationLevelID;
+	// Does the chunk end inside a string literal or comment? And where did that string literal start?
+	eLexerState m_eEndState;
+	size_t m_iLiteralStart;
+};
+
+// What the chunk tasks need to know
+struct CParallelLexingContext
+{
+	const char * m_pSource;
+	std::vector<CLexerChunk> * m_pChunks;
+};
+
+// Lexes a chunk, starting in eStartState (a string literal that started at iLiteralStart, or a comment)
+static void LexChunk(const char * pSource, CLexerChunk & oChunk, eLexerState eStartState, size_t iLiteralStart)
+{
+	CLexer oLexer;
+	oLexer.Start(pSource, oChunk.m_iBegin, oChunk.m_iEnd, 0);
+	oLexer.SetState(eStartState, iLiteralStart);
+
+	oChunk.m_lTokens.clear();
+
+	CLexedToken oLexedToken;
+	while(oLexer.Next(oLexedToken))
+	{
+		oChunk.m_lTokens.push_back(CClassifiedToken());
+		CTokenizer::ClassifyToken(pSource, oLexedToken, oChunk.m_lTokens.back());
+	}
+
+	oChunk.m_iNewLines = oLexer.GetLineNumber();
+	oChunk.m_iIndentationLevel = oLexer.GetIndentationLevel();
+	oChunk.m_iIndentationLevelID = oLexer.GetIndentationLevelID();
+	oChunk.m_eEndState = oLexer.GetState();
+	oChunk.m_iLiteralStart = oLexer.GetLiteralStart();
+}
+
+// The task the thread pool runs for every chunk
+// We don't know yet if the chunk starts inside a string literal or comment, we guess it doesn't
+static void LexChunkTask(void * pContext, size_t iChunk)
+{
+	CParallelLexingContext * pLexingContext = (CParallelLexingContext *) pContext;
+	LexChunk(pLexingContext->m_pSource, (*pLexingContext->m_pChunks)[iChunk], LEXER_STATE_NORMAL, 0);
+}
+
+// Parses the entire source file, the source is split in chunks which are lexed on iThreadCount threads
+void CTokenizer::RunParallel(int iThreadCount)
+{
+	Open();
+
+	const char * pSource = m_oSourceFile.GetData();
+	size_t iSourceSize = m_oSourceFile.GetSize();
+
+	// Split the source in chunks, every chunk ends right after a newline (except the last one)
+	size_t iChunkCount = (size_t) (iThreadCount > 1 ? iThreadCount : 1) * PARALLEL_LEXING_CHUNKS_PER_THREAD;
+
+	if(iChunkCount > iSourceSize / PARALLEL_LEXING_MIN_CHUNK_SIZE)
+		iChunkCount = iSourceSize / PARALLEL_LEXING_MIN_CHUNK_SIZE;
+
+	// Not worth it, lex the source on this thread
+	if(iThreadCount <= 1 || iChunkCount < 2)
 	{
+		while(LexNextToken());
+
 		#if _DEBUG
-		CLogger::Write("Line %d: %s", iLineNumber, sLine.c_str());
+		LogTokens();
 		#endif
+		return;
+	}
+
+	std::vector<CLexerChunk> lChunks;
 
-		// Loop through the line, one character at a time
-		for(size_t i = 0; i < sLine.length(); i++)
+	for(size_t i = 0, iBegin = 0; i < iChunkCount && iBegin < iSourceSize; i++)
+	{
+		size_t iEnd = (i == iChunkCount - 1) ? iSourceSize : iSourceSize / iChunkCount * (i + 1);
+
+		if(iEnd < iBegin)
+			iEnd = iBegin;
+
+		// Move the end of the chunk to the next newline
+		while(iEnd < iSourceSize && (iEnd == 0 || pSource[iEnd - 1] != '\n'))
+			iEnd++;
+
+		CLexerChunk oChunk;
+		oChunk.m_iBegin = iBegin;
+		oChunk.m_iEnd = iEnd;
+		lChunks.push_back(oChunk);
+
+		iBegin = iEnd;
+	}
+
+	#if _DEBUG
+	CLogger::Write("\n* Lexing %d chunks on %d threads", (int) lChunks.size(), iThreadCount);
+	#endif
+
+	// Lex every chunk, guessing that none of them starts inside a string literal or comment
+	CParallelLexingContext oContext;
+	oContext.m_pSource = pSource;
+	oContext.m_pChunks = &lChunks;
+
+	CThreadPool oThreadPool(iThreadCount);
+	oThreadPool.Run(LexChunkTask, &oContext, lChunks.size());
+
+	// Now walk the chunks in order, the end of each chunk tells where the next chunk really starts
+	// A chunk that starts inside a string literal or comment was guessed wrong and is lexed again
+	// The symbols are interned here, in source order, so they get the same IDs as with Run()
+	eLexerState eState = LEXER_STATE_NORMAL;
+	size_t iLiteralStart = 0;
+	int iFirstLine = 1;
+	CIndentation oBaseIndentation(0, 0);
+	size_t iTokenCount = 0;
+
+	for(size_t i = 0; i < lChunks.size(); i++)
+		iTokenCount += lChunks[i].m_lTokens.size();
+
+	m_oTokenBuffer.Reserve(iTokenCount);
+
+	for(size_t i = 0; i < lChunks.size(); i++)
+	{
+		CLexerChunk & oChunk = lChunks[i];
+
+		if(eState != LEXER_STATE_NORMAL)
 		{
-			// Get the character at the current position
-			char cCurrentChar = sLine[i];
-
-			// Are we in a string literal?
-			if(bInStringLiteral)
-			{
-				// If we've found another ", the user is exiting the string literal parsing
-				if(cCurrentChar == '"')
-				{
-					AddStringLiteralToList(sTokenValue, iLineNumber, CIndentation(iIndentationLevel, iIndentationLevelID));
-
-					// Reset the current token value
-					sTokenValue = "";
-
-					// We're no longer parsing a string literal
-					bInStringLiteral = false;
-					continue;
-				}
-
-				// As long as we're in the string literal, push the character back onto the list
-				sTokenValue += cCurrentChar;
-				continue;
-			}
-
-			// Are we in a multi line comment?
-			if(bInMultiLineComment)
-			{
-				// End of multi-line comment (/* blah */)
-				if(cCurrentChar == '/' && i != 0 && sLine[i - 1] == '*')
-				{
-					// Reset the token value
-					sTokenValue = "";
-
-					// Set the bool to false
-					bInMultiLineComment = false;
-				}
-
-				// Continue onto the next token
-				continue;
-			}
-
-			// Current character is a space or a tab
-			if(cCurrentChar == ' ' || cCurrentChar == '\t')
-			{
-				// Make sure we actually have a token before pushing it onto the list
-				// An example of when we wouldn't have a token is when parsing the ' = ' part of 'int test = 5;'
-				// When it comes to the second space there's no token yet (seeing as the = sign was just pushed onto the list)
-				if(sTokenValue.length() > 0)
-				{
-					AddTokenToList(sTokenValue, iLineNumber, CIndentation(iIndentationLevel, iIndentationLevelID));
-
-					// Reset the current token value
-					sTokenValue = "";
-				}
-			}
-
-			// If we found a double quote, we're entering a string literal
-			else if(cCurrentChar == '"')
-			{
-				// Set the string literal bool to true
-				bInStringLiteral = true;
-				continue;
-			}
-
-			// This is a single line comment
-			else if(cCurrentChar == '/' && i != 0 && sLine[i - 1] == '/')
-			{
-				// Reset the token value
-				sTokenValue = "";
-
-				// Break out of the current line parsing
-				break;
-			}
-
-			// Start of multi-line comment (/* example of multi line comment */)
-			else if(cCurrentChar == '*' && i != 0 && sLine[i - 1] == '/')
-			{
-				// Set the multi line comment bool to true
-				bInMultiLineComment = true;
-
-				// Continue onto the next token
-				continue;
-			}
-
-			else if(cCurrentChar == '{' || cCurrentChar == '}' || cCurrentChar == '=' || cCurrentChar == ';' || cCurrentChar == '+' || cCurrentChar == '-' || cCurrentChar == '(' || cCurrentChar == ')' || cCurrentChar == ',')
-			{
-				if(cCurrentChar == '{')
-				{
-					// We found a {, increase the indentation level and the unique indentation id
-					iIndentationLevel++;
-					iIndentationLevelID++;
-				}
-
-				if(cCurrentChar == '}')
-				{
-					// We found a }, decrease the indentation level, keep increasing the unique id
-					iIndentationLevel--;
-					iIndentationLevelID++;
-				}
-
-				// If we already have a token length (eg: when processing '5;'), we first push
-				// the already existing token onto the token list before processing the new one we just found
-				if(sTokenValue.length() > 0)
-				{
-					AddTokenToList(sTokenValue, iLineNumber, CIndentation(iIndentationLevel, iIndentationLevelID));
-
-					// Reset the current token value
-					sTokenValue = "";
-				}
-
-				// Set the token string to the one character we just found and push that onto the token list as well
-				sTokenValue += cCurrentChar;
-				AddTokenToList(sTokenValue, iLineNumber, CIndentation(iIndentationLevel, iIndentationLevelID));
-
-				// Reset the current token value
-				sTokenValue = "";
-			}
-
-			// The character is neither of the above
-			else
-			{
-				// Append the character to the token string
-				sTokenValue += cCurrentChar;
-			}
+			#if _DEBUG
+			CLogger::Write("* Chunk %d starts inside a %s, lexing it again", (int) i, eState == LEXER_STATE_COMMENT ? "comment" : "string literal");
+			#endif
+
+			LexChunk(pSource, oChunk, eState, iLiteralStart);
 		}
 
-		// Increment the line number
-		iLineNumber++;
+		for(size_t j = 0; j < oChunk.m_lTokens.size(); j++)
+			AddTokenToList(oChunk.m_lTokens[j], iFirstLine, oBaseIndentation);
+
+		// The next chunk continues where this one ended
+		iFirstLine += oChunk.m_iNewLines;
+		oBaseIndentation.m_iLevel += oChunk.m_iIndentationLevel;
+		oBaseIndentation.m_iLevelID += oChunk.m_iIndentationLevelID;
+		eState = oChunk.m_eEndState;
+		iLiteralStart = oChunk.m_iLiteralStart;
+
+		// Free the chunk's tokens right away
+		std::vector<CClassifiedToken>().swap(oChunk.m_lTokens);
 	}
 
+	// Everything has been lexed, Fetch() shouldn't find any more tokens
+	m_oLexer.Start(pSource, iSourceSize, iSourceSize, iFirstLine);
+
 	#if _DEBUG
-	CLogger::Write("\n* Tokens found in the source:");
+	LogTokens();
+	#endif
+}
+
+// Lexes the range [iBegin, iEnd) of a source that's already in memory, the first line of the range is iFirstLine
+void CTokenizer::RunRange(const char * pSource, size_t iBegin, size_t iEnd, int iFirstLine)
+{
+	// The token offsets stay relative to the start of the source
+	m_oSourceFile.Attach(pSource, iEnd);
+	m_oLexer.Start(pSource, iBegin, iEnd, iFirstLine);
+
+	while(LexNextToken());
+}
+
+// Prepares the tokenizer for streaming, no tokens are lexed yet
+// The parser pulls them with Fetch(), the token buffer only keeps a window of iWindowSize tokens
+void CTokenizer::Stream(size_t iWindowSize)
+{
+	m_oTokenBuffer.SetWindowSize(iWindowSize);
+	Open();
+
+	#if _DEBUG
+	CLogger::Write("\n* Streaming the tokens to the parser (window of %d tokens)", (int) m_oTokenBuffer.GetWindowSize());
+	#endif
+}
+
+// Like Stream(), but the tokens are lexed on a separate thread while the parser checks the ones before them
+void CTokenizer::Pipeline(size_t iWindowSize)
+{
+	m_oTokenBuffer.SetWindowSize(iWindowSize);
+	Open();
 
-	for(TokenList::iterator iterator = m_lTokenList.begin(); iterator != m_lTokenList.end(); iterator++)
-		CLogger::Write("%s: value: %s, on line: %d", getStringFromTokenType((*iterator).m_iTokenType), (*iterator).m_sValue.c_str(), (*iterator).m_iLine);
+	m_pTokenRing = new CTokenRing(PIPELINE_RING_SIZE);
+	m_lPipelineBatch.resize(PIPELINE_BATCH_SIZE);
+
+	m_hLexerThread = (void *) _beginthreadex(NULL, 0, LexerThread, this, 0, NULL);
+
+	// Without a thread, the parser will have to lex the tokens itself
+	if(m_hLexerThread == NULL)
+	{
+		delete m_pTokenRing;
+		m_pTokenRing = NULL;
+
+		CLogger::Write("* Could not start the lexer thread, streaming the tokens instead");
+	}
+
+	#if _DEBUG
+	if(m_pTokenRing != NULL)
+		CLogger::Write("\n* Lexing on a separate thread, pipelining the tokens to the parser (window of %d tokens)", (int) m_oTokenBuffer.GetWindowSize());
 	#endif
+}
+
+// The function the lexer thread of Pipeline() runs
+// It lexes and classifies the tokens, the parser's thread interns them when it pops them
+unsigned __stdcall CTokenizer::LexerThread(void * pTokenizer)
+{
+	CTokenizer * pThis = (CTokenizer *) pTokenizer;
+	const char * pSource = pThis->m_oSourceFile.GetData();
+
+	CClassifiedToken aBatch[PIPELINE_BATCH_SIZE];
+	size_t iBatchSize = 0;
+	CLexedToken oLexedToken;
 
+	while(pThis->m_oLexer.Next(oLexedToken))
+	{
+		ClassifyToken(pSource, oLexedToken, aBatch[iBatchSize++]);
+
+		if(iBatchSize < PIPELINE_BATCH_SIZE)
+			continue;
+
+		// The parser stopped popping, there's no point in lexing the rest
+		if(!pThis->m_pTokenRing->Push(aBatch, iBatchSize))
+			return 0;
+
+		iBatchSize = 0;
+	}
+
+	if(iBatchSize > 0 && !pThis->m_pTokenRing->Push(aBatch, iBatchSize))
+		return 0;
+
+	pThis->m_pTokenRing->Close();
+	return 0;
+}
+
+// Pops the next token the lexer thread found and pushes it onto the token buffer
+bool CTokenizer::PopNextToken()
+{
+	// Pop a new batch when the last one is used up
+	if(m_iPipelineBatchPosition == m_iPipelineBatchSize)
+	{
+		m_iPipelineBatchPosition = 0;
+		m_iPipelineBatchSize = m_pTokenRing->Pop(&m_lPipelineBatch[0], m_lPipelineBatch.size());
+
+		if(m_iPipelineBatchSize == 0)
+			return false;
+	}
+
+	// The lexer thread already counts from line 1 and level 0
+	AddTokenToList(m_lPipelineBatch[m_iPipelineBatchPosition++], 0, CIndentation(0, 0));
+	return true;
+}
+
+// Makes sure a token has been lexed, returns false if the source has less tokens
+// After Run() every token is already there, while streaming this lexes more of the source
+// and when pipelined this pops the tokens the lexer thread found
+bool CTokenizer::Fetch(size_t iToken)
+{
+	while(iToken >= m_oTokenBuffer.GetSize())
+	{
+		bool bFound = (m_pTokenRing != NULL) ? PopNextToken() : LexNextToken();
+
+		if(!bFound)
+			return false;
+	}
+
+	return true;
+}
+
+// Tells the tokenizer the tokens before iToken aren't needed anymore, while streaming they'll be overwritten
+void CTokenizer::Release(size_t iToken)
+{
+	m_oTokenBuffer.Release(iToken);
+}
+
+// Return the token buffer
+const CTokenBuffer & CTokenizer::GetTokenBuffer()
+{
+	return m_oTokenBuffer;
+}
+
+// Returns the source file the tokens point into
+const CSourceFile & CTokenizer::GetSourceFile()
+{
+	return m_oSourceFile;
 }
 
-// Return the token list
-TokenList CTokenizer::GetTokenList()
+// Returns a copy of the value of a token
+std::string CTokenizer::GetTokenValue(size_t iToken)
 {
-	return m_lTokenList;
+	return m_oSourceFile.GetString(m_oTokenBuffer.GetOffset(iToken), m_oTokenBuffer.GetLength(iToken));
 }
 
 // This method returns the string type from the token, this method is only available when compiling in debug mode
 #if _DEBUG
 const char * CTokenizer::getStringFromTokenType(eTokenType eType)
 {
-	if(eType == CLOSE_CURLY_BRACKET_TOKEN) return "CLOSE_BRACKET_TOKEN";
-	if(eType == OPEN_CURLY_BRACKET_TOKEN) return "OPEN_BRACKET_TOKEN";
-	if(eType == SEMICOLON_TOKEN) return "SEMICOLON_TOKEN";
-	if(eType == INTEGER_TYPE_TOKEN) return "INTEGER_TYPE_TOKEN";
-	if(eType == FLOAT_TYPE_TOKEN) return "FLOAT_TYPE_TOKEN";
-	if(eType == STRING_TYPE_TOKEN) return "STRING_TYPE_TOKEN";
-	if(eType == VALUE_TOKEN) return "VALUE_TOKEN";
-	if(eType == EQUALSIGN_TOKEN) return "EQUALSIGN_TOKEN";
-	if(eType == DOUBLE_QUOTE_TOKEN) return "DOUBLE_QUOTE_TOKEN";
-	if(eType == STRING_LITERAL_TOKEN) return "STRING_LITERAL_TOKEN";
-	if(eType == PLUS_OPERATOR_TOKEN) return "PLUS_OPERATOR_TOKEN";
-	if(eType == MINUS_OPERATOR_TOKEN) return "MINUS_OPERATOR_TOKEN";
-	if(eType == OPEN_BRACKET_TOKEN) return "OPEN_BRACKET_TOKEN";
-	if(eType == CLOSE_BRACKET_TOKEN) return "CLOSE_BRACKET_TOKEN";
-	if(eType == COMMA_TOKEN) return "COMMA_TOKEN";
-
-	return "Invalid token";
+	return GetTokenTypeName(eType);
 }
 #endif
\ No newline at end of file
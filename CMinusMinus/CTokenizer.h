@@ -7,35 +7,118 @@
 //
 // The tokenizer reads the entire source input and splits it up in tokens (without
 // validating anything though). It contains a method which -after parsing- returns
-// the list of tokens.
+// the list of tokens. The source file is memory-mapped, tokens point into the
+// mapping instead of holding a copy of their value.
 //
 //==============================================================================
 
 #pragma once
 
-#include "CToken.h"
+#include "CTokenBuffer.h"
+#include "CSourceFile.h"
+#include "CLexer.h"
 #include <string>
+#include <vector>
+
+class CTokenRing;
+
+// A token the lexer found, with its type worked out but not interned yet
+struct CClassifiedToken
+{
+	// The type of the token
+	eTokenType m_eType;
+	// Where the value of the token can be found in the source, and how long it is
+	size_t m_iOffset;
+	size_t m_iLength;
+	// The line the token was found on
+	int m_iLine;
+	// The indentation level the token is on
+	CIndentation m_oIndentation;
+	// The hash of the value (see CSymbolPool::Hash), only for values and string literals
+	unsigned int m_iHash;
+	// The value of number literals
+	int m_iIntegerValue;
+	double m_fFloatValue;
+
+	CClassifiedToken::CClassifiedToken(): m_eType(INVALID_TOKEN_TYPE), m_iOffset(0), m_iLength(0), m_iLine(0), m_oIndentation(INVALID_INDENTATION_LEVEL, INVALID_INDENTATION_ID), m_iHash(0), m_iIntegerValue(0), m_fFloatValue(0.0) { }
+};
 
 class CTokenizer
 {
-	// The token list
-	TokenList m_lTokenList;
+	// The tokens that were found, see CTokenBuffer
+	CTokenBuffer m_oTokenBuffer;
 	// The name of the source file we're supposed to parse
 	std::string m_sSourceFile;
+	// The memory-mapped source file, the token values point into this file
+	CSourceFile m_oSourceFile;
+
+	// Finds the tokens in the source, used by Run(), Stream() and the lexer thread of Pipeline()
+	CLexer m_oLexer;
+
+	// Pipeline(): the lexer thread pushes classified tokens onto the ring, Fetch() pops them in batches
+	CTokenRing * m_pTokenRing;
+	void * m_hLexerThread;
+	std::vector<CClassifiedToken> m_lPipelineBatch;
+	size_t m_iPipelineBatchPosition;
+	size_t m_iPipelineBatchSize;
+
+	// The tokenizer can't be copied, it might own a thread
+	CTokenizer(const CTokenizer &);
+	CTokenizer & operator=(const CTokenizer &);
+
+	// Opens the source file and resets the state of the tokenizer
+	void Open();
+	// Lexes the next token and pushes it onto the token buffer
+	// Returns false if the end of the source was reached without finding a token
+	bool LexNextToken();
+	// Interns a classified token and pushes it onto the token buffer
+	// The line and indentation of the token are relative to iFirstLine and oBaseIndentation
+	void AddTokenToList(const CClassifiedToken & oToken, int iFirstLine, CIndentation oBaseIndentation);
+	// Pops the next token the lexer thread found and pushes it onto the token buffer
+	// Returns false if the lexer thread reached the end of the source
+	bool PopNextToken();
+	// The function the lexer thread of Pipeline() runs
+	static unsigned __stdcall LexerThread(void * pTokenizer);
+	// Logs every token, this method is only available when compiling in debug mode
+	#if _DEBUG
+	void LogTokens();
+	#endif
 
 public:
 	// The constructor of the CTokenizer class
 	CTokenizer(std::string sSourceInput);
-	// Parses the source file
+	// Stops the lexer thread if the tokenizer is pipelined
+	~CTokenizer();
+	// Parses the entire source file
 	void Run();
-	// Pushes a token onto the token list
-	void AddTokenToList(std::string sTokenValue, int iLineNumber, CIndentation oIndentation);
-	// Pushes a string literal onto the token list
-	void AddStringLiteralToList(std::string sValue, int iLineNumber, CIndentation oIndentation);
+	// Parses the entire source file, the source is split in chunks which are lexed on iThreadCount threads
+	// The tokens are exactly the same as the ones Run() finds
+	void RunParallel(int iThreadCount);
+	// Lexes the range [iBegin, iEnd) of a source that's already in memory, the first line of the range is iFirstLine
+	// The range has to start in between tokens on level 0, CEditSession lexes the sections of a script with this
+	void RunRange(const char * pSource, size_t iBegin, size_t iEnd, int iFirstLine);
+	// Prepares the tokenizer for streaming, the parser pulls the tokens with Fetch()
+	// Only a window of iWindowSize tokens is kept in memory
+	void Stream(size_t iWindowSize);
+	// Like Stream(), but the tokens are lexed on a separate thread while the parser checks the ones before them
+	// The parser gets exactly the same tokens, the interning is still done on the parser's thread
+	void Pipeline(size_t iWindowSize);
+	// Makes sure a token has been lexed, returns false if the source has less tokens
+	// While streaming or pipelined, this lexes or pops more tokens
+	bool Fetch(size_t iToken);
+	// Tells the tokenizer the tokens before iToken aren't needed anymore
+	void Release(size_t iToken);
 	// Returns the token type from the value
-	eTokenType GetTokenType(std::string sTokenValue);
-	// Returns the token list
-	TokenList GetTokenList();
+	static eTokenType GetTokenType(const char * szTokenValue, size_t iLength);
+	// Works out the type of a token the lexer found, and parses the value of number literals
+	// This doesn't touch the tokenizer, so chunks of the source can be classified on any thread
+	static void ClassifyToken(const char * pSource, const CLexedToken & oLexedToken, CClassifiedToken & oToken);
+	// Returns the token buffer
+	const CTokenBuffer & GetTokenBuffer();
+	// Returns the source file the tokens point into
+	const CSourceFile & GetSourceFile();
+	// Returns a copy of the value of a token
+	std::string GetTokenValue(size_t iToken);
 	// This method returns the string type from the token, this method is only available when compiling in debug mode
 	#if _DEBUG
 	const char * getStringFromTokenType(eTokenType eType);
@@ -0,0 +1,526 @@
+//==============================================================================
+//
+// File: CValue.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CValue class holds one value of the script: an integer, a float or a
+// string. The value is a tagged union, only the member of its type is alive.
+// Short strings are stored in the value itself, only longer strings allocate
+// memory. Values are used for the variables, the parameters and return values
+// of the natives, and the values the analyzer evaluates at compile time.
+//
+//==============================================================================
+
+#include "CValue.h"
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <windows.h>
+
+// The most characters a leaf that short strings are gathered in holds
+#define VALUE_ROPE_CHUNK_SIZE 256
+// The deepest a rope gets, a deeper rope is rebuilt into a balanced one
+#define VALUE_ROPE_MAX_DEPTH 48
+
+// The empty value of a type: 0, 0.0 or ""
+CValue::CValue(eVariableTypes eType): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0)
+{
+	if(eType == VARIABLE_TYPE_FLOAT)
+		SetFloat(0.0);
+	else if(eType == VARIABLE_TYPE_STRING)
+		SetString("", 0);
+}
+
+// The constructor for a string
+CValue::CValue(const char * szValue, size_t iLength): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0)
+{
+	SetString(szValue, iLength);
+}
+
+// The constructor for a string
+CValue::CValue(const std::string & sValue): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0)
+{
+	SetString(sValue.c_str(), sValue.size());
+}
+
+// A node of a rope, it's shared by every value and every node that holds it
+// A leaf holds characters, a concatenation holds two ropes and only gets characters of its own when it's flattened
+struct CRopeNode
+{
+	// How many values and nodes hold this node, it's freed when the last one lets go
+	volatile long m_iReferences;
+	// The length of the string
+	size_t m_iLength;
+	// The two halves of a concatenation, NULL for a leaf
+	CRopeNode * m_pLeft;
+	CRopeNode * m_pRight;
+	// The characters: of a leaf right away, of a concatenation once it's flattened (NULL until then)
+	char * volatile m_szText;
+	// How many characters fit in m_szText (leaves only), a leaf that only one value holds is appended to in place
+	size_t m_iCapacity;
+	// The longest path to a leaf, 0 for a leaf
+	unsigned int m_iDepth;
+};
+
+// Returns the depth of a rope, a concatenation that was flattened is read as a whole so it counts as a leaf
+static unsigned int GetDepth(const CRopeNode * pNode)
+{
+	return pNode->m_szText != NULL ? 0 : pNode->m_iDepth;
+}
+
+// Makes a leaf that holds szFirst followed by szSecond, with room for iCapacity characters
+static CRopeNode * NewLeaf(const char * szFirst, size_t iFirstLength, const char * szSecond, size_t iSecondLength, size_t iCapacity)
+{
+	size_t iLength = iFirstLength + iSecondLength;
+
+	if(iCapacity < iLength)
+		iCapacity = iLength;
+
+	CRopeNode * pNode = new CRopeNode();
+	pNode->m_iReferences = 1;
+	pNode->m_iLength = iLength;
+	pNode->m_pLeft = NULL;
+	pNode->m_pRight = NULL;
+	pNode->m_szText = new char[iCapacity + 1];
+	pNode->m_iCapacity = iCapacity;
+	pNode->m_iDepth = 0;
+
+	memcpy(pNode->m_szText, szFirst, iFirstLength);
+	memcpy(pNode->m_szText + iFirstLength, szSecond, iSecondLength);
+	pNode->m_szText[iLength] = '\0';
+
+	return pNode;
+}
+
+// Makes the concatenation of two ropes, it takes over a reference to both of them
+static CRopeNode * NewConcatenation(CRopeNode * pLeft, CRopeNode * pRight)
+{
+	CRopeNode * pNode = new CRopeNode();
+	pNode->m_iReferences = 1;
+	pNode->m_iLength = pLeft->m_iLength + pRight->m_iLength;
+	pNode->m_pLeft = pLeft;
+	pNode->m_pRight = pRight;
+	pNode->m_szText = NULL;
+	pNode->m_iCapacity = 0;
+	pNode->m_iDepth = (GetDepth(pLeft) > GetDepth(pRight) ? GetDepth(pLeft) : GetDepth(pRight)) + 1;
+
+	return pNode;
+}
+
+// Appends to a leaf that nobody else sees, the memory at least doubles so appending in a loop stays linear
+static void AppendToLeaf(CRopeNode * pLeaf, const char * szValue, size_t iLength)
+{
+	size_t iNewLength = pLeaf->m_iLength + iLength;
+
+	if(iNewLength > pLeaf->m_iCapacity)
+	{
+		size_t iCapacity = pLeaf->m_iCapacity * 2 > iNewLength ? pLeaf->m_iCapacity * 2 : iNewLength;
+		char * szText = new char[iCapacity + 1];
+		memcpy(szText, pLeaf->m_szText, pLeaf->m_iLength);
+		memcpy(szText + pLeaf->m_iLength, szValue, iLength);
+
+		delete[] pLeaf->m_szText;
+		pLeaf->m_szText = szText;
+		pLeaf->m_iCapacity = iCapacity;
+	}
+	else
+		memcpy(pLeaf->m_szText + pLeaf->m_iLength, szValue, iLength);
+
+	pLeaf->m_szText[iNewLength] = '\0';
+	pLeaf->m_iLength = iNewLength;
+}
+
+// Adds a reference to a node
+static void AddReference(CRopeNode * pNode)
+{
+	InterlockedIncrement(&pNode->m_iReferences);
+}
+
+// Lets go of a node, it's freed if this was the last reference
+// Ropes built by appending in a loop are very deep, so the nodes are released without recursion
+static void ReleaseNode(CRopeNode * pNode)
+{
+	std::vector<CRopeNode *> lNodes(1, pNode);
+
+	while(!lNodes.empty())
+	{
+		pNode = lNodes.back();
+		lNodes.pop_back();
+
+		if(InterlockedDecrement(&pNode->m_iReferences) != 0)
+			continue;
+
+		if(pNode->m_pLeft != NULL)
+		{
+			lNodes.push_back(pNode->m_pLeft);
+			lNodes.push_back(pNode->m_pRight);
+		}
+
+		delete[] pNode->m_szText;
+		delete pNode;
+	}
+}
+
+// Copies the characters of a rope to szOutput, without recursion
+static void CopyCharacters(const CRopeNode * pNode, char * szOutput)
+{
+	std::vector<const CRopeNode *> lNodes(1, pNode);
+
+	while(!lNodes.empty())
+	{
+		pNode = lNodes.back();
+		lNodes.pop_back();
+
+		// A leaf, or a concatenation that was already flattened
+		const char * szText = pNode->m_szText;
+
+		if(szText != NULL)
+		{
+			memcpy(szOutput, szText, pNode->m_iLength);
+			szOutput += pNode->m_iLength;
+			continue;
+		}
+
+		// The left half goes first, so it's pushed last
+		lNodes.push_back(pNode->m_pRight);
+		lNodes.push_back(pNode->m_pLeft);
+	}
+}
+
+// Returns true if a rope is balanced enough to be kept as a whole when a rope that holds it is rebuilt
+// Like the ropes of Boehm, Atkinson and Plass a rope is balanced if it's at least Fibonacci(depth + 2) long
+static bool IsBalanced(const CRopeNode * pNode)
+{
+	unsigned int iDepth = GetDepth(pNode);
+
+	if(iDepth > VALUE_ROPE_MAX_DEPTH)
+		return false;
+
+	unsigned long long iPrevious = 1, iFibonacci = 1;
+
+	for(unsigned int i = 0; i < iDepth; i++)
+	{
+		unsigned long long iNext = iPrevious + iFibonacci;
+		iPrevious = iFibonacci;
+		iFibonacci = iNext;
+	}
+
+	return pNode->m_iLength >= iFibonacci;
+}
+
+// Builds a balanced rope out of pieces, it takes a reference to every piece
+// The pieces are split where half of the characters are, so a long piece doesn't end up deep in the rope
+static CRopeNode * BuildBalancedRope(CRopeNode * const * ppPieces, size_t iCount, size_t iLength)
+{
+	if(iCount == 1)
+	{
+		AddReference(ppPieces[0]);
+		return ppPieces[0];
+	}
+
+	size_t iHalf = 1;
+	size_t iLeftLength = ppPieces[0]->m_iLength;
+
+	while(iHalf < iCount - 1 && iLeftLength + ppPieces[iHalf]->m_iLength <= iLength / 2)
+		iLeftLength += ppPieces[iHalf++]->m_iLength;
+
+	return NewConcatenation(BuildBalancedRope(ppPieces, iHalf, iLeftLength), BuildBalancedRope(ppPieces + iHalf, iCount - iHalf, iLength - iLeftLength));
+}
+
+// Returns the rope, or a balanced rope with the same characters if it got deeper than VALUE_ROPE_MAX_DEPTH
+// A string built by concatenating in a loop would otherwise get a level for every piece
+static CRopeNode * LimitDepth(CRopeNode * pRope)
+{
+	if(GetDepth(pRope) <= VALUE_ROPE_MAX_DEPTH)
+		return pRope;
+
+	// Gather the pieces from left to right, the parts that are still balanced are kept as a whole
+	// A concatenation that was flattened counts as a leaf
+	std::vector<CRopeNode *> lPieces;
+	std::vector<CRopeNode *> lNodes(1, pRope);
+
+	while(!lNodes.empty())
+	{
+		CRopeNode * pNode = lNodes.back();
+		lNodes.pop_back();
+
+		if(GetDepth(pNode) == 0 || IsBalanced(pNode))
+		{
+			lPieces.push_back(pNode);
+			continue;
+		}
+
+		lNodes.push_back(pNode->m_pRight);
+		lNodes.push_back(pNode->m_pLeft);
+	}
+
+	CRopeNode * pBalanced = BuildBalancedRope(&lPieces[0], lPieces.size(), pRope->m_iLength);
+	ReleaseNode(pRope);
+	return pBalanced;
+}
+
+// The copy constructor, a rope is shared
+CValue::CValue(const CValue & oOther): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0)
+{
+	*this = oOther;
+}
+
+// The move constructor, the other value is the integer 0 after this
+CValue::CValue(CValue && oOther) throw(): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0)
+{
+	Steal(oOther);
+}
+
+// Copies another value, a rope is shared
+CValue & CValue::operator=(const CValue & oOther)
+{
+	if(this == &oOther)
+		return *this;
+
+	// Take the reference first, the other value may hold part of our rope
+	if(oOther.IsRope())
+		AddReference(oOther.m_pRope);
+
+	Release();
+	m_eType = oOther.m_eType;
+	m_iLength = oOther.m_iLength;
+	memcpy(m_aSmallString, oOther.m_aSmallString, sizeof(m_aSmallString));
+
+	return *this;
+}
+
+// Moves another value into this one, the other value is the integer 0 after this
+CValue & CValue::operator=(CValue && oOther) throw()
+{
+	if(this != &oOther)
+	{
+		Release();
+		Steal(oOther);
+	}
+
+	return *this;
+}
+
+// Lets go of the rope, the value is the integer 0 after this
+void CValue::Release()
+{
+	if(IsRope())
+		ReleaseNode(m_pRope);
+
+	m_eType = VARIABLE_TYPE_INTEGER;
+	m_iLength = 0;
+	m_iInteger = 0;
+}
+
+// Takes the contents of another value, the other value is the integer 0 after this
+// This value must not hold a rope, it would leak
+void CValue::Steal(CValue & oOther)
+{
+	m_eType = oOther.m_eType;
+	m_iLength = oOther.m_iLength;
+	memcpy(m_aSmallString, oOther.m_aSmallString, sizeof(m_aSmallString));
+
+	// The rope belongs to us now
+	oOther.m_eType = VARIABLE_TYPE_INTEGER;
+	oOther.m_iLength = 0;
+	oOther.m_iInteger = 0;
+}
+
+// Returns the characters of the rope, they're copied into one piece of memory the first time
+// Values on different threads can share the rope, so the characters are published with a compare exchange
+const char * CValue::Flatten() const
+{
+	char * szText = m_pRope->m_szText;
+
+	if(szText != NULL)
+		return szText;
+
+	szText = new char[m_iLength + 1];
+	CopyCharacters(m_pRope, szText);
+	szText[m_iLength] = '\0';
+
+	// Another thread flattened the rope in the meantime, use its characters
+	char * szOther = (char *) InterlockedCompareExchangePointer((PVOID volatile *) &m_pRope->m_szText, szText, NULL);
+
+	if(szOther != NULL)
+	{
+		delete[] szText;
+		return szOther;
+	}
+
+	return szText;
+}
+
+// Replaces the value by a string
+void CValue::SetString(const char * szValue, size_t iLength)
+{
+	// The string may be part of our rope, it's copied before the rope is let go
+	if(IsRope())
+	{
+		CValue oCopy(szValue, iLength);
+		*this = std::move(oCopy);
+		return;
+	}
+
+	if(m_eType == VARIABLE_TYPE_STRING && szValue >= m_aSmallString && szValue <= m_aSmallString + VALUE_SMALL_STRING_SIZE)
+	{
+		memmove(m_aSmallString, szValue, iLength);
+		m_iLength = (unsigned int) iLength;
+		m_aSmallString[iLength] = '\0';
+		return;
+	}
+
+	Release();
+	m_eType = VARIABLE_TYPE_STRING;
+	m_aSmallString[0] = '\0';
+	Append(szValue, iLength);
+}
+
+// Appends to the string, the value has to be a string
+void CValue::Append(const char * szValue, size_t iLength)
+{
+	size_t iNewLength = m_iLength + iLength;
+
+	// It still fits in the value itself
+	if(iNewLength < VALUE_SMALL_STRING_SIZE)
+	{
+		memcpy(m_aSmallString + m_iLength, szValue, iLength);
+		m_aSmallString[iNewLength] = '\0';
+		m_iLength = (unsigned int) iNewLength;
+		return;
+	}
+
+	// The string becomes a rope, start with a leaf that has room to grow
+	if(!IsRope())
+	{
+		CRopeNode * pLeaf = NewLeaf(m_aSmallString, m_iLength, szValue, iLength, VALUE_SMALL_STRING_SIZE * 2);
+		m_pRope = pLeaf;
+		m_iLength = (unsigned int) iNewLength;
+		return;
+	}
+
+	CRopeNode * pRope = m_pRope;
+
+	// Nobody else sees the leaf, append in place
+	if(pRope->m_pLeft == NULL && pRope->m_iReferences == 1)
+	{
+		AppendToLeaf(pRope, szValue, iLength);
+		m_iLength = (unsigned int) iNewLength;
+		return;
+	}
+
+	CRopeNode * pRight = pRope->m_pRight;
+
+	// Nobody else sees the rope or its last leaf, a short piece is appended to the leaf in place
+	if(pRope->m_pLeft != NULL && pRope->m_iReferences == 1 && pRight->m_pLeft == NULL && pRight->m_iReferences == 1 && pRight->m_iLength + iLength <= VALUE_ROPE_CHUNK_SIZE)
+	{
+		AppendToLeaf(pRight, szValue, iLength);
+		pRope->m_iLength = iNewLength;
+
+		// The characters the rope was flattened into are out of date, the piece may be part of them so it's appended first
+		delete[] pRope->m_szText;
+		pRope->m_szText = NULL;
+
+		m_iLength = (unsigned int) iNewLength;
+		return;
+	}
+
+	// The rope is shared, link a new leaf to it
+	// Short pieces are gathered in the last leaf, so a string built a piece at a time doesn't get a node for every piece
+
+	if(pRope->m_pLeft != NULL && pRight->m_pLeft == NULL && pRight->m_iLength + iLength <= VALUE_ROPE_CHUNK_SIZE)
+	{
+		AddReference(pRope->m_pLeft);
+		m_pRope = NewConcatenation(pRope->m_pLeft, NewLeaf(pRight->m_szText, pRight->m_iLength, szValue, iLength, VALUE_ROPE_CHUNK_SIZE));
+	}
+	else
+		m_pRope = NewConcatenation(pRope, NewLeaf(szValue, iLength, "", 0, iLength < VALUE_ROPE_CHUNK_SIZE ? VALUE_ROPE_CHUNK_SIZE : iLength));
+
+	// The new rope holds the halves it needs, let go of the old one (the concatenation took our reference instead)
+	if(m_pRope->m_pLeft != pRope)
+		ReleaseNode(pRope);
+
+	m_pRope = LimitDepth(m_pRope);
+	m_iLength = (unsigned int) iNewLength;
+}
+
+// Appends another string, a long string is linked into the rope instead of copied
+void CValue::Append(const CValue & oOther)
+{
+	// A short string is copied, that's cheaper than a node
+	if(oOther.m_iLength < VALUE_ROPE_CHUNK_SIZE)
+	{
+		Append(oOther.GetString(), oOther.m_iLength);
+		return;
+	}
+
+	// Take the reference first, the other value may be this one
+	CRopeNode * pRight = oOther.m_pRope;
+	AddReference(pRight);
+
+	size_t iNewLength = m_iLength + oOther.m_iLength;
+
+	if(m_iLength == 0)
+		m_pRope = pRight;
+	else if(IsRope())
+		m_pRope = NewConcatenation(m_pRope, pRight);
+	else
+		m_pRope = NewConcatenation(NewLeaf(m_aSmallString, m_iLength, "", 0, 0), pRight);
+
+	m_pRope = LimitDepth(m_pRope);
+	m_iLength = (unsigned int) iNewLength;
+}
+
+// Returns a hash of the type and the contents of the value (FNV-1a over the bytes)
+size_t CValue::GetHash() const
+{
+	const unsigned char * pBytes;
+	size_t iSize;
+
+	if(m_eType == VARIABLE_TYPE_INTEGER)
+	{
+		pBytes = (const unsigned char *) &m_iInteger;
+		iSize = sizeof(m_iInteger);
+	}
+	else if(m_eType == VARIABLE_TYPE_FLOAT)
+	{
+		pBytes = (const unsigned char *) &m_fFloat;
+		iSize = sizeof(m_fFloat);
+	}
+	else
+	{
+		pBytes = (const unsigned char *) GetString();
+		iSize = m_iLength;
+	}
+
+	// Start from the type, so 0 and "" don't hash the same
+	unsigned int iHash = 2166136261u ^ (unsigned int) m_eType;
+
+	for(size_t i = 0; i < iSize; i++)
+		iHash = (iHash ^ pBytes[i]) * 16777619u;
+
+	return iHash;
+}
+
+// Returns true if both values have the same type and contents
+bool CValue::IsIdentical(const CValue & oOther) const
+{
+	if(m_eType != oOther.m_eType)
+		return false;
+
+	// Both values share the rope
+	if(IsRope() && oOther.IsRope() && m_pRope == oOther.m_pRope)
+		return true;
+
+	// Compare the bits of a float, -0.0 and 0.0 give a different string so they aren't the same
+	if(m_eType == VARIABLE_TYPE_INTEGER)
+		return m_iInteger == oOther.m_iInteger;
+
+	if(m_eType == VARIABLE_TYPE_FLOAT)
+		return memcmp(&m_fFloat, &oOther.m_fFloat, sizeof(m_fFloat)) == 0;
+
+	return m_iLength == oOther.m_iLength && memcmp(GetString(), oOther.GetString(), m_iLength) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+//==============================================================================
+//
+// File: CValue.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// The CValue class holds one value of the script: an integer, a float or a
+// string. The value is a tagged union, only the member of its type is alive.
+// Short strings are stored in the value itself, only longer strings allocate
+// memory. Values are used for the variables, the parameters and return values
+// of the natives, and the values the analyzer evaluates at compile time.
+// A longer string is a rope: a tree of nodes shared by every value that holds
+// it. Copying a value or concatenating two strings links the nodes instead of
+// copying the characters, the rope is only flattened into one piece of memory
+// when GetString() is called.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// This enum holds all possible types a value can have
+enum eVariableTypes
+{
+	VARIABLE_TYPE_INTEGER,
+	VARIABLE_TYPE_FLOAT,
+	VARIABLE_TYPE_STRING,
+	// Only a parameter of a native has this type, it takes a value of any type
+	VARIABLE_TYPE_ANY
+};
+
+// The size of the buffer for short strings, a string shorter than this is stored in the value itself
+#define VALUE_SMALL_STRING_SIZE 16
+
+// A node of a rope, see CValue.cpp
+struct CRopeNode;
+
+class CValue
+{
+	// The type of the value, this tells which member of the union is alive
+	eVariableTypes m_eType;
+	// The length of the string (strings only), strings of VALUE_SMALL_STRING_SIZE characters and longer are ropes
+	unsigned int m_iLength;
+
+	union
+	{
+		int m_iInteger;
+		double m_fFloat;
+		char m_aSmallString[VALUE_SMALL_STRING_SIZE];
+		CRopeNode * m_pRope;
+	};
+
+	// Is the string a rope?
+	bool IsRope() const { return m_eType == VARIABLE_TYPE_STRING && m_iLength >= VALUE_SMALL_STRING_SIZE; }
+	// Returns the characters of the rope, they're copied into one piece of memory the first time
+	const char * Flatten() const;
+	// Frees the string, the value is the integer 0 after this
+	void Release();
+	// Takes the contents of another value, the other value is the integer 0 after this
+	void Steal(CValue & oOther);
+
+public:
+	// The default constructor of the CValue class, the value is the integer 0
+	CValue(): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(0) { }
+	// The empty value of a type: 0, 0.0 or ""
+	explicit CValue(eVariableTypes eType);
+	// The constructors for an integer, a float and a string
+	explicit CValue(int iValue): m_eType(VARIABLE_TYPE_INTEGER), m_iLength(0), m_iInteger(iValue) { }
+	explicit CValue(double fValue): m_eType(VARIABLE_TYPE_FLOAT), m_iLength(0), m_fFloat(fValue) { }
+	CValue(const char * szValue, size_t iLength);
+	explicit CValue(const std::string & sValue);
+
+	// Copying a value shares its rope, moving it takes the rope along
+	CValue(const CValue & oOther);
+	CValue(CValue && oOther) throw();
+	CValue & operator=(const CValue & oOther);
+	CValue & operator=(CValue && oOther) throw();
+	~CValue() { Release(); }
+
+	// Returns the type of the value
+	eVariableTypes GetType() const { return m_eType; }
+	// Returns the value as an integer, a float is truncated and a string is 0
+	int GetInteger() const { return m_eType == VARIABLE_TYPE_INTEGER ? m_iInteger : (m_eType == VARIABLE_TYPE_FLOAT ? (int) m_fFloat : 0); }
+	// Returns the value as a float, an integer is converted and a string is 0.0
+	double GetFloat() const { return m_eType == VARIABLE_TYPE_FLOAT ? m_fFloat : (m_eType == VARIABLE_TYPE_INTEGER ? (double) m_iInteger : 0.0); }
+	// Returns the string, the value of another type is ""
+	// A rope is flattened the first time, use GetLength() if only the length is needed
+	const char * GetString() const { return m_eType != VARIABLE_TYPE_STRING ? "" : (IsRope() ? Flatten() : m_aSmallString); }
+	// Returns the length of the string, 0 for another type
+	size_t GetLength() const { return m_iLength; }
+	// Returns a hash of the type and the contents of the value
+	size_t GetHash() const;
+	// Returns true if both values have the same type and contents, floats are compared bit by bit
+	bool IsIdentical(const CValue & oOther) const;
+
+	// Replaces the value by an integer, a float or a string
+	void SetInteger(int iValue) { Release(); m_iInteger = iValue; }
+	void SetFloat(double fValue) { Release(); m_eType = VARIABLE_TYPE_FLOAT; m_fFloat = fValue; }
+	void SetString(const char * szValue, size_t iLength);
+	// Appends to the string, the value has to be a string
+	void Append(const char * szValue, size_t iLength);
+	// Appends another string, a long string is linked into the rope instead of copied
+	void Append(const CValue & oOther);
+};
\ No newline at end of file
@@ -14,28 +14,19 @@
 #pragma once
 
 #include "CIndentation.h"
+#include "CSymbolPool.h"
+#include "CValue.h"
 #include <vector>
 
-// This enum holds all possible types the CVariable struct can hold
-enum eVariableTypes
-{
-	VARIABLE_TYPE_INTEGER,
-	VARIABLE_TYPE_FLOAT,
-	VARIABLE_TYPE_STRING
-};
-
 struct CVariable
 {
-	// Since the CVariable struct can hold three types of variables (floats, integers and strings)
-	// we need three seperate variables for each of these types.
-	std::string m_sValue;
-	int m_iValue;
-	double m_fValue;
+	// The value of the variable, it always has the type of the variable
+	CValue m_oValue;
 
 	// Holds the indentation level and ID for this variable
 	CIndentation m_oIndentation;
-	// The name of the variable
-	std::string m_sValueName;
+	// The name of the variable (interned, see CSymbolPool)
+	SymbolID m_iName;
 	// The type this CVariable object holds
 	eVariableTypes m_eType;
 	// This bool is set to true if the variable has been declared and defined, false otherwise
@@ -0,0 +1,55 @@
+//==============================================================================
+//
+// File: CpuFeatures.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file tells which instruction sets the CPU supports. The scanning
+// kernels and the string kernels both use it to pick their fastest kernel
+// when the program starts.
+//
+//==============================================================================
+
+#include "CpuFeatures.h"
+
+#include <intrin.h>
+
+#if CPU_FEATURES_AVX2
+#include <immintrin.h>
+#endif
+
+// Returns true if the CPU supports SSE2
+bool CpuSupportsSSE2()
+{
+	int aCpuInfo[4];
+	__cpuid(aCpuInfo, 1);
+	return (aCpuInfo[3] & (1 << 26)) != 0;
+}
+
+// Returns true if both the CPU and the OS support AVX2
+bool CpuSupportsAVX2()
+{
+	#if CPU_FEATURES_AVX2
+	int aCpuInfo[4];
+
+	// Does the CPU know about the extended features leaf at all?
+	__cpuid(aCpuInfo, 0);
+	if(aCpuInfo[0] < 7)
+		return false;
+
+	// The OS has to use XSAVE and the CPU has to support AVX
+	__cpuid(aCpuInfo, 1);
+	if((aCpuInfo[2] & (1 << 27)) == 0 || (aCpuInfo[2] & (1 << 28)) == 0)
+		return false;
+
+	// The OS has to save the YMM registers on a context switch
+	if((_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(aCpuInfo, 7, 0);
+	return (aCpuInfo[1] & (1 << 5)) != 0;
+	#else
+	return false;
+	#endif
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+//==============================================================================
+//
+// File: CpuFeatures.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file tells which instruction sets the CPU supports. The scanning
+// kernels and the string kernels both use it to pick their fastest kernel
+// when the program starts.
+//
+//==============================================================================
+
+#pragma once
+
+// The AVX2 intrinsics are only available since Visual Studio 2012, the AVX2 kernels are only compiled if they are
+// The project builds with the Visual Studio 2010 toolset (v100), so it only has the SSE2 and scalar kernels. Building
+// with the v110 toolset or later, or defining CPU_FEATURES_AVX2 for a compiler that has the intrinsics, adds AVX2
+#if !defined(CPU_FEATURES_AVX2) && defined(_MSC_VER) && _MSC_VER >= 1700
+#define CPU_FEATURES_AVX2 1
+#endif
+
+// Returns true if the CPU supports SSE2
+bool CpuSupportsSSE2();
+// Returns true if both the CPU and the OS support AVX2, always false if the AVX2 kernels aren't compiled
+bool CpuSupportsAVX2();
\ No newline at end of file
@@ -15,6 +15,32 @@
 #include "CParser.h"
 #include "CCompiler.h"
 #include "CFunctionWrapper.h"
+#include "CThreadPool.h"
+#include "CEditSession.h"
+#include "CDiagnostics.h"
+#include "CNativeCache.h"
+#include "CFormat.h"
+#include "CPluginLoader.h"
+#include "CPassManager.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+// The amount of tokens the tokenizer keeps in memory when it streams the tokens to the parser
+#define STREAM_WINDOW_SIZE 1024
+
+// Registers the natives, then the functions of the plugins, the program stops if a plugin can't be loaded
+static void RegisterFunctions(char * argv[], const std::vector<int> & lPluginArguments)
+{
+	CFunctionWrapper::RegisterNatives();
+
+	for(size_t i = 0; i < lPluginArguments.size(); i++)
+	{
+		if(!CPluginLoader::Load(argv[lPluginArguments[i]]))
+			exit(1);
+	}
+}
 
 int main(int argc, char * argv[])
 {
@@ -29,19 +55,130 @@ int main(int argc, char * argv[])
 		exit(1);
 	}
 
+	// Check the options after the source file
+	// -stream: the parser pulls the tokens from the tokenizer, only a small window of tokens is kept in memory
+	// -pipeline: like -stream, but the tokens are lexed on a separate thread while the parser runs
+	// -threads N: lex the source and evaluate the script on N threads (0 means one thread for every processor)
+	// -edit OFFSET LENGTH TEXT: replace LENGTH bytes at OFFSET by TEXT, then check the script again (see CEditSession)
+	// -max-errors N: give up after N errors (0 means there's no limit, the default is DIAGNOSTIC_DEFAULT_ERROR_LIMIT)
+	// -diagnostics json: print the errors as one JSON document instead of one line per error
+	// -warnings: also report the variables used before they're assigned and the values that are never read
+	// -native-cache N: remember the results of up to N calls of pure natives (0 turns the cache off)
+	// -stats: log the statistics of the native cache and the formats when the script is compiled
+	// -plugin FILE: load the natives of a plugin DLL (see CMinusMinusPlugin.h), can be given more than once
+	// -passes LIST: the IR passes to run, in order and separated by commas ("none" runs no pass, see CPassManager.h)
+	// -dump-ir: log the IR before the first pass and after every pass
+	// -time-passes: log how long every pass took
+	bool bStream = false;
+	bool bPipeline = false;
+	int iThreadCount = 1;
+	bool bStatistics = false;
+	std::vector<int> lEditArguments;
+	std::vector<int> lPluginArguments;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-stream") == 0)
+			bStream = true;
+		else if(strcmp(argv[i], "-pipeline") == 0)
+			bPipeline = true;
+		else if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+			iThreadCount = atoi(argv[++i]);
+		else if(strcmp(argv[i], "-edit") == 0 && i + 3 < argc)
+		{
+			lEditArguments.push_back(i + 1);
+			i += 3;
+		}
+		else if(strcmp(argv[i], "-warnings") == 0)
+			CDiagnostics::SetWarningsEnabled(true);
+		else if(strcmp(argv[i], "-native-cache") == 0 && i + 1 < argc)
+			CNativeCache::SetCapacity((size_t) atoi(argv[++i]));
+		else if(strcmp(argv[i], "-stats") == 0)
+			bStatistics = true;
+		else if(strcmp(argv[i], "-plugin") == 0 && i + 1 < argc)
+			lPluginArguments.push_back(++i);
+		else if(strcmp(argv[i], "-passes") == 0 && i + 1 < argc)
+			CPassManager::SetPipeline(argv[++i]);
+		else if(strcmp(argv[i], "-dump-ir") == 0)
+			CPassManager::SetDumpEnabled(true);
+		else if(strcmp(argv[i], "-time-passes") == 0)
+			CPassManager::SetTimingEnabled(true);
+		else if(strcmp(argv[i], "-max-errors") == 0 && i + 1 < argc)
+			CDiagnostics::SetErrorLimit((size_t) atoi(argv[++i]));
+		else if(strcmp(argv[i], "-diagnostics") == 0 && i + 1 < argc)
+		{
+			i++;
+
+			if(strcmp(argv[i], "json") == 0)
+				CDiagnostics::SetOutputFormat(DIAGNOSTIC_OUTPUT_JSON);
+			else if(strcmp(argv[i], "text") == 0)
+				CDiagnostics::SetOutputFormat(DIAGNOSTIC_OUTPUT_TEXT);
+			else
+				CLogger::Write("* Unknown diagnostics format %s", argv[i]);
+		}
+		else
+			CLogger::Write("* Unknown option %s", argv[i]);
+	}
+
+	if(iThreadCount <= 0)
+		iThreadCount = CThreadPool::GetProcessorCount();
+
+	// Edits are applied to the script in an edit session, only what an edit touched is lexed and parsed again
+	if(!lEditArguments.empty())
+	{
+		RegisterFunctions(argv, lPluginArguments);
+
+		CEditSession oSession(argv[1], iThreadCount);
+		oSession.Open();
+
+		for(size_t i = 0; i < lEditArguments.size(); i++)
+		{
+			int iArgument = lEditArguments[i];
+			oSession.ApplyEdit((size_t) atoi(argv[iArgument]), (size_t) atoi(argv[iArgument + 1]), argv[iArgument + 2]);
+		}
+
+		oSession.LogErrors();
+		CCompiler::Run();
+
+		if(bStatistics)
+		{
+			CNativeCache::LogStatistics();
+			CFormat::LogStatistics();
+		}
+
+		// Stop the console from closing
+		std::getchar();
+		return 0;
+	}
+
 	// Initialise the tokenizer
-	CTokenizer oTokenizer = CTokenizer(argv[1]);
-	oTokenizer.Run();
+	CTokenizer oTokenizer(argv[1]);
 
-	// Register the natives for the language
-	CFunctionWrapper::RegisterNatives();
+	// Either lex the entire source now (on one or more threads), or let the parser pull the tokens
+	if(bPipeline)
+		oTokenizer.Pipeline(STREAM_WINDOW_SIZE);
+	else if(bStream)
+		oTokenizer.Stream(STREAM_WINDOW_SIZE);
+	else if(iThreadCount > 1)
+		oTokenizer.RunParallel(iThreadCount);
+	else
+		oTokenizer.Run();
+
+	// Register the natives for the language, and the ones of the plugins
+	RegisterFunctions(argv, lPluginArguments);
 
-	// Pass the token list onto the parser
-	CParser oParser = CParser(oTokenizer.GetTokenList());
-	oParser.Run();
+	// Pass the tokenizer onto the parser
+	CParser oParser(oTokenizer);
+	oParser.Run(iThreadCount);
 
 	CCompiler::Run();
 
+	if(bStatistics)
+	{
+		CNativeCache::LogStatistics();
+		CFormat::LogStatistics();
+	}
+
 	// Stop the console from closing
 	std::getchar();
 	return 0;
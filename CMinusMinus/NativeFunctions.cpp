@@ -12,64 +12,231 @@
 #include "NativeFunctions.h"
 #include "CLogger.h"
 #include "CCompiler.h"
+#include "StringKernels.h"
+#include "CFormat.h"
+#include "Util.h"
 
-#include <sstream>
+#include <cmath>
 
 // The power function executes base^exponent (both parameters are floats)
-CReturnValue power(ParameterList lParameterList)
+double power(double fBase, double fExponent)
 {
-	double fBase = lParameterList[0].m_fValue;
-	double fExponent = lParameterList[1].m_fValue;
-
-	return CReturnValue(VARIABLE_TYPE_FLOAT, (float) pow(fBase, fExponent));
+	return pow(fBase, fExponent);
 }
 
 // The squareroot function, returns the squareroot of the float parameter
-CReturnValue squareroot(ParameterList lParameterList)
+double squareroot(double fValue)
 {
-	double fValue = lParameterList[0].m_fValue;
-
-	return CReturnValue(VARIABLE_TYPE_FLOAT, (float) sqrt(fValue));
+	return sqrt(fValue);
 }
 
 // The messageBox function, outputs a mesagebox
-CReturnValue messageBox(ParameterList lParameterList)
+// It's effectful, this is called when the program is compiled and emits the code that shows the messagebox
+void messageBox(const char * szText, const char * szCaption)
 {
-	CCompiler::AddFunction(MESSAGEBOX_FUNCTION, lParameterList);
-	return CReturnValue();
+	std::string sCode = "\tinvoke	MessageBox,HWND_DESKTOP,\"";
+	sCode += szText;
+	sCode += "\",\"";
+	sCode += szCaption;
+	sCode += "\",MB_OK\n";
+
+	CCompiler::Emit(sCode);
 }
 
 // The substring function returns a substring of the parameter
-CReturnValue getSubstring(ParameterList lParameterList)
+std::string getSubstring(const std::string & sString, int iStart, int iLength)
 {
-	std::string sString = lParameterList[0].m_sValue;
-	int iStart = lParameterList[1].m_iValue;
-	int iEnd = lParameterList[2].m_iValue;
+	// The start is clamped to the string and a negative length is 0, a substring past the end is empty
+	if(iStart < 0)
+		iStart = 0;
+
+	if((size_t) iStart > sString.size())
+		iStart = (int) sString.size();
 
-	return CReturnValue(VARIABLE_TYPE_STRING, sString.substr(iStart, iEnd));
+	if(iLength < 0)
+		iLength = 0;
+
+	return sString.substr(iStart, iLength);
 }
 
 // Returns the string size
-CReturnValue getSize(ParameterList lParameterList)
+int getSize(CStringValue oString)
+{
+	// The value knows its length, the string doesn't have to be copied
+	return (int) oString->GetLength();
+}
+
+// Converts a float or integer to a string, floats are written with the fewest digits that read back as the same float
+CValue toString(const CValue & oValue)
 {
-	std::string sString = lParameterList[0].m_sValue;
+	char szNumber[MAX_NUMBER_STRING_LENGTH];
 
-	return CReturnValue(VARIABLE_TYPE_INTEGER, (int) sString.size());
+	if(oValue.GetType() == VARIABLE_TYPE_FLOAT)
+		return CValue(szNumber, FormatFloat(oValue.GetFloat(), szNumber));
+
+	if(oValue.GetType() == VARIABLE_TYPE_INTEGER)
+		return CValue(szNumber, FormatInteger(oValue.GetInteger(), szNumber));
+
+	// A string is shared, not copied
+	return oValue;
 }
 
-// Converts a float or integer to a string
-CReturnValue toString(ParameterList lParameterList)
+// Returns where part first occurs in the string, -1 if it doesn't
+int find(CStringValue oString, CStringValue oPart)
 {
-	std::stringstream ssString;
+	size_t iIndex = FindSubstring(oString->GetString(), oString->GetLength(), oPart->GetString(), oPart->GetLength());
+	return iIndex == STRING_NOT_FOUND ? -1 : (int) iIndex;
+}
 
-	if(lParameterList[0].m_eType == PARAMETER_TYPE_STRING)
-		ssString << lParameterList[0].m_sValue;
+// Returns how often part occurs in the string, the occurrences don't overlap
+int count(CStringValue oString, CStringValue oPart)
+{
+	return (int) CountSubstring(oString->GetString(), oString->GetLength(), oPart->GetString(), oPart->GetLength());
+}
+
+// Replaces every occurrence of part in the string by the replacement
+std::string replace(CStringValue oString, CStringValue oPart, CStringValue oReplacement)
+{
+	const char * szString = oString->GetString();
+	size_t iLength = oString->GetLength();
+	size_t iPartLength = oPart->GetLength();
+
+	// An empty part occurs everywhere, there's nothing sensible to replace
+	if(iPartLength == 0)
+		return std::string(szString, iLength);
+
+	// Count the occurrences first, so the result is allocated once
+	size_t iCount = CountSubstring(szString, iLength, oPart->GetString(), iPartLength);
+	std::string sResult;
+	sResult.reserve(iLength - iCount * iPartLength + iCount * oReplacement->GetLength());
+
+	size_t iStart = 0;
+
+	for(size_t i = 0; i < iCount; i++)
+	{
+		size_t iIndex = iStart + FindSubstring(szString + iStart, iLength - iStart, oPart->GetString(), iPartLength);
+		sResult.append(szString + iStart, iIndex - iStart);
+		sResult.append(oReplacement->GetString(), oReplacement->GetLength());
+		iStart = iIndex + iPartLength;
+	}
+
+	sResult.append(szString + iStart, iLength - iStart);
+	return sResult;
+}
+
+// Splits the string at every separator and returns field iIndex (counting from 0), an empty string if there's no such field
+CValue split(CStringValue oString, CStringValue oSeparator, int iIndex)
+{
+	const char * szString = oString->GetString();
+	size_t iLength = oString->GetLength();
+	size_t iSeparatorLength = oSeparator->GetLength();
+
+	if(iIndex < 0)
+		return CValue(VARIABLE_TYPE_STRING);
+
+	// Without a separator the string is one field
+	if(iSeparatorLength == 0)
+		return iIndex == 0 ? *oString : CValue(VARIABLE_TYPE_STRING);
+
+	// Skip the fields before the one we want
+	size_t iStart = 0;
+
+	for(int i = 0; i < iIndex; i++)
+	{
+		size_t iSeparator = FindSubstring(szString + iStart, iLength - iStart, oSeparator->GetString(), iSeparatorLength);
+
+		if(iSeparator == STRING_NOT_FOUND)
+			return CValue(VARIABLE_TYPE_STRING);
+
+		iStart += iSeparator + iSeparatorLength;
+	}
+
+	// The field ends at the next separator, or at the end of the string
+	size_t iEnd = FindSubstring(szString + iStart, iLength - iStart, oSeparator->GetString(), iSeparatorLength);
+	iEnd = iEnd == STRING_NOT_FOUND ? iLength : iStart + iEnd;
+
+	return CValue(szString + iStart, iEnd - iStart);
+}
+
+// Compares two strings byte by byte, returns -1, 0 or 1
+int compare(CStringValue oFirst, CStringValue oSecond)
+{
+	// A shared rope is equal to itself, it doesn't have to be flattened
+	if(oFirst->IsIdentical(*oSecond))
+		return 0;
 
-	if(lParameterList[0].m_eType == PARAMETER_TYPE_FLOAT)
-		ssString << lParameterList[0].m_fValue;
+	size_t iLength = oFirst->GetLength() < oSecond->GetLength() ? oFirst->GetLength() : oSecond->GetLength();
+	const char * szFirst = oFirst->GetString();
+	const char * szSecond = oSecond->GetString();
+	size_t iMismatch = FindMismatch(szFirst, szSecond, iLength);
 
-	if(lParameterList[0].m_eType == PARAMETER_TYPE_INTEGER)
-		ssString << lParameterList[0].m_iValue;
+	// The bytes are compared unsigned, like strcmp does
+	if(iMismatch < iLength)
+		return (unsigned char) szFirst[iMismatch] < (unsigned char) szSecond[iMismatch] ? -1 : 1;
 
-	return CReturnValue(VARIABLE_TYPE_STRING, ssString.str());
+	// One string starts with the other, the shortest one comes first
+	if(oFirst->GetLength() == oSecond->GetLength())
+		return 0;
+
+	return oFirst->GetLength() < oSecond->GetLength() ? -1 : 1;
+}
+
+// Returns the string in upper case, only ASCII letters are changed
+std::string toUpper(CStringValue oString)
+{
+	std::string sResult(oString->GetLength(), '\0');
+
+	if(!sResult.empty())
+		ChangeCase(oString->GetString(), &sResult[0], sResult.size(), true);
+
+	return sResult;
+}
+
+// Returns the string in lower case, only ASCII letters are changed
+std::string toLower(CStringValue oString)
+{
+	std::string sResult(oString->GetLength(), '\0');
+
+	if(!sResult.empty())
+		ChangeCase(oString->GetString(), &sResult[0], sResult.size(), false);
+
+	return sResult;
+}
+
+// Returns the string without the whitespace at its start and its end
+CValue trim(CStringValue oString)
+{
+	const char * szString = oString->GetString();
+	size_t iEnd = SkipSpaceBackwards(szString, oString->GetLength());
+	size_t iStart = SkipSpace(szString, iEnd);
+
+	// Nothing to trim, the value can be shared instead of copied
+	if(iStart == 0 && iEnd == oString->GetLength())
+		return *oString;
+
+	return CValue(szString + iStart, iEnd - iStart);
+}
+
+// Formats the arguments, see CFormat.h for the placeholders
+std::string format(CStringValue oFormat)
+{
+	return CFormat::Format(*oFormat, NULL, 0);
+}
+
+std::string format(CStringValue oFormat, const CValue & oFirst)
+{
+	const CValue * apArguments[] = { &oFirst };
+	return CFormat::Format(*oFormat, apArguments, 1);
+}
+
+std::string format(CStringValue oFormat, const CValue & oFirst, const CValue & oSecond)
+{
+	const CValue * apArguments[] = { &oFirst, &oSecond };
+	return CFormat::Format(*oFormat, apArguments, 2);
+}
+
+std::string format(CStringValue oFormat, const CValue & oFirst, const CValue & oSecond, const CValue & oThird)
+{
+	const CValue * apArguments[] = { &oFirst, &oSecond, &oThird };
+	return CFormat::Format(*oFormat, apArguments, 3);
 }
\ No newline at end of file
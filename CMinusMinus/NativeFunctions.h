@@ -9,20 +9,42 @@
 // 
 //==============================================================================
 
-#include "CReturnValue.h"
-#include "CParameter.h"
+#pragma once
 
+#include <string>
+#include "CValue.h"
+#include "CNativeBinder.h"
+
+// The natives are bound with BindNative(), their parameter types follow from these signatures
 // The power function executes base^exponent (both parameters are floats)
-CReturnValue power(ParameterList);
+double power(double fBase, double fExponent);
 // The squareroot function, returns the squareroot of the float parameter
-CReturnValue squareroot(ParameterList);
+double squareroot(double fValue);
 // The messageBox function, outputs a mesagebox
-CReturnValue messageBox(ParameterList);
+void messageBox(const char * szText, const char * szCaption);
 // The substring function returns a substring of the parameter
-CReturnValue getSubstring(ParameterList);
+std::string getSubstring(const std::string & sString, int iStart, int iLength);
 // Returns the string size
-CReturnValue getSize(ParameterList);
-// Convert int and floats to a string
-CReturnValue getSize(ParameterList);
-// Converts any type to a string
-CReturnValue toString(ParameterList lParameterList);
\ No newline at end of file
+int getSize(CStringValue oString);
+// Converts any type to a string, floats are written with the fewest digits that read back as the same float
+CValue toString(const CValue & oValue);
+// Returns where part first occurs in the string, -1 if it doesn't
+int find(CStringValue oString, CStringValue oPart);
+// Returns how often part occurs in the string, the occurrences don't overlap
+int count(CStringValue oString, CStringValue oPart);
+// Replaces every occurrence of part in the string by the replacement
+std::string replace(CStringValue oString, CStringValue oPart, CStringValue oReplacement);
+// Splits the string at every separator and returns field iIndex (counting from 0), an empty string if there's no such field
+CValue split(CStringValue oString, CStringValue oSeparator, int iIndex);
+// Compares two strings byte by byte, returns -1, 0 or 1
+int compare(CStringValue oFirst, CStringValue oSecond);
+// Returns the string in upper case or lower case, only ASCII letters are changed
+std::string toUpper(CStringValue oString);
+std::string toLower(CStringValue oString);
+// Returns the string without the whitespace at its start and its end
+CValue trim(CStringValue oString);
+// Formats the arguments, see CFormat.h for the placeholders
+std::string format(CStringValue oFormat);
+std::string format(CStringValue oFormat, const CValue & oFirst);
+std::string format(CStringValue oFormat, const CValue & oFirst, const CValue & oSecond);
+std::string format(CStringValue oFormat, const CValue & oFirst, const CValue & oSecond, const CValue & oThird);
\ No newline at end of file
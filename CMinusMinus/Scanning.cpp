@@ -0,0 +1,347 @@
+//==============================================================================
+//
+// File: Scanning.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the character class table and the scanning kernels the tokenizer
+// uses. Every byte of the source is classified through one table lookup instead of
+// a chain of comparisons. Whitespace, string literal bodies and comment bodies are
+// skipped 16 (SSE2) or 32 (AVX2) bytes at a time, the kernel is picked at runtime
+// depending on what the CPU supports, with a scalar fallback. The AVX2 kernels
+// are only compiled by Visual Studio 2012 and later, see CpuFeatures.h.
+//
+//==============================================================================
+
+#include "Scanning.h"
+#include "TokenTypes.h"
+#include "CpuFeatures.h"
+
+#include <intrin.h>
+#include <emmintrin.h>
+#include <cstring>
+
+#if CPU_FEATURES_AVX2
+#include <immintrin.h>
+#endif
+
+// The class of every possible byte, filled in when the program starts
+unsigned char g_aCharacterClasses[256];
+
+// Fills in the character class table
+// The punctuators come from TOKEN_TYPE_LIST, so the table can't get out of sync with the token types
+static bool InitialiseCharacterClasses()
+{
+	memset(g_aCharacterClasses, CHARACTER_CLASS_VALUE, sizeof(g_aCharacterClasses));
+
+	g_aCharacterClasses[(unsigned char) ' '] = CHARACTER_CLASS_WHITESPACE;
+	g_aCharacterClasses[(unsigned char) '\t'] = CHARACTER_CLASS_WHITESPACE;
+	g_aCharacterClasses[(unsigned char) '\r'] = CHARACTER_CLASS_WHITESPACE;
+	g_aCharacterClasses[(unsigned char) '\n'] = CHARACTER_CLASS_WHITESPACE;
+	g_aCharacterClasses[(unsigned char) '"'] = CHARACTER_CLASS_DOUBLE_QUOTE;
+	g_aCharacterClasses[(unsigned char) '/'] = CHARACTER_CLASS_SLASH;
+
+	// Every single character punctuator is a token of its own
+	#define CHARACTER_CLASS_PUNCTUATOR_ENTRY(eType, eClass, szSpelling) \
+		if(TOKEN_TYPE_CLASS_##eClass == TOKEN_TYPE_CLASS_PUNCTUATOR && sizeof(szSpelling) == 2) \
+			g_aCharacterClasses[(unsigned char) szSpelling[0]] = CHARACTER_CLASS_PUNCTUATOR;
+	TOKEN_TYPE_LIST(CHARACTER_CLASS_PUNCTUATOR_ENTRY)
+	#undef CHARACTER_CLASS_PUNCTUATOR_ENTRY
+
+	return true;
+}
+
+// The table is filled in once, when the program starts
+static const bool g_bCharacterClassesInitialised = InitialiseCharacterClasses();
+
+// Returns the amount of bits set in iMask
+// There are only a few newlines in each block, so we don't need the popcnt instruction for this
+static int CountBits(unsigned int iMask)
+{
+	int iCount = 0;
+
+	for(; iMask != 0; iMask &= iMask - 1)
+		iCount++;
+
+	return iCount;
+}
+
+// Returns the index of the lowest bit set in iMask, iMask can't be 0
+static unsigned int GetLowestBitIndex(unsigned int iMask)
+{
+	unsigned long iIndex;
+	_BitScanForward(&iIndex, iMask);
+	return iIndex;
+}
+
+//==============================================================================
+// Scalar kernels, these work on every CPU
+//==============================================================================
+
+static const char * SkipWhitespaceScalar(const char * pCurrent, const char * pEnd, int & iNewLines)
+{
+	while(pCurrent < pEnd && GetCharacterClass(*pCurrent) == CHARACTER_CLASS_WHITESPACE)
+	{
+		if(*pCurrent == '\n')
+			iNewLines++;
+
+		pCurrent++;
+	}
+
+	return pCurrent;
+}
+
+static const char * FindCharacterScalar(const char * pCurrent, const char * pEnd, char cCharacter, int & iNewLines)
+{
+	while(pCurrent < pEnd && *pCurrent != cCharacter)
+	{
+		if(*pCurrent == '\n')
+			iNewLines++;
+
+		pCurrent++;
+	}
+
+	return pCurrent;
+}
+
+//==============================================================================
+// SSE2 kernels, these process 16 bytes at a time
+//==============================================================================
+
+static const char * SkipWhitespaceSSE2(const char * pCurrent, const char * pEnd, int & iNewLines)
+{
+	const __m128i xSpace = _mm_set1_epi8(' ');
+	const __m128i xTab = _mm_set1_epi8('\t');
+	const __m128i xCarriageReturn = _mm_set1_epi8('\r');
+	const __m128i xNewLine = _mm_set1_epi8('\n');
+
+	while(pEnd - pCurrent >= 16)
+	{
+		__m128i xBytes = _mm_loadu_si128((const __m128i *) pCurrent);
+		__m128i xNewLines = _mm_cmpeq_epi8(xBytes, xNewLine);
+		__m128i xWhitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(xBytes, xSpace), _mm_cmpeq_epi8(xBytes, xTab)), _mm_or_si128(_mm_cmpeq_epi8(xBytes, xCarriageReturn), xNewLines));
+
+		unsigned int iWhitespaceMask = (unsigned int) _mm_movemask_epi8(xWhitespace);
+		unsigned int iNewLineMask = (unsigned int) _mm_movemask_epi8(xNewLines);
+
+		// Is there a character in this block that isn't whitespace?
+		if(iWhitespaceMask != 0xFFFF)
+		{
+			unsigned int iIndex = GetLowestBitIndex(~iWhitespaceMask & 0xFFFF);
+			iNewLines += CountBits(iNewLineMask & ((1u << iIndex) - 1));
+			return pCurrent + iIndex;
+		}
+
+		iNewLines += CountBits(iNewLineMask);
+		pCurrent += 16;
+	}
+
+	// Less than 16 bytes left
+	return SkipWhitespaceScalar(pCurrent, pEnd, iNewLines);
+}
+
+static const char * FindCharacterSSE2(const char * pCurrent, const char * pEnd, char cCharacter, int & iNewLines)
+{
+	const __m128i xCharacter = _mm_set1_epi8(cCharacter);
+	const __m128i xNewLine = _mm_set1_epi8('\n');
+
+	while(pEnd - pCurrent >= 16)
+	{
+		__m128i xBytes = _mm_loadu_si128((const __m128i *) pCurrent);
+
+		unsigned int iCharacterMask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(xBytes, xCharacter));
+		unsigned int iNewLineMask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(xBytes, xNewLine));
+
+		// Did we find the character in this block?
+		if(iCharacterMask != 0)
+		{
+			unsigned int iIndex = GetLowestBitIndex(iCharacterMask);
+			iNewLines += CountBits(iNewLineMask & ((1u << iIndex) - 1));
+			return pCurrent + iIndex;
+		}
+
+		iNewLines += CountBits(iNewLineMask);
+		pCurrent += 16;
+	}
+
+	// Less than 16 bytes left
+	return FindCharacterScalar(pCurrent, pEnd, cCharacter, iNewLines);
+}
+
+//==============================================================================
+// AVX2 kernels, these process 32 bytes at a time
+//==============================================================================
+
+#if CPU_FEATURES_AVX2
+static const char * SkipWhitespaceAVX2(const char * pCurrent, const char * pEnd, int & iNewLines)
+{
+	const __m256i xSpace = _mm256_set1_epi8(' ');
+	const __m256i xTab = _mm256_set1_epi8('\t');
+	const __m256i xCarriageReturn = _mm256_set1_epi8('\r');
+	const __m256i xNewLine = _mm256_set1_epi8('\n');
+
+	while(pEnd - pCurrent >= 32)
+	{
+		__m256i xBytes = _mm256_loadu_si256((const __m256i *) pCurrent);
+		__m256i xNewLines = _mm256_cmpeq_epi8(xBytes, xNewLine);
+		__m256i xWhitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(xBytes, xSpace), _mm256_cmpeq_epi8(xBytes, xTab)), _mm256_or_si256(_mm256_cmpeq_epi8(xBytes, xCarriageReturn), xNewLines));
+
+		unsigned int iWhitespaceMask = (unsigned int) _mm256_movemask_epi8(xWhitespace);
+		unsigned int iNewLineMask = (unsigned int) _mm256_movemask_epi8(xNewLines);
+
+		// Is there a character in this block that isn't whitespace?
+		if(iWhitespaceMask != 0xFFFFFFFF)
+		{
+			unsigned int iIndex = GetLowestBitIndex(~iWhitespaceMask);
+			iNewLines += CountBits(iNewLineMask & ((1u << iIndex) - 1));
+			return pCurrent + iIndex;
+		}
+
+		iNewLines += CountBits(iNewLineMask);
+		pCurrent += 32;
+	}
+
+	// Less than 32 bytes left
+	return SkipWhitespaceSSE2(pCurrent, pEnd, iNewLines);
+}
+
+static const char * FindCharacterAVX2(const char * pCurrent, const char * pEnd, char cCharacter, int & iNewLines)
+{
+	const __m256i xCharacter = _mm256_set1_epi8(cCharacter);
+	const __m256i xNewLine = _mm256_set1_epi8('\n');
+
+	while(pEnd - pCurrent >= 32)
+	{
+		__m256i xBytes = _mm256_loadu_si256((const __m256i *) pCurrent);
+
+		unsigned int iCharacterMask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(xBytes, xCharacter));
+		unsigned int iNewLineMask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(xBytes, xNewLine));
+
+		// Did we find the character in this block?
+		if(iCharacterMask != 0)
+		{
+			unsigned int iIndex = GetLowestBitIndex(iCharacterMask);
+			iNewLines += CountBits(iNewLineMask & ((1u << iIndex) - 1));
+			return pCurrent + iIndex;
+		}
+
+		iNewLines += CountBits(iNewLineMask);
+		pCurrent += 32;
+	}
+
+	// Less than 32 bytes left
+	return FindCharacterSSE2(pCurrent, pEnd, cCharacter, iNewLines);
+}
+#endif
+
+//==============================================================================
+// Kernel selection
+//==============================================================================
+
+// Holds the kernels that were picked for this CPU
+struct CScanningKernels
+{
+	// The name of the kernel, used for debugging
+	const char * m_szName;
+	// Skips whitespace
+	const char * (*m_pSkipWhitespace) (const char *, const char *, int &);
+	// Finds a character
+	const char * (*m_pFindCharacter) (const char *, const char *, char, int &);
+};
+
+// Picks the fastest kernels the CPU supports
+static CScanningKernels SelectScanningKernels()
+{
+	CScanningKernels oKernels;
+
+	#if CPU_FEATURES_AVX2
+	if(CpuSupportsAVX2())
+	{
+		oKernels.m_szName = "AVX2";
+		oKernels.m_pSkipWhitespace = SkipWhitespaceAVX2;
+		oKernels.m_pFindCharacter = FindCharacterAVX2;
+		return oKernels;
+	}
+	#endif
+
+	if(CpuSupportsSSE2())
+	{
+		oKernels.m_szName = "SSE2";
+		oKernels.m_pSkipWhitespace = SkipWhitespaceSSE2;
+		oKernels.m_pFindCharacter = FindCharacterSSE2;
+		return oKernels;
+	}
+
+	oKernels.m_szName = "scalar";
+	oKernels.m_pSkipWhitespace = SkipWhitespaceScalar;
+	oKernels.m_pFindCharacter = FindCharacterScalar;
+	return oKernels;
+}
+
+// The kernels are picked once, when the program starts
+static const CScanningKernels g_oScanningKernels = SelectScanningKernels();
+
+//==============================================================================
+// Public scanning functions
+//==============================================================================
+
+// Returns a pointer to the first character that isn't whitespace (or pEnd)
+const char * SkipWhitespace(const char * pCurrent, const char * pEnd, int & iNewLines)
+{
+	// Most whitespace runs are a single space between two tokens, those aren't worth a vector load
+	if(pEnd - pCurrent < 2 || GetCharacterClass(pCurrent[1]) != CHARACTER_CLASS_WHITESPACE)
+		return SkipWhitespaceScalar(pCurrent, pEnd, iNewLines);
+
+	return g_oScanningKernels.m_pSkipWhitespace(pCurrent, pEnd, iNewLines);
+}
+
+// Returns a pointer to the first occurrence of cCharacter (or pEnd)
+const char * FindCharacter(const char * pCurrent, const char * pEnd, char cCharacter, int & iNewLines)
+{
+	return g_oScanningKernels.m_pFindCharacter(pCurrent, pEnd, cCharacter, iNewLines);
+}
+
+// Returns a pointer to the first character after a variable name, function name or value (or pEnd)
+const char * SkipValue(const char * pCurrent, const char * pEnd)
+{
+	while(pCurrent < pEnd)
+	{
+		eCharacterClass eClass = GetCharacterClass(*pCurrent);
+
+		// A slash is part of the value, unless it starts a comment
+		if(eClass == CHARACTER_CLASS_SLASH && (pEnd - pCurrent < 2 || (pCurrent[1] != '/' && pCurrent[1] != '*')))
+			eClass = CHARACTER_CLASS_VALUE;
+
+		if(eClass != CHARACTER_CLASS_VALUE)
+			break;
+
+		pCurrent++;
+	}
+
+	return pCurrent;
+}
+
+// Returns a pointer to the first character after the end of a multi line comment (or pEnd)
+const char * SkipMultiLineComment(const char * pCurrent, const char * pEnd, int & iNewLines)
+{
+	while(true)
+	{
+		// Jump to the next star, the comment ends if it's followed by a slash
+		pCurrent = FindCharacter(pCurrent, pEnd, '*', iNewLines);
+
+		if(pEnd - pCurrent < 2)
+			return pEnd;
+
+		if(pCurrent[1] == '/')
+			return pCurrent + 2;
+
+		pCurrent++;
+	}
+}
+
+// Returns the name of the scanning kernel that was picked for this CPU
+const char * GetScanningKernelName()
+{
+	return g_oScanningKernels.m_szName;
+}
\ No newline at end of file
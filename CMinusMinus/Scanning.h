@@ -0,0 +1,57 @@
+//==============================================================================
+//
+// File: Scanning.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the character class table and the scanning kernels the tokenizer
+// uses. Every byte of the source is classified through one table lookup instead of
+// a chain of comparisons. Whitespace, string literal bodies and comment bodies are
+// skipped 16 (SSE2) or 32 (AVX2) bytes at a time, the kernel is picked at runtime
+// depending on what the CPU supports, with a scalar fallback. The AVX2 kernels
+// are only compiled by Visual Studio 2012 and later, see CpuFeatures.h.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+
+// The classes a byte of the source can belong to
+enum eCharacterClass
+{
+	// Part of a variable name, function name or value
+	CHARACTER_CLASS_VALUE,
+	// ' ', '\t', '\r' and '\n'
+	CHARACTER_CLASS_WHITESPACE,
+	// A single character token: { } ( ) , ; = + -
+	CHARACTER_CLASS_PUNCTUATOR,
+	// '"', starts or ends a string literal
+	CHARACTER_CLASS_DOUBLE_QUOTE,
+	// '/', might start a comment
+	CHARACTER_CLASS_SLASH
+};
+
+// The class of every possible byte, the punctuators are taken from TOKEN_TYPE_LIST (see TokenTypes.h)
+extern unsigned char g_aCharacterClasses[256];
+
+// Returns the class of a character
+inline eCharacterClass GetCharacterClass(char cCharacter)
+{
+	return (eCharacterClass) g_aCharacterClasses[(unsigned char) cCharacter];
+}
+
+// Returns a pointer to the first character that isn't whitespace (or pEnd)
+// The amount of newlines that were skipped is added to iNewLines
+const char * SkipWhitespace(const char * pCurrent, const char * pEnd, int & iNewLines);
+// Returns a pointer to the first occurrence of cCharacter (or pEnd)
+// The amount of newlines that were skipped is added to iNewLines
+const char * FindCharacter(const char * pCurrent, const char * pEnd, char cCharacter, int & iNewLines);
+// Returns a pointer to the first character after a variable name, function name or value (or pEnd)
+const char * SkipValue(const char * pCurrent, const char * pEnd);
+// Returns a pointer to the first character after the end of a multi line comment (or pEnd)
+// The amount of newlines that were skipped is added to iNewLines
+const char * SkipMultiLineComment(const char * pCurrent, const char * pEnd, int & iNewLines);
+// Returns the name of the scanning kernel that was picked for this CPU
+const char * GetScanningKernelName();
\ No newline at end of file
@@ -0,0 +1,547 @@
+//==============================================================================
+//
+// File: StringKernels.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the kernels of the string natives: searching, counting,
+// comparing, changing the case and trimming. They work on a pointer and a
+// length, so the natives can run them on the characters of a value without
+// copying them. Like the scanning kernels of the tokenizer they process 16
+// (SSE2) or 32 (AVX2) bytes at a time, the kernel is picked at runtime
+// depending on what the CPU supports, with a scalar fallback. The AVX2 kernels
+// are only compiled by Visual Studio 2012 and later, see CpuFeatures.h.
+//
+//==============================================================================
+
+#include "StringKernels.h"
+#include "CpuFeatures.h"
+
+#include <intrin.h>
+#include <emmintrin.h>
+#include <cstring>
+
+#if CPU_FEATURES_AVX2
+#include <immintrin.h>
+#endif
+
+// The most blocks the counting kernels add up in bytes, one more could overflow them
+#define STRING_MAX_COUNT_BLOCKS 255
+
+// Returns the index of the lowest bit set in iMask, iMask can't be 0
+static unsigned int GetLowestBitIndex(unsigned int iMask)
+{
+	unsigned long iIndex;
+	_BitScanForward(&iIndex, iMask);
+	return iIndex;
+}
+
+// Returns the index of the highest bit set in iMask, iMask can't be 0
+static unsigned int GetHighestBitIndex(unsigned int iMask)
+{
+	unsigned long iIndex;
+	_BitScanReverse(&iIndex, iMask);
+	return iIndex;
+}
+
+// Is the character whitespace? That's a space and '\t' up to '\r'
+static bool IsSpace(char cCharacter)
+{
+	return cCharacter == ' ' || (cCharacter >= '\t' && cCharacter <= '\r');
+}
+
+//==============================================================================
+// Scalar kernels, these work on every CPU
+//==============================================================================
+
+// The part is never empty and never longer than the string, the public functions check that
+static size_t FindSubstringScalar(const char * szString, size_t iLength, const char * szPart, size_t iPartLength)
+{
+	for(size_t i = 0; i + iPartLength <= iLength; i++)
+	{
+		if(szString[i] == szPart[0] && memcmp(szString + i + 1, szPart + 1, iPartLength - 1) == 0)
+			return i;
+	}
+
+	return STRING_NOT_FOUND;
+}
+
+static size_t CountCharacterScalar(const char * szString, size_t iLength, char cCharacter)
+{
+	size_t iCount = 0;
+
+	for(size_t i = 0; i < iLength; i++)
+	{
+		if(szString[i] == cCharacter)
+			iCount++;
+	}
+
+	return iCount;
+}
+
+static size_t FindMismatchScalar(const char * szFirst, const char * szSecond, size_t iLength)
+{
+	size_t i = 0;
+
+	while(i < iLength && szFirst[i] == szSecond[i])
+		i++;
+
+	return i;
+}
+
+static void ChangeCaseScalar(const char * szString, char * szOutput, size_t iLength, bool bUpper)
+{
+	char cFirst = bUpper ? 'a' : 'A';
+
+	for(size_t i = 0; i < iLength; i++)
+	{
+		char cCharacter = szString[i];
+
+		// A letter of the other case differs in one bit
+		if(cCharacter >= cFirst && cCharacter <= cFirst + 25)
+			cCharacter ^= 0x20;
+
+		szOutput[i] = cCharacter;
+	}
+}
+
+static size_t SkipSpaceScalar(const char * szString, size_t iLength)
+{
+	size_t i = 0;
+
+	while(i < iLength && IsSpace(szString[i]))
+		i++;
+
+	return i;
+}
+
+static size_t SkipSpaceBackwardsScalar(const char * szString, size_t iLength)
+{
+	while(iLength > 0 && IsSpace(szString[iLength - 1]))
+		iLength--;
+
+	return iLength;
+}
+
+//==============================================================================
+// SSE2 kernels, these process 16 bytes at a time
+//==============================================================================
+
+// Returns a mask of the bytes that are whitespace
+static unsigned int GetSpaceMaskSSE2(__m128i xBytes)
+{
+	__m128i xSpace = _mm_cmpeq_epi8(xBytes, _mm_set1_epi8(' '));
+	__m128i xControl = _mm_and_si128(_mm_cmpgt_epi8(xBytes, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(xBytes, _mm_set1_epi8('\r' + 1)));
+	return (unsigned int) _mm_movemask_epi8(_mm_or_si128(xSpace, xControl));
+}
+
+static size_t FindSubstringSSE2(const char * szString, size_t iLength, const char * szPart, size_t iPartLength)
+{
+	// A block holds 16 places the part could start, they're only compared in full if the first and the last character match
+	const __m128i xFirst = _mm_set1_epi8(szPart[0]);
+	const __m128i xLast = _mm_set1_epi8(szPart[iPartLength - 1]);
+	size_t i = 0;
+
+	while(i + iPartLength + 15 <= iLength)
+	{
+		__m128i xStarts = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (szString + i)), xFirst);
+		__m128i xEnds = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (szString + i + iPartLength - 1)), xLast);
+		unsigned int iMask = (unsigned int) _mm_movemask_epi8(_mm_and_si128(xStarts, xEnds));
+
+		for(; iMask != 0; iMask &= iMask - 1)
+		{
+			size_t iIndex = i + GetLowestBitIndex(iMask);
+
+			if(memcmp(szString + iIndex, szPart, iPartLength) == 0)
+				return iIndex;
+		}
+
+		i += 16;
+	}
+
+	// Less than 16 places left
+	size_t iIndex = FindSubstringScalar(szString + i, iLength - i, szPart, iPartLength);
+	return iIndex == STRING_NOT_FOUND ? STRING_NOT_FOUND : i + iIndex;
+}
+
+static size_t CountCharacterSSE2(const char * szString, size_t iLength, char cCharacter)
+{
+	const __m128i xCharacter = _mm_set1_epi8(cCharacter);
+	const __m128i xZero = _mm_setzero_si128();
+	size_t iCount = 0;
+	size_t i = 0;
+
+	while(iLength - i >= 16)
+	{
+		// Every match subtracts -1 from its byte, the bytes are added up before they can overflow
+		size_t iBlocks = (iLength - i) / 16;
+		__m128i xCounts = xZero;
+
+		if(iBlocks > STRING_MAX_COUNT_BLOCKS)
+			iBlocks = STRING_MAX_COUNT_BLOCKS;
+
+		for(size_t j = 0; j < iBlocks; j++, i += 16)
+			xCounts = _mm_sub_epi8(xCounts, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (szString + i)), xCharacter));
+
+		__m128i xSums = _mm_sad_epu8(xCounts, xZero);
+		iCount += (size_t) _mm_cvtsi128_si32(xSums) + (size_t) _mm_cvtsi128_si32(_mm_srli_si128(xSums, 8));
+	}
+
+	// Less than 16 bytes left
+	return iCount + CountCharacterScalar(szString + i, iLength - i, cCharacter);
+}
+
+static size_t FindMismatchSSE2(const char * szFirst, const char * szSecond, size_t iLength)
+{
+	size_t i = 0;
+
+	while(iLength - i >= 16)
+	{
+		__m128i xFirst = _mm_loadu_si128((const __m128i *) (szFirst + i));
+		__m128i xSecond = _mm_loadu_si128((const __m128i *) (szSecond + i));
+		unsigned int iEqualMask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(xFirst, xSecond));
+
+		// Do the strings differ in this block?
+		if(iEqualMask != 0xFFFF)
+			return i + GetLowestBitIndex(~iEqualMask & 0xFFFF);
+
+		i += 16;
+	}
+
+	// Less than 16 bytes left
+	return i + FindMismatchScalar(szFirst + i, szSecond + i, iLength - i);
+}
+
+static void ChangeCaseSSE2(const char * szString, char * szOutput, size_t iLength, bool bUpper)
+{
+	// The letters are positive as signed bytes, so a signed range check works
+	char cFirst = bUpper ? 'a' : 'A';
+	const __m128i xBelow = _mm_set1_epi8(cFirst - 1);
+	const __m128i xAbove = _mm_set1_epi8(cFirst + 26);
+	const __m128i xCaseBit = _mm_set1_epi8(0x20);
+	size_t i = 0;
+
+	while(iLength - i >= 16)
+	{
+		__m128i xBytes = _mm_loadu_si128((const __m128i *) (szString + i));
+		__m128i xLetters = _mm_and_si128(_mm_cmpgt_epi8(xBytes, xBelow), _mm_cmplt_epi8(xBytes, xAbove));
+		_mm_storeu_si128((__m128i *) (szOutput + i), _mm_xor_si128(xBytes, _mm_and_si128(xLetters, xCaseBit)));
+		i += 16;
+	}
+
+	// Less than 16 bytes left
+	ChangeCaseScalar(szString + i, szOutput + i, iLength - i, bUpper);
+}
+
+static size_t SkipSpaceSSE2(const char * szString, size_t iLength)
+{
+	size_t i = 0;
+
+	while(iLength - i >= 16)
+	{
+		unsigned int iSpaceMask = GetSpaceMaskSSE2(_mm_loadu_si128((const __m128i *) (szString + i)));
+
+		// Is there a character in this block that isn't whitespace?
+		if(iSpaceMask != 0xFFFF)
+			return i + GetLowestBitIndex(~iSpaceMask & 0xFFFF);
+
+		i += 16;
+	}
+
+	// Less than 16 bytes left
+	return i + SkipSpaceScalar(szString + i, iLength - i);
+}
+
+static size_t SkipSpaceBackwardsSSE2(const char * szString, size_t iLength)
+{
+	while(iLength >= 16)
+	{
+		unsigned int iSpaceMask = GetSpaceMaskSSE2(_mm_loadu_si128((const __m128i *) (szString + iLength - 16)));
+
+		// Is there a character in this block that isn't whitespace? The last one ends the string
+		if(iSpaceMask != 0xFFFF)
+			return iLength - 16 + GetHighestBitIndex(~iSpaceMask & 0xFFFF) + 1;
+
+		iLength -= 16;
+	}
+
+	// Less than 16 bytes left
+	return SkipSpaceBackwardsScalar(szString, iLength);
+}
+
+//==============================================================================
+// AVX2 kernels, these process 32 bytes at a time
+//==============================================================================
+
+#if CPU_FEATURES_AVX2
+// Returns a mask of the bytes that are whitespace
+static unsigned int GetSpaceMaskAVX2(__m256i xBytes)
+{
+	__m256i xSpace = _mm256_cmpeq_epi8(xBytes, _mm256_set1_epi8(' '));
+	__m256i xControl = _mm256_and_si256(_mm256_cmpgt_epi8(xBytes, _mm256_set1_epi8('\t' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), xBytes));
+	return (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(xSpace, xControl));
+}
+
+static size_t FindSubstringAVX2(const char * szString, size_t iLength, const char * szPart, size_t iPartLength)
+{
+	const __m256i xFirst = _mm256_set1_epi8(szPart[0]);
+	const __m256i xLast = _mm256_set1_epi8(szPart[iPartLength - 1]);
+	size_t i = 0;
+
+	while(i + iPartLength + 31 <= iLength)
+	{
+		__m256i xStarts = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (szString + i)), xFirst);
+		__m256i xEnds = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (szString + i + iPartLength - 1)), xLast);
+		unsigned int iMask = (unsigned int) _mm256_movemask_epi8(_mm256_and_si256(xStarts, xEnds));
+
+		for(; iMask != 0; iMask &= iMask - 1)
+		{
+			size_t iIndex = i + GetLowestBitIndex(iMask);
+
+			if(memcmp(szString + iIndex, szPart, iPartLength) == 0)
+				return iIndex;
+		}
+
+		i += 32;
+	}
+
+	// Less than 32 places left
+	size_t iIndex = FindSubstringSSE2(szString + i, iLength - i, szPart, iPartLength);
+	return iIndex == STRING_NOT_FOUND ? STRING_NOT_FOUND : i + iIndex;
+}
+
+static size_t CountCharacterAVX2(const char * szString, size_t iLength, char cCharacter)
+{
+	const __m256i xCharacter = _mm256_set1_epi8(cCharacter);
+	const __m256i xZero = _mm256_setzero_si256();
+	size_t iCount = 0;
+	size_t i = 0;
+
+	while(iLength - i >= 32)
+	{
+		size_t iBlocks = (iLength - i) / 32;
+		__m256i xCounts = xZero;
+
+		if(iBlocks > STRING_MAX_COUNT_BLOCKS)
+			iBlocks = STRING_MAX_COUNT_BLOCKS;
+
+		for(size_t j = 0; j < iBlocks; j++, i += 32)
+			xCounts = _mm256_sub_epi8(xCounts, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (szString + i)), xCharacter));
+
+		// Add up the four sums of the block
+		__m256i xSums = _mm256_sad_epu8(xCounts, xZero);
+		__m128i xHalves = _mm_add_epi64(_mm256_castsi256_si128(xSums), _mm256_extracti128_si256(xSums, 1));
+		iCount += (size_t) _mm_cvtsi128_si32(xHalves) + (size_t) _mm_cvtsi128_si32(_mm_srli_si128(xHalves, 8));
+	}
+
+	// Less than 32 bytes left
+	return iCount + CountCharacterSSE2(szString + i, iLength - i, cCharacter);
+}
+
+static size_t FindMismatchAVX2(const char * szFirst, const char * szSecond, size_t iLength)
+{
+	size_t i = 0;
+
+	while(iLength - i >= 32)
+	{
+		__m256i xFirst = _mm256_loadu_si256((const __m256i *) (szFirst + i));
+		__m256i xSecond = _mm256_loadu_si256((const __m256i *) (szSecond + i));
+		unsigned int iEqualMask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(xFirst, xSecond));
+
+		if(iEqualMask != 0xFFFFFFFF)
+			return i + GetLowestBitIndex(~iEqualMask);
+
+		i += 32;
+	}
+
+	// Less than 32 bytes left
+	return i + FindMismatchSSE2(szFirst + i, szSecond + i, iLength - i);
+}
+
+static void ChangeCaseAVX2(const char * szString, char * szOutput, size_t iLength, bool bUpper)
+{
+	char cFirst = bUpper ? 'a' : 'A';
+	const __m256i xBelow = _mm256_set1_epi8(cFirst - 1);
+	const __m256i xAbove = _mm256_set1_epi8(cFirst + 26);
+	const __m256i xCaseBit = _mm256_set1_epi8(0x20);
+	size_t i = 0;
+
+	while(iLength - i >= 32)
+	{
+		__m256i xBytes = _mm256_loadu_si256((const __m256i *) (szString + i));
+		__m256i xLetters = _mm256_and_si256(_mm256_cmpgt_epi8(xBytes, xBelow), _mm256_cmpgt_epi8(xAbove, xBytes));
+		_mm256_storeu_si256((__m256i *) (szOutput + i), _mm256_xor_si256(xBytes, _mm256_and_si256(xLetters, xCaseBit)));
+		i += 32;
+	}
+
+	// Less than 32 bytes left
+	ChangeCaseSSE2(szString + i, szOutput + i, iLength - i, bUpper);
+}
+
+static size_t SkipSpaceAVX2(const char * szString, size_t iLength)
+{
+	size_t i = 0;
+
+	while(iLength - i >= 32)
+	{
+		unsigned int iSpaceMask = GetSpaceMaskAVX2(_mm256_loadu_si256((const __m256i *) (szString + i)));
+
+		if(iSpaceMask != 0xFFFFFFFF)
+			return i + GetLowestBitIndex(~iSpaceMask);
+
+		i += 32;
+	}
+
+	// Less than 32 bytes left
+	return i + SkipSpaceSSE2(szString + i, iLength - i);
+}
+
+static size_t SkipSpaceBackwardsAVX2(const char * szString, size_t iLength)
+{
+	while(iLength >= 32)
+	{
+		unsigned int iSpaceMask = GetSpaceMaskAVX2(_mm256_loadu_si256((const __m256i *) (szString + iLength - 32)));
+
+		if(iSpaceMask != 0xFFFFFFFF)
+			return iLength - 32 + GetHighestBitIndex(~iSpaceMask) + 1;
+
+		iLength -= 32;
+	}
+
+	// Less than 32 bytes left
+	return SkipSpaceBackwardsSSE2(szString, iLength);
+}
+#endif
+
+//==============================================================================
+// Kernel selection
+//==============================================================================
+
+// Holds the kernels that were picked for this CPU
+struct CStringKernels
+{
+	// The name of the kernel, used for debugging
+	const char * m_szName;
+	size_t (*m_pFindSubstring) (const char *, size_t, const char *, size_t);
+	size_t (*m_pCountCharacter) (const char *, size_t, char);
+	size_t (*m_pFindMismatch) (const char *, const char *, size_t);
+	void (*m_pChangeCase) (const char *, char *, size_t, bool);
+	size_t (*m_pSkipSpace) (const char *, size_t);
+	size_t (*m_pSkipSpaceBackwards) (const char *, size_t);
+};
+
+// Picks the fastest kernels the CPU supports
+static CStringKernels SelectStringKernels()
+{
+	CStringKernels oKernels;
+
+	#if CPU_FEATURES_AVX2
+	if(CpuSupportsAVX2())
+	{
+		oKernels.m_szName = "AVX2";
+		oKernels.m_pFindSubstring = FindSubstringAVX2;
+		oKernels.m_pCountCharacter = CountCharacterAVX2;
+		oKernels.m_pFindMismatch = FindMismatchAVX2;
+		oKernels.m_pChangeCase = ChangeCaseAVX2;
+		oKernels.m_pSkipSpace = SkipSpaceAVX2;
+		oKernels.m_pSkipSpaceBackwards = SkipSpaceBackwardsAVX2;
+		return oKernels;
+	}
+	#endif
+
+	if(CpuSupportsSSE2())
+	{
+		oKernels.m_szName = "SSE2";
+		oKernels.m_pFindSubstring = FindSubstringSSE2;
+		oKernels.m_pCountCharacter = CountCharacterSSE2;
+		oKernels.m_pFindMismatch = FindMismatchSSE2;
+		oKernels.m_pChangeCase = ChangeCaseSSE2;
+		oKernels.m_pSkipSpace = SkipSpaceSSE2;
+		oKernels.m_pSkipSpaceBackwards = SkipSpaceBackwardsSSE2;
+		return oKernels;
+	}
+
+	oKernels.m_szName = "scalar";
+	oKernels.m_pFindSubstring = FindSubstringScalar;
+	oKernels.m_pCountCharacter = CountCharacterScalar;
+	oKernels.m_pFindMismatch = FindMismatchScalar;
+	oKernels.m_pChangeCase = ChangeCaseScalar;
+	oKernels.m_pSkipSpace = SkipSpaceScalar;
+	oKernels.m_pSkipSpaceBackwards = SkipSpaceBackwardsScalar;
+	return oKernels;
+}
+
+// The kernels are picked once, when the program starts
+static const CStringKernels g_oStringKernels = SelectStringKernels();
+
+//==============================================================================
+// Public string functions
+//==============================================================================
+
+// Returns the index of the first occurrence of szPart in szString, or STRING_NOT_FOUND
+size_t FindSubstring(const char * szString, size_t iLength, const char * szPart, size_t iPartLength)
+{
+	if(iPartLength == 0)
+		return 0;
+
+	if(iPartLength > iLength)
+		return STRING_NOT_FOUND;
+
+	return g_oStringKernels.m_pFindSubstring(szString, iLength, szPart, iPartLength);
+}
+
+// Returns how often szPart occurs in szString, occurrences don't overlap
+size_t CountSubstring(const char * szString, size_t iLength, const char * szPart, size_t iPartLength)
+{
+	if(iPartLength == 0)
+		return 0;
+
+	// A single character can't overlap itself, count every match at once
+	if(iPartLength == 1)
+		return g_oStringKernels.m_pCountCharacter(szString, iLength, szPart[0]);
+
+	size_t iCount = 0;
+	size_t iStart = 0;
+
+	while(true)
+	{
+		size_t iIndex = FindSubstring(szString + iStart, iLength - iStart, szPart, iPartLength);
+
+		if(iIndex == STRING_NOT_FOUND)
+			return iCount;
+
+		iCount++;
+		iStart += iIndex + iPartLength;
+	}
+}
+
+// Returns the index of the first byte where the strings differ, or iLength if they don't
+size_t FindMismatch(const char * szFirst, const char * szSecond, size_t iLength)
+{
+	return g_oStringKernels.m_pFindMismatch(szFirst, szSecond, iLength);
+}
+
+// Copies szString to szOutput in upper case or in lower case
+void ChangeCase(const char * szString, char * szOutput, size_t iLength, bool bUpper)
+{
+	g_oStringKernels.m_pChangeCase(szString, szOutput, iLength, bUpper);
+}
+
+// Returns the index of the first character that isn't whitespace, or iLength
+size_t SkipSpace(const char * szString, size_t iLength)
+{
+	return g_oStringKernels.m_pSkipSpace(szString, iLength);
+}
+
+// Returns the length of the string without the whitespace at its end
+size_t SkipSpaceBackwards(const char * szString, size_t iLength)
+{
+	return g_oStringKernels.m_pSkipSpaceBackwards(szString, iLength);
+}
+
+// Returns the name of the string kernel that was picked for this CPU
+const char * GetStringKernelName()
+{
+	return g_oStringKernels.m_szName;
+}
\ No newline at end of file
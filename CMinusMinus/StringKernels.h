@@ -0,0 +1,39 @@
+//==============================================================================
+//
+// File: StringKernels.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the kernels of the string natives: searching, counting,
+// comparing, changing the case and trimming. They work on a pointer and a
+// length, so the natives can run them on the characters of a value without
+// copying them. Like the scanning kernels of the tokenizer they process 16
+// (SSE2) or 32 (AVX2) bytes at a time, the kernel is picked at runtime
+// depending on what the CPU supports, with a scalar fallback. The AVX2 kernels
+// are only compiled by Visual Studio 2012 and later, see CpuFeatures.h.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+
+// What the search functions return when there's nothing to find
+#define STRING_NOT_FOUND ((size_t) -1)
+
+// Returns the index of the first occurrence of szPart in szString, or STRING_NOT_FOUND
+// An empty part is found at the start of the string
+size_t FindSubstring(const char * szString, size_t iLength, const char * szPart, size_t iPartLength);
+// Returns how often szPart occurs in szString, occurrences don't overlap (an empty part occurs 0 times)
+size_t CountSubstring(const char * szString, size_t iLength, const char * szPart, size_t iPartLength);
+// Returns the index of the first byte where the strings differ, or iLength if they don't
+size_t FindMismatch(const char * szFirst, const char * szSecond, size_t iLength);
+// Copies szString to szOutput in upper case (bUpper) or in lower case, only the ASCII letters change
+void ChangeCase(const char * szString, char * szOutput, size_t iLength, bool bUpper);
+// Returns the index of the first character that isn't whitespace, or iLength
+size_t SkipSpace(const char * szString, size_t iLength);
+// Returns the length of the string without the whitespace at its end
+size_t SkipSpaceBackwards(const char * szString, size_t iLength);
+// Returns the name of the string kernel that was picked for this CPU
+const char * GetStringKernelName();
\ No newline at end of file
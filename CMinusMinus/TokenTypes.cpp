@@ -0,0 +1,184 @@
+//==============================================================================
+//
+// File: TokenTypes.cpp
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the specification of every token type. The eTokenType enum,
+// the table with the names of the token types and the keyword and punctuator
+// lookup are all generated from TOKEN_TYPE_LIST, so adding a keyword (for example
+// 'while') is a matter of adding one line to the list.
+//
+//==============================================================================
+
+#include "TokenTypes.h"
+#include "CLogger.h"
+
+#include <cstring>
+#include <cstdlib>
+
+// One entry of the token type specification
+struct CTokenTypeSpecification
+{
+	// The token type
+	eTokenType m_eType;
+	// Is this a keyword, a punctuator or neither?
+	eTokenTypeClass m_eClass;
+	// The spelling of the token type
+	const char * m_szSpelling;
+	// The name of the token type
+	const char * m_szName;
+};
+
+// The specification of every token type, generated from TOKEN_TYPE_LIST
+// The entries are in the same order as the eTokenType enum, so the table can be indexed with a token type
+static const CTokenTypeSpecification g_aTokenTypes[TOKEN_TYPE_COUNT] =
+{
+	#define TOKEN_TYPE_SPECIFICATION_ENTRY(eType, eClass, szSpelling) { eType, TOKEN_TYPE_CLASS_##eClass, szSpelling, #eType },
+	TOKEN_TYPE_LIST(TOKEN_TYPE_SPECIFICATION_ENTRY)
+	#undef TOKEN_TYPE_SPECIFICATION_ENTRY
+};
+
+// The biggest perfect hash table we'll try, this is far more than the language will ever need
+#define MAX_TOKEN_TYPE_SLOTS 1024
+
+// The CTokenTypeLookup class finds the keyword or punctuator for a spelling without comparing
+// it against every spelling. Single character punctuators are looked up directly in a table
+// indexed by the character. Longer spellings are stored in a perfect hash table, the seed of
+// the hash function is picked so no two spellings of the specification share a slot. That
+// means a lookup hashes the value once and compares it against at most one spelling.
+class CTokenTypeLookup
+{
+	// The token type of every single character punctuator, VALUE_TOKEN for other characters
+	eTokenType m_aSingleCharacterTypes[256];
+	// The slots of the perfect hash table, NULL if the slot is empty
+	const CTokenTypeSpecification * m_aSlots[MAX_TOKEN_TYPE_SLOTS];
+	// The length of each spelling in the slots, so most misses don't even need a string comparison
+	size_t m_aSlotLengths[MAX_TOKEN_TYPE_SLOTS];
+	// The amount of slots that are in use (always a power of two) minus one
+	unsigned int m_iMask;
+	// The seed of the hash function
+	unsigned int m_iSeed;
+	// The length of the longest spelling in the slots, longer values are never looked up
+	size_t m_iMaxLength;
+
+	// Hashes a value (which has at least one character), every character counts so any two spellings can be told apart
+	unsigned int Hash(const char * szValue, size_t iLength) const
+	{
+		unsigned int iHash = m_iSeed;
+
+		for(size_t i = 0; i < iLength; i++)
+			iHash = (iHash ^ (unsigned char) szValue[i]) * 16777619;
+
+		return (iHash ^ (iHash >> 16)) & m_iMask;
+	}
+
+	// Tries to fill the slots with the current mask and seed, returns false if two spellings share a slot
+	bool FillSlots()
+	{
+		memset(m_aSlots, 0, sizeof(m_aSlots));
+
+		for(int i = 0; i < TOKEN_TYPE_COUNT; i++)
+		{
+			const CTokenTypeSpecification & oSpecification = g_aTokenTypes[i];
+			size_t iLength = strlen(oSpecification.m_szSpelling);
+
+			// Only keywords and punctuators are looked up, single characters have their own table
+			if(oSpecification.m_eClass == TOKEN_TYPE_CLASS_OTHER || iLength < 2)
+				continue;
+
+			unsigned int iSlot = Hash(oSpecification.m_szSpelling, iLength);
+
+			if(m_aSlots[iSlot] != NULL)
+				return false;
+
+			m_aSlots[iSlot] = &oSpecification;
+			m_aSlotLengths[iSlot] = iLength;
+		}
+
+		return true;
+	}
+
+public:
+	// The constructor builds both tables from the specification
+	CTokenTypeLookup()
+	{
+		m_iMaxLength = 0;
+
+		for(int i = 0; i < 256; i++)
+			m_aSingleCharacterTypes[i] = VALUE_TOKEN;
+
+		for(int i = 0; i < TOKEN_TYPE_COUNT; i++)
+		{
+			if(g_aTokenTypes[i].m_eClass == TOKEN_TYPE_CLASS_OTHER)
+				continue;
+
+			size_t iLength = strlen(g_aTokenTypes[i].m_szSpelling);
+
+			if(iLength == 1)
+				m_aSingleCharacterTypes[(unsigned char) g_aTokenTypes[i].m_szSpelling[0]] = g_aTokenTypes[i].m_eType;
+
+			if(iLength > m_iMaxLength)
+				m_iMaxLength = iLength;
+		}
+
+		// Look for a seed that doesn't give any collisions, start with a small table and grow it if needed
+		for(m_iMask = 7; m_iMask < MAX_TOKEN_TYPE_SLOTS; m_iMask = m_iMask * 2 + 1)
+		{
+			for(m_iSeed = 1; m_iSeed < 4096; m_iSeed++)
+			{
+				if(FillSlots())
+					return;
+			}
+		}
+
+		// Every lookup would read past the slots, there's no way to lex anything
+		CLogger::Write("* No seed separates the keywords and punctuators in %d slots", MAX_TOKEN_TYPE_SLOTS);
+		exit(1);
+	}
+
+	// Returns the keyword or punctuator with this spelling, VALUE_TOKEN if there is none
+	eTokenType Lookup(const char * szValue, size_t iLength) const
+	{
+		if(iLength == 1)
+			return m_aSingleCharacterTypes[(unsigned char) szValue[0]];
+
+		if(iLength == 0 || iLength > m_iMaxLength)
+			return VALUE_TOKEN;
+
+		unsigned int iSlot = Hash(szValue, iLength);
+
+		if(m_aSlots[iSlot] != NULL && m_aSlotLengths[iSlot] == iLength && memcmp(m_aSlots[iSlot]->m_szSpelling, szValue, iLength) == 0)
+			return m_aSlots[iSlot]->m_eType;
+
+		return VALUE_TOKEN;
+	}
+};
+
+// The lookup tables are built once, when the program starts
+static const CTokenTypeLookup g_oTokenTypeLookup;
+
+// Returns the keyword or punctuator with this spelling, VALUE_TOKEN if there is none
+eTokenType LookupTokenType(const char * szValue, size_t iLength)
+{
+	return g_oTokenTypeLookup.Lookup(szValue, iLength);
+}
+
+// Returns the name of a token type, for example "SEMICOLON_TOKEN"
+const char * GetTokenTypeName(eTokenType eType)
+{
+	if(eType < 0 || eType >= TOKEN_TYPE_COUNT)
+		return "Invalid token";
+
+	return g_aTokenTypes[eType].m_szName;
+}
+
+// Returns the spelling of a token type, for example ";"
+const char * GetTokenTypeSpelling(eTokenType eType)
+{
+	if(eType < 0 || eType >= TOKEN_TYPE_COUNT)
+		return "";
+
+	return g_aTokenTypes[eType].m_szSpelling;
+}
\ No newline at end of file
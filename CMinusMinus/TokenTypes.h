@@ -0,0 +1,69 @@
+//==============================================================================
+//
+// File: TokenTypes.h
+// Project: CMinusMinus
+// Author(s): Matthias Van Eeghem (matthias@van-eeghem.com)
+// License: See LICENSE in root directory
+//
+// This file holds the specification of every token type. The eTokenType enum,
+// the table with the names of the token types and the keyword and punctuator
+// lookup are all generated from TOKEN_TYPE_LIST, so adding a keyword (for example
+// 'while') is a matter of adding one line to the list.
+//
+//==============================================================================
+
+#pragma once
+
+#include <cstddef>
+
+// TOKEN(type, class, spelling)
+// KEYWORD and PUNCTUATOR tokens are recognised by their spelling, OTHER tokens are
+// produced by the tokenizer in another way (their spelling is only used for debugging)
+#define TOKEN_TYPE_LIST(TOKEN) \
+	TOKEN(OPEN_CURLY_BRACKET_TOKEN, PUNCTUATOR, "{") \
+	TOKEN(CLOSE_CURLY_BRACKET_TOKEN, PUNCTUATOR, "}") \
+	TOKEN(OPEN_BRACKET_TOKEN, PUNCTUATOR, "(") \
+	TOKEN(CLOSE_BRACKET_TOKEN, PUNCTUATOR, ")") \
+	TOKEN(COMMA_TOKEN, PUNCTUATOR, ",") \
+	TOKEN(SEMICOLON_TOKEN, PUNCTUATOR, ";") \
+	TOKEN(EQUALSIGN_TOKEN, PUNCTUATOR, "=") \
+	TOKEN(INTEGER_TYPE_TOKEN, KEYWORD, "int") \
+	TOKEN(FLOAT_TYPE_TOKEN, KEYWORD, "float") \
+	TOKEN(STRING_TYPE_TOKEN, KEYWORD, "string") \
+	TOKEN(DOUBLE_QUOTE_TOKEN, OTHER, "\"") \
+	TOKEN(STRING_LITERAL_TOKEN, OTHER, "string literal") \
+	TOKEN(INTEGER_LITERAL_TOKEN, OTHER, "integer literal") \
+	TOKEN(FLOAT_LITERAL_TOKEN, OTHER, "float literal") \
+	TOKEN(PLUS_OPERATOR_TOKEN, PUNCTUATOR, "+") \
+	TOKEN(MINUS_OPERATOR_TOKEN, PUNCTUATOR, "-") \
+	TOKEN(VALUE_TOKEN, OTHER, "value")
+
+// The classes a token type can belong to, see TOKEN_TYPE_LIST
+enum eTokenTypeClass
+{
+	TOKEN_TYPE_CLASS_KEYWORD,
+	TOKEN_TYPE_CLASS_PUNCTUATOR,
+	TOKEN_TYPE_CLASS_OTHER
+};
+
+// List of all possible tokens
+enum eTokenType
+{
+	// Invalid token types, the default for the CToken class
+	INVALID_TOKEN_TYPE = -1,
+
+	#define TOKEN_TYPE_ENUM_ENTRY(eType, eClass, szSpelling) eType,
+	TOKEN_TYPE_LIST(TOKEN_TYPE_ENUM_ENTRY)
+	#undef TOKEN_TYPE_ENUM_ENTRY
+
+	// The amount of token types
+	TOKEN_TYPE_COUNT
+};
+
+// Returns the keyword or punctuator with this spelling, VALUE_TOKEN if there is none
+// The value doesn't have to be null terminated
+eTokenType LookupTokenType(const char * szValue, size_t iLength);
+// Returns the name of a token type, for example "SEMICOLON_TOKEN"
+const char * GetTokenTypeName(eTokenType eType);
+// Returns the spelling of a token type, for example ";"
+const char * GetTokenTypeSpelling(eTokenType eType);
\ No newline at end of file
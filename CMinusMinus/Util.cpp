@@ -10,43 +10,715 @@
 //==============================================================================
 
 #include "Util.h"
-#include <locale>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <intrin.h>
+#include <string>
 
-// This function returns true if the string input is a float or an integer, false otherwise
-bool IsFloatOrInteger(std::string sInput)
+// The biggest integer a double can hold exactly (2^53)
+#define MAX_EXACT_DOUBLE_INTEGER 9007199254740992ULL
+
+// The powers of ten a double can hold exactly
+static const double g_aExactPowersOfTen[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// The most significant digits a double needs to be read back exactly
+#define FLOAT_MAX_DIGITS 17
+
+// The fixed float fast path only rounds values below this (2^40) itself, the fraction of the scaled value is then exact enough to round
+#define MAX_FAST_FIXED_FLOAT 1099511627776.0
+
+// The two digit strings of 0 up to 99, numbers are written two digits at a time
+static const char g_aDigitPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+// Returns true if the character is a digit, this doesn't depend on the locale like isdigit() does
+static inline bool IsDigit(char cCharacter)
 {
-	// This float shouldn't be used for anything else other than being called in sscanf() below
-	float fFloatForParsingWithSccanf;
+	return (unsigned char) (cCharacter - '0') < 10;
+}
 
-	// sscanf could parse the input as float or int, return true
-	if(sscanf_s(sInput.c_str(), "%f", &fFloatForParsingWithSccanf) != 0)
+// This function returns true if the value starts like a number ("5", "3.14", ".5"), false otherwise
+bool IsNumericLiteral(const char * szValue, size_t iLength)
+{
+	if(iLength == 0)
+		return false;
+
+	if(IsDigit(szValue[0]))
 		return true;
 
-	// Otherwise, return false
+	// ".5" is a number as well, "." on its own isn't
+	return szValue[0] == '.' && iLength > 1 && IsDigit(szValue[1]);
+}
+
+// This function returns true if the value only consists of digits, false otherwise
+bool IsIntegerLiteral(const char * szValue, size_t iLength)
+{
+	if(iLength == 0)
+		return false;
+
+	for(size_t i = 0; i < iLength; i++)
+	{
+		if(!IsDigit(szValue[i]))
+			return false;
+	}
+
+	return true;
+}
+
+// This function parses an integer literal, values that don't fit in an int are clamped to INT_MAX
+int ParseIntegerLiteral(const char * szValue, size_t iLength)
+{
+	unsigned int iValue = 0;
+
+	for(size_t i = 0; i < iLength && IsDigit(szValue[i]); i++)
+	{
+		unsigned int iDigit = szValue[i] - '0';
+
+		// Would this digit make the value bigger than INT_MAX?
+		if(iValue > (INT_MAX - iDigit) / 10)
+			return INT_MAX;
+
+		iValue = iValue * 10 + iDigit;
+	}
+
+	return (int) iValue;
+}
+
+// This function parses the float at the start of the value, the same way atof() would
+// Most literals have few digits and a small exponent, those are converted exactly with one
+// multiplication or division (both operands are exact doubles, so the result is correctly rounded).
+// Everything else is handed to strtod()
+double ParseFloatLiteral(const char * szValue, size_t iLength)
+{
+	const char * pCurrent = szValue;
+	const char * pEnd = szValue + iLength;
+
+	// The digits of the number without the decimal point, and how many of them there are
+	unsigned long long iMantissa = 0;
+	int iDigitCount = 0;
+	// The power of ten the mantissa has to be multiplied with
+	int iExponent = 0;
+
+	// The digits before the decimal point
+	for(; pCurrent != pEnd && IsDigit(*pCurrent); pCurrent++)
+	{
+		if(iMantissa != 0 || *pCurrent != '0')
+			iDigitCount++;
+
+		if(iDigitCount <= 19)
+			iMantissa = iMantissa * 10 + (*pCurrent - '0');
+		else
+			iExponent++;
+	}
+
+	// The digits after the decimal point
+	if(pCurrent != pEnd && *pCurrent == '.')
+	{
+		for(pCurrent++; pCurrent != pEnd && IsDigit(*pCurrent); pCurrent++)
+		{
+			if(iMantissa != 0 || *pCurrent != '0')
+				iDigitCount++;
+
+			if(iDigitCount <= 19)
+			{
+				iMantissa = iMantissa * 10 + (*pCurrent - '0');
+				iExponent--;
+			}
+		}
+	}
+
+	// The exponent, it's only part of the number if at least one digit follows the 'e'
+	if(pCurrent != pEnd && (*pCurrent == 'e' || *pCurrent == 'E'))
+	{
+		const char * pExponent = pCurrent + 1;
+		bool bNegative = false;
+
+		if(pExponent != pEnd && (*pExponent == '+' || *pExponent == '-'))
+			bNegative = (*pExponent++ == '-');
+
+		if(pExponent != pEnd && IsDigit(*pExponent))
+		{
+			int iExplicitExponent = 0;
+
+			for(; pExponent != pEnd && IsDigit(*pExponent); pExponent++)
+			{
+				if(iExplicitExponent < 10000)
+					iExplicitExponent = iExplicitExponent * 10 + (*pExponent - '0');
+			}
+
+			iExponent += bNegative ? -iExplicitExponent : iExplicitExponent;
+			pCurrent = pExponent;
+		}
+	}
+
+	// The fast path, both the mantissa and the power of ten are exact doubles
+	if(iDigitCount <= 19 && iMantissa <= MAX_EXACT_DOUBLE_INTEGER && iExponent >= -22 && iExponent <= 22)
+	{
+		if(iExponent < 0)
+			return (double) iMantissa / g_aExactPowersOfTen[-iExponent];
+
+		return (double) iMantissa * g_aExactPowersOfTen[iExponent];
+	}
+
+	// The slow path, strtod() needs a null terminated copy of the number
+	std::string sNumber(szValue, pCurrent);
+	return strtod(sNumber.c_str(), NULL);
+}
+
+// Writes an unsigned number to the buffer and returns its length, the buffer isn't null terminated
+static size_t WriteDigits(unsigned long long iValue, char * szBuffer)
+{
+	// Write the digits backwards into a scratch buffer, two at a time
+	char aDigits[20];
+	char * pDigit = aDigits + sizeof(aDigits);
+
+	while(iValue >= 100)
+	{
+		unsigned int iPair = (unsigned int) (iValue % 100) * 2;
+		iValue /= 100;
+		*--pDigit = g_aDigitPairs[iPair + 1];
+		*--pDigit = g_aDigitPairs[iPair];
+	}
+
+	if(iValue >= 10)
+	{
+		*--pDigit = g_aDigitPairs[iValue * 2 + 1];
+		*--pDigit = g_aDigitPairs[iValue * 2];
+	}
+	else
+		*--pDigit = (char) ('0' + iValue);
+
+	size_t iLength = aDigits + sizeof(aDigits) - pDigit;
+	memcpy(szBuffer, pDigit, iLength);
+	return iLength;
+}
+
+// Writes iMantissa / 10^iDecimals with exactly iDecimals digits after the decimal point, returns the length
+static size_t WriteDecimal(unsigned long long iMantissa, int iDecimals, char * szBuffer)
+{
+	char aDigits[20];
+	size_t iDigitCount = WriteDigits(iMantissa, aDigits);
+	char * pCurrent = szBuffer;
+
+	// The part before the decimal point, 0 if every digit is behind it
+	if(iDigitCount > (size_t) iDecimals)
+	{
+		memcpy(pCurrent, aDigits, iDigitCount - iDecimals);
+		pCurrent += iDigitCount - iDecimals;
+	}
+	else
+		*pCurrent++ = '0';
+
+	if(iDecimals == 0)
+		return pCurrent - szBuffer;
+
+	// The zeroes right after the decimal point, then the rest of the digits
+	*pCurrent++ = '.';
+
+	for(size_t i = iDigitCount; i < (size_t) iDecimals; i++)
+		*pCurrent++ = '0';
+
+	size_t iFractionDigits = iDigitCount < (size_t) iDecimals ? iDigitCount : iDecimals;
+	memcpy(pCurrent, aDigits + iDigitCount - iFractionDigits, iFractionDigits);
+	pCurrent += iFractionDigits;
+
+	return pCurrent - szBuffer;
+}
+
+// Writes infinity or NaN, returns 0 if the value is finite
+static size_t WriteSpecialFloat(double fValue, char * szBuffer)
+{
+	const char * szSpecial = NULL;
+
+	if(fValue != fValue)
+		szSpecial = "nan";
+	else if(fValue - fValue != 0.0)
+		szSpecial = fValue < 0.0 ? "-inf" : "inf";
+	else
+		return 0;
+
+	size_t iLength = strlen(szSpecial);
+	memcpy(szBuffer, szSpecial, iLength + 1);
+	return iLength;
+}
+
+// A float as a 64-bit mantissa and a binary exponent, without a sign: m_iMantissa * 2^m_iExponent
+struct CDiyFloat
+{
+	unsigned long long m_iMantissa;
+	int m_iExponent;
+
+	CDiyFloat::CDiyFloat(unsigned long long iMantissa, int iExponent): m_iMantissa(iMantissa), m_iExponent(iExponent) { }
+};
+
+// A power of ten as a CDiyFloat, rounded to the nearest 64-bit mantissa
+struct CCachedPower
+{
+	unsigned long long m_iMantissa;
+	int m_iBinaryExponent;
+	int m_iDecimalExponent;
+};
+
+// The powers of ten that fit in an unsigned int
+static const unsigned int g_aPowersOfTen[] =
+{
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// The powers 10^-348 up to 10^340 in steps of 8, enough to bring any double in the range Grisu needs
+static const CCachedPower g_aCachedPowers[] =
+{
+	{ 0xfa8fd5a0081c0288ULL, -1220, -348 },
+	{ 0xbaaee17fa23ebf76ULL, -1193, -340 },
+	{ 0x8b16fb203055ac76ULL, -1166, -332 },
+	{ 0xcf42894a5dce35eaULL, -1140, -324 },
+	{ 0x9a6bb0aa55653b2dULL, -1113, -316 },
+	{ 0xe61acf033d1a45dfULL, -1087, -308 },
+	{ 0xab70fe17c79ac6caULL, -1060, -300 },
+	{ 0xff77b1fcbebcdc4fULL, -1034, -292 },
+	{ 0xbe5691ef416bd60cULL, -1007, -284 },
+	{ 0x8dd01fad907ffc3cULL, -980, -276 },
+	{ 0xd3515c2831559a83ULL, -954, -268 },
+	{ 0x9d71ac8fada6c9b5ULL, -927, -260 },
+	{ 0xea9c227723ee8bcbULL, -901, -252 },
+	{ 0xaecc49914078536dULL, -874, -244 },
+	{ 0x823c12795db6ce57ULL, -847, -236 },
+	{ 0xc21094364dfb5637ULL, -821, -228 },
+	{ 0x9096ea6f3848984fULL, -794, -220 },
+	{ 0xd77485cb25823ac7ULL, -768, -212 },
+	{ 0xa086cfcd97bf97f4ULL, -741, -204 },
+	{ 0xef340a98172aace5ULL, -715, -196 },
+	{ 0xb23867fb2a35b28eULL, -688, -188 },
+	{ 0x84c8d4dfd2c63f3bULL, -661, -180 },
+	{ 0xc5dd44271ad3cdbaULL, -635, -172 },
+	{ 0x936b9fcebb25c996ULL, -608, -164 },
+	{ 0xdbac6c247d62a584ULL, -582, -156 },
+	{ 0xa3ab66580d5fdaf6ULL, -555, -148 },
+	{ 0xf3e2f893dec3f126ULL, -529, -140 },
+	{ 0xb5b5ada8aaff80b8ULL, -502, -132 },
+	{ 0x87625f056c7c4a8bULL, -475, -124 },
+	{ 0xc9bcff6034c13053ULL, -449, -116 },
+	{ 0x964e858c91ba2655ULL, -422, -108 },
+	{ 0xdff9772470297ebdULL, -396, -100 },
+	{ 0xa6dfbd9fb8e5b88fULL, -369, -92 },
+	{ 0xf8a95fcf88747d94ULL, -343, -84 },
+	{ 0xb94470938fa89bcfULL, -316, -76 },
+	{ 0x8a08f0f8bf0f156bULL, -289, -68 },
+	{ 0xcdb02555653131b6ULL, -263, -60 },
+	{ 0x993fe2c6d07b7facULL, -236, -52 },
+	{ 0xe45c10c42a2b3b06ULL, -210, -44 },
+	{ 0xaa242499697392d3ULL, -183, -36 },
+	{ 0xfd87b5f28300ca0eULL, -157, -28 },
+	{ 0xbce5086492111aebULL, -130, -20 },
+	{ 0x8cbccc096f5088ccULL, -103, -12 },
+	{ 0xd1b71758e219652cULL, -77, -4 },
+	{ 0x9c40000000000000ULL, -50, 4 },
+	{ 0xe8d4a51000000000ULL, -24, 12 },
+	{ 0xad78ebc5ac620000ULL, 3, 20 },
+	{ 0x813f3978f8940984ULL, 30, 28 },
+	{ 0xc097ce7bc90715b3ULL, 56, 36 },
+	{ 0x8f7e32ce7bea5c70ULL, 83, 44 },
+	{ 0xd5d238a4abe98068ULL, 109, 52 },
+	{ 0x9f4f2726179a2245ULL, 136, 60 },
+	{ 0xed63a231d4c4fb27ULL, 162, 68 },
+	{ 0xb0de65388cc8ada8ULL, 189, 76 },
+	{ 0x83c7088e1aab65dbULL, 216, 84 },
+	{ 0xc45d1df942711d9aULL, 242, 92 },
+	{ 0x924d692ca61be758ULL, 269, 100 },
+	{ 0xda01ee641a708deaULL, 295, 108 },
+	{ 0xa26da3999aef774aULL, 322, 116 },
+	{ 0xf209787bb47d6b85ULL, 348, 124 },
+	{ 0xb454e4a179dd1877ULL, 375, 132 },
+	{ 0x865b86925b9bc5c2ULL, 402, 140 },
+	{ 0xc83553c5c8965d3dULL, 428, 148 },
+	{ 0x952ab45cfa97a0b3ULL, 455, 156 },
+	{ 0xde469fbd99a05fe3ULL, 481, 164 },
+	{ 0xa59bc234db398c25ULL, 508, 172 },
+	{ 0xf6c69a72a3989f5cULL, 534, 180 },
+	{ 0xb7dcbf5354e9beceULL, 561, 188 },
+	{ 0x88fcf317f22241e2ULL, 588, 196 },
+	{ 0xcc20ce9bd35c78a5ULL, 614, 204 },
+	{ 0x98165af37b2153dfULL, 641, 212 },
+	{ 0xe2a0b5dc971f303aULL, 667, 220 },
+	{ 0xa8d9d1535ce3b396ULL, 694, 228 },
+	{ 0xfb9b7cd9a4a7443cULL, 720, 236 },
+	{ 0xbb764c4ca7a44410ULL, 747, 244 },
+	{ 0x8bab8eefb6409c1aULL, 774, 252 },
+	{ 0xd01fef10a657842cULL, 800, 260 },
+	{ 0x9b10a4e5e9913129ULL, 827, 268 },
+	{ 0xe7109bfba19c0c9dULL, 853, 276 },
+	{ 0xac2820d9623bf429ULL, 880, 284 },
+	{ 0x80444b5e7aa7cf85ULL, 907, 292 },
+	{ 0xbf21e44003acdd2dULL, 933, 300 },
+	{ 0x8e679c2f5e44ff8fULL, 960, 308 },
+	{ 0xd433179d9c8cb841ULL, 986, 316 },
+	{ 0x9e19db92b4e31ba9ULL, 1013, 324 },
+	{ 0xeb96bf6ebadf77d9ULL, 1039, 332 },
+	{ 0xaf87023b9bf0ee6bULL, 1066, 340 }
+};
+
+// Returns the 64 most significant bits of the product of two CDiyFloats, rounded
+static CDiyFloat MultiplyDiyFloats(const CDiyFloat & oFirst, const CDiyFloat & oSecond)
+{
+	unsigned long long iMask = 0xFFFFFFFFULL;
+	unsigned long long a = oFirst.m_iMantissa >> 32, b = oFirst.m_iMantissa & iMask;
+	unsigned long long c = oSecond.m_iMantissa >> 32, d = oSecond.m_iMantissa & iMask;
+	unsigned long long ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+	// The carry of the lower half, plus a half for the rounding
+	unsigned long long iMiddle = (bd >> 32) + (ad & iMask) + (bc & iMask) + (1ULL << 31);
+	return CDiyFloat(ac + (ad >> 32) + (bc >> 32) + (iMiddle >> 32), oFirst.m_iExponent + oSecond.m_iExponent + 64);
+}
+
+// Shifts the mantissa to the left until its highest bit is set
+static CDiyFloat NormalizeDiyFloat(CDiyFloat oFloat)
+{
+	// Find the highest bit set, one half at a time so this works on 32-bit builds as well
+	unsigned long iHighestBit;
+	int iShift;
+
+	if(_BitScanReverse(&iHighestBit, (unsigned long) (oFloat.m_iMantissa >> 32)))
+		iShift = 31 - (int) iHighestBit;
+	else
+	{
+		_BitScanReverse(&iHighestBit, (unsigned long) oFloat.m_iMantissa);
+		iShift = 63 - (int) iHighestBit;
+	}
+
+	oFloat.m_iMantissa <<= iShift;
+	oFloat.m_iExponent -= iShift;
+	return oFloat;
+}
+
+// Lowers the last digit while that brings the digits closer to the value, and checks the digits are right
+// This is round_weed from Loitsch's paper, the distances are in units of the scaled values
+static bool WeedDigits(char * aDigits, int iDigitCount, unsigned long long iDistanceTooHigh, unsigned long long iUnsafeInterval, unsigned long long iRest, unsigned long long iTenKappa, unsigned long long iUnit)
+{
+	unsigned long long iSmallDistance = iDistanceTooHigh - iUnit;
+	unsigned long long iBigDistance = iDistanceTooHigh + iUnit;
+
+	while(iRest < iSmallDistance && iUnsafeInterval - iRest >= iTenKappa && (iRest + iTenKappa < iSmallDistance || iSmallDistance - iRest >= iRest + iTenKappa - iSmallDistance))
+	{
+		aDigits[iDigitCount - 1]--;
+		iRest += iTenKappa;
+	}
+
+	// If a lower digit could be closer given the errors of the scaling, we can't tell which digit is right
+	if(iRest < iBigDistance && iUnsafeInterval - iRest >= iTenKappa && (iRest + iTenKappa < iBigDistance || iBigDistance - iRest > iRest + iTenKappa - iBigDistance))
+		return false;
+
+	return 2 * iUnit <= iRest && iRest <= iUnsafeInterval - 4 * iUnit;
+}
+
+// Generates the shortest digits of a positive float with Grisu3, the value is digits * 10^iExponent
+// Returns false for the few values Grisu3 can't prove it found the shortest digits for
+static bool GenerateShortestDigits(double fValue, char * aDigits, int & iDigitCount, int & iExponent)
+{
+	unsigned long long iBits;
+	memcpy(&iBits, &fValue, sizeof(iBits));
+
+	// Unpack the double, denormals don't have the hidden bit
+	unsigned long long iFraction = iBits & 0x000FFFFFFFFFFFFFULL;
+	int iBiasedExponent = (int) (iBits >> 52);
+	CDiyFloat oValue(iFraction, 1 - 1075);
+
+	if(iBiasedExponent != 0)
+		oValue = CDiyFloat(iFraction | 0x0010000000000000ULL, iBiasedExponent - 1075);
+
+	// The boundaries halfway to the neighbouring doubles, the lower one is closer at a power of two
+	CDiyFloat oUpper = NormalizeDiyFloat(CDiyFloat((oValue.m_iMantissa << 1) + 1, oValue.m_iExponent - 1));
+	CDiyFloat oLower(0, 0);
+
+	if(iFraction == 0 && iBiasedExponent > 1)
+		oLower = CDiyFloat((oValue.m_iMantissa << 2) - 1, oValue.m_iExponent - 2);
+	else
+		oLower = CDiyFloat((oValue.m_iMantissa << 1) - 1, oValue.m_iExponent - 1);
+
+	oLower.m_iMantissa <<= oLower.m_iExponent - oUpper.m_iExponent;
+	oLower.m_iExponent = oUpper.m_iExponent;
+	oValue = NormalizeDiyFloat(oValue);
+
+	// Pick the power of ten that brings the binary exponent of the scaled value between -60 and -32
+	int iMinimalExponent = -60 - (oValue.m_iExponent + 64);
+	int iDecimalGuess = (int) ceil((iMinimalExponent + 63) * 0.30102999566398114);
+	const CCachedPower & oPower = g_aCachedPowers[(348 + iDecimalGuess - 1) / 8 + 1];
+	CDiyFloat oTenMk(oPower.m_iMantissa, oPower.m_iBinaryExponent);
+
+	CDiyFloat oScaled = MultiplyDiyFloats(oValue, oTenMk);
+	CDiyFloat oScaledLower = MultiplyDiyFloats(oLower, oTenMk);
+	CDiyFloat oScaledUpper = MultiplyDiyFloats(oUpper, oTenMk);
+
+	// Widen the interval by the error of the scaling, digits in there may not belong to the value
+	unsigned long long iUnit = 1;
+	unsigned long long iTooLow = oScaledLower.m_iMantissa - iUnit;
+	unsigned long long iTooHigh = oScaledUpper.m_iMantissa + iUnit;
+	unsigned long long iUnsafeInterval = iTooHigh - iTooLow;
+
+	// Split the scaled upper boundary at the binary point
+	int iShift = -oScaled.m_iExponent;
+	unsigned long long iOne = 1ULL << iShift;
+	unsigned int iIntegrals = (unsigned int) (iTooHigh >> iShift);
+	unsigned long long iFractionals = iTooHigh & (iOne - 1);
+
+	// The biggest power of ten that fits in the integral part
+	int iKappa = 1;
+
+	while(iKappa < 10 && iIntegrals >= g_aPowersOfTen[iKappa])
+		iKappa++;
+
+	unsigned int iDivisor = g_aPowersOfTen[iKappa - 1];
+	iDigitCount = 0;
+
+	// The digits of the integral part, stop as soon as the rest is within the interval
+	while(iKappa > 0)
+	{
+		aDigits[iDigitCount++] = (char) ('0' + iIntegrals / iDivisor);
+		iIntegrals %= iDivisor;
+		iKappa--;
+
+		unsigned long long iRest = ((unsigned long long) iIntegrals << iShift) + iFractionals;
+
+		if(iRest < iUnsafeInterval)
+		{
+			iExponent = iKappa - oPower.m_iDecimalExponent;
+			return WeedDigits(aDigits, iDigitCount, iTooHigh - oScaled.m_iMantissa, iUnsafeInterval, iRest, (unsigned long long) iDivisor << iShift, iUnit);
+		}
+
+		iDivisor /= 10;
+	}
+
+	// The digits of the fractional part, the error grows with every digit
+	while(iDigitCount < FLOAT_MAX_DIGITS)
+	{
+		iFractionals *= 10;
+		iUnit *= 10;
+		iUnsafeInterval *= 10;
+		aDigits[iDigitCount++] = (char) ('0' + (iFractionals >> iShift));
+		iFractionals &= iOne - 1;
+		iKappa--;
+
+		if(iFractionals < iUnsafeInterval)
+		{
+			iExponent = iKappa - oPower.m_iDecimalExponent;
+			return WeedDigits(aDigits, iDigitCount, (iTooHigh - oScaled.m_iMantissa) * iUnit, iUnsafeInterval, iFractionals, iOne, iUnit);
+		}
+	}
+
 	return false;
 }
 
-// This function returns true if the string input is an integer, false otherwise
-bool IsInteger(std::string sInput)
+// Generates the shortest digits of a positive float with sprintf(), trying 15, 16 and then 17 significant digits
+static void GenerateDigitsSlow(double fValue, char * aDigits, int & iDigitCount, int & iExponent)
+{
+	char szNumber[MAX_NUMBER_STRING_LENGTH];
+
+	for(int iPrecision = 15; iPrecision <= FLOAT_MAX_DIGITS; iPrecision++)
+	{
+		sprintf_s(szNumber, sizeof(szNumber), "%.*e", iPrecision - 1, fValue);
+
+		// Up to 15 digits ParseFloatLiteral() reads the number back without calling strtod()
+		if(iPrecision == FLOAT_MAX_DIGITS || ParseFloatLiteral(szNumber, strlen(szNumber)) == fValue)
+			break;
+	}
+
+	// The number looks like d.ddde+x, take the digits without their trailing zeroes
+	const char * pCurrent = szNumber;
+	iDigitCount = 0;
+
+	for(; *pCurrent != 'e'; pCurrent++)
+	{
+		if(*pCurrent != '.')
+			aDigits[iDigitCount++] = *pCurrent;
+	}
+
+	int iScientificExponent = atoi(pCurrent + 1);
+
+	while(iDigitCount > 1 && aDigits[iDigitCount - 1] == '0')
+		iDigitCount--;
+
+	iExponent = iScientificExponent - (iDigitCount - 1);
+}
+
+// Writes digits * 10^iExponent like printf("%g") would with enough precision, returns the length
+static size_t WriteFloatDigits(const char * aDigits, int iDigitCount, int iExponent, char * szBuffer)
 {
-	std::string::const_iterator it = sInput.begin();
-	while (it != sInput.end() && std::isdigit(*it, std::locale()))
-		++it;
+	// The exponent of the first digit
+	int iScientificExponent = iDigitCount - 1 + iExponent;
+	char * pCurrent = szBuffer;
+
+	if(iScientificExponent < -4 || iScientificExponent >= FLOAT_MAX_DIGITS)
+	{
+		// d.ddde+xx, the exponent has at least two digits
+		*pCurrent++ = aDigits[0];
+
+		if(iDigitCount > 1)
+		{
+			*pCurrent++ = '.';
+			memcpy(pCurrent, aDigits + 1, iDigitCount - 1);
+			pCurrent += iDigitCount - 1;
+		}
+
+		*pCurrent++ = 'e';
+		*pCurrent++ = iScientificExponent < 0 ? '-' : '+';
+
+		unsigned int iMagnitude = iScientificExponent < 0 ? -iScientificExponent : iScientificExponent;
+
+		if(iMagnitude < 10)
+			*pCurrent++ = '0';
+
+		pCurrent += WriteDigits(iMagnitude, pCurrent);
+	}
+	else if(iExponent >= 0)
+	{
+		// An integer, the digits followed by zeroes
+		memcpy(pCurrent, aDigits, iDigitCount);
+		pCurrent += iDigitCount;
+
+		for(int i = 0; i < iExponent; i++)
+			*pCurrent++ = '0';
+	}
+	else if(iScientificExponent >= 0)
+	{
+		// The decimal point is in between the digits
+		memcpy(pCurrent, aDigits, iScientificExponent + 1);
+		pCurrent += iScientificExponent + 1;
+		*pCurrent++ = '.';
+		memcpy(pCurrent, aDigits + iScientificExponent + 1, iDigitCount - iScientificExponent - 1);
+		pCurrent += iDigitCount - iScientificExponent - 1;
+	}
+	else
+	{
+		// 0.000ddd
+		*pCurrent++ = '0';
+		*pCurrent++ = '.';
+
+		for(int i = -1; i > iScientificExponent; i--)
+			*pCurrent++ = '0';
+
+		memcpy(pCurrent, aDigits, iDigitCount);
+		pCurrent += iDigitCount;
+	}
 
-	return !sInput.empty() && it == sInput.end();
+	return pCurrent - szBuffer;
+}
+
+// This function writes an integer to the buffer and returns its length, the buffer is null terminated
+size_t FormatInteger(int iValue, char * szBuffer)
+{
+	size_t iLength = 0;
+
+	// INT_MIN can't be negated as an int, so negate it unsigned
+	unsigned int iMagnitude = (unsigned int) iValue;
+
+	if(iValue < 0)
+	{
+		szBuffer[iLength++] = '-';
+		iMagnitude = 0u - iMagnitude;
+	}
+
+	iLength += WriteDigits(iMagnitude, szBuffer + iLength);
+	szBuffer[iLength] = '\0';
+	return iLength;
+}
+
+// This function writes the shortest string that parses back (with ParseFloatLiteral() or atof()) to the same float
+// The digits come from Grisu3 or from sprintf() if Grisu3 can't prove its digits are the shortest, the layout is
+// the one printf("%g") uses: the exponent notation for very big and very small values, the fixed notation otherwise
+size_t FormatFloat(double fValue, char * szBuffer)
+{
+	size_t iLength = WriteSpecialFloat(fValue, szBuffer);
+
+	if(iLength != 0)
+		return iLength;
+
+	// Write the sign ourselves, this keeps the sign of -0 as well
+	double fMagnitude = fValue;
+
+	if(fValue < 0.0 || (fValue == 0.0 && 1.0 / fValue < 0.0))
+	{
+		szBuffer[iLength++] = '-';
+		fMagnitude = -fValue;
+	}
+
+	if(fMagnitude == 0.0)
+	{
+		memcpy(szBuffer + iLength, "0", 2);
+		return iLength + 1;
+	}
+
+	// The value is digits * 10^iExponent
+	char aDigits[FLOAT_MAX_DIGITS + 1];
+	int iDigitCount;
+	int iExponent;
+
+	if(!GenerateShortestDigits(fMagnitude, aDigits, iDigitCount, iExponent))
+		GenerateDigitsSlow(fMagnitude, aDigits, iDigitCount, iExponent);
+
+	iLength += WriteFloatDigits(aDigits, iDigitCount, iExponent, szBuffer + iLength);
+	szBuffer[iLength] = '\0';
+	return iLength;
+}
+
+// This function writes a float with iPrecision digits after the decimal point, like printf("%.*f") would
+// Values that aren't too big are scaled and rounded here, unless the scaled value is so close to a half
+// that the rounding error of the multiplication could decide the direction. Those go through sprintf()
+size_t FormatFixedFloat(double fValue, int iPrecision, char * szBuffer)
+{
+	size_t iLength = WriteSpecialFloat(fValue, szBuffer);
+
+	if(iLength != 0)
+		return iLength;
+
+	if(iPrecision < 0)
+		iPrecision = 0;
+	else if(iPrecision > MAX_FIXED_FLOAT_PRECISION)
+		iPrecision = MAX_FIXED_FLOAT_PRECISION;
+
+	double fMagnitude = fValue < 0.0 ? -fValue : fValue;
+	double fScaled = fMagnitude * g_aExactPowersOfTen[iPrecision];
+
+	// The scaled value is positive, so converting it to an integer rounds it down
+	if(fScaled < MAX_FAST_FIXED_FLOAT && fabs(fScaled - (double) (unsigned long long) fScaled - 0.5) > 1.0 / 4096.0)
+	{
+		unsigned long long iMantissa = (unsigned long long) (fScaled + 0.5);
+
+		// printf() keeps the sign of a negative value that rounds to 0, so do we
+		if(fValue < 0.0 || (fValue == 0.0 && 1.0 / fValue < 0.0))
+			szBuffer[iLength++] = '-';
+
+		iLength += WriteDecimal(iMantissa, iPrecision, szBuffer + iLength);
+		szBuffer[iLength] = '\0';
+		return iLength;
+	}
+
+	// Big values are written with all of their integer digits, the buffer has room for the biggest float
+	sprintf_s(szBuffer, MAX_FIXED_FLOAT_STRING_LENGTH, "%.*f", iPrecision, fValue);
+	return strlen(szBuffer);
 }
 
 // This function returns a string from a parameter type
-std::string GetTypeAsString(eParameterTypes eType)
+std::string GetTypeAsString(eVariableTypes eType)
 {
-	if(eType == PARAMETER_TYPE_INTEGER)
+	if(eType == VARIABLE_TYPE_INTEGER)
 		return "integer";
 
-	if(eType == PARAMETER_TYPE_FLOAT)
+	if(eType == VARIABLE_TYPE_FLOAT)
 		return "float";
 
-	if(eType == PARAMETER_TYPE_STRING)
+	if(eType == VARIABLE_TYPE_STRING)
 		return "string";
 
+	if(eType == VARIABLE_TYPE_ANY)
+		return "any";
+
 	return "Invalid type";
 }
\ No newline at end of file
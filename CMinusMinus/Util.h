@@ -12,10 +12,31 @@
 #pragma once
 
 #include "CParameter.h"
+#include <cstddef>
+#include <string>
 
-// This function returns true if the string input is a float or an integer, false otherwise
-bool IsFloatOrInteger(std::string sInput);
-// This function returns true if the string input is an integer, false otherwise
-bool IsInteger(std::string sInput);
+// This function returns true if the value starts like a number ("5", "3.14", ".5"), false otherwise
+// The value doesn't have to be null terminated
+bool IsNumericLiteral(const char * szValue, size_t iLength);
+// This function returns true if the value only consists of digits, false otherwise
+bool IsIntegerLiteral(const char * szValue, size_t iLength);
+// This function parses an integer literal, values that don't fit in an int are clamped to INT_MAX
+int ParseIntegerLiteral(const char * szValue, size_t iLength);
+// This function parses the float at the start of the value, the same way atof() would
+double ParseFloatLiteral(const char * szValue, size_t iLength);
+// The most characters FormatInteger() and FormatFloat() write, including the null terminator
+#define MAX_NUMBER_STRING_LENGTH 48
+// The most digits after the decimal point FormatFixedFloat() writes
+#define MAX_FIXED_FLOAT_PRECISION 17
+// The most characters FormatFixedFloat() writes: a sign, the 309 digits of the biggest float, the point, the decimals and the null terminator
+#define MAX_FIXED_FLOAT_STRING_LENGTH (1 + 309 + 1 + MAX_FIXED_FLOAT_PRECISION + 1)
+// This function writes an integer to the buffer and returns its length, the buffer is null terminated
+size_t FormatInteger(int iValue, char * szBuffer);
+// This function writes the shortest string that parses back (with ParseFloatLiteral() or atof()) to the same float
+// It returns the length of the string, the buffer is null terminated
+size_t FormatFloat(double fValue, char * szBuffer);
+// This function writes a float with iPrecision digits after the decimal point, like printf("%.*f") would
+// It returns the length of the string, the buffer (of MAX_FIXED_FLOAT_STRING_LENGTH characters) is null terminated
+size_t FormatFixedFloat(double fValue, int iPrecision, char * szBuffer);
 // This function returns a string from a parameter type
-std::string GetTypeAsString(eParameterTypes eType);
\ No newline at end of file
+std::string GetTypeAsString(eVariableTypes eType);
\ No newline at end of file